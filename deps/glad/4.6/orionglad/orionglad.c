@@ -30,6 +30,7 @@ typedef struct {
     GLuint dispatchIndirectBuffer;
     GLuint drawIndirectBuffer;
     GLuint elementArrayBuffer;
+    GLuint parameterBuffer;
     GLuint pixelPackBuffer;
     GLuint pixelUnpackBuffer;
     GLuint queryBuffer;
@@ -91,6 +92,8 @@ GLuint *_oriCurrentBufferPtrAt(GLenum target) {
             return &(_oriCurrentBuffers.drawIndirectBuffer);
         case GL_ELEMENT_ARRAY_BUFFER:
             return &(_oriCurrentBuffers.elementArrayBuffer);
+        case GL_PARAMETER_BUFFER:
+            return &(_oriCurrentBuffers.parameterBuffer);
         case GL_PIXEL_PACK_BUFFER:
             return &(_oriCurrentBuffers.pixelPackBuffer);
         case GL_PIXEL_UNPACK_BUFFER:
@@ -199,6 +202,8 @@ const GLenum orion_glGetBufferTarget(GLuint buffer) {
         return GL_DRAW_INDIRECT_BUFFER;
     } else if (buffer == _oriCurrentBuffers.elementArrayBuffer) {
         return GL_ELEMENT_ARRAY_BUFFER;
+    } else if (buffer == _oriCurrentBuffers.parameterBuffer) {
+        return GL_PARAMETER_BUFFER;
     } else if (buffer == _oriCurrentBuffers.pixelPackBuffer) {
         return GL_PIXEL_PACK_BUFFER;
     } else if (buffer == _oriCurrentBuffers.pixelUnpackBuffer) {
@@ -42,6 +42,7 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <glad/4.6/glad.h>
 #include <glad/4.6/orionglad/orionglad.h>
@@ -106,6 +107,23 @@ void oriDebugFlags(const unsigned int source, const unsigned int type, const uns
  */
 void oriSetFlag(unsigned int flag, int value);
 
+// ======================================================================================
+// *****                         ORION THREAD POOL FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Set the amount of worker threads that Orion uses for background work, such as decoding images loaded with
+ * oriLoadTextureAsync().
+ *
+ * @details The worker threads are started the first time they are needed; this has no effect after that (until
+ * oriTerminate() is called). By default, one thread is started for each CPU except one, up to 8.
+ *
+ * @param count the amount of worker threads, or 0 to choose from the amount of CPUs.
+ *
+ * @ingroup meta
+ */
+void oriSetWorkerThreadCount(const unsigned int count);
+
 // ======================================================================================
 // *****                        ORION FLAGS (for oriSetFlag())                      *****
 // ======================================================================================
@@ -194,6 +212,86 @@ typedef struct oriShader oriShader;
  */
 typedef struct oriBuffer oriBuffer;
 
+/**
+ * @brief An opaque, persistently-mapped buffer used to stream per-frame data to the GPU.
+ *
+ * @note All instances of oriStreamBuffer will be freed with oriTerminate().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriStreamBuffer oriStreamBuffer;
+
+/**
+ * @brief A region of an oriStreamBuffer handed out by oriStreamAlloc().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriStreamAllocation {
+    /// a write-only pointer to the allocated memory, or NULL if the allocation failed.
+    void *ptr;
+    /// the offset of the allocation (in bytes) from the start of the stream buffer's GL buffer object.
+    size_t offset;
+} oriStreamAllocation;
+
+/**
+ * @brief An opaque set of large OpenGL buffer objects that are sub-allocated into oriBufferRange handles.
+ *
+ * @note All instances of oriBufferHeap will be freed with oriTerminate().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBufferHeap oriBufferHeap;
+
+/**
+ * @brief A range of a buffer allocated from an oriBufferHeap.
+ *
+ * @details To use a range as an index buffer, bind @c buffer to @c GL_ELEMENT_ARRAY_BUFFER and pass @c offset as the
+ * indices offset of the draw call.
+ *
+ * @warning These members are read-only. They are updated when the range is moved by oriDefragmentBufferHeap().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBufferRange {
+    /// the heap that the range was allocated from.
+    oriBufferHeap *heap;
+    /// the buffer object that the range currently lives in.
+    oriBuffer *buffer;
+    /// the offset of the range into @c buffer, in bytes.
+    size_t offset;
+    /// the size of the range in bytes.
+    size_t size;
+    /// incremented every time the range is moved by oriDefragmentBufferHeap().
+    unsigned int generation;
+} oriBufferRange;
+
+/**
+ * @brief An opaque cache of OpenGL buffer objects that are recycled by size class and usage.
+ *
+ * @note All instances of oriBufferPool will be freed with oriTerminate().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBufferPool oriBufferPool;
+
+/**
+ * @brief An opaque, pending transfer of GPU data back to the CPU (see oriReadBufferAsync()).
+ *
+ * @note All instances of oriReadback will be freed with oriTerminate().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriReadback oriReadback;
+
+/**
+ * @brief An opaque buffer with a large virtual address range, of which only some pages are backed by memory.
+ *
+ * @note All instances of oriSparseBuffer will be freed with oriTerminate().
+ *
+ * @ingroup buffers
+ */
+typedef struct oriSparseBuffer oriSparseBuffer;
+
 /**
  * @brief An opaque OpenGL vertex array object.
  * 
@@ -203,6 +301,80 @@ typedef struct oriBuffer oriBuffer;
  */
 typedef struct oriVertexArray oriVertexArray;
 
+/**
+ * @brief An opaque description of a vertex format with shared vertex buffer binding slots.
+ *
+ * @note All instances of oriVertexLayout will be freed with oriTerminate().
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriVertexLayout oriVertexLayout;
+
+/**
+ * @brief An opaque chain of simplified index buffers for one mesh (see oriCreateMeshLOD()).
+ *
+ * @note All instances of oriMeshLOD will be freed with oriTerminate().
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriMeshLOD oriMeshLOD;
+
+/**
+ * @brief An opaque mesh split into clusters of triangles that are culled individually (see oriCreateClusteredMesh()).
+ *
+ * @note All instances of oriClusteredMesh will be freed with oriTerminate().
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriClusteredMesh oriClusteredMesh;
+
+/**
+ * @brief A description of one float attribute of interleaved vertices, and the format to pack it into (see
+ * oriPackVertices()).
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriPackedAttribute {
+    // the index of the generic vertex attribute
+    unsigned int index;
+    // the packed format, e.g. ORION_PACK_HALF
+    unsigned int format;
+    // the amount of float components of the source attribute (1-4)
+    unsigned int components;
+    // the offset of the source attribute in each source vertex, in floats
+    unsigned int srcOffset;
+} oriPackedAttribute;
+
+/**
+ * @brief Interleaved, indexed vertex data in client memory, to be optimised with oriOptimiseMesh().
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriMeshData {
+    // the interleaved vertices
+    float *vertices;
+    // the amount of vertices
+    size_t vertexCount;
+    // the amount of floats in each vertex
+    unsigned int stride;
+    // the offset of the 3-component position in each vertex, in floats
+    unsigned int positionOffset;
+
+    // the indices of a triangle list
+    unsigned int *indices;
+    // the amount of indices
+    size_t indexCount;
+} oriMeshData;
+
+/**
+ * @brief An opaque list of indirect draw commands (see oriCreateDrawList()).
+ *
+ * @note All instances of oriDrawList will be freed with oriTerminate().
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriDrawList oriDrawList;
+
 /**
  * @brief An opaque OpenGL texture object.
  * 
@@ -212,10 +384,109 @@ typedef struct oriVertexArray oriVertexArray;
  */
 typedef struct oriTexture oriTexture;
 
+/**
+ * @brief A CPU copy of one level of a texture, whose changed regions are uploaded in one batch.
+ *
+ * @note All instances of oriTextureShadow will be freed with oriTerminate().
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureShadow oriTextureShadow;
+
+/**
+ * @brief A 2D array texture that images are packed into at runtime.
+ *
+ * @note All instances of oriTextureAtlas will be freed with oriTerminate().
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureAtlas oriTextureAtlas;
+
+/**
+ * @brief The location of an image packed into an oriTextureAtlas.
+ *
+ * @ingroup textures
+ */
+typedef struct oriAtlasRegion {
+    // the texture coordinates of the image (u0, v0 at its first texel and u1, v1 past its last), and its array layer
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+    unsigned int layer;
+    // the position and size of the image in the layer, in texels (without padding)
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+} oriAtlasRegion;
+
+/**
+ * @brief A set of 2D array textures that same-sized textures are allocated from as layers.
+ *
+ * @note All instances of oriTextureArrayPool will be freed with oriTerminate().
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureArrayPool oriTextureArrayPool;
+
+/**
+ * @brief A layer of a 2D array texture allocated from an oriTextureArrayPool.
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureLayer {
+    // the array texture to bind (owned by the pool)
+    oriTexture *array;
+    // the index of the layer in the array, to select it with in shaders
+    unsigned int layer;
+} oriTextureLayer;
+
+/**
+ * @brief A GPU memory budget that managed textures are evicted to low-resolution mipmaps to stay under.
+ *
+ * @note All instances of oriTextureResidency will be freed with oriTerminate().
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureResidency oriTextureResidency;
+
+/**
+ * @brief A texture that is too large to be resident, which is sampled through a cache of its pages.
+ *
+ * @note All instances of oriVirtualTexture will be freed with oriTerminate().
+ *
+ * @ingroup textures
+ */
+typedef struct oriVirtualTexture oriVirtualTexture;
+
+/**
+ * @brief Options for loading a texture with oriLoadTextureAsync().
+ *
+ * @ingroup textures
+ */
+typedef struct oriTextureLoadParams {
+    // the internal format of the texture, or 0 to choose one from the image's channels (e.g. GL_RGBA8 for 4 channels)
+    unsigned int internalFormat;
+    // the amount of channels to decode the image to (1-4), or 0 to keep the image's own
+    unsigned int channels;
+    // true to flip the image vertically, so that its first row is at the bottom as OpenGL expects
+    bool flipVertically;
+    // true to build mipmaps for the image (on the worker thread) and upload them with it
+    bool generateMipmaps;
+    // the filter to build mipmaps with: ORION_MIP_FILTER_BOX or ORION_MIP_FILTER_KAISER
+    unsigned int mipmapFilter;
+} oriTextureLoadParams;
+
 // ======================================================================================
 // *****                          ORION TEXTURE FUNCTIONS                           *****
 // ======================================================================================
 
+// mipmap policies (for oriSetTextureMipmapPolicy())
+#define ORION_MIPMAPS_AUTO      0x00    // generate mipmaps after an upload if the minifying filter samples them
+#define ORION_MIPMAPS_ALWAYS    0x01    // generate mipmaps after every upload
+#define ORION_MIPMAPS_NEVER     0x02    // never generate mipmaps after an upload
+
 
 /**
  * @brief Allocate and initialise a new oriTexture structure with mutable storage.
@@ -271,6 +542,8 @@ void oriFreeTexture(oriTexture *texture);
 /**
  * @brief Bind a given texture to the specified target.
  * 
+ * @details If the texture is managed by an oriTextureResidency, it is marked as used (see oriUpdateTextureResidency()).
+ *
  * @param texture the texture to bind.
  * @param unit the texture image unit to bind the texture to.
  * 
@@ -308,7 +581,8 @@ void oriGetTextureProperty(oriTexture *texture, unsigned int *type, unsigned int
 /**
  * @brief Fill the given texture's storage with an image at the specified path.
  * 
- * @details The path is relative to the location of the executable.
+ * @details The path is relative to the location of the executable. Afterwards, mipmaps are generated according to the
+ * texture's mipmap policy (see oriSetTextureMipmapPolicy()).
  * 
  * @param texture the texture object to update.
  * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if @c data is an unsigned char array)
@@ -322,6 +596,101 @@ void oriGetTextureProperty(oriTexture *texture, unsigned int *type, unsigned int
  */
 void oriUploadTexImage(oriTexture *texture, unsigned int dataType, const void *data, unsigned int width, unsigned int height, unsigned int depth, unsigned int imageFormat);
 
+/**
+ * @brief Update a region of one level of the given texture with an image, without reallocating its storage.
+ *
+ * @details Unlike oriUploadTexImage(), only the given region is written, and no mipmaps are generated (see
+ * oriGenerateTextureMipmaps()). The texture must already have storage for the region, i.e. it must have immutable
+ * storage or have had an image uploaded to it. For cube maps, @c z is the face index (0-5), in the order of
+ * @c GL_TEXTURE_CUBE_MAP_POSITIVE_X onwards.
+ *
+ * To batch many small updates into one upload per frame, use an oriTextureShadow instead.
+ *
+ * @param texture the texture object to update.
+ * @param level the mipmap level to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region (or the layer, for 1D array textures). Set to 0 if the texture is 1D.
+ * @param z the z offset of the region (or the layer or face, for array and cube map textures). Set to 0 if the texture
+ * is 1D or 2D.
+ * @param width the width of the region.
+ * @param height the height of the region. Set to 1 if the texture is 1D.
+ * @param depth the depth of the region. Set to 1 if the texture is 1D or 2D.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if @c data is an unsigned char array)
+ * @param data the image data to write to the region.
+ * @param imageFormat the format of the image data.
+ *
+ * @ingroup textures
+ */
+void oriUploadTexSubImage(oriTexture *texture, unsigned int level, int x, int y, int z, unsigned int width, unsigned int height, unsigned int depth, unsigned int dataType, const void *data, unsigned int imageFormat);
+
+/**
+ * @brief Fill every mipmap level of the given 2D texture with the given images.
+ *
+ * @details This uploads a mipmap chain that was built ahead of time (e.g. with oriGenerateMipChain(), or loaded from a
+ * file), so no mipmaps are generated by the GL. If the texture has immutable storage, it must have at least
+ * @c levelCount levels; otherwise, storage is reallocated for each level, and @c GL_TEXTURE_MAX_LEVEL is set so that
+ * the texture is complete with only the given levels.
+ *
+ * @param texture the texture object to update. Its type must be @c GL_TEXTURE_2D.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level. Each level is half the size of the one
+ * above it (rounded down, to a minimum of 1), with tightly packed rows.
+ * @param levelCount the amount of levels to upload.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriUploadTexMipmaps(oriTexture *texture, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height, unsigned int imageFormat);
+
+/**
+ * @brief Fill every mipmap level of the given 2D texture with the given block-compressed images.
+ *
+ * @details This is the compressed counterpart of oriUploadTexMipmaps(): each level is written with
+ * glCompressedTex(ture)SubImage2D if the texture has immutable storage (which must have the same compressed internal
+ * format and at least @c levelCount levels), or with glCompressedTexImage2D otherwise.
+ *
+ * @param texture the texture object to update. Its type must be @c GL_TEXTURE_2D.
+ * @param format the compressed format of the images (see oriCompressImage()).
+ * @param levels an array of @c levelCount compressed images, starting with the base level (e.g. from
+ * oriCompressImage()).
+ * @param levelCount the amount of levels to upload.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ *
+ * @ingroup textures
+ */
+void oriUploadCompressedTexMipmaps(oriTexture *texture, unsigned int format, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height);
+
+/**
+ * @brief Generate the mipmaps of the given texture from its base level with the GL.
+ *
+ * @details This is done by oriUploadTexImage() if the texture's mipmap policy asks for it (see
+ * oriSetTextureMipmapPolicy()); call it directly when the policy is @c ORION_MIPMAPS_NEVER, e.g. after several partial
+ * updates.
+ *
+ * @param texture the texture to update.
+ *
+ * @ingroup textures
+ */
+void oriGenerateTextureMipmaps(oriTexture *texture);
+
+/**
+ * @brief Set when oriUploadTexImage() generates mipmaps for the given texture.
+ *
+ * @details By default (@c ORION_MIPMAPS_AUTO), mipmaps are generated after an upload only if the texture's minifying
+ * filter samples them, so textures filtered with @c GL_NEAREST or @c GL_LINEAR (such as video frames) are uploaded
+ * without regenerating a mipmap chain every time. @c ORION_MIPMAPS_ALWAYS generates them after every upload, and
+ * @c ORION_MIPMAPS_NEVER leaves them to oriGenerateTextureMipmaps() or oriUploadTexMipmaps().
+ *
+ * @param texture the texture to update.
+ * @param policy the mipmap policy: @c ORION_MIPMAPS_AUTO, @c ORION_MIPMAPS_ALWAYS or @c ORION_MIPMAPS_NEVER.
+ *
+ * @ingroup textures
+ */
+void oriSetTextureMipmapPolicy(oriTexture *texture, unsigned int policy);
+
 /**
  * @brief Set a parameter for the given texture.
  * 
@@ -365,124 +734,2317 @@ int oriGetTextureParameteri(oriTexture *texture, unsigned int param);
 float oriGetTextureParameterf(oriTexture *texture, unsigned int param);
 
 // ======================================================================================
-// *****                           ORION BUFFER FUNCTIONS                           *****
+// *****                        ORION TEXTURE LOADING FUNCTIONS                     *****
 // ======================================================================================
 
 /**
- * @brief Allocate and initialise a new oriBuffer structure.
- * 
- * @ingroup buffers
+ * @brief Start loading a 2D texture from an image file in the background, and return it straight away with a placeholder
+ * image.
+ *
+ * @details The image is decoded with stb_image on a worker thread (see oriSetWorkerThreadCount()), then uploaded over
+ * the following frames by oriProcessTextureLoads(), which must be called regularly (e.g. once per frame) on the thread
+ * with the GL context. Until then, the texture is a 1x1 opaque grey image. Once the upload is complete, the placeholder
+ * is replaced, keeping the filtering and wrapping parameters that were set on it, so the returned texture can be used
+ * straight away and will show the image once it is ready.
+ *
+ * If the image can't be loaded, a warning is thrown by oriProcessTextureLoads() and the placeholder is kept.
+ *
+ * @param path the path of the image file (any format supported by stb_image, e.g. PNG or JPEG), relative to the
+ * location of the executable.
+ * @param params how to load the image, or NULL for the defaults (all zero/false, except that mipmaps are generated).
+ *
+ * @ingroup textures
  */
-oriBuffer *oriCreateBuffer();
+oriTexture *oriLoadTextureAsync(const char *path, const oriTextureLoadParams *params);
 
 /**
- * @brief Destroy and free memory for the given buffer.
- * 
- * @param buffer the buffer to free
- * 
- * @ingroup buffers
+ * @brief Upload the images of textures loaded with oriLoadTextureAsync() that have finished decoding.
+ *
+ * @details This must be called on the thread with the GL context, e.g. once per frame. Images are uploaded a few rows at a
+ * time, so that at most the budget set with oriSetTextureUploadBudget() is uploaded per call, and a large texture
+ * doesn't stall a single frame. The rows are staged in one pixel unpack buffer the size of the budget, shared by every
+ * load and reused as a ring.
+ *
+ * @ingroup textures
  */
-void oriFreeBuffer(oriBuffer *buffer);
+void oriProcessTextureLoads();
 
 /**
- * @brief Bind the given buffer.
- * 
- * @param buffer the buffer to bind.
- * @param target the OpenGL buffer target to bind the buffer to.
- * 
- * @ingroup buffers
+ * @brief Set the amount of bytes of image data that oriProcessTextureLoads(), oriProcessTextureStreaming() and
+ * oriUpdateVirtualTexture() each upload per call.
+ *
+ * @param bytes the upload budget in bytes, or 0 for the default (4 MiB).
+ *
+ * @ingroup textures
  */
-void oriBindBuffer(oriBuffer *buffer, unsigned int target);
+void oriSetTextureUploadBudget(const size_t bytes);
 
 /**
- * @brief Return the OpenGL handle to the given buffer struct.
- * 
- * @param buffer the buffer to inspect.
- * 
- * @ingroup buffers
+ * @brief Return true if the given texture was created with oriLoadTextureAsync() and is still showing its placeholder.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
  */
-unsigned int oriGetBufferHandle(oriBuffer *buffer);
+bool oriIsTextureLoading(oriTexture *texture);
+
+// ======================================================================================
+// *****                        ORION TEXTURE SHADOW FUNCTIONS                      *****
+// ======================================================================================
 
 /**
- * @brief Set data in a given oriBuffer structure.
- * 
- * @param buffer the buffer to copy data into.
- * @param data the data to copy in @c buffer.
- * @param size the size of the given data.
- * @param usage the usage of the buffer.
- * 
- * @ingroup buffers
+ * @brief Allocate and initialise a CPU copy of one level of the given texture, for batching small updates to it.
+ *
+ * @details Updates are written to the shadow with oriWriteTextureShadow() (or directly through
+ * oriGetTextureShadowData() and oriMarkTextureShadowDirty()), which only records the regions that changed. Regions that
+ * overlap or sit next to each other are merged when their bounding rectangle wastes few texels. oriFlushTextureShadows()
+ * then uploads the changed regions of every shadow through one pixel unpack buffer, e.g. once per frame. This suits
+ * dynamic atlases, lightmap patches and video tiles, which change a few small regions at a time.
+ *
+ * The texture's storage is not read back: the shadow starts with the given image, or zeroes.
+ *
+ * @param texture the texture to shadow. It must already have storage for the level.
+ * @param level the mipmap level to shadow. It must be less than the texture's level count, if that is known.
+ * @param layer the layer (or face, for cube maps) to shadow, for array, cube map and 3D textures. Set to 0 otherwise.
+ * @param dataType the GL type of the shadow's texels (e.g. GL_UNSIGNED_BYTE).
+ * @param imageFormat the format of the shadow's texels (e.g. GL_RGBA).
+ * @param data the initial image of the shadow, with tightly packed rows, or NULL to start with zeroes.
+ *
+ * @warning If the texture is freed before the shadow, the shadow is detached from it and its changes are no longer
+ * uploaded; it must still be freed with oriFreeTextureShadow().
+ *
+ * @ingroup textures
+ */
+oriTextureShadow *oriCreateTextureShadow(oriTexture *texture, unsigned int level, unsigned int layer, unsigned int dataType, unsigned int imageFormat, const void *data);
+
+/**
+ * @brief Destroy and free memory for the given texture shadow.
+ *
+ * @details Changes that haven't been flushed with oriFlushTextureShadows() are discarded.
+ *
+ * @param shadow the texture shadow to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureShadow(oriTextureShadow *shadow);
+
+/**
+ * @brief Return the CPU copy of the texels of the given texture shadow.
+ *
+ * @details Rows are tightly packed, starting from the first row of the texture. Regions written through this pointer
+ * must be marked with oriMarkTextureShadowDirty() to be uploaded.
+ *
+ * @param shadow the texture shadow to inspect.
+ *
+ * @ingroup textures
+ */
+void *oriGetTextureShadowData(oriTextureShadow *shadow);
+
+/**
+ * @brief Mark a region of the given texture shadow as changed, so that it is uploaded by the next call to
+ * oriFlushTextureShadows().
+ *
+ * @details The region is clipped to the shadow.
+ *
+ * @param shadow the texture shadow to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region, in texels.
+ * @param width the width of the region.
+ * @param height the height of the region.
+ *
+ * @ingroup textures
+ */
+void oriMarkTextureShadowDirty(oriTextureShadow *shadow, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+/**
+ * @brief Write an image to a region of the given texture shadow and mark it as changed.
+ *
+ * @param shadow the texture shadow to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region, in texels.
+ * @param width the width of the region (and the image).
+ * @param height the height of the region (and the image).
+ * @param data the image to write, with tightly packed rows, in the data type and format of the shadow.
+ *
+ * @ingroup textures
+ */
+void oriWriteTextureShadow(oriTextureShadow *shadow, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data);
+
+/**
+ * @brief Upload the changed regions of every texture shadow.
+ *
+ * @details The regions are packed into one pixel unpack buffer (orphaned and mapped once per call), then copied into
+ * their textures with one glTex(ture)SubImage* call each. Call this once per frame, before drawing with the textures.
+ * No mipmaps are generated; use oriGenerateTextureMipmaps() if the shadowed level is the base of a mipmapped texture.
+ *
+ * @ingroup textures
  */
-void oriSetBufferData(oriBuffer *buffer, const void *data, const unsigned int size, const unsigned int usage);
+void oriFlushTextureShadows();
 
 // ======================================================================================
-// *****                     ORION VERTEX SPECIFICATION FUNCTIONS                   *****
+// *****                        ORION TEXTURE ATLAS FUNCTIONS                       *****
 // ======================================================================================
 
 /**
- * @brief Allocate and initialise a new oriVertexArray structure.
- * 
- * @ingroup vertexspec
+ * @brief Allocate and initialise a new texture atlas: a 2D array texture that images can be packed into at runtime.
+ *
+ * @details Many small images (e.g. UI elements, glyphs or sprites) can be packed into one atlas, so that they are drawn
+ * with the same texture binding and can be batched together. Images are inserted with oriInsertTextureAtlasImage(),
+ * which places them with a skyline packer and returns where they were placed. When a layer is full, a layer is added to
+ * the array.
+ *
+ * Inserted images are written to a CPU copy of each layer (see oriTextureShadow) and uploaded by
+ * oriUpdateTextureAtlas(), which should be called once per frame before drawing with the atlas.
+ *
+ * The texture starts with one layer, linear filtering (trilinear if it has more than one level) and clamp-to-edge
+ * wrapping; sample it with a @c sampler2DArray.
+ *
+ * @param width the width of each layer of the atlas, in texels.
+ * @param height the height of each layer of the atlas, in texels.
+ * @param internalFormat the internal format of the texture, e.g. @c GL_RGBA8.
+ * @param imageFormat the format of the images that will be inserted, e.g. @c GL_RGBA.
+ * @param dataType the GL type of the images that will be inserted, e.g. @c GL_UNSIGNED_BYTE.
+ * @param levels the amount of mipmap levels of the texture.
+ * @param padding the amount of texels around each image that its edges are repeated into, so that filtering doesn't
+ * bleed neighbouring images into it. For mipmapped atlases, this should be at least 2 to the power of (levels - 1) to
+ * keep the smallest levels clean.
+ *
+ * @ingroup textures
  */
-oriVertexArray *oriCreateVertexArray();
+oriTextureAtlas *oriCreateTextureAtlas(unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int imageFormat, unsigned int dataType, unsigned int levels, unsigned int padding);
 
 /**
- * @brief Destroy and free memory for the given vertex array.
- * 
- * @param va the vertex array to free.
- * 
- * @ingroup vertexspec
+ * @brief Destroy and free memory for the given texture atlas, including its texture.
+ *
+ * @param atlas the texture atlas to free.
+ *
+ * @ingroup textures
  */
-void oriFreeVertexArray(oriVertexArray *va);
+void oriFreeTextureAtlas(oriTextureAtlas *atlas);
 
 /**
- * @brief Bind a vertex array.
- * 
- * @param va the vertex array to bind.
- * 
- * @ingroup vertexspec
+ * @brief Pack an image into the given texture atlas.
+ *
+ * @details The image is placed in the first layer with room for it (with its padding), at the lowest position the
+ * skyline packer finds; if no layer has room, a layer is added. Adding a layer reallocates the texture's storage, so
+ * every layer is uploaded again by the next call to oriUpdateTextureAtlas(). The handle of the atlas' texture changes,
+ * but the oriTexture returned by oriGetTextureAtlasTexture() stays the same.
+ *
+ * Texture coordinates in @c region cover the image without its padding, with v = 0 at its first row.
+ *
+ * @param atlas the texture atlas to insert into.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param data the image, with tightly packed rows, in the format and type given to oriCreateTextureAtlas().
+ * @param region the location of the image in the atlas. Not written to if the image couldn't be inserted.
+ * @return true if the image was inserted, or false if it is larger than a layer or no more layers can be added.
+ *
+ * @ingroup textures
  */
-void oriBindVertexArray(oriVertexArray *va);
+bool oriInsertTextureAtlasImage(oriTextureAtlas *atlas, unsigned int width, unsigned int height, const void *data, oriAtlasRegion *region);
 
 /**
- * @brief Return the OpenGL handle to the given vertex array.
- * 
- * @param va the vertex array to inspect.
- * 
- * @ingroup vertexspec
+ * @brief Upload the images inserted into the given texture atlas since the last call, and regenerate its mipmaps if it
+ * has any.
+ *
+ * @details The images are uploaded with oriFlushTextureShadows(), so this also flushes every other texture shadow.
+ *
+ * @param atlas the texture atlas to update.
+ *
+ * @ingroup textures
  */
-unsigned int oriGetVertexArrayHandle(oriVertexArray *va);
+void oriUpdateTextureAtlas(oriTextureAtlas *atlas);
 
 /**
- * @brief Specifies vertex data with the given attribute format.
- * @details @c buffer @b should be a vertex buffer. But it does not necessarily have to be.
- * According to the OpenGL specification:
- *  > [Vertex Buffer Objects] are no different from any other buffer object, and a buffer object used for Transform
- *  > Feedback or asynchronous pixel transfers can be used as source values for vertex arrays.
- * 
- * @warning The buffer still needs to be bound to @c GL_ARRAY_BUFFER when not using direct state access. So
- * if your GL version is below 4.5 and your buffer is not bound to @c GL_ARRAY_BUFFER then you will get a warning in the
- * console and @b the @b function @b will @b exit @b early.
- * 
- * @param va the vertex array object (VAO) to store the vertex data in.
- * @param buffer the buffer to read from.
- * @param index the index of the vertex attribute to be defined.
- * @param size the number of components per vertex attribute.
- * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
- * @param normalised should the data be normalised
- * @param stride the byte offset between each vertex attribute.
- * @param offset an offset of the first component of the vertex attribute.
- * 
- * @ingroup vertexspec
+ * @brief Forget every image packed into the given texture atlas, so that its space can be reused.
+ *
+ * @details The texels of the atlas aren't cleared; images inserted afterwards overwrite them.
+ *
+ * @param atlas the texture atlas to reset.
+ *
+ * @ingroup textures
  */
-void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer, 
-    const unsigned int index,
-    const unsigned int size,
-    const unsigned int type,
-    const bool normalised,
-    const unsigned int stride,
-    const unsigned int offset
-);
+void oriResetTextureAtlas(oriTextureAtlas *atlas);
+
+/**
+ * @brief Return the 2D array texture of the given texture atlas.
+ *
+ * @param atlas the texture atlas to inspect.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetTextureAtlasTexture(oriTextureAtlas *atlas);
+
+/**
+ * @brief Return the amount of layers in the given texture atlas.
+ *
+ * @param atlas the texture atlas to inspect.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetTextureAtlasLayerCount(oriTextureAtlas *atlas);
+
+// ======================================================================================
+// *****                    ORION TEXTURE ARRAY POOL FUNCTIONS                      *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new texture array pool.
+ *
+ * @details Textures that share their size, internal format and level count are allocated as layers of the same 2D array
+ * texture (see oriAllocateTextureArrayLayer()), instead of as textures of their own. Draws that use any of them can then
+ * bind the array once and select the texture with the layer index, e.g. from a uniform, an instance attribute or a
+ * material buffer, so that they can be batched together (sample it with a @c sampler2DArray).
+ *
+ * Each array is created with immutable storage for @c layersPerArray layers when the first layer of its size is
+ * allocated, and another is created when it is full.
+ *
+ * @param layersPerArray the amount of layers in each array texture; at most @c GL_MAX_ARRAY_TEXTURE_LAYERS. As the
+ * storage for every layer is allocated with the array, this trades memory held in reserve for fewer arrays to bind.
+ *
+ * @ingroup textures
+ */
+oriTextureArrayPool *oriCreateTextureArrayPool(unsigned int layersPerArray);
+
+/**
+ * @brief Destroy and free memory for the given texture array pool, including all of its array textures.
+ *
+ * @param pool the texture array pool to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureArrayPool(oriTextureArrayPool *pool);
+
+/**
+ * @brief Allocate a layer for a texture with the given size, internal format and level count from the given pool.
+ *
+ * @details The layer is taken from an array with the same size, format and level count that has a free layer, or from
+ * a new array if none do. Its contents are undefined until they are uploaded, e.g. with oriUploadTextureArrayLayer().
+ *
+ * @param pool the texture array pool to allocate from.
+ * @param width the width of the texture.
+ * @param height the height of the texture.
+ * @param internalFormat the internal format of the texture, e.g. @c GL_RGBA8.
+ * @param levels the amount of mipmap levels of the texture.
+ * @param layer the array texture and layer index that were allocated.
+ *
+ * @ingroup textures
+ */
+void oriAllocateTextureArrayLayer(oriTextureArrayPool *pool, unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levels, oriTextureLayer *layer);
+
+/**
+ * @brief Return a layer allocated with oriAllocateTextureArrayLayer() to its pool, so that it can be allocated again.
+ *
+ * @details The layer's contents are left as they are. Arrays that have no layers allocated are kept until
+ * oriTrimTextureArrayPool() is called.
+ *
+ * @param pool the texture array pool the layer was allocated from.
+ * @param layer the layer to release.
+ *
+ * @ingroup textures
+ */
+void oriReleaseTextureArrayLayer(oriTextureArrayPool *pool, const oriTextureLayer *layer);
+
+/**
+ * @brief Free every array of the given texture array pool that has no layers allocated.
+ *
+ * @param pool the texture array pool to trim.
+ *
+ * @ingroup textures
+ */
+void oriTrimTextureArrayPool(oriTextureArrayPool *pool);
+
+/**
+ * @brief Fill the mipmap levels of a layer allocated with oriAllocateTextureArrayLayer() with the given images.
+ *
+ * @details Mipmaps can't be generated with the GL for one layer alone (glGenerateMipmap() would regenerate every layer
+ * of the array), so the levels are uploaded as they are given; oriGenerateMipChain() can build them on the CPU. Any
+ * levels that aren't given are left undefined.
+ *
+ * @param layer the layer to update.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows.
+ * @param levelCount the amount of levels to upload; at most the level count the layer was allocated with.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriUploadTextureArrayLayer(const oriTextureLayer *layer, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int imageFormat);
+
+// ======================================================================================
+// *****                      ORION TEXTURE COMPRESSION FUNCTIONS                   *****
+// ======================================================================================
+
+// S3TC formats (from GL_EXT_texture_compression_s3tc and GL_EXT_texture_sRGB, which the GL loader doesn't include)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#   define GL_COMPRESSED_RGB_S3TC_DXT1_EXT          0x83F0
+#   define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT         0x83F1
+#   define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT         0x83F2
+#   define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT         0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#   define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT         0x8C4C
+#   define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT   0x8C4D
+#   define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT   0x8C4E
+#   define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT   0x8C4F
+#endif
+
+/**
+ * @brief Return the size in bytes of an image of the given dimensions compressed to the given block-compressed format.
+ *
+ * @param format the compressed format (see oriCompressImage()).
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @return the size of the compressed image, or 0 if the format isn't supported.
+ *
+ * @ingroup textures
+ */
+size_t oriGetCompressedImageSize(unsigned int format, unsigned int width, unsigned int height);
+
+/**
+ * @brief Compress an 8-bit image to a block-compressed (BCn) format, on the worker threads.
+ *
+ * @details The image is split into bands of 4x4 blocks that are compressed in parallel (see oriSetWorkerThreadCount());
+ * this function returns once every band is done. Endpoints are fitted along the principal axis of each block's colours,
+ * and indices are chosen with SIMD distance searches where they are available. The supported formats are:
+ *  - @c GL_COMPRESSED_RGB_S3TC_DXT1_EXT / @c GL_COMPRESSED_SRGB_S3TC_DXT1_EXT (BC1; opaque colour, 4 bits per texel)
+ *  - @c GL_COMPRESSED_RGBA_S3TC_DXT5_EXT / @c GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT (BC3; colour and alpha, 8 bits)
+ *  - @c GL_COMPRESSED_RED_RGTC1 (BC4; one channel, 4 bits)
+ *  - @c GL_COMPRESSED_RG_RGTC2 (BC5; two channels, e.g. normal maps, 8 bits)
+ *  - @c GL_COMPRESSED_RGBA_BPTC_UNORM / @c GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM (BC7; colour and alpha, 8 bits)
+ *
+ * BC7 is encoded with mode 6 only (one subset), which is fast and suits most images, but doesn't reach the quality of
+ * an exhaustive offline encoder.
+ *
+ * The result can be uploaded with oriUploadCompressedTexMipmaps(); oriLoadTextureAsync() compresses images itself if it
+ * is given one of these formats.
+ *
+ * @param image the image, with tightly packed rows. Images that aren't a multiple of 4 texels in size have their edge
+ * texels repeated to fill their last blocks.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param channels the amount of channels in the image (1-4). Missing colour channels are read as 0 and missing alpha as
+ * 255.
+ * @param format the compressed format.
+ * @param dst the array to write the compressed image to. It must hold at least oriGetCompressedImageSize() bytes.
+ *
+ * @ingroup textures
+ */
+void oriCompressImage(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int format, void *dst);
+
+/**
+ * @brief Set the directory that compressed textures are cached in, so that images are only compressed once.
+ *
+ * @details When oriLoadTextureAsync() loads an image to a compressed format, it looks for a cache entry keyed by a hash
+ * of the image file's contents and the load parameters; if there is one, the compressed levels are read from it instead
+ * of being decoded and compressed again. Otherwise, the compressed levels are written to a new entry. Entries written
+ * by another version of the encoder are ignored.
+ *
+ * Loads that have already started keep using the directory that was set when they started.
+ *
+ * @param path the directory to cache compressed textures in (which must exist), relative to the location of the
+ * executable, or NULL to stop caching (the default).
+ *
+ * @ingroup textures
+ */
+void oriSetTextureCacheDirectory(const char *path);
+
+// ======================================================================================
+// *****                      ORION TEXTURE CONTAINER FUNCTIONS                     *****
+// ======================================================================================
+
+/**
+ * @brief Load a texture from a KTX2 or DDS container file, with the format, mipmap levels and layers stored in it.
+ *
+ * @details Unlike oriLoadTextureAsync(), nothing is decoded: the file is mapped into memory, its level index is parsed
+ * and each image is uploaded straight from the mapped pages to immutable storage created with
+ * oriCreateTextureImmutable(), without being copied into memory of its own first. This makes it the fastest way to
+ * load textures that were baked ahead of time, especially block-compressed ones, which are uploaded as they are.
+ *
+ * 2D, 2D array, cube map, cube map array and 3D textures are supported, in uncompressed 8-bit, half-float and float
+ * formats or the BC1-BC7 compressed formats (BC1-BC3 need @c GL_EXT_texture_compression_s3tc). KTX2 files must not be
+ * supercompressed (e.g. with Basis Universal or zstd). If a KTX2 file has a level count of 0, the rest of the mipmap
+ * chain is generated with the GL; the GL can't generate mipmaps of compressed textures, so only the stored level is
+ * loaded for those.
+ *
+ * If the file can't be loaded, a warning is thrown and NULL is returned.
+ *
+ * @param path the path of the container file, relative to the location of the executable.
+ * @return the texture, or NULL if it couldn't be loaded.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriLoadTextureContainer(const char *path);
+
+// ======================================================================================
+// *****                      ORION TEXTURE RESIDENCY FUNCTIONS                     *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new texture residency manager.
+ *
+ * @details Textures added to the manager with oriAddResidentTexture() are counted against a GPU memory budget, with the
+ * estimate from oriGetTextureMemorySize(). When oriUpdateTextureResidency() finds the budget exceeded, the textures
+ * that were bound least recently (with oriBindTexture()) are evicted: their storage is reallocated with only the
+ * mipmap levels of at most @c evictedSize texels across, or with a 1x1 placeholder if they have no levels that small.
+ * A texture that is bound while evicted is restored to full resolution from its CPU copy by the next update.
+ *
+ * This lets an application keep more textures loaded than fit in GPU memory at once, as long as those that are drawn
+ * in any one frame do.
+ *
+ * @param budget the amount of GPU memory in bytes that the managed textures should fit in.
+ * @param evictedSize the largest width or height of the level that evicted textures keep, e.g. 64.
+ *
+ * @ingroup textures
+ */
+oriTextureResidency *oriCreateTextureResidency(size_t budget, unsigned int evictedSize);
+
+/**
+ * @brief Free memory for the given texture residency manager.
+ *
+ * @details Its textures are not freed; those that are evicted are restored to full resolution first.
+ *
+ * @param residency the texture residency manager to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureResidency(oriTextureResidency *residency);
+
+/**
+ * @brief Set the amount of GPU memory that the textures of the given residency manager should fit in.
+ *
+ * @details If the budget is lowered, textures are evicted by the next call to oriUpdateTextureResidency().
+ *
+ * @param residency the texture residency manager to update.
+ * @param budget the budget in bytes.
+ *
+ * @ingroup textures
+ */
+void oriSetTextureResidencyBudget(oriTextureResidency *residency, size_t budget);
+
+/**
+ * @brief Start managing the residency of the given texture, keeping a CPU copy of its mipmap levels to restore it from.
+ *
+ * @details The texture must be a 2D texture that already holds the given levels (e.g. uploaded with
+ * oriUploadTexMipmaps() or oriUploadCompressedTexMipmaps()), which are copied so that the application can free its
+ * own. If the texture's internal format is block-compressed (see oriCompressImage()), the levels are compressed images
+ * in that format, and @c dataType and @c imageFormat are ignored. The more levels are given, the smaller the texture
+ * can be evicted to.
+ *
+ * The texture stops being managed when it is freed, or with oriRemoveResidentTexture().
+ *
+ * @param residency the texture residency manager to add the texture to.
+ * @param texture the texture to manage. It can only be managed by one residency manager.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows.
+ * @param levelCount the amount of levels, at most 32.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriAddResidentTexture(oriTextureResidency *residency, oriTexture *texture, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int imageFormat);
+
+/**
+ * @brief Stop managing the residency of the given texture, restoring it to full resolution if it is evicted.
+ *
+ * @param texture the texture added to a residency manager with oriAddResidentTexture().
+ *
+ * @ingroup textures
+ */
+void oriRemoveResidentTexture(oriTexture *texture);
+
+/**
+ * @brief Restore the textures of the given residency manager that have been bound since they were evicted, and evict
+ * the least recently used textures while the budget is exceeded.
+ *
+ * @details This should be called once per frame, e.g. before drawing. Textures bound since the previous update are
+ * never evicted, so the budget is exceeded if they don't fit in it on their own. A texture that is needed while
+ * evicted is shown at low resolution for the frame it is first bound in, and restored by the following update if
+ * enough textures can be evicted to make room for it.
+ *
+ * @param residency the texture residency manager to update.
+ *
+ * @ingroup textures
+ */
+void oriUpdateTextureResidency(oriTextureResidency *residency);
+
+/**
+ * @brief Return the estimated amount of GPU memory in bytes used by the textures of the given residency manager.
+ *
+ * @param residency the texture residency manager to inspect.
+ *
+ * @ingroup textures
+ */
+size_t oriGetTextureResidencyUsage(oriTextureResidency *residency);
+
+/**
+ * @brief Return false if the given texture is managed by a residency manager and is evicted, or true otherwise.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
+ */
+bool oriIsTextureResident(oriTexture *texture);
+
+/**
+ * @brief Return an estimate of the amount of GPU memory in bytes used by the given texture's storage.
+ *
+ * @details This is calculated from the texture's dimensions, level count, sample count and internal format, so it
+ * doesn't include any padding or alignment added by the driver.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
+ */
+size_t oriGetTextureMemorySize(oriTexture *texture);
+
+// ======================================================================================
+// *****                       ORION TEXTURE STREAMING FUNCTIONS                    *****
+// ======================================================================================
+
+/**
+ * @brief Create a 2D texture whose finer mipmap levels are only uploaded while they are needed.
+ *
+ * @details The texture is created with immutable storage holding only the levels of at most 64 texels across, which
+ * are always kept. Each frame, the finest level that is needed is reported with oriRequestTextureLevel() or
+ * oriRequestTextureCoverage() (e.g. from the size of the objects that use the texture on screen, or from a feedback
+ * pass), and oriProcessTextureStreaming() streams finer levels in one at a time as demand rises, and drops them again
+ * once they have gone unrequested for a while. A texture that only ever covers 40 pixels on screen is then never
+ * uploaded at full resolution.
+ *
+ * Levels are added and dropped by reallocating the texture's storage with one more or fewer level, keeping the
+ * contents of the others, so the texture's handle changes (see oriGetTextureHandle()). While a new level is being
+ * uploaded, @c GL_TEXTURE_BASE_LEVEL keeps it from being sampled; once it is complete, @c GL_TEXTURE_MIN_LOD is
+ * lowered to it over a few frames so that it fades in rather than popping.
+ *
+ * The levels are copied so that the application can free its own. If the internal format is block-compressed (see
+ * oriCompressImage()), the levels are compressed images in that format, and @c dataType and @c imageFormat are
+ * ignored. The texture can't be added to an oriTextureResidency.
+ *
+ * @param internalFormat the internal format of the texture.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows (e.g. from
+ * oriGenerateMipChain()).
+ * @param levelCount the amount of levels, at most oriGetMipLevelCount() of the width and height.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param imageFormat the format of the images.
+ * @return the texture, or NULL if the size or level count is out of range.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriCreateStreamedTexture(unsigned int internalFormat, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height, unsigned int imageFormat);
+
+/**
+ * @brief Report the finest mipmap level of the given streamed texture that is needed this frame.
+ *
+ * @details This can be called any amount of times per frame (e.g. once per object that uses the texture); the finest
+ * level reported since the last call to oriProcessTextureStreaming() is used. Textures that aren't reported in a frame
+ * are treated as needing only their coarsest levels.
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ * @param level the finest level needed (0 for the full-resolution level).
+ *
+ * @ingroup textures
+ */
+void oriRequestTextureLevel(oriTexture *texture, unsigned int level);
+
+/**
+ * @brief Report the finest mipmap level of the given streamed texture that is needed this frame from the amount of
+ * pixels that it covers on screen.
+ *
+ * @details This is a shortcut for oriRequestTextureLevel() with the level that has about as many texels across as the
+ * texture covers pixels (the texture is assumed not to be tiled).
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ * @param pixels the size in pixels that the texture's width or height (whichever is larger) covers on screen.
+ *
+ * @ingroup textures
+ */
+void oriRequestTextureCoverage(oriTexture *texture, float pixels);
+
+/**
+ * @brief Stream the mipmap levels of textures created with oriCreateStreamedTexture() in or out to meet the demand
+ * reported since the last call.
+ *
+ * @details This must be called on the thread with the GL context, e.g. once per frame after the levels have been
+ * reported. Levels are uploaded from the texture's CPU copy a few rows at a time, staged in the same pixel unpack
+ * buffer as oriProcessTextureLoads(), so that at most the budget set with oriSetTextureUploadBudget() is uploaded per
+ * call, and a texture only becomes sharper once a whole level has been uploaded. Levels are dropped once they have gone
+ * unrequested for 60 calls, so that textures don't flicker between levels at the edge of their demand; a level that is
+ * no longer requested while it is being uploaded stops being uploaded straight away, and is dropped in the same way.
+ *
+ * @ingroup textures
+ */
+void oriProcessTextureStreaming();
+
+/**
+ * @brief Return the finest mipmap level of the given streamed texture that is fully uploaded and can be sampled.
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetTextureStreamLevel(oriTexture *texture);
+
+// ======================================================================================
+// *****                      ORION VIRTUAL TEXTURE FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Write an 8-bit image to a virtual texture file, split into pages, to be opened with oriCreateVirtualTexture().
+ *
+ * @details The image is padded to a square of a power-of-two amount of pages (repeating its edge texels), and its
+ * mipmap levels are built down to a single page with oriGenerateMipChain(). Each page is stored with @c border texels
+ * of its neighbours around it, so that it can be filtered on its own in the page cache.
+ *
+ * @param path the path of the file to write.
+ * @param image the image, with tightly packed rows.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param channels the amount of channels in the image (1-4).
+ * @param pageSize the width and height of each page, without its border (e.g. 128); at most 4096.
+ * @param border the width of the border around each page: 1 for bilinear filtering, or more for anisotropic filtering;
+ * at most @c pageSize.
+ * @param srgb true if the colour channels of the image are sRGB-encoded (the cache is then created as an sRGB texture).
+ * @return true if the file was written.
+ *
+ * @ingroup textures
+ */
+bool oriWriteVirtualTextureFile(const char *path, const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int pageSize, unsigned int border, bool srgb);
+
+/**
+ * @brief Open a virtual texture file written with oriWriteVirtualTextureFile(), and allocate and initialise a virtual
+ * texture that samples it through a page cache.
+ *
+ * @details Only the pages that are needed are kept in GPU memory, in a fixed-size cache texture of
+ * @c slotsPerSide * @c slotsPerSide pages (see oriGetVirtualTextureCache()). A page table texture (see
+ * oriGetVirtualTexturePageTable()) has a texel for each page of each level, which holds the cache slot and level of the
+ * page that is sampled in its place: the page itself if it is resident, or else its closest resident ancestor. The
+ * single page of the last level is loaded now and never evicted, so that every page has one to fall back to.
+ *
+ * Pages are requested by the application, typically from a feedback pass (see oriProcessVirtualTextureFeedback()), read
+ * from the file (which is mapped into memory) on worker threads, and uploaded into the cache by
+ * oriUpdateVirtualTexture(). Only regular texture uploads are used, so this works on any GL 2.0+ implementation without
+ * @c ARB_sparse_texture.
+ *
+ * With @c vt being (pagesPerSide, pageSize, border, slotsPerSide) from oriGetVirtualTextureProperty(), it is sampled
+ * with:
+ * @code
+ * float virtualLod(vec2 uv) {
+ *     vec2 texels = uv * vt.x * vt.y;
+ *     vec2 dx = dFdx(texels), dy = dFdy(texels);
+ *     return clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), 0.0, log2(vt.x));
+ * }
+ *
+ * vec4 sampleVirtual(vec2 uv) {
+ *     vec3 entry = floor(textureLod(pageTable, uv, floor(virtualLod(uv))).rgb * 255.0 + 0.5);
+ *     float pages = vt.x / exp2(entry.z);
+ *     float tile = vt.y + 2.0 * vt.z;
+ *     vec2 texel = entry.xy * tile + vt.z + fract(uv * pages) * vt.y;
+ *     return textureLod(pageCache, texel / (vt.w * tile), 0.0);
+ * }
+ * @endcode
+ *
+ * @param path the path of the virtual texture file.
+ * @param slotsPerSide the amount of pages along each side of the cache texture (at most 256).
+ * @return the virtual texture, or NULL if the file couldn't be opened or the cache texture would be too large.
+ *
+ * @ingroup textures
+ */
+oriVirtualTexture *oriCreateVirtualTexture(const char *path, unsigned int slotsPerSide);
+
+/**
+ * @brief Destroy and free memory for the given virtual texture, including its cache and page table textures. Pages that
+ * are being loaded are waited for (or cancelled if they haven't started).
+ *
+ * @param vt the virtual texture to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeVirtualTexture(oriVirtualTexture *vt);
+
+/**
+ * @brief Request a page of the given virtual texture, to be loaded by the next call to oriUpdateVirtualTexture() if it
+ * isn't resident, or kept in the cache if it is.
+ *
+ * @param vt the virtual texture.
+ * @param level the level of the page.
+ * @param x the column of the page in its level.
+ * @param y the row of the page in its level.
+ *
+ * @ingroup textures
+ */
+void oriRequestVirtualTexturePage(oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y);
+
+/**
+ * @brief Request the pages that were written to a feedback buffer, to be loaded by the next call to
+ * oriUpdateVirtualTexture() if they aren't resident, or kept in the cache if they are.
+ *
+ * @details The feedback buffer is an RGBA8 target that the scene is drawn to with the virtual texture's shader at a low
+ * resolution (e.g. a quarter or an eighth of the screen's). Each texel names the page it sampled: R and G are the low 8
+ * bits of its column and row, B is the high 4 bits of its column plus 16 times the high 4 bits of its row, and A is its
+ * level. Texels that didn't sample the virtual texture are cleared to an A of 255. Using virtualLod() from
+ * oriCreateVirtualTexture() (where @c bias is the log2 of how many times smaller the feedback buffer is than the
+ * screen, so that the same level is requested as is sampled at full resolution):
+ * @code
+ * float lod = floor(max(virtualLod(uv) - bias, 0.0));
+ * vec2 page = min(floor(uv * vt.x / exp2(lod)), vt.x / exp2(lod) - 1.0);
+ * feedback = vec4(mod(page, 256.0), floor(page.x / 256.0) + floor(page.y / 256.0) * 16.0, lod) / 255.0;
+ * @endcode
+ *
+ * The buffer can be read back without stalling with oriReadPixelsAsync(). Each virtual texture needs its own buffer
+ * (or attachment).
+ *
+ * @param vt the virtual texture.
+ * @param feedback the texels of the feedback buffer.
+ * @param texelCount the amount of texels in @c feedback.
+ *
+ * @ingroup textures
+ */
+void oriProcessVirtualTextureFeedback(oriVirtualTexture *vt, const unsigned char *feedback, size_t texelCount);
+
+/**
+ * @brief Upload the pages of the given virtual texture that have been loaded, and start loading the pages that have been
+ * requested since the last update. This should be called once per frame.
+ *
+ * @details Loaded pages are uploaded into the cache up to the texture upload budget (see oriSetTextureUploadBudget()),
+ * and the page table entries that fall back to them are updated. Requested pages are loaded on worker threads, coarser
+ * levels first, into free slots or the slots of the least recently used pages; pages that were requested (or sampled in
+ * place of a requested page) this frame are never evicted for them, so if the cache is too small for a frame's pages,
+ * the rest keep falling back to coarser ones.
+ *
+ * @param vt the virtual texture to update.
+ *
+ * @ingroup textures
+ */
+void oriUpdateVirtualTexture(oriVirtualTexture *vt);
+
+/**
+ * @brief Return the page cache texture of the given virtual texture, to bind as its @c pageCache sampler. It is owned by
+ * the virtual texture, and freed with it.
+ *
+ * @param vt the virtual texture.
+ * @return the page cache texture.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetVirtualTextureCache(oriVirtualTexture *vt);
+
+/**
+ * @brief Return the page table texture of the given virtual texture, to bind as its @c pageTable sampler. It is owned by
+ * the virtual texture, and freed with it.
+ *
+ * @param vt the virtual texture.
+ * @return the page table texture.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetVirtualTexturePageTable(oriVirtualTexture *vt);
+
+/**
+ * @brief Retrieve properties of the given virtual texture. Pass NULL for any property that isn't needed.
+ *
+ * @details The image covers the top-left @c width by @c height texels of the base level, which is
+ * @c pagesPerSide * @c pageSize texels across, so texture coordinates of the image are scaled by
+ * @c width / (@c pagesPerSide * @c pageSize) and @c height / (@c pagesPerSide * @c pageSize) before they are sampled.
+ *
+ * @param vt the virtual texture.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param pagesPerSide the amount of pages along each side of the base level.
+ * @param pageSize the width and height of each page, without its border.
+ * @param border the width of the border around each page in the cache.
+ * @param slotsPerSide the amount of pages along each side of the cache.
+ * @param levels the amount of levels, down to a single page.
+ *
+ * @ingroup textures
+ */
+void oriGetVirtualTextureProperty(oriVirtualTexture *vt, unsigned int *width, unsigned int *height, unsigned int *pagesPerSide, unsigned int *pageSize, unsigned int *border, unsigned int *slotsPerSide, unsigned int *levels);
+
+// ======================================================================================
+// *****                           ORION MIPMAP FUNCTIONS                           *****
+// ======================================================================================
+
+// mipmap downsampling filters (for oriGenerateMipChain())
+#define ORION_MIP_FILTER_BOX    0x00    // average of the texels covered
+#define ORION_MIP_FILTER_KAISER 0x01    // Kaiser-windowed sinc (sharper)
+
+/**
+ * @brief Return the amount of levels in a full mipmap chain for an image with the given dimensions, including the base
+ * level.
+ *
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetMipLevelCount(unsigned int width, unsigned int height);
+
+/**
+ * @brief Return the amount of bytes needed to hold every mipmap level below the base level of an 8-bit image, as
+ * written by oriGenerateMipChain().
+ *
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param channels the amount of channels in the image (1-4).
+ *
+ * @ingroup textures
+ */
+size_t oriGetMipChainSize(unsigned int width, unsigned int height, unsigned int channels);
+
+/**
+ * @brief Build the mipmap levels of an 8-bit image on the CPU.
+ *
+ * @details Each level is filtered from the one above it in linear floating point (without rounding to 8 bits between
+ * levels), with SIMD row kernels where they are available. The box filter averages the texels each destination texel
+ * covers; the Kaiser filter is a windowed sinc that keeps distant levels sharper. If @c srgb is true, colour channels
+ * are converted from sRGB to linear before filtering and back afterwards (alpha is always filtered as it is), so that
+ * the levels of an sRGB texture don't darken.
+ *
+ * Unlike glGenerateMipmap(), this doesn't need the GL context, so it can run on a worker thread (as
+ * oriLoadTextureAsync() does). The levels can then be uploaded with oriUploadTexMipmaps().
+ *
+ * @param image the base level, with tightly packed rows.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param channels the amount of channels in the image (1-4).
+ * @param filter the downsampling filter: @c ORION_MIP_FILTER_BOX or @c ORION_MIP_FILTER_KAISER.
+ * @param srgb true if the colour channels of the image are sRGB-encoded.
+ * @param dst the array to write the levels below the base level to, one after the other with tightly packed rows. It
+ * must hold at least oriGetMipChainSize() bytes.
+ * @param levels an array of at least oriGetMipLevelCount() pointers to fill with the start of each level (the first
+ * being @c image), or NULL.
+ * @return the amount of levels, including the base level, or 0 if the memory to filter them couldn't be allocated.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGenerateMipChain(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int filter, bool srgb, unsigned char *dst, const unsigned char **levels);
+
+// ======================================================================================
+// *****                           ORION BUFFER FUNCTIONS                           *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriBuffer structure.
+ * 
+ * @ingroup buffers
+ */
+oriBuffer *oriCreateBuffer();
+
+/**
+ * @brief Allocate and initialise a new oriBuffer structure with immutable storage.
+ *
+ * @details The size of the buffer's data store is fixed on creation, so the driver is free to place it wherever suits
+ * the given @c flags best. The data store can still be overwritten with oriSetBufferData() if @c GL_DYNAMIC_STORAGE_BIT
+ * is set, or mapped with oriMapBufferRange() if any of the @c GL_MAP_*_BIT flags are set.
+ *
+ * @param size the size of the buffer's data store in bytes.
+ * @param data the data to initialise the buffer with. Set to NULL to leave the data store uninitialised.
+ * @param flags the intended usage of the buffer's data store, e.g. @c GL_DYNAMIC_STORAGE_BIT or @c GL_MAP_WRITE_BIT.
+ *
+ * @sa <a href="https://docs.gl/gl4/glBufferStorage">glBufferStorage</a>
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriCreateBufferImmutable(const size_t size, const void *data, const unsigned int flags);
+
+/**
+ * @brief Destroy and free memory for the given buffer.
+ * 
+ * @param buffer the buffer to free
+ * 
+ * @ingroup buffers
+ */
+void oriFreeBuffer(oriBuffer *buffer);
+
+/**
+ * @brief Bind the given buffer.
+ * 
+ * @param buffer the buffer to bind.
+ * @param target the OpenGL buffer target to bind the buffer to.
+ * 
+ * @ingroup buffers
+ */
+void oriBindBuffer(oriBuffer *buffer, unsigned int target);
+
+/**
+ * @brief Return the OpenGL handle to the given buffer struct.
+ * 
+ * @param buffer the buffer to inspect.
+ * 
+ * @ingroup buffers
+ */
+unsigned int oriGetBufferHandle(oriBuffer *buffer);
+
+/**
+ * @brief Set data in a given oriBuffer structure.
+ * 
+ * @param buffer the buffer to copy data into.
+ * @param data the data to copy in @c buffer.
+ * @param size the size of the given data.
+ * @param usage the usage of the buffer.
+ * 
+ * @ingroup buffers
+ */
+void oriSetBufferData(oriBuffer *buffer, const void *data, const size_t size, const unsigned int usage);
+
+/**
+ * @brief Overwrite part of a buffer's data store.
+ *
+ * @details Unlike oriSetBufferData(), only the given range is uploaded. If the buffer is in deferred mode (see
+ * oriSetBufferDeferred()), the data is only copied into the buffer's CPU shadow copy and the range is recorded; it is
+ * uploaded on the next call to oriFlushBuffer() or oriFlushDeferredBuffers().
+ *
+ * @param buffer the buffer to update.
+ * @param offset the offset into the buffer's data store to write to, in bytes.
+ * @param size the size of the given data.
+ * @param data the data to copy into @c buffer.
+ *
+ * @ingroup buffers
+ */
+void oriUpdateBufferRange(oriBuffer *buffer, const size_t offset, const size_t size, const void *data);
+
+/**
+ * @brief Enable or disable deferred mode for the given buffer.
+ *
+ * @details In deferred mode, the buffer keeps a CPU shadow copy of its data store. oriUpdateBufferRange() only writes to the
+ * shadow copy and records the modified range, and the recorded ranges are merged and uploaded with as few calls as possible
+ * when the buffer is flushed. This is useful when many small, scattered parts of a buffer change every frame (e.g.
+ * per-instance transforms).
+ *
+ * @note If the buffer already has data, enabling deferred mode reads it back from the GL once to initialise the shadow copy.
+ * Disabling deferred mode flushes any pending ranges first.
+ *
+ * @param buffer the buffer to update.
+ * @param deferred true to enable deferred mode, false to disable it.
+ *
+ * @ingroup buffers
+ */
+void oriSetBufferDeferred(oriBuffer *buffer, const bool deferred);
+
+/**
+ * @brief Upload the pending ranges of a buffer in deferred mode.
+ *
+ * @details Overlapping and adjacent ranges (and ranges separated by small gaps) are merged first, so that the minimum amount
+ * of upload calls are made.
+ *
+ * @param buffer the buffer to flush.
+ *
+ * @ingroup buffers
+ */
+void oriFlushBuffer(oriBuffer *buffer);
+
+/**
+ * @brief Upload the pending ranges of every buffer in deferred mode.
+ *
+ * @details Call this once per frame, before issuing draw calls.
+ *
+ * @sa oriFlushBuffer()
+ *
+ * @ingroup buffers
+ */
+void oriFlushDeferredBuffers();
+
+/**
+ * @brief Map a range of the given buffer's data store into client memory.
+ *
+ * @details The returned pointer points to the start of the range (i.e. to @c offset), not the start of the buffer. The
+ * buffer must be unmapped with oriUnmapBuffer() before it is used by the GL, unless it is mapped with
+ * @c GL_MAP_PERSISTENT_BIT. @c GL_MAP_INVALIDATE_RANGE_BIT, @c GL_MAP_INVALIDATE_BUFFER_BIT, @c GL_MAP_UNSYNCHRONIZED_BIT
+ * and @c GL_MAP_FLUSH_EXPLICIT_BIT are passed on to the GL as they are.
+ *
+ * @param buffer the buffer to map.
+ * @param offset the offset of the range to map, in bytes.
+ * @param length the length of the range to map, in bytes.
+ * @param access the access flags to map the range with, e.g. <tt>GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT</tt>.
+ * @return a pointer to the mapped range, or NULL if the range could not be mapped.
+ *
+ * @sa <a href="https://docs.gl/gl4/glMapBufferRange">glMapBufferRange</a>
+ *
+ * @ingroup buffers
+ */
+void *oriMapBufferRange(oriBuffer *buffer, const size_t offset, const size_t length, const unsigned int access);
+
+/**
+ * @brief Indicate that a range of a buffer that was mapped with @c GL_MAP_FLUSH_EXPLICIT_BIT has been modified.
+ *
+ * @param buffer the mapped buffer.
+ * @param offset the offset of the modified range, in bytes, @b relative @b to @b the @b start @b of @b the @b mapping.
+ * @param length the length of the modified range, in bytes.
+ *
+ * @sa <a href="https://docs.gl/gl4/glFlushMappedBufferRange">glFlushMappedBufferRange</a>
+ *
+ * @ingroup buffers
+ */
+void oriFlushMappedRange(oriBuffer *buffer, const size_t offset, const size_t length);
+
+/**
+ * @brief Unmap the given buffer.
+ *
+ * @param buffer the buffer to unmap.
+ * @return false if the buffer's data store became corrupt while it was mapped (e.g. due to a screen mode change), in which
+ * case its contents are undefined and must be uploaded again.
+ *
+ * @ingroup buffers
+ */
+bool oriUnmapBuffer(oriBuffer *buffer);
+
+/**
+ * @brief The index that marks a primitive restart in the data given to oriUploadIndexData().
+ *
+ * @ingroup buffers
+ */
+#define ORION_PRIMITIVE_RESTART 0xFFFFFFFF
+
+/**
+ * @brief Upload 32-bit index data to the given buffer, narrowing it to 16 bits if every index fits.
+ *
+ * @details The indices are scanned once: if the largest index is below 65535, they are stored as @c GL_UNSIGNED_SHORT,
+ * halving the memory and bandwidth they take up; otherwise they are stored as given. If @c restart is true, indices equal
+ * to @c ORION_PRIMITIVE_RESTART are primitive restart markers, and are stored as the largest value of the chosen type
+ * (see oriSetPrimitiveRestart()).
+ *
+ * @param buffer the buffer to copy the indices into. Its data store is reallocated with oriSetBufferData().
+ * @param indices the indices to upload.
+ * @param count the amount of indices.
+ * @param usage the usage of the buffer, e.g. @c GL_STATIC_DRAW.
+ * @param restart true if @c indices contains @c ORION_PRIMITIVE_RESTART markers.
+ * @return the type that the indices were stored as (@c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT), to be given to
+ * oriSetVertexArrayIndexBuffer().
+ *
+ * @ingroup buffers
+ */
+unsigned int oriUploadIndexData(oriBuffer *buffer, const unsigned int *indices, const size_t count, const unsigned int usage, const bool restart);
+
+// ======================================================================================
+// *****                         ORION BUFFER HEAP FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriBufferHeap structure.
+ *
+ * @details A buffer heap reserves large GL buffer objects ('pages') and sub-allocates them into oriBufferRange handles with
+ * a buddy allocator, so thousands of small meshes can share a handful of buffer objects. Pages are created as they are
+ * needed.
+ *
+ * @param pageSize the size of each GL buffer object in bytes. Rounded up to a power of two.
+ * @param minAlignment the minimum size and alignment of each range in bytes, e.g. the largest vertex stride that will be used.
+ * Rounded up to a power of two. Each page can hold at most 2^20 ranges of this size.
+ * @return the heap, or NULL if the page size or alignment is out of range.
+ *
+ * @ingroup buffers
+ */
+oriBufferHeap *oriCreateBufferHeap(const size_t pageSize, const unsigned int minAlignment);
+
+/**
+ * @brief Destroy and free memory for the given buffer heap, including all of its ranges.
+ *
+ * @param heap the heap to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeBufferHeap(oriBufferHeap *heap);
+
+/**
+ * @brief Allocate a range of the given size from a buffer heap.
+ *
+ * @param heap the heap to allocate from.
+ * @param size the size of the range in bytes.
+ * @return the allocated range, or NULL if @c size is larger than the heap's page size.
+ *
+ * @ingroup buffers
+ */
+oriBufferRange *oriBufferHeapAlloc(oriBufferHeap *heap, const size_t size);
+
+/**
+ * @brief Return the given range to its heap.
+ *
+ * @param range the range to free.
+ *
+ * @ingroup buffers
+ */
+void oriBufferHeapFree(oriBufferRange *range);
+
+/**
+ * @brief Upload data into the given range.
+ *
+ * @param range the range to copy data into.
+ * @param data the data to copy.
+ * @param size the size of the given data; must not be larger than the range's size.
+ *
+ * @ingroup buffers
+ */
+void oriSetBufferRangeData(oriBufferRange *range, const void *data, const size_t size);
+
+/**
+ * @brief Incrementally compact the live ranges of a buffer heap.
+ *
+ * @details The least-occupied page of the heap is evacuated into free space in the other pages with
+ * @c glCopyNamedBufferSubData, and released once it is empty. This is intended to be called once per frame with a small
+ * budget so that the work is spread out.
+ *
+ * Each range that is moved has its @c buffer and @c offset members updated and its @c generation incremented, so any
+ * vertex arrays that reference it need to be re-specified.
+ *
+ * @param heap the heap to defragment.
+ * @param maxBytes the maximum amount of bytes to move. Set to 0 for no limit.
+ * @return the amount of bytes that were moved.
+ *
+ * @ingroup buffers
+ */
+size_t oriDefragmentBufferHeap(oriBufferHeap *heap, const size_t maxBytes);
+
+// ======================================================================================
+// *****                         ORION BUFFER POOL FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriBufferPool structure.
+ *
+ * @details A buffer pool hands out buffer objects that have been released earlier instead of creating new ones, which
+ * avoids the driver overhead of creating and deleting buffers for transient, per-frame geometry. Buffers are grouped by
+ * size class (sizes are rounded up to the next power of two) and usage.
+ *
+ * @param maxIdle the maximum amount of idle buffers the pool keeps; buffers released past this are freed.
+ *
+ * @ingroup buffers
+ */
+oriBufferPool *oriCreateBufferPool(const unsigned int maxIdle);
+
+/**
+ * @brief Destroy and free memory for the given buffer pool, and all idle buffers it owns.
+ *
+ * @note Buffers that have been acquired from the pool and not released are not freed; they become regular buffers.
+ *
+ * @param pool the buffer pool to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeBufferPool(oriBufferPool *pool);
+
+/**
+ * @brief Acquire a buffer of at least @c size bytes from the given pool.
+ *
+ * @details The returned buffer's data store is @c size rounded up to the next power of two, and its contents are undefined;
+ * write to it with oriUpdateBufferRange() or oriMapBufferRange(). Do not reallocate the buffer with oriSetBufferData() or
+ * free it with oriFreeBuffer(); return it to the pool with oriBufferPoolRelease() instead.
+ *
+ * @param pool the pool to acquire a buffer from.
+ * @param size the minimum size of the buffer's data store in bytes.
+ * @param usage the usage of the buffer, e.g. @c GL_STREAM_DRAW.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriBufferPoolAcquire(oriBufferPool *pool, const size_t size, const unsigned int usage);
+
+/**
+ * @brief Return a buffer that was acquired with oriBufferPoolAcquire() to the given pool.
+ *
+ * @details The buffer is only handed out again once the GPU has finished with the commands that were issued before this
+ * call (on GL 3.2+; below that, the driver synchronises the next upload instead), so it is safe to release a buffer
+ * straight after the draw calls that use it.
+ *
+ * @param pool the pool that the buffer was acquired from.
+ * @param buffer the buffer to release.
+ *
+ * @ingroup buffers
+ */
+void oriBufferPoolRelease(oriBufferPool *pool, oriBuffer *buffer);
+
+/**
+ * @brief Get the usage statistics of the given pool, to help tune its size.
+ *
+ * @details A hit is an acquisition that reused an idle buffer; a miss is one that had to create a new buffer object.
+ *
+ * @param pool the pool to inspect.
+ * @param hits if not NULL, this is set to the amount of hits since the pool was created.
+ * @param misses if not NULL, this is set to the amount of misses since the pool was created.
+ * @param idle if not NULL, this is set to the amount of buffers that are currently owned by the pool (including those
+ * that are waiting on the GPU).
+ *
+ * @ingroup buffers
+ */
+void oriGetBufferPoolStats(oriBufferPool *pool, unsigned int *hits, unsigned int *misses, unsigned int *idle);
+
+// ======================================================================================
+// *****                        ORION STREAM BUFFER FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriStreamBuffer structure.
+ *
+ * @details The stream buffer is split into @c regionCount regions of @c regionSize bytes each, one of which is written to
+ * per frame. Each region is guarded by a fence, so the CPU only ever writes to memory that the GPU has finished reading.
+ * On GL 4.4+ the storage is persistently and coherently mapped so that uploads are a plain @c memcpy; on older versions the
+ * buffer is orphaned each frame instead (and @c regionCount is ignored).
+ *
+ * @param regionSize the size, in bytes, of the data that will be streamed per frame.
+ * @param regionCount the amount of frames that can be in flight at once (3 is a sensible default).
+ *
+ * @ingroup buffers
+ */
+oriStreamBuffer *oriCreateStreamBuffer(const size_t regionSize, const unsigned int regionCount);
+
+/**
+ * @brief Destroy and free memory for the given stream buffer.
+ *
+ * @param stream the stream buffer to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeStreamBuffer(oriStreamBuffer *stream);
+
+/**
+ * @brief Return the oriBuffer that backs the given stream buffer, e.g. for use with oriSpecifyVertexData() or oriBindBuffer().
+ *
+ * @warning The returned buffer is owned by the stream buffer; do not free it or set its data with oriSetBufferData().
+ *
+ * @param stream the stream buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriGetStreamBufferBuffer(oriStreamBuffer *stream);
+
+/**
+ * @brief Allocate @c size bytes from the current frame's region of the given stream buffer.
+ *
+ * @details The returned pointer is write-only. If the region doesn't have enough space left, a warning is sent and a NULL
+ * pointer is returned.
+ *
+ * @param stream the stream buffer to allocate from.
+ * @param size the size of the allocation in bytes.
+ * @param align the alignment of the allocation's offset in bytes. Set to 0 or 1 if not applicable.
+ *
+ * @ingroup buffers
+ */
+oriStreamAllocation oriStreamAlloc(oriStreamBuffer *stream, const size_t size, const unsigned int align);
+
+/**
+ * @brief Make the data written to the given stream buffer this frame visible to the GPU.
+ *
+ * @details This must be called after writing and @b before issuing any draw calls that read the streamed data. It is a
+ * no-op when the stream buffer is persistently mapped.
+ *
+ * @param stream the stream buffer to flush.
+ *
+ * @ingroup buffers
+ */
+void oriFlushStreamBuffer(oriStreamBuffer *stream);
+
+/**
+ * @brief Finish the current frame's region and move on to the next one.
+ *
+ * @details Call this once per frame, @b after the draw calls that read the streamed data have been issued.
+ *
+ * @param stream the stream buffer to advance.
+ *
+ * @ingroup buffers
+ */
+void oriAdvanceStreamBuffer(oriStreamBuffer *stream);
+
+// ======================================================================================
+// *****                        ORION SPARSE BUFFER FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriSparseBuffer structure.
+ *
+ * @details Only address space is reserved on creation; memory is committed in pages with oriCommitBufferPages(). If
+ * @c ARB_sparse_buffer is supported (and the GL version is 4.4 or later), the buffer is a single buffer object with sparse
+ * storage. Otherwise, it is emulated with one buffer object per page (see oriGetSparseBufferPageSize()), so data that is
+ * read in one draw call must not straddle a page boundary; use oriGetSparseBufferBuffer() to find the buffer object and
+ * offset to draw from.
+ *
+ * @param virtualSize the size of the buffer's address range in bytes. This can be far larger than the available memory.
+ *
+ * @ingroup buffers
+ */
+oriSparseBuffer *oriCreateSparseBuffer(const size_t virtualSize);
+
+/**
+ * @brief Destroy and free memory for the given sparse buffer, including all of its committed pages.
+ *
+ * @param sparse the sparse buffer to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeSparseBuffer(oriSparseBuffer *sparse);
+
+/**
+ * @brief Return the granularity, in bytes, with which memory is committed to the given sparse buffer.
+ *
+ * @param sparse the sparse buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+size_t oriGetSparseBufferPageSize(oriSparseBuffer *sparse);
+
+/**
+ * @brief Return the amount of bytes of the given sparse buffer that are currently backed by memory.
+ *
+ * @param sparse the sparse buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+size_t oriGetSparseBufferCommittedSize(oriSparseBuffer *sparse);
+
+/**
+ * @brief Commit or decommit memory for the pages of a sparse buffer that overlap the given range.
+ *
+ * @details When committing, every page that the range touches is committed. When decommitting, only the pages that lie
+ * completely inside the range are decommitted, so that neighbouring data that shares a page with the range is kept.
+ * The contents of newly committed pages are undefined.
+ *
+ * @param sparse the sparse buffer to modify.
+ * @param offset the offset of the range into the buffer's address range, in bytes.
+ * @param size the size of the range in bytes.
+ * @param commit true to commit memory for the range, false to release it.
+ *
+ * @ingroup buffers
+ */
+void oriCommitBufferPages(oriSparseBuffer *sparse, const size_t offset, const size_t size, const bool commit);
+
+/**
+ * @brief Return the buffer object that holds the data at the given offset of a sparse buffer, e.g. for use with
+ * oriSpecifyVertexData() or oriBindBuffer().
+ *
+ * @details With @c ARB_sparse_buffer, this is always the same buffer object and @c localOffset is set to @c offset.
+ * Otherwise, it is the buffer object of the page that contains @c offset (or NULL if that page isn't committed), and
+ * @c localOffset is set to the offset into that buffer object.
+ *
+ * @warning The returned buffer is owned by the sparse buffer; do not free it or set its data with oriSetBufferData().
+ *
+ * @param sparse the sparse buffer to inspect.
+ * @param offset the offset into the sparse buffer's address range, in bytes.
+ * @param localOffset if not NULL, this is set to the offset into the returned buffer object that corresponds to @c offset.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriGetSparseBufferBuffer(oriSparseBuffer *sparse, const size_t offset, size_t *localOffset);
+
+/**
+ * @brief Overwrite part of a sparse buffer's data. Every page that the range touches must be committed.
+ *
+ * @param sparse the sparse buffer to update.
+ * @param offset the offset into the buffer's address range to write to, in bytes.
+ * @param size the size of the given data.
+ * @param data the data to copy into @c sparse.
+ *
+ * @ingroup buffers
+ */
+void oriSetSparseBufferData(oriSparseBuffer *sparse, const size_t offset, const size_t size, const void *data);
+
+// ======================================================================================
+// *****                           ORION READBACK FUNCTIONS                         *****
+// ======================================================================================
+
+/**
+ * @brief Start reading back @c size bytes of the given buffer, starting at @c offset, without stalling the pipeline.
+ *
+ * @details The data is copied into a staging buffer on the GPU timeline and a fence is inserted after the copy. Poll
+ * oriReadbackReady() (e.g. once per frame) and read the result with oriReadbackData() once it returns true; results from
+ * compute or transform feedback passes typically arrive one to three frames later. NULL is returned if the range is out
+ * of the buffer's bounds.
+ *
+ * @param buffer the buffer to read from.
+ * @param offset the offset into the buffer's data store, in bytes.
+ * @param size the amount of bytes to read.
+ *
+ * @ingroup buffers
+ */
+oriReadback *oriReadBufferAsync(oriBuffer *buffer, const size_t offset, const size_t size);
+
+/**
+ * @brief Start reading back a block of pixels from the current read framebuffer without stalling the pipeline.
+ *
+ * @details This is the asynchronous equivalent of @c glReadPixels: the pixels are packed into a staging buffer bound at
+ * @c GL_PIXEL_PACK_BUFFER and are available through oriReadbackData() once oriReadbackReady() returns true. Rows are
+ * padded to the current @c GL_PACK_ALIGNMENT, as with @c glReadPixels. NULL is returned if the format/type combination is
+ * not recognised.
+ *
+ * @param x the window x coordinate of the first pixel to read.
+ * @param y the window y coordinate of the first pixel to read.
+ * @param width the width of the block of pixels.
+ * @param height the height of the block of pixels.
+ * @param format the format of the pixel data, e.g. @c GL_RGBA.
+ * @param type the data type of the pixel data, e.g. @c GL_UNSIGNED_BYTE.
+ *
+ * @ingroup buffers
+ */
+oriReadback *oriReadPixelsAsync(const int x, const int y, const unsigned int width, const unsigned int height, const unsigned int format, const unsigned int type);
+
+/**
+ * @brief Destroy and free memory for the given readback, whether it is ready or not.
+ *
+ * @param readback the readback to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeReadback(oriReadback *readback);
+
+/**
+ * @brief Return true if the GPU has finished the transfer of the given readback. This function never blocks.
+ *
+ * @param readback the readback to poll.
+ *
+ * @ingroup buffers
+ */
+bool oriReadbackReady(oriReadback *readback);
+
+/**
+ * @brief Return the data of the given readback, or NULL if it isn't ready yet (see oriReadbackReady()).
+ *
+ * @details The returned pointer is valid until the readback is freed.
+ *
+ * @param readback the readback to read.
+ * @param size if not NULL, this is set to the size of the data in bytes.
+ *
+ * @ingroup buffers
+ */
+const void *oriReadbackData(oriReadback *readback, size_t *size);
+
+// ======================================================================================
+// *****                     ORION VERTEX SPECIFICATION FUNCTIONS                   *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriVertexArray structure.
+ * 
+ * @ingroup vertexspec
+ */
+oriVertexArray *oriCreateVertexArray();
+
+/**
+ * @brief Destroy and free memory for the given vertex array.
+ * 
+ * @param va the vertex array to free.
+ * 
+ * @ingroup vertexspec
+ */
+void oriFreeVertexArray(oriVertexArray *va);
+
+/**
+ * @brief Bind a vertex array.
+ * 
+ * @param va the vertex array to bind.
+ * 
+ * @ingroup vertexspec
+ */
+void oriBindVertexArray(oriVertexArray *va);
+
+/**
+ * @brief Return the OpenGL handle to the given vertex array.
+ * 
+ * @param va the vertex array to inspect.
+ * 
+ * @ingroup vertexspec
+ */
+unsigned int oriGetVertexArrayHandle(oriVertexArray *va);
+
+/**
+ * @brief Attach an element (index) buffer to the given vertex array, so that indexed draws with the vertex array read
+ * their indices from it.
+ *
+ * @details The index type is stored with the vertex array and can be read back with oriGetVertexArrayIndexType(). If the
+ * buffer is freed with oriFreeBuffer(), it is detached from every vertex array it is attached to.
+ *
+ * @param va the vertex array to modify.
+ * @param buffer the buffer holding the indices, or NULL to detach the current one.
+ * @param type the type of the indices: @c GL_UNSIGNED_BYTE, @c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT (as returned by
+ * oriUploadIndexData()).
+ *
+ * @ingroup vertexspec
+ */
+void oriSetVertexArrayIndexBuffer(oriVertexArray *va, oriBuffer *buffer, const unsigned int type);
+
+/**
+ * @brief Return the type of the indices in the element buffer attached to the given vertex array, or 0 if none is.
+ *
+ * @param va the vertex array to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetVertexArrayIndexType(oriVertexArray *va);
+
+/**
+ * @brief Enable or disable primitive restart for indexed draws with the given index type.
+ *
+ * @details While enabled, the largest value of @c indexType (e.g. @c 0xFFFF for @c GL_UNSIGNED_SHORT) ends the current
+ * strip or fan and starts a new one, as inserted by oriUploadIndexData() for @c ORION_PRIMITIVE_RESTART.
+ *
+ * @param enabled true to enable primitive restart, false to disable it.
+ * @param indexType the type of the indices that will be drawn (only needed below GL 4.3).
+ *
+ * @ingroup vertexspec
+ */
+void oriSetPrimitiveRestart(const bool enabled, const unsigned int indexType);
+
+/**
+ * @brief Specifies vertex data with the given attribute format.
+ * @details @c buffer @b should be a vertex buffer. But it does not necessarily have to be.
+ * According to the OpenGL specification:
+ *  > [Vertex Buffer Objects] are no different from any other buffer object, and a buffer object used for Transform
+ *  > Feedback or asynchronous pixel transfers can be used as source values for vertex arrays.
+ * 
+ * @warning The buffer still needs to be bound to @c GL_ARRAY_BUFFER when not using direct state access. So
+ * if your GL version is below 4.5 and your buffer is not bound to @c GL_ARRAY_BUFFER then you will get a warning in the
+ * console and @b the @b function @b will @b exit @b early.
+ * 
+ * @param va the vertex array object (VAO) to store the vertex data in.
+ * @param buffer the buffer to read from.
+ * @param index the index of the vertex attribute to be defined.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param stride the byte offset between each vertex attribute.
+ * @param offset an offset of the first component of the vertex attribute.
+ * 
+ * @ingroup vertexspec
+ */
+void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer, 
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset
+);
+
+/**
+ * @brief Specifies per-instance vertex data with the given attribute format.
+ *
+ * @details This is the same as oriSpecifyVertexData(), except the attribute advances once every @c divisor instances
+ * rather than once per vertex, so that e.g. per-instance transforms and colours can live in their own buffer and be drawn
+ * with oriDrawInstanced() or an oriDrawList. Attributes wider than 4 components (such as a @c mat4) take up consecutive
+ * indices: specify each column separately, with @c offset advanced by the size of one column.
+ *
+ * @warning As with oriSpecifyVertexData(), the buffer must be bound to @c GL_ARRAY_BUFFER when the GL version is below 4.5.
+ *
+ * @param va the vertex array object (VAO) to store the vertex data in.
+ * @param buffer the buffer to read from.
+ * @param index the index of the vertex attribute to be defined.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param stride the byte offset between the attribute of each instance.
+ * @param offset an offset of the first component of the vertex attribute.
+ * @param divisor the amount of instances that share each value of the attribute (usually 1).
+ *
+ * @ingroup vertexspec
+ */
+void oriSpecifyInstanceData(oriVertexArray *va, oriBuffer *buffer,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset,
+    const unsigned int divisor
+);
+
+/**
+ * @brief Specifies vertex data with the given attribute format, read from a range of a buffer heap.
+ *
+ * @details This is the same as oriSpecifyVertexData(), except the buffer is read from the start of the range. Unlike
+ * oriSpecifyVertexData(), the buffer does not need to be bound beforehand.
+ *
+ * @param va the vertex array object (VAO) to store the vertex data in.
+ * @param range the buffer range to read from.
+ * @param index the index of the vertex attribute to be defined.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param stride the byte offset between each vertex attribute.
+ * @param offset an offset of the first component of the vertex attribute, relative to the start of the range.
+ *
+ * @ingroup vertexspec
+ */
+void oriSpecifyVertexDataRange(oriVertexArray *va, oriBufferRange *range,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset
+);
+
+// ======================================================================================
+// *****                        ORION VERTEX LAYOUT FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new, empty oriVertexLayout structure.
+ *
+ * @details A vertex layout declares a vertex format once: attributes are added with oriVertexLayoutAttribute() and
+ * refer to binding slots declared with oriVertexLayoutBinding(), so e.g. the attributes of an interleaved vertex all share
+ * one binding. Vertex arrays are then created from the layout with oriCreateVertexArrayFromLayout().
+ *
+ * @ingroup vertexspec
+ */
+oriVertexLayout *oriCreateVertexLayout();
+
+/**
+ * @brief Destroy and free memory for the given vertex layout, including every vertex array created from it.
+ *
+ * @param layout the vertex layout to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeVertexLayout(oriVertexLayout *layout);
+
+/**
+ * @brief Declare the stride and instance divisor of a binding slot of the given vertex layout.
+ *
+ * @details Slots that are never declared have a stride of 0 (tightly packed is @b not inferred) and a divisor of 0.
+ *
+ * @note Modifying a layout frees every vertex array that has been created from it.
+ *
+ * @param layout the layout to modify.
+ * @param binding the index of the binding slot, up to 15.
+ * @param stride the byte offset between consecutive elements in the slot's buffer.
+ * @param divisor 0 if the slot's buffer holds per-vertex data, otherwise the amount of instances that share each element.
+ *
+ * @ingroup vertexspec
+ */
+void oriVertexLayoutBinding(oriVertexLayout *layout, const unsigned int binding, const unsigned int stride, const unsigned int divisor);
+
+/**
+ * @brief Declare a vertex attribute of the given vertex layout.
+ *
+ * @note Modifying a layout frees every vertex array that has been created from it.
+ *
+ * @param layout the layout to modify.
+ * @param index the index of the vertex attribute to be defined.
+ * @param binding the binding slot that the attribute reads from, up to 15.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param offset the offset of the attribute from the start of each element of the binding slot's buffer.
+ *
+ * @ingroup vertexspec
+ */
+void oriVertexLayoutAttribute(oriVertexLayout *layout,
+    const unsigned int index,
+    const unsigned int binding,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int offset
+);
+
+/**
+ * @brief Return a vertex array that reads the given buffers with the given layout.
+ *
+ * @details Vertex arrays are cached by layout and buffers: if this has been called before with the same layout and the
+ * same buffers, the same vertex array is returned without any GL calls. Otherwise, a new vertex array is created and its
+ * format is specified once, with one vertex buffer binding per binding slot rather than one per attribute.
+ *
+ * @warning The returned vertex array is owned by the layout; do not free it or modify it with oriSpecifyVertexData(). It
+ * is freed when the layout is freed or modified, or when one of its buffers is freed.
+ *
+ * @param layout the layout of the vertex data.
+ * @param buffers an array with one buffer per binding slot of the layout (slots that no attribute uses may be NULL).
+ *
+ * @ingroup vertexspec
+ */
+oriVertexArray *oriCreateVertexArrayFromLayout(oriVertexLayout *layout, oriBuffer **buffers);
+
+// ======================================================================================
+// *****                        ORION VERTEX PACKING FUNCTIONS                      *****
+// ======================================================================================
+
+// packed vertex attribute formats (for oriPackedAttribute)
+#define ORION_PACK_FLOAT        0x00    // unchanged 32-bit floats
+#define ORION_PACK_HALF         0x01    // 16-bit half floats (GL_HALF_FLOAT)
+#define ORION_PACK_SNORM8       0x02    // normalised 8-bit signed integers (GL_BYTE)
+#define ORION_PACK_SNORM16      0x03    // normalised 16-bit signed integers (GL_SHORT)
+#define ORION_PACK_OCTAHEDRAL   0x04    // unit 3-component vectors as two normalised 16-bit signed integers
+#define ORION_PACK_2_10_10_10   0x05    // normalised 10-bit x, y, z and 2-bit w (GL_INT_2_10_10_10_REV)
+
+/**
+ * @brief Convert @c count floats to half floats, for use with @c GL_HALF_FLOAT attributes.
+ *
+ * @details Values are rounded to the nearest representable half float; values too large for a half float become
+ * infinities.
+ *
+ * @param dst the destination array of @c count half floats.
+ * @param src the source array of @c count floats.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackHalf(unsigned short *dst, const float *src, const size_t count);
+
+/**
+ * @brief Convert @c count floats in [-1, 1] to normalised signed bytes, for use with normalised @c GL_BYTE attributes.
+ *
+ * @param dst the destination array of @c count bytes.
+ * @param src the source array of @c count floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackSnorm8(signed char *dst, const float *src, const size_t count);
+
+/**
+ * @brief Convert @c count floats in [-1, 1] to normalised signed shorts, for use with normalised @c GL_SHORT attributes.
+ *
+ * @param dst the destination array of @c count shorts.
+ * @param src the source array of @c count floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackSnorm16(short *dst, const float *src, const size_t count);
+
+/**
+ * @brief Encode @c count unit vectors (e.g. normals) with octahedral mapping into pairs of normalised signed shorts.
+ *
+ * @details The encoded attribute is read by the shader as a @c vec2 @c e and decoded with:
+ * @code
+ * vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+ * float t = max(-n.z, 0.0);
+ * n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+ * n = normalize(n);
+ * @endcode
+ *
+ * @param dst the destination array of @c count * 2 shorts.
+ * @param src the source array of @c count * 3 floats.
+ * @param count the amount of vectors to encode.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackOctahedral(short *dst, const float *src, const size_t count);
+
+/**
+ * @brief Pack @c count 4-component vectors in [-1, 1] into the @c GL_INT_2_10_10_10_REV format, for use with normalised
+ * attributes of that type.
+ *
+ * @details x, y and z get 10 bits each and w gets 2 bits, so w can only be -1, 0 or 1 (e.g. the handedness of a tangent).
+ *
+ * @param dst the destination array of @c count packed values.
+ * @param src the source array of @c count * 4 floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of vectors to pack.
+ *
+ * @ingroup vertexspec
+ */
+void oriPack2_10_10_10(unsigned int *dst, const float *src, const size_t count);
+
+/**
+ * @brief Pack interleaved float vertices into a compact vertex format and upload them to the given buffer.
+ *
+ * @details Each attribute of the source vertices is converted to the format given by its oriPackedAttribute, and the
+ * packed attributes are interleaved in the order given (each padded to 4 bytes). If @c layout is not NULL, the packed
+ * attributes are declared in it, reading from binding slot @c binding, with the GL type and normalisation that match
+ * their format; the layout can then be used with oriCreateVertexArrayFromLayout().
+ *
+ * @param buffer the buffer to upload the packed vertices to. Its data store is reallocated with oriSetBufferData().
+ * @param usage the usage of the buffer, e.g. @c GL_STATIC_DRAW.
+ * @param src the source vertices.
+ * @param srcStride the amount of floats between the starts of consecutive source vertices.
+ * @param vertexCount the amount of vertices.
+ * @param attributes the attributes to pack.
+ * @param attributeCount the amount of attributes.
+ * @param layout the layout to declare the packed attributes in, or NULL.
+ * @param binding the binding slot of @c layout that @c buffer will be bound to.
+ * @return the stride, in bytes, of the packed vertices.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriPackVertices(oriBuffer *buffer, const unsigned int usage, const float *src, const unsigned int srcStride, const size_t vertexCount, const oriPackedAttribute *attributes, const unsigned int attributeCount, oriVertexLayout *layout, const unsigned int binding);
+
+// ======================================================================================
+// *****                        ORION MESH OPTIMISATION FUNCTIONS                   *****
+// ======================================================================================
+
+/**
+ * @brief Build an index buffer for non-indexed, interleaved vertices (e.g. a vertex array drawn with oriDrawArrays()) by
+ * merging identical vertices.
+ *
+ * @details The unique vertices are moved to the front of @c vertices, in the order they first appear.
+ *
+ * @param indices the destination array of @c vertexCount indices.
+ * @param vertices the vertices, which are compacted in place.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @return the amount of unique vertices.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriGenerateIndexBuffer(unsigned int *indices, float *vertices, const size_t vertexCount, const unsigned int stride);
+
+/**
+ * @brief Reorder triangles so that their vertices are reused from the GPU's post-transform cache as much as possible.
+ *
+ * @details The Tipsify algorithm is used, which runs in linear time and doesn't depend on the exact cache size.
+ *
+ * @param dst the destination array of @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertexCount the amount of vertices that the indices refer to.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseVertexCache(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const size_t vertexCount);
+
+/**
+ * @brief Reorder clusters of triangles so that those facing outwards from the mesh are drawn first, which reduces
+ * overdraw.
+ *
+ * @details The indices should already be optimised with oriOptimiseVertexCache(). They are split into clusters wherever
+ * the cache is cold, and further wherever the vertex cache efficiency is within @c threshold of the whole cluster's, so
+ * reordering the clusters keeps most of the cache optimisation.
+ *
+ * @param dst the destination array of @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertices the interleaved vertices that the indices refer to.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param threshold the allowed decrease in cache efficiency, e.g. 1.05 for 5%.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseOverdraw(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const float threshold);
+
+/**
+ * @brief Reorder interleaved vertices in the order they are first used by the given indices, so that vertex fetches are
+ * as sequential as possible, and remap the indices to match.
+ *
+ * @details Vertices that aren't used by any index are removed.
+ *
+ * @param dstVertices the destination array of at most @c vertexCount vertices. This must not overlap @c vertices.
+ * @param indices the indices, which are remapped in place.
+ * @param indexCount the amount of indices.
+ * @param vertices the source vertices.
+ * @param vertexCount the amount of source vertices.
+ * @param stride the amount of floats in each vertex.
+ * @return the amount of vertices written to @c dstVertices.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriOptimiseVertexFetch(float *dstVertices, unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride);
+
+/**
+ * @brief Get the average cache miss ratio (ACMR) of the given indices, i.e. the average amount of vertex shader invocations
+ * per triangle with a typical post-transform cache.
+ *
+ * @details This can be used to measure the effect of oriOptimiseVertexCache(); it is between 0.5 (ideal for large meshes)
+ * and 3 (no reuse).
+ *
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices.
+ * @param vertexCount the amount of vertices that the indices refer to.
+ *
+ * @ingroup vertexspec
+ */
+float oriGetVertexCacheMissRatio(const unsigned int *indices, const size_t indexCount, const size_t vertexCount);
+
+/**
+ * @brief Run the full optimisation pipeline on the given mesh: vertex cache, then overdraw, then vertex fetch.
+ *
+ * @details This should be done once, when building assets or before the mesh's data is uploaded with oriSetBufferData().
+ * The vertices and indices are modified in place, and @c vertexCount is updated to the amount of vertices that are used.
+ * For non-indexed vertices, build the indices first with oriGenerateIndexBuffer().
+ *
+ * @param mesh the mesh to optimise.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseMesh(oriMeshData *mesh);
+
+/**
+ * @brief Optimise the given meshes with oriOptimiseMesh(), spread across the worker threads (see
+ * oriSetWorkerThreadCount()).
+ *
+ * @details Meshes are handed out to the threads one at a time, so a batch of meshes of different sizes is balanced
+ * between them. The calling thread also optimises meshes, and the function returns once all meshes have been optimised.
+ *
+ * @param meshes the meshes to optimise.
+ * @param meshCount the amount of meshes.
+ * @param threadCount the most threads to use, including the calling thread.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseMeshes(oriMeshData *meshes, const size_t meshCount, const unsigned int threadCount);
+
+// ======================================================================================
+// *****                          ORION MESH LOD FUNCTIONS                          *****
+// ======================================================================================
+
+/**
+ * @brief Simplify a triangle list to roughly @c targetIndexCount indices by collapsing edges, using quadric error metrics
+ * to choose the collapses that change the shape of the mesh the least.
+ *
+ * @details Vertices are only ever collapsed onto other existing vertices, so the simplified indices refer to the same
+ * vertex buffer as the original indices. Vertices on open borders and on attribute seams (vertices that share their
+ * position with another vertex, e.g. where texture coordinates are split) are kept in place, so the result may have more
+ * indices than requested.
+ *
+ * @param dst the destination array of at most @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertices the interleaved vertices that the indices refer to.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param targetIndexCount the amount of indices to aim for.
+ * @param error if not NULL, this is set to the largest distance (in the same units as the vertex positions) between the
+ * simplified mesh and the original that was introduced by a collapse.
+ * @return the amount of indices written to @c dst.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriSimplifyMesh(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const size_t targetIndexCount, float *error);
+
+/**
+ * @brief Allocate and initialise a new oriMeshLOD structure, generating a chain of simplified index buffers for a mesh.
+ *
+ * @details Level 0 is the given indices at full detail, and each further level is simplified from the one before it with
+ * oriSimplifyMesh() to the corresponding fraction of the original triangle count. All levels are uploaded into one index
+ * buffer (narrowed to 16-bit indices where possible), which is attached to @c va as its element buffer, so each level is
+ * drawn from the same vertex buffer with oriDrawMeshLOD() or from a draw list with the range given by
+ * oriGetMeshLODRange().
+ *
+ * @warning Free the mesh LOD before the vertex array it is attached to.
+ *
+ * @param va the vertex array that the mesh's vertex data is specified in.
+ * @param vertices the interleaved vertices of the mesh, as uploaded to the vertex array's buffer.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param indices the indices of the mesh's triangle list.
+ * @param indexCount the amount of indices.
+ * @param ratios the fraction of triangles to keep for each simplified level, e.g. { 0.5, 0.25, 0.1 }.
+ * @param ratioCount the amount of simplified levels (at most 15).
+ *
+ * @ingroup vertexspec
+ */
+oriMeshLOD *oriCreateMeshLOD(oriVertexArray *va, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const unsigned int *indices, const size_t indexCount, const float *ratios, unsigned int ratioCount);
+
+/**
+ * @brief Destroy and free memory for the given mesh LOD, and its index buffer.
+ *
+ * @details If the index buffer is still attached to the mesh's vertex array, it is detached.
+ *
+ * @param lod the mesh LOD to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeMeshLOD(oriMeshLOD *lod);
+
+/**
+ * @brief Return the amount of levels of detail in the given mesh LOD, including the full-detail level 0.
+ *
+ * @param lod the mesh LOD to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetMeshLODLevelCount(oriMeshLOD *lod);
+
+/**
+ * @brief Get the range of the element buffer that holds the indices of the given level, e.g. to add it to a draw list
+ * with oriDrawListAddElements().
+ *
+ * @param lod the mesh LOD to inspect.
+ * @param level the level of detail.
+ * @param firstIndex if not NULL, this is set to the position of the level's first index in the element buffer.
+ * @param count if not NULL, this is set to the amount of indices in the level.
+ * @return the type of the indices in the element buffer (@c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT).
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetMeshLODRange(oriMeshLOD *lod, unsigned int level, unsigned int *firstIndex, unsigned int *count);
+
+/**
+ * @brief Choose the coarsest level of detail whose error, projected onto the screen, is at most @c maxPixelError pixels.
+ *
+ * @details @c projectionScale converts a size at a distance of 1 unit into pixels; for a perspective projection, it is
+ * the viewport height divided by @c (2 * tan(fovY / 2)).
+ *
+ * @param lod the mesh LOD to choose a level from.
+ * @param distance the distance from the camera to the mesh, in the same units as the vertex positions (after scaling).
+ * @param projectionScale the size in pixels of 1 unit at a distance of 1 unit.
+ * @param maxPixelError the largest acceptable error on screen, in pixels (e.g. 1).
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriSelectMeshLOD(oriMeshLOD *lod, const float distance, const float projectionScale, const float maxPixelError);
+
+/**
+ * @brief Draw the given level of detail of a mesh, from the vertex array that the mesh LOD was created with.
+ *
+ * @param lod the mesh LOD to draw.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param level the level of detail to draw, e.g. as chosen by oriSelectMeshLOD().
+ * @param instanceCount the amount of instances to draw.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawMeshLOD(oriMeshLOD *lod, oriShader *shader, unsigned int level, const unsigned int instanceCount);
+
+// ======================================================================================
+// *****                       ORION CLUSTERED MESH FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriClusteredMesh structure, splitting a mesh into clusters of at most 64 vertices
+ * and 124 triangles.
+ *
+ * @details The triangles are reordered for the vertex cache and then grouped into clusters in that order, so each
+ * cluster is a small, connected patch of the mesh. Each cluster gets a bounding sphere and a cone containing the normals
+ * of its triangles, which are used by oriCullClusters() to skip clusters that are off-screen or entirely back-facing.
+ * The clustered indices are uploaded to one index buffer (narrowed to 16-bit indices where possible), which is attached
+ * to @c va as its element buffer.
+ *
+ * @warning Back-face culling of clusters assumes that front faces are wound counter-clockwise. Free the clustered mesh
+ * before the vertex array it is attached to.
+ *
+ * @param va the vertex array that the mesh's vertex data is specified in.
+ * @param vertices the interleaved vertices of the mesh, as uploaded to the vertex array's buffer.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param indices the indices of the mesh's triangle list.
+ * @param indexCount the amount of indices.
+ *
+ * @ingroup vertexspec
+ */
+oriClusteredMesh *oriCreateClusteredMesh(oriVertexArray *va, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const unsigned int *indices, const size_t indexCount);
+
+/**
+ * @brief Destroy and free memory for the given clustered mesh, and its index buffer.
+ *
+ * @details If the index buffer is still attached to the mesh's vertex array, it is detached.
+ *
+ * @param mesh the clustered mesh to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeClusteredMesh(oriClusteredMesh *mesh);
+
+/**
+ * @brief Return the amount of clusters in the given clustered mesh.
+ *
+ * @param mesh the clustered mesh to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetClusterCount(oriClusteredMesh *mesh);
+
+/**
+ * @brief Return the type of the indices in the given clustered mesh's element buffer (@c GL_UNSIGNED_SHORT or
+ * @c GL_UNSIGNED_INT), e.g. to create a draw list for it.
+ *
+ * @param mesh the clustered mesh to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetClusteredMeshIndexType(oriClusteredMesh *mesh);
+
+/**
+ * @brief Cull the clusters of a mesh that are outside of the view frustum or entirely back-facing, and get the ranges of
+ * its element buffer that remain to be drawn.
+ *
+ * @details Visible clusters that are next to each other in the element buffer are merged into one range, so the ranges
+ * can be drawn with few calls, e.g. with @c glMultiDrawElements.
+ *
+ * @param mesh the clustered mesh to cull.
+ * @param modelViewProjection the column-major model-view-projection matrix that the mesh will be drawn with.
+ * @param cameraPosition the position of the camera in the mesh's model space, or NULL to skip back-face culling.
+ * @param firstIndices the destination array of at least oriGetClusterCount() ranges' first indices.
+ * @param counts the destination array of at least oriGetClusterCount() ranges' index counts.
+ * @return the amount of ranges.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriCullClusters(oriClusteredMesh *mesh, const float *modelViewProjection, const float *cameraPosition, unsigned int *firstIndices, unsigned int *counts);
+
+/**
+ * @brief Cull the clusters of a mesh with oriCullClusters() and add a draw command for each remaining range to the given
+ * draw list.
+ *
+ * @details The draw list must have been created with the index type given by oriGetClusteredMeshIndexType().
+ *
+ * @param list the draw list to add commands to.
+ * @param mesh the clustered mesh to cull and draw.
+ * @param shader the shader to draw with.
+ * @param modelViewProjection the column-major model-view-projection matrix that the mesh will be drawn with.
+ * @param cameraPosition the position of the camera in the mesh's model space, or NULL to skip back-face culling.
+ * @return the amount of commands added.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriDrawListAddClusters(oriDrawList *list, oriClusteredMesh *mesh, oriShader *shader, const float *modelViewProjection, const float *cameraPosition);
+
+// ======================================================================================
+// *****                             ORION DRAW FUNCTIONS                           *****
+// ======================================================================================
+
+/**
+ * @brief Draw @c instanceCount instances of non-indexed geometry with one call.
+ *
+ * @details Per-instance attributes are specified with oriSpecifyInstanceData(). A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param first the first vertex to draw.
+ * @param count the amount of vertices to draw per instance.
+ * @param instanceCount the amount of instances to draw.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawInstanced(oriVertexArray *va, oriShader *shader, const unsigned int mode, const unsigned int first, const unsigned int count, const unsigned int instanceCount, const unsigned int baseInstance);
+
+/**
+ * @brief Draw @c instanceCount instances of indexed geometry with one call.
+ *
+ * @details The indices are read from the element buffer of @c va. Per-instance attributes are specified with
+ * oriSpecifyInstanceData(). A non-zero @c baseVertex requires GL 3.2, and a non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param count the amount of indices to draw per instance.
+ * @param indexType the type of the indices, e.g. @c GL_UNSIGNED_INT.
+ * @param indexOffset the offset of the first index into the element buffer, in bytes.
+ * @param instanceCount the amount of instances to draw.
+ * @param baseVertex a constant that is added to each index.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawElementsInstanced(oriVertexArray *va, oriShader *shader, const unsigned int mode, const unsigned int count, const unsigned int indexType, const size_t indexOffset, const unsigned int instanceCount, const int baseVertex, const unsigned int baseInstance);
+
+// ======================================================================================
+// *****                          ORION DRAW LIST FUNCTIONS                         *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriDrawList structure.
+ *
+ * @details A draw list records draw commands into a @c GL_DRAW_INDIRECT_BUFFER. Commands are grouped by the vertex array
+ * and shader they are drawn with, and each group is submitted with a single @c glMultiDrawElementsIndirect (or
+ * @c glMultiDrawArraysIndirect) call, so thousands of draws only cost a handful of driver calls. Draw lists are intended
+ * to be cleared and refilled every frame with oriClearDrawList(); the memory they allocate is kept between frames.
+ *
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param indexType the type of the indices in the vertex arrays' element buffers (@c GL_UNSIGNED_BYTE,
+ * @c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT), or 0 to draw non-indexed geometry.
+ *
+ * @ingroup vertexspec
+ */
+oriDrawList *oriCreateDrawList(const unsigned int mode, const unsigned int indexType);
+
+/**
+ * @brief Destroy and free memory for the given draw list.
+ *
+ * @param list the draw list to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeDrawList(oriDrawList *list);
+
+/**
+ * @brief Remove all commands from the given draw list.
+ *
+ * @note The list remembers the vertex array and shader pairs it has seen. If a vertex array or shader that was used
+ * with the list is freed, free the list as well.
+ *
+ * @param list the draw list to clear.
+ *
+ * @ingroup vertexspec
+ */
+void oriClearDrawList(oriDrawList *list);
+
+/**
+ * @brief Add an indexed draw to the given draw list.
+ *
+ * @details The draw reads its indices from the element buffer of @c va. The list must have been created with an index
+ * type. A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param list the draw list to add to.
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound when the list is submitted.
+ * @param count the amount of indices to draw.
+ * @param instanceCount the amount of instances to draw (1 if instancing isn't used).
+ * @param firstIndex the index (not byte offset) of the first index to draw in the element buffer.
+ * @param baseVertex a constant that is added to each index.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawListAddElements(oriDrawList *list, oriVertexArray *va, oriShader *shader, const unsigned int count, const unsigned int instanceCount, const unsigned int firstIndex, const int baseVertex, const unsigned int baseInstance);
+
+/**
+ * @brief Add a non-indexed draw to the given draw list.
+ *
+ * @details The list must have been created with an index type of 0. A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param list the draw list to add to.
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound when the list is submitted.
+ * @param count the amount of vertices to draw.
+ * @param instanceCount the amount of instances to draw (1 if instancing isn't used).
+ * @param first the first vertex to draw.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawListAddArrays(oriDrawList *list, oriVertexArray *va, oriShader *shader, const unsigned int count, const unsigned int instanceCount, const unsigned int first, const unsigned int baseInstance);
+
+/**
+ * @brief Upload the commands of the given draw list to its indirect buffer without drawing them.
+ *
+ * @details This is done implicitly by oriSubmitDrawList(). Call it explicitly to modify the commands on the GPU before
+ * they are drawn, e.g. to cull them with a compute shader: the indirect buffer (see oriGetDrawListIndirectBuffer()) holds
+ * each batch's commands back-to-back, and on GL 4.6 the parameter buffer (see oriGetDrawListParameterBuffer()) holds one
+ * @c uint command count per batch, which may be lowered to skip the commands at the end of a batch.
+ *
+ * @param list the draw list to upload.
+ *
+ * @ingroup vertexspec
+ */
+void oriUploadDrawList(oriDrawList *list);
+
+/**
+ * @brief Draw every command in the given draw list.
+ *
+ * @details Each vertex array and shader pair is bound once and drawn with one call: @c glMultiDraw*IndirectCount on
+ * GL 4.6, @c glMultiDraw*Indirect on GL 4.3, or one @c glDraw*Indirect per command below that. The list's commands are
+ * uploaded first if they have changed (see oriUploadDrawList()).
+ *
+ * @param list the draw list to draw.
+ *
+ * @ingroup vertexspec
+ */
+void oriSubmitDrawList(oriDrawList *list);
+
+/**
+ * @brief Return the indirect buffer that the commands of the given draw list are uploaded to.
+ *
+ * @warning The returned buffer is owned by the draw list; do not free it or set its data with oriSetBufferData().
+ *
+ * @param list the draw list to inspect.
+ *
+ * @ingroup vertexspec
+ */
+oriBuffer *oriGetDrawListIndirectBuffer(oriDrawList *list);
+
+/**
+ * @brief Return the buffer that the per-batch command counts of the given draw list are uploaded to, or NULL below GL 4.6.
+ *
+ * @warning The returned buffer is owned by the draw list; do not free it or set its data with oriSetBufferData().
+ *
+ * @param list the draw list to inspect.
+ *
+ * @ingroup vertexspec
+ */
+oriBuffer *oriGetDrawListParameterBuffer(oriDrawList *list);
 
 // ======================================================================================
 // *****                           ORION SHADER FUNCTIONS                           *****
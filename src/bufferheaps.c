@@ -0,0 +1,494 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// the largest order of a page, i.e. each page is at most 2^20 minimum-size blocks.
+#define _ORION_HEAP_MAX_ORDER 20
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief One GL buffer object of a heap, sub-allocated with a binary buddy allocator.
+ *
+ */
+typedef struct _oriBufferHeapPage {
+    oriBuffer *buffer;
+
+    // complete binary tree of (order + 1) of the largest free block in each node's subtree, or 0 if the subtree is full.
+    // node 0 is the whole page; the children of node i are nodes 2i + 1 and 2i + 2.
+    unsigned char *longest;
+
+    // the amount of bytes allocated from the page (in whole blocks).
+    size_t used;
+} _oriBufferHeapPage;
+
+/**
+ * @brief A range allocated from a heap. The public part of the range comes first so that the two can be cast between.
+ *
+ */
+typedef struct _oriBufferHeapRange {
+    oriBufferRange range;
+
+    // doubly-linked list of all live ranges in the heap
+    struct _oriBufferHeapRange *next;
+    struct _oriBufferHeapRange *prev;
+
+    _oriBufferHeapPage *page;
+    // the allocated block is (heap->minBlockSize << order) bytes.
+    unsigned int order;
+} _oriBufferHeapRange;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A set of large GL buffers that are sub-allocated into oriBufferRange handles.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBufferHeap {
+    oriBufferHeap *next;
+
+    size_t minBlockSize;
+    // each page is (minBlockSize << maxOrder) bytes.
+    unsigned int maxOrder;
+
+    _oriBufferHeapPage **pages;
+    unsigned int pageCount;
+
+    _oriBufferHeapRange *rangeListHead;
+} oriBufferHeap;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// return x rounded up to a power of two, or 0 if that doesn't fit in a size_t.
+static size_t _orionRoundUpPow2(size_t x) {
+    size_t r = 1;
+    while (r && r < x) {
+        r <<= 1;
+    }
+    return r;
+}
+
+static unsigned int _orionLog2(size_t x) {
+    unsigned int r = 0;
+    while (x >>= 1) {
+        r++;
+    }
+    return r;
+}
+
+static _oriBufferHeapPage *_orionCreateHeapPage(oriBufferHeap *heap) {
+    size_t pageSize = heap->minBlockSize << heap->maxOrder;
+
+    _oriBufferHeapPage *r = malloc(sizeof(_oriBufferHeapPage));
+    r->used = 0;
+
+    // initialise the tree: every node is completely free
+    unsigned int nodeCount = (2u << heap->maxOrder) - 1;
+    r->longest = malloc(nodeCount);
+
+    unsigned int order = heap->maxOrder + 1;
+    for (unsigned int i = 0; i < nodeCount; i++) {
+        // nodes 2^d - 1 .. 2^(d+1) - 2 are at depth d
+        if (((i + 1) & i) == 0) {
+            order--;
+        }
+        r->longest[i] = order + 1;
+    }
+
+    if (_orion.glVersion >= 440) {
+        r->buffer = oriCreateBufferImmutable(pageSize, NULL, GL_DYNAMIC_STORAGE_BIT);
+    } else {
+        r->buffer = oriCreateBuffer();
+        oriSetBufferData(r->buffer, NULL, pageSize, GL_STATIC_DRAW);
+    }
+
+    // append to the heap's page array
+    heap->pages = realloc(heap->pages, (heap->pageCount + 1) * sizeof(_oriBufferHeapPage *));
+    heap->pages[heap->pageCount++] = r;
+
+    return r;
+}
+
+static void _orionFreeHeapPage(oriBufferHeap *heap, _oriBufferHeapPage *page) {
+    for (unsigned int i = 0; i < heap->pageCount; i++) {
+        if (heap->pages[i] == page) {
+            heap->pages[i] = heap->pages[--heap->pageCount];
+            break;
+        }
+    }
+
+    oriFreeBuffer(page->buffer);
+    free(page->longest);
+    free(page);
+}
+
+// allocate a block of the given order from the page; returns false if there is no space.
+static bool _orionHeapPageAlloc(oriBufferHeap *heap, _oriBufferHeapPage *page, unsigned int order, size_t *offset) {
+    if (page->longest[0] < order + 1) {
+        return false;
+    }
+
+    // descend to a free node of the right order, preferring the left (lower) half
+    unsigned int i = 0;
+    unsigned int nodeOrder = heap->maxOrder;
+    while (nodeOrder != order) {
+        i = (page->longest[2 * i + 1] >= order + 1) ? 2 * i + 1 : 2 * i + 2;
+        nodeOrder--;
+    }
+    page->longest[i] = 0;
+
+    unsigned int depth = heap->maxOrder - order;
+    *offset = ((size_t) (i + 1 - (1u << depth)) << order) * heap->minBlockSize;
+
+    // update the ancestors
+    while (i) {
+        i = (i - 1) / 2;
+        unsigned char l = page->longest[2 * i + 1];
+        unsigned char r = page->longest[2 * i + 2];
+        page->longest[i] = l > r ? l : r;
+    }
+
+    page->used += heap->minBlockSize << order;
+
+    return true;
+}
+
+// free a block that was allocated with _orionHeapPageAlloc().
+static void _orionHeapPageFree(oriBufferHeap *heap, _oriBufferHeapPage *page, unsigned int order, size_t offset) {
+    unsigned int depth = heap->maxOrder - order;
+    unsigned int i = (unsigned int) ((offset / heap->minBlockSize) >> order) + (1u << depth) - 1;
+    page->longest[i] = order + 1;
+
+    // update the ancestors, merging buddies that are both completely free
+    unsigned int nodeOrder = order;
+    while (i) {
+        i = (i - 1) / 2;
+        nodeOrder++;
+
+        unsigned char l = page->longest[2 * i + 1];
+        unsigned char r = page->longest[2 * i + 2];
+        if (l == nodeOrder && r == nodeOrder) {
+            page->longest[i] = nodeOrder + 1;
+        } else {
+            page->longest[i] = l > r ? l : r;
+        }
+    }
+
+    page->used -= heap->minBlockSize << order;
+}
+
+// ======================================================================================
+// *****                         ORION BUFFER HEAP FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriBufferHeap structure.
+ *
+ * @details A buffer heap reserves large GL buffer objects ('pages') and sub-allocates them into oriBufferRange handles with
+ * a buddy allocator, so thousands of small meshes can share a handful of buffer objects. Pages are created as they are
+ * needed.
+ *
+ * @param pageSize the size of each GL buffer object in bytes. Rounded up to a power of two.
+ * @param minAlignment the minimum size and alignment of each range in bytes, e.g. the largest vertex stride that will be used.
+ * Rounded up to a power of two. Each page can hold at most 2^20 ranges of this size.
+ * @return the heap, or NULL if the page size or alignment is out of range.
+ *
+ * @ingroup buffers
+ */
+oriBufferHeap *oriCreateBufferHeap(const size_t pageSize, const unsigned int minAlignment) {
+    _orionAssertVersion(310);
+
+    if (pageSize == 0 || minAlignment == 0) {
+        _orionThrowError(ORERR_NULL_RECIEVED);
+    }
+
+    // (each page's tree has a node per block and per merged block, so the amount of blocks per page is bounded too)
+    size_t minBlockSize = _orionRoundUpPow2(minAlignment);
+    size_t roundedPageSize = _orionRoundUpPow2(pageSize);
+    if (!minBlockSize || !roundedPageSize || _orionLog2(roundedPageSize / minBlockSize) > _ORION_HEAP_MAX_ORDER) {
+        _orionThrowWarning("(in oriCreateBufferHeap()): Page size or alignment is too large, or there are too many blocks per page. Buffer heap not created.");
+        return NULL;
+    }
+
+    oriBufferHeap *r = malloc(sizeof(oriBufferHeap));
+    r->minBlockSize = minBlockSize;
+    r->maxOrder = _orionLog2(roundedPageSize / minBlockSize);
+    r->pages = NULL;
+    r->pageCount = 0;
+    r->rangeListHead = NULL;
+
+    // add to global linked list
+    r->next = _orion.bufferHeapListHead;
+    _orion.bufferHeapListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given buffer heap, including all of its ranges.
+ *
+ * @param heap the heap to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeBufferHeap(oriBufferHeap *heap) {
+    _orionAssertVersion(310);
+
+    // unlink from global linked list
+    if (_orion.bufferHeapListHead == heap) {
+        _orion.bufferHeapListHead = heap->next;
+    } else {
+        oriBufferHeap *current = _orion.bufferHeapListHead;
+        while (current->next != heap)
+            current = current->next;
+        current->next = heap->next;
+    }
+
+    while (heap->rangeListHead) {
+        _oriBufferHeapRange *next = heap->rangeListHead->next;
+        free(heap->rangeListHead);
+        heap->rangeListHead = next;
+    }
+
+    while (heap->pageCount) {
+        _orionFreeHeapPage(heap, heap->pages[0]);
+    }
+    free(heap->pages);
+
+    free(heap);
+    heap = NULL;
+}
+
+/**
+ * @brief Allocate a range of the given size from a buffer heap.
+ *
+ * @param heap the heap to allocate from.
+ * @param size the size of the range in bytes.
+ * @return the allocated range, or NULL if @c size is larger than the heap's page size.
+ *
+ * @ingroup buffers
+ */
+oriBufferRange *oriBufferHeapAlloc(oriBufferHeap *heap, const size_t size) {
+    size_t blocks = size / heap->minBlockSize + (size % heap->minBlockSize != 0);
+    size_t roundedBlocks = _orionRoundUpPow2(blocks ? blocks : 1);
+    unsigned int order = _orionLog2(roundedBlocks);
+
+    if (!roundedBlocks || order > heap->maxOrder) {
+        _orionThrowWarning("(in oriBufferHeapAlloc()): Requested size is larger than the heap's page size. Nothing allocated.");
+        return NULL;
+    }
+
+    _oriBufferHeapPage *page = NULL;
+    size_t offset = 0;
+
+    for (unsigned int i = 0; i < heap->pageCount; i++) {
+        if (_orionHeapPageAlloc(heap, heap->pages[i], order, &offset)) {
+            page = heap->pages[i];
+            break;
+        }
+    }
+    if (!page) {
+        page = _orionCreateHeapPage(heap);
+        _orionHeapPageAlloc(heap, page, order, &offset);
+    }
+
+    _oriBufferHeapRange *r = malloc(sizeof(_oriBufferHeapRange));
+    r->range.heap = heap;
+    r->range.buffer = page->buffer;
+    r->range.offset = offset;
+    r->range.size = size;
+    r->range.generation = 0;
+    r->page = page;
+    r->order = order;
+
+    r->prev = NULL;
+    r->next = heap->rangeListHead;
+    if (r->next) {
+        r->next->prev = r;
+    }
+    heap->rangeListHead = r;
+
+    return &r->range;
+}
+
+/**
+ * @brief Return the given range to its heap.
+ *
+ * @param range the range to free.
+ *
+ * @ingroup buffers
+ */
+void oriBufferHeapFree(oriBufferRange *range) {
+    _oriBufferHeapRange *r = (_oriBufferHeapRange *) range;
+    oriBufferHeap *heap = range->heap;
+
+    _orionHeapPageFree(heap, r->page, r->order, range->offset);
+
+    if (r->prev) {
+        r->prev->next = r->next;
+    } else {
+        heap->rangeListHead = r->next;
+    }
+    if (r->next) {
+        r->next->prev = r->prev;
+    }
+
+    free(r);
+    r = NULL;
+}
+
+/**
+ * @brief Upload data into the given range.
+ *
+ * @param range the range to copy data into.
+ * @param data the data to copy.
+ * @param size the size of the given data; must not be larger than the range's size.
+ *
+ * @ingroup buffers
+ */
+void oriSetBufferRangeData(oriBufferRange *range, const void *data, const size_t size) {
+    if (size > range->size) {
+        _orionThrowWarning("(in oriSetBufferRangeData()): Data is larger than the range. Range data not updated.");
+        return;
+    }
+
+    if (_orion.glVersion >= 450) {
+        glNamedBufferSubData(range->buffer->handle, range->offset, size, data);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(range->buffer, GL_ARRAY_BUFFER);
+
+        glBufferSubData(GL_ARRAY_BUFFER, range->offset, size, data);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
+
+/**
+ * @brief Incrementally compact the live ranges of a buffer heap.
+ *
+ * @details The least-occupied page of the heap is evacuated into free space in the other pages with
+ * @c glCopyNamedBufferSubData, and released once it is empty. This is intended to be called once per frame with a small
+ * budget so that the work is spread out.
+ *
+ * Each range that is moved has its @c buffer and @c offset members updated and its @c generation incremented, so any
+ * vertex arrays that reference it need to be re-specified.
+ *
+ * @param heap the heap to defragment.
+ * @param maxBytes the maximum amount of bytes to move. Set to 0 for no limit.
+ * @return the amount of bytes that were moved.
+ *
+ * @ingroup buffers
+ */
+size_t oriDefragmentBufferHeap(oriBufferHeap *heap, const size_t maxBytes) {
+    // release empty pages, except for the last one (which is kept for future allocations)
+    for (unsigned int i = 0; i < heap->pageCount && heap->pageCount > 1;) {
+        if (heap->pages[i]->used == 0) {
+            _orionFreeHeapPage(heap, heap->pages[i]);
+        } else {
+            i++;
+        }
+    }
+
+    if (heap->pageCount < 2) {
+        return 0;
+    }
+
+    // pick the least-occupied page to evacuate
+    _oriBufferHeapPage *src = heap->pages[0];
+    for (unsigned int i = 1; i < heap->pageCount; i++) {
+        if (heap->pages[i]->used < src->used) {
+            src = heap->pages[i];
+        }
+    }
+
+    size_t moved = 0;
+
+    for (_oriBufferHeapRange *r = heap->rangeListHead; r; r = r->next) {
+        if (r->page != src) {
+            continue;
+        }
+        if (maxBytes && moved + r->range.size > maxBytes) {
+            break;
+        }
+
+        _oriBufferHeapPage *dst = NULL;
+        size_t offset = 0;
+        for (unsigned int i = 0; i < heap->pageCount; i++) {
+            if (heap->pages[i] != src && _orionHeapPageAlloc(heap, heap->pages[i], r->order, &offset)) {
+                dst = heap->pages[i];
+                break;
+            }
+        }
+        // the other pages are full
+        if (!dst) {
+            break;
+        }
+
+        _orionCopyBufferData(src->buffer, r->range.offset, dst->buffer, offset, r->range.size);
+        _orionHeapPageFree(heap, src, r->order, r->range.offset);
+
+        r->page = dst;
+        r->range.buffer = dst->buffer;
+        r->range.offset = offset;
+        r->range.generation++;
+
+        moved += r->range.size;
+    }
+
+    return moved;
+}
+
+// ======================================================================================
+// *****                     ORION VERTEX SPECIFICATION FUNCTIONS                   *****
+// ======================================================================================
+
+/**
+ * @brief Specifies vertex data with the given attribute format, read from a range of a buffer heap.
+ *
+ * @details This is the same as oriSpecifyVertexData(), except the buffer is read from the start of the range. Unlike
+ * oriSpecifyVertexData(), the buffer does not need to be bound beforehand.
+ *
+ * @param va the vertex array object (VAO) to store the vertex data in.
+ * @param range the buffer range to read from.
+ * @param index the index of the vertex attribute to be defined.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param stride the byte offset between each vertex attribute.
+ * @param offset an offset of the first component of the vertex attribute, relative to the start of the range.
+ *
+ * @ingroup vertexspec
+ */
+void oriSpecifyVertexDataRange(oriVertexArray *va, oriBufferRange *range,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset
+) {
+    _orionSpecifyVertexData("oriSpecifyVertexDataRange", va, range->buffer, range->offset, index, size, type, normalised, stride, offset, 0);
+}
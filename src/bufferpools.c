@@ -0,0 +1,294 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// the smallest size class of a pool, in bytes.
+#define _ORION_POOL_MIN_SIZE 256
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A buffer object owned by a pool that isn't in use by the caller.
+ *
+ */
+typedef struct _oriBufferPoolEntry {
+    struct _oriBufferPoolEntry *next;
+
+    oriBuffer *buffer;
+    unsigned int usage;
+
+    // signalled when the GPU has finished with the buffer; NULL once the buffer can be reused.
+    GLsync fence;
+} _oriBufferPoolEntry;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A cache of buffer objects that are recycled by size class and usage.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBufferPool {
+    oriBufferPool *next;
+
+    // the maximum amount of idle buffers to keep; buffers released past this are freed.
+    unsigned int maxIdle;
+
+    // buffers that can be reused immediately
+    _oriBufferPoolEntry *idleListHead;
+    unsigned int idleCount;
+
+    // released buffers that the GPU may still be using, oldest first
+    _oriBufferPoolEntry *pendingListHead;
+    _oriBufferPoolEntry *pendingListTail;
+    unsigned int pendingCount;
+
+    unsigned int hits;
+    unsigned int misses;
+} oriBufferPool;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static size_t _orionPoolSizeClass(size_t size) {
+    size_t r = _ORION_POOL_MIN_SIZE;
+    while (r < size) {
+        r <<= 1;
+    }
+    return r;
+}
+
+// move released buffers whose fences have been signalled to the idle list.
+static void _orionPoolReclaim(oriBufferPool *pool) {
+    while (pool->pendingListHead) {
+        _oriBufferPoolEntry *entry = pool->pendingListHead;
+
+        if (entry->fence) {
+            // fences are signalled in the order they were inserted, so stop at the first one that isn't
+            GLenum status = glClientWaitSync(entry->fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                return;
+            }
+
+            glDeleteSync(entry->fence);
+            entry->fence = NULL;
+        }
+
+        pool->pendingListHead = entry->next;
+        if (!pool->pendingListHead) {
+            pool->pendingListTail = NULL;
+        }
+        pool->pendingCount--;
+
+        if (pool->idleCount >= pool->maxIdle) {
+            oriFreeBuffer(entry->buffer);
+            free(entry);
+            continue;
+        }
+
+        entry->next = pool->idleListHead;
+        pool->idleListHead = entry;
+        pool->idleCount++;
+    }
+}
+
+static void _orionFreePoolEntries(_oriBufferPoolEntry *head) {
+    while (head) {
+        _oriBufferPoolEntry *next = head->next;
+
+        if (head->fence) {
+            glDeleteSync(head->fence);
+        }
+        oriFreeBuffer(head->buffer);
+        free(head);
+
+        head = next;
+    }
+}
+
+// ======================================================================================
+// *****                         ORION BUFFER POOL FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriBufferPool structure.
+ *
+ * @details A buffer pool hands out buffer objects that have been released earlier instead of creating new ones, which
+ * avoids the driver overhead of creating and deleting buffers for transient, per-frame geometry. Buffers are grouped by
+ * size class (sizes are rounded up to the next power of two) and usage.
+ *
+ * @param maxIdle the maximum amount of idle buffers the pool keeps; buffers released past this are freed.
+ *
+ * @ingroup buffers
+ */
+oriBufferPool *oriCreateBufferPool(const unsigned int maxIdle) {
+    _orionAssertVersion(200);
+
+    oriBufferPool *r = malloc(sizeof(oriBufferPool));
+    r->maxIdle = maxIdle;
+    r->idleListHead = NULL;
+    r->idleCount = 0;
+    r->pendingListHead = NULL;
+    r->pendingListTail = NULL;
+    r->pendingCount = 0;
+    r->hits = 0;
+    r->misses = 0;
+
+    // add to global linked list
+    r->next = _orion.bufferPoolListHead;
+    _orion.bufferPoolListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given buffer pool, and all idle buffers it owns.
+ *
+ * @note Buffers that have been acquired from the pool and not released are not freed; they become regular buffers.
+ *
+ * @param pool the buffer pool to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeBufferPool(oriBufferPool *pool) {
+    _orionAssertVersion(200);
+
+    // unlink from global linked list
+    if (_orion.bufferPoolListHead == pool) {
+        _orion.bufferPoolListHead = pool->next;
+    } else {
+        oriBufferPool *current = _orion.bufferPoolListHead;
+        while (current->next != pool)
+            current = current->next;
+        current->next = pool->next;
+    }
+
+    _orionFreePoolEntries(pool->idleListHead);
+    _orionFreePoolEntries(pool->pendingListHead);
+
+    free(pool);
+    pool = NULL;
+}
+
+/**
+ * @brief Acquire a buffer of at least @c size bytes from the given pool.
+ *
+ * @details The returned buffer's data store is @c size rounded up to the next power of two, and its contents are undefined;
+ * write to it with oriUpdateBufferRange() or oriMapBufferRange(). Do not reallocate the buffer with oriSetBufferData() or
+ * free it with oriFreeBuffer(); return it to the pool with oriBufferPoolRelease() instead.
+ *
+ * @param pool the pool to acquire a buffer from.
+ * @param size the minimum size of the buffer's data store in bytes.
+ * @param usage the usage of the buffer, e.g. @c GL_STREAM_DRAW.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriBufferPoolAcquire(oriBufferPool *pool, const size_t size, const unsigned int usage) {
+    _orionAssertVersion(200);
+
+    size_t sizeClass = _orionPoolSizeClass(size);
+
+    _orionPoolReclaim(pool);
+
+    _oriBufferPoolEntry **current = &pool->idleListHead;
+    while (*current) {
+        _oriBufferPoolEntry *entry = *current;
+
+        if (entry->usage == usage && entry->buffer->dataSize == sizeClass) {
+            *current = entry->next;
+            pool->idleCount--;
+            pool->hits++;
+
+            oriBuffer *r = entry->buffer;
+            free(entry);
+
+            return r;
+        }
+
+        current = &entry->next;
+    }
+
+    pool->misses++;
+
+    oriBuffer *r = oriCreateBuffer();
+    oriSetBufferData(r, NULL, sizeClass, usage);
+
+    return r;
+}
+
+/**
+ * @brief Return a buffer that was acquired with oriBufferPoolAcquire() to the given pool.
+ *
+ * @details The buffer is only handed out again once the GPU has finished with the commands that were issued before this
+ * call (on GL 3.2+; below that, the driver synchronises the next upload instead), so it is safe to release a buffer
+ * straight after the draw calls that use it.
+ *
+ * @param pool the pool that the buffer was acquired from.
+ * @param buffer the buffer to release.
+ *
+ * @ingroup buffers
+ */
+void oriBufferPoolRelease(oriBufferPool *pool, oriBuffer *buffer) {
+    _orionAssertVersion(200);
+
+    oriUnmapBuffer(buffer);
+
+    _oriBufferPoolEntry *entry = malloc(sizeof(_oriBufferPoolEntry));
+    entry->next = NULL;
+    entry->buffer = buffer;
+    entry->usage = buffer->usage;
+    entry->fence = (_orion.glVersion >= 320) ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : NULL;
+
+    if (pool->pendingListTail) {
+        pool->pendingListTail->next = entry;
+    } else {
+        pool->pendingListHead = entry;
+    }
+    pool->pendingListTail = entry;
+    pool->pendingCount++;
+}
+
+/**
+ * @brief Get the usage statistics of the given pool, to help tune its size.
+ *
+ * @details A hit is an acquisition that reused an idle buffer; a miss is one that had to create a new buffer object.
+ *
+ * @param pool the pool to inspect.
+ * @param hits if not NULL, this is set to the amount of hits since the pool was created.
+ * @param misses if not NULL, this is set to the amount of misses since the pool was created.
+ * @param idle if not NULL, this is set to the amount of buffers that are currently owned by the pool (including those
+ * that are waiting on the GPU).
+ *
+ * @ingroup buffers
+ */
+void oriGetBufferPoolStats(oriBufferPool *pool, unsigned int *hits, unsigned int *misses, unsigned int *idle) {
+    if (hits) {
+        *hits = pool->hits;
+    }
+    if (misses) {
+        *misses = pool->misses;
+    }
+    if (idle) {
+        *idle = pool->idleCount + pool->pendingCount;
+    }
+}
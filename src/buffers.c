@@ -16,31 +16,80 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 // ======================================================================================
-// *****                           ORION PUBLIC STRUCTURES                          *****
+// *****                              HELPER FUNCTIONS                              *****
 // ======================================================================================
 
+// dirty ranges that are separated by fewer than this many bytes are uploaded together, as re-uploading a few unchanged
+// bytes from the shadow copy is cheaper than issuing another call.
+#define _ORION_DIRTY_MERGE_GAP 256
+
+static int _orionCompareDirtyRanges(const void *a, const void *b) {
+    size_t x = ((const _oriBufferDirtyRange *) a)->offset;
+    size_t y = ((const _oriBufferDirtyRange *) b)->offset;
+    return (x > y) - (x < y);
+}
+
+// upload size bytes of data to the given offset of the buffer's data store, without going through the shadow copy.
+static void _orionBufferSubData(oriBuffer *buffer, const size_t offset, const size_t size, const void *data) {
+    // immutable stores without GL_DYNAMIC_STORAGE_BIT can only be written to through a mapping
+    if (buffer->immutableStorage && !(buffer->storageFlags & GL_DYNAMIC_STORAGE_BIT)) {
+        // persistently-mapped buffers can just be written to directly
+        if (buffer->mapped && (buffer->mapAccess & GL_MAP_PERSISTENT_BIT) && (buffer->mapAccess & GL_MAP_WRITE_BIT) &&
+            offset >= buffer->mapOffset && offset + size <= buffer->mapOffset + buffer->mapLength) {
+            memcpy((unsigned char *) buffer->mapped + (offset - buffer->mapOffset), data, size);
+
+            if (buffer->mapAccess & GL_MAP_FLUSH_EXPLICIT_BIT) {
+                oriFlushMappedRange(buffer, offset - buffer->mapOffset, size);
+            }
+            return;
+        }
+
+        void *ptr = oriMapBufferRange(buffer, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!ptr) {
+            _orionThrowWarning("(in oriUpdateBufferRange()): Buffer has immutable storage that can't be written to. Buffer data not updated.");
+            return;
+        }
+        memcpy(ptr, data, size);
+        oriUnmapBuffer(buffer);
+
+        return;
+    }
+
+    if (_orion.glVersion >= 450) {
+        glNamedBufferSubData(buffer->handle, offset, size, data);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(buffer, GL_ARRAY_BUFFER);
+
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
+
 /**
- * @brief An OpenGL buffer object.
- * 
- * @ingroup buffers
+ * @brief Copy @c size bytes from one buffer's data store to another's.
+ *
  */
-typedef struct oriBuffer {
-    oriBuffer *next;
-
-    unsigned int handle;
-    unsigned int currentTarget;
-    bool dataSet;
-    unsigned int dataSize;
-} oriBuffer;
+void _orionCopyBufferData(oriBuffer *src, size_t srcOffset, oriBuffer *dst, size_t dstOffset, size_t size) {
+    if (_orion.glVersion >= 450) {
+        glCopyNamedBufferSubData(src->handle, dst->handle, srcOffset, dstOffset, size);
+        return;
+    }
 
-typedef struct oriVertexArray {
-    oriVertexArray *next;
+    unsigned int readCache = oriCurrentBufferAt(GL_COPY_READ_BUFFER);
+    unsigned int writeCache = oriCurrentBufferAt(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_READ_BUFFER, src->handle);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dst->handle);
 
-    unsigned int handle;
-} oriVertexArray;
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset, dstOffset, size);
 
+    glBindBuffer(GL_COPY_READ_BUFFER, readCache);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, writeCache);
+}
 
 // ======================================================================================
 // *****                     ORION VERTEX SPECIFICATION FUNCTIONS                   *****
@@ -56,6 +105,8 @@ oriVertexArray *oriCreateVertexArray() {
 
     oriVertexArray *r = malloc(sizeof(oriVertexArray));
     r->handle = 0;
+    r->indexBuffer = NULL;
+    r->indexType = 0;
 
     // use DSA if possible
     if (_orion.glVersion >= 450) {
@@ -83,10 +134,14 @@ void oriFreeVertexArray(oriVertexArray *va) {
     _orionAssertVersion(300);
 
     // unlink from global linked list
-    oriVertexArray *current = _orion.vertexArrayListHead;
-    while (current != va)
-        current = current->next;
-    _orion.vertexArrayListHead = va->next;
+    if (_orion.vertexArrayListHead == va) {
+        _orion.vertexArrayListHead = va->next;
+    } else {
+        oriVertexArray *current = _orion.vertexArrayListHead;
+        while (current->next != va)
+            current = current->next;
+        current->next = va->next;
+    }
 
     glDeleteVertexArrays(1, &va->handle);
 
@@ -121,6 +176,97 @@ unsigned int oriGetVertexArrayHandle(oriVertexArray *va) {
     return va->handle;
 }
 
+/**
+ * @brief Attach an element (index) buffer to the given vertex array, so that indexed draws with the vertex array read
+ * their indices from it.
+ *
+ * @details The index type is stored with the vertex array and can be read back with oriGetVertexArrayIndexType(). If the
+ * buffer is freed with oriFreeBuffer(), it is detached from every vertex array it is attached to.
+ *
+ * @param va the vertex array to modify.
+ * @param buffer the buffer holding the indices, or NULL to detach the current one.
+ * @param type the type of the indices: @c GL_UNSIGNED_BYTE, @c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT (as returned by
+ * oriUploadIndexData()).
+ *
+ * @ingroup vertexspec
+ */
+void oriSetVertexArrayIndexBuffer(oriVertexArray *va, oriBuffer *buffer, const unsigned int type) {
+    _orionAssertVersion(300);
+
+    va->indexBuffer = buffer;
+    va->indexType = buffer ? type : 0;
+
+    if (_orion.glVersion >= 450) {
+        glVertexArrayElementBuffer(va->handle, buffer ? buffer->handle : 0);
+        return;
+    }
+
+    // the element buffer binding is part of the vertex array's state, so it is recorded by binding it with the VAO bound
+    unsigned int previousVA = oriCurrentVertexArray();
+    unsigned int previousElements = oriCurrentBufferAt(GL_ELEMENT_ARRAY_BUFFER);
+    oriBindVertexArray(va);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer ? buffer->handle : 0);
+
+    // rebinding the previous vertex array brings back its element buffer, so the tracked binding is restored with it
+    glBindVertexArray(previousVA);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, previousElements);
+}
+
+/**
+ * @brief Return the type of the indices in the element buffer attached to the given vertex array, or 0 if none is.
+ *
+ * @param va the vertex array to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetVertexArrayIndexType(oriVertexArray *va) {
+    return va->indexType;
+}
+
+/**
+ * @brief Enable or disable primitive restart for indexed draws with the given index type.
+ *
+ * @details While enabled, the largest value of @c indexType (e.g. @c 0xFFFF for @c GL_UNSIGNED_SHORT) ends the current
+ * strip or fan and starts a new one, as inserted by oriUploadIndexData() for @c ORION_PRIMITIVE_RESTART.
+ *
+ * @param enabled true to enable primitive restart, false to disable it.
+ * @param indexType the type of the indices that will be drawn (only needed below GL 4.3).
+ *
+ * @ingroup vertexspec
+ */
+void oriSetPrimitiveRestart(const bool enabled, const unsigned int indexType) {
+    _orionAssertVersion(310);
+
+    // 4.3 can use the largest value of whichever index type is drawn
+    if (_orion.glVersion >= 430) {
+        if (enabled) {
+            glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+        } else {
+            glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+        }
+        return;
+    }
+
+    if (!enabled) {
+        glDisable(GL_PRIMITIVE_RESTART);
+        return;
+    }
+
+    glEnable(GL_PRIMITIVE_RESTART);
+    switch (indexType) {
+        case GL_UNSIGNED_BYTE:
+            glPrimitiveRestartIndex(0xFF);
+            break;
+        case GL_UNSIGNED_SHORT:
+            glPrimitiveRestartIndex(0xFFFF);
+            break;
+        default:
+            glPrimitiveRestartIndex(0xFFFFFFFF);
+            break;
+    }
+}
+
 /**
  * @brief Specifies vertex data with the given attribute format.
  * @details @c buffer @b should be a vertex buffer. But it does not necessarily have to be.
@@ -151,28 +297,64 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
     const unsigned int stride,
     const unsigned int offset
 ) {
-    if (type == GL_DOUBLE) {
-        _orionThrowWarning("(in oriSpecifyVertexData()): The OpenGL Specification heavily warns against using GL_DOUBLE.");
-    }
-    if (type == GL_UNSIGNED_INT_10F_11F_11F_REV) {
-        _orionAssertVersion(440);
-        if (size != 3) {
-            _orionThrowWarning("(in oriSpecifyVertexData()): Size MUST be 3 when using GL_UNSIGNED_INT_10F_11F_11F_REV.");
-            return;
-        }
+    if (_orion.glVersion < 450 && buffer->currentTarget != GL_ARRAY_BUFFER) {
+        _orionThrowWarning("(in oriSpecifyVertexData()): When version is below 4.5, the buffer must be bound to GL_ARRAY_BUFFER.");
+        return;
     }
-    if ((type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV) && size != 4) {
-        _orionThrowWarning("(in oriSpecifyVertexData()): Size MUST be 4 when using either GL_INT_2_10_10_10_REV or GL_UNSIGNED_INT_2_10_10_10_REV.");
+
+    _orionSpecifyVertexData("oriSpecifyVertexData", va, buffer, 0, index, size, type, normalised, stride, offset, 0);
+}
+
+/**
+ * @brief Specifies per-instance vertex data with the given attribute format.
+ *
+ * @details This is the same as oriSpecifyVertexData(), except the attribute advances once every @c divisor instances
+ * rather than once per vertex, so that e.g. per-instance transforms and colours can live in their own buffer and be drawn
+ * with oriDrawInstanced() or an oriDrawList. Attributes wider than 4 components (such as a @c mat4) take up consecutive
+ * indices: specify each column separately, with @c offset advanced by the size of one column.
+ *
+ * @warning As with oriSpecifyVertexData(), the buffer must be bound to @c GL_ARRAY_BUFFER when the GL version is below 4.5.
+ *
+ * @param va the vertex array object (VAO) to store the vertex data in.
+ * @param buffer the buffer to read from.
+ * @param index the index of the vertex attribute to be defined.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param stride the byte offset between the attribute of each instance.
+ * @param offset an offset of the first component of the vertex attribute.
+ * @param divisor the amount of instances that share each value of the attribute (usually 1).
+ *
+ * @ingroup vertexspec
+ */
+void oriSpecifyInstanceData(oriVertexArray *va, oriBuffer *buffer,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset,
+    const unsigned int divisor
+) {
+    _orionAssertVersion(330);
+
+    if (_orion.glVersion < 450 && buffer->currentTarget != GL_ARRAY_BUFFER) {
+        _orionThrowWarning("(in oriSpecifyInstanceData()): When version is below 4.5, the buffer must be bound to GL_ARRAY_BUFFER.");
         return;
     }
 
-    _orionAssertVersion(300);
+    _orionSpecifyVertexData("oriSpecifyInstanceData", va, buffer, 0, index, size, type, normalised, stride, offset, divisor);
+}
 
+/**
+ * @brief Return which variant of glVertexAttrib*Pointer / glVertexArrayAttrib*Format should be used for attributes of the
+ * given component type so that their data isn't converted to floats.
+ *
+ */
+unsigned int _orionVertexAttribFuncType(const unsigned int type) {
     // 1 = glVertexAttribPointer / glVertexArrayAttribFormat
     // 2 = glVertexAttribIPointer / glVertexArrayAttribIFormat
     // 3 = glVertexAttribLPointer / glVertexArrayAttribLFormat
-    unsigned int vertexAttribPointerFuncType = 0;
-
     // glVertexAttribPointer and its I variant are available
     if (_orion.glVersion < 410) {
         switch (type) {
@@ -182,11 +364,9 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
             case GL_FIXED:
             case GL_INT_2_10_10_10_REV:
             case GL_UNSIGNED_INT_2_10_10_10_REV:
-                vertexAttribPointerFuncType = 1;
-                break;
+                return 1;
             default:
-                vertexAttribPointerFuncType = 2;
-                break;
+                return 2;
         }
     }
     // all variants of glVertexAttribPointer are available
@@ -198,21 +378,59 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
             case GL_INT_2_10_10_10_REV:
             case GL_UNSIGNED_INT_2_10_10_10_REV:
             case GL_UNSIGNED_INT_10F_11F_11F_REV:
-                vertexAttribPointerFuncType = 1;
-                break;
+                return 1;
             case GL_DOUBLE:
-                vertexAttribPointerFuncType = 3;
-                break;
+                return 3;
             default:
-                vertexAttribPointerFuncType = 2;
-                break;
+                return 2;
         }
     }
+}
+
+/**
+ * @brief Shared implementation of oriSpecifyVertexData(), oriSpecifyInstanceData() and oriSpecifyVertexDataRange(), with
+ * the buffer read from @c bufferOffset bytes onwards and the attribute advanced once every @c divisor instances (0 for
+ * once per vertex).
+ *
+ */
+void _orionSpecifyVertexData(const char *caller, oriVertexArray *va, oriBuffer *buffer, const size_t bufferOffset,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset,
+    const unsigned int divisor
+) {
+    // warnings are prefixed with the public function that was called
+    char msg[256];
+
+    if (type == GL_DOUBLE) {
+        snprintf(msg, sizeof(msg), "(in %s()): The OpenGL Specification heavily warns against using GL_DOUBLE.", caller);
+        _orionThrowWarning(msg);
+    }
+    if (type == GL_UNSIGNED_INT_10F_11F_11F_REV) {
+        _orionAssertVersion(440);
+        if (size != 3) {
+            snprintf(msg, sizeof(msg), "(in %s()): Size MUST be 3 when using GL_UNSIGNED_INT_10F_11F_11F_REV.", caller);
+            _orionThrowWarning(msg);
+            return;
+        }
+    }
+    if ((type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV) && size != 4) {
+        snprintf(msg, sizeof(msg), "(in %s()): Size MUST be 4 when using either GL_INT_2_10_10_10_REV or GL_UNSIGNED_INT_2_10_10_10_REV.", caller);
+        _orionThrowWarning(msg);
+        return;
+    }
+
+    _orionAssertVersion(300);
+
+    unsigned int vertexAttribPointerFuncType = _orionVertexAttribFuncType(type);
 
     // Use DSA where possible
     if (_orion.glVersion >= 450) {
         glEnableVertexArrayAttrib(va->handle, index);
-        glVertexArrayVertexBuffer(va->handle, index, buffer->handle, 0, stride);
+        glVertexArrayVertexBuffer(va->handle, index, buffer->handle, bufferOffset, stride);
         
         // use appropriate function as decided above to stop data from being converted to floats
         switch (vertexAttribPointerFuncType) {
@@ -228,6 +446,7 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
                 break;
         }
         glVertexArrayAttribBinding(va->handle, index, index);
+        glVertexArrayBindingDivisor(va->handle, index, divisor);
 
         // I don't understand binding indices at all, so I'm doing what some guy
         // recommended: simply using the attribute index as the binding index.
@@ -239,11 +458,6 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
     // ---
     // if DSA is not possible
 
-    if (buffer->currentTarget != GL_ARRAY_BUFFER) {
-        _orionThrowWarning("(in oriSpecifyVertexData()): When version is below 4.5, the buffer must be bound to GL_ARRAY_BUFFER.");
-        return;
-    }
-
     unsigned int previousVA = oriCurrentVertexArray();
     unsigned int previousBuffer = oriCurrentBufferAt(GL_ARRAY_BUFFER);
 
@@ -264,18 +478,23 @@ void oriSpecifyVertexData(oriVertexArray *va, oriBuffer *buffer,
     switch (vertexAttribPointerFuncType) {
         case 1:
         default:
-            glVertexAttribPointer(index, size, type, normalised, stride, (const void *) offset);
+            glVertexAttribPointer(index, size, type, normalised, stride, (const void *) (bufferOffset + offset));
             break;
         case 2:
-            glVertexAttribIPointer(index, size, type, stride, (const void *) offset);
+            glVertexAttribIPointer(index, size, type, stride, (const void *) (bufferOffset + offset));
             break;
         case 3:
-            glVertexAttribLPointer(index, size, type, stride, (const void *) offset);
+            glVertexAttribLPointer(index, size, type, stride, (const void *) (bufferOffset + offset));
             break;
     }
 
 #   pragma GCC diagnostic pop
 
+    // (divisors are 3.3+; below that, every attribute is per-vertex anyway)
+    if (_orion.glVersion >= 330) {
+        glVertexAttribDivisor(index, divisor);
+    }
+
     // bind to previous objects
     glBindVertexArray(previousVA);
     glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
@@ -297,7 +516,20 @@ oriBuffer *oriCreateBuffer() {
     r->handle = 0;
     r->dataSet = false;
     r->dataSize = 0;
+    r->usage = 0;
     r->currentTarget = 0;
+    r->immutableStorage = false;
+    r->storageFlags = 0;
+    r->mapped = NULL;
+    r->mapOffset = 0;
+    r->mapLength = 0;
+    r->mapAccess = 0;
+    r->shadow = NULL;
+    r->dirtyRanges = NULL;
+    r->dirtyCount = 0;
+    r->dirtyCapacity = 0;
+    r->nextDirty = NULL;
+    r->queued = false;
 
     // use DSA if possible
     if (_orion.glVersion >= 450) {
@@ -307,12 +539,54 @@ oriBuffer *oriCreateBuffer() {
         glGenBuffers(1, &r->handle);
     }
 
+    r->prev = NULL;
     r->next = _orion.bufferListHead;
+    if (r->next) {
+        r->next->prev = r;
+    }
     _orion.bufferListHead = r;
 
     return r;
 }
 
+/**
+ * @brief Allocate and initialise a new oriBuffer structure with immutable storage.
+ *
+ * @details The size of the buffer's data store is fixed on creation, so the driver is free to place it wherever suits
+ * the given @c flags best. The data store can still be overwritten with oriSetBufferData() if @c GL_DYNAMIC_STORAGE_BIT
+ * is set, or mapped with oriMapBufferRange() if any of the @c GL_MAP_*_BIT flags are set.
+ *
+ * @param size the size of the buffer's data store in bytes.
+ * @param data the data to initialise the buffer with. Set to NULL to leave the data store uninitialised.
+ * @param flags the intended usage of the buffer's data store, e.g. @c GL_DYNAMIC_STORAGE_BIT or @c GL_MAP_WRITE_BIT.
+ *
+ * @sa <a href="https://docs.gl/gl4/glBufferStorage">glBufferStorage</a>
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriCreateBufferImmutable(const size_t size, const void *data, const unsigned int flags) {
+    _orionAssertVersion(440);
+
+    oriBuffer *r = oriCreateBuffer();
+    r->dataSet = true;
+    r->dataSize = size;
+    r->immutableStorage = true;
+    r->storageFlags = flags;
+
+    if (_orion.glVersion >= 450) {
+        glNamedBufferStorage(r->handle, size, data, flags);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(r, GL_ARRAY_BUFFER);
+
+        glBufferStorage(GL_ARRAY_BUFFER, size, data, flags);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+
+    return r;
+}
+
 /**
  * @brief Destroy and free memory for the given buffer.
  * 
@@ -324,10 +598,37 @@ void oriFreeBuffer(oriBuffer *buffer) {
     _orionAssertVersion(200);
 
     // unlink from global linked list
-    oriBuffer *current = _orion.bufferListHead;
-    while (current != buffer)
-        current = current->next;
-    _orion.bufferListHead = buffer->next;
+    if (buffer->prev) {
+        buffer->prev->next = buffer->next;
+    } else {
+        _orion.bufferListHead = buffer->next;
+    }
+    if (buffer->next) {
+        buffer->next->prev = buffer->prev;
+    }
+
+    // remove from the list of buffers waiting to be flushed
+    if (buffer->queued) {
+        oriBuffer **current = &_orion.dirtyBufferListHead;
+        while (*current != buffer)
+            current = &(*current)->nextDirty;
+        *current = buffer->nextDirty;
+    }
+    free(buffer->shadow);
+    free(buffer->dirtyRanges);
+
+    // detach the buffer from vertex arrays that read their indices from it
+    for (oriVertexArray *va = _orion.vertexArrayListHead; va; va = va->next) {
+        if (va->indexBuffer == buffer) {
+            va->indexBuffer = NULL;
+            va->indexType = 0;
+        }
+    }
+
+    // vertex arrays that read from the buffer can't be reused any more
+    if (_orion.vertexLayoutListHead) {
+        _orionEvictVertexLayoutBuffer(buffer);
+    }
 
     glDeleteBuffers(1, &buffer->handle);
 
@@ -353,6 +654,9 @@ void oriBindBuffer(oriBuffer *buffer, unsigned int target) {
         case GL_TEXTURE_BUFFER:
             _orionAssertVersion(310);
             break;
+        case GL_PARAMETER_BUFFER:
+            _orionAssertVersion(460);
+            break;
         case GL_ATOMIC_COUNTER_BUFFER:
             _orionAssertVersion(420);
         case GL_DISPATCH_INDIRECT_BUFFER:
@@ -392,9 +696,30 @@ unsigned int oriGetBufferHandle(oriBuffer *buffer) {
  * 
  * @ingroup buffers
  */
-void oriSetBufferData(oriBuffer *buffer, const void *data, const unsigned int size, const unsigned int usage) {
+void oriSetBufferData(oriBuffer *buffer, const void *data, const size_t size, const unsigned int usage) {
     _orionAssertVersion(200);
 
+    // immutable storage can only be overwritten (never reallocated)
+    if (buffer->immutableStorage && buffer->dataSize != size) {
+        _orionThrowWarning("(in oriSetBufferData()): Cannot change the size of a buffer with immutable storage. Buffer data not updated.");
+        return;
+    }
+    if (buffer->immutableStorage && !(buffer->storageFlags & GL_DYNAMIC_STORAGE_BIT)) {
+        _orionThrowWarning("(in oriSetBufferData()): Buffer has immutable storage without GL_DYNAMIC_STORAGE_BIT; map it with oriMapBufferRange() instead. Buffer data not updated.");
+        return;
+    }
+
+    // keep the shadow copy of deferred buffers up to date; the whole store is uploaded now, so nothing is left dirty
+    if (buffer->shadow) {
+        if (buffer->dataSize != size) {
+            buffer->shadow = realloc(buffer->shadow, size ? size : 1);
+        }
+        if (data) {
+            memcpy(buffer->shadow, data, size);
+        }
+        buffer->dirtyCount = 0;
+    }
+
     bool dsaEnabled = _orion.glVersion >= 450;
 
     // for the sake of supporting non-DSA, the buffer will be temporarily bound to GL_ARRAY_BUFFER during this function's lifespan.
@@ -407,9 +732,11 @@ void oriSetBufferData(oriBuffer *buffer, const void *data, const unsigned int si
         oriBindBuffer(buffer, GL_ARRAY_BUFFER);
     }
 
-    // reallocate space for the data if the data hasn't been set or if the size has changed
-    if (!buffer->dataSet || buffer->dataSize != size) {
+    // reallocate space for the data if the data hasn't been set or if the size or usage has changed (immutable storage
+    // has no usage hint, and is always overwritten)
+    if (!buffer->dataSet || buffer->dataSize != size || (!buffer->immutableStorage && buffer->usage != usage)) {
         buffer->dataSize = size;
+        buffer->usage = usage;
         
         if (dsaEnabled) {
             glNamedBufferData(buffer->handle, size, data, usage);
@@ -440,3 +767,336 @@ void oriSetBufferData(oriBuffer *buffer, const void *data, const unsigned int si
         glBindBuffer(GL_ARRAY_BUFFER, boundCache);
     }
 }
+
+/**
+ * @brief Overwrite part of a buffer's data store.
+ *
+ * @details Unlike oriSetBufferData(), only the given range is uploaded. If the buffer is in deferred mode (see
+ * oriSetBufferDeferred()), the data is only copied into the buffer's CPU shadow copy and the range is recorded; it is
+ * uploaded on the next call to oriFlushBuffer() or oriFlushDeferredBuffers().
+ *
+ * @param buffer the buffer to update.
+ * @param offset the offset into the buffer's data store to write to, in bytes.
+ * @param size the size of the given data.
+ * @param data the data to copy into @c buffer.
+ *
+ * @ingroup buffers
+ */
+void oriUpdateBufferRange(oriBuffer *buffer, const size_t offset, const size_t size, const void *data) {
+    _orionAssertVersion(200);
+
+    if (!buffer->dataSet || size > buffer->dataSize || offset > buffer->dataSize - size) {
+        _orionThrowWarning("(in oriUpdateBufferRange()): Range is outside of the buffer's data store. Buffer data not updated.");
+        return;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    if (!buffer->shadow) {
+        _orionBufferSubData(buffer, offset, size, data);
+        return;
+    }
+
+    memcpy(buffer->shadow + offset, data, size);
+
+    if (buffer->dirtyCount == buffer->dirtyCapacity) {
+        buffer->dirtyCapacity = buffer->dirtyCapacity ? buffer->dirtyCapacity * 2 : 16;
+        buffer->dirtyRanges = realloc(buffer->dirtyRanges, buffer->dirtyCapacity * sizeof(_oriBufferDirtyRange));
+    }
+    buffer->dirtyRanges[buffer->dirtyCount].offset = offset;
+    buffer->dirtyRanges[buffer->dirtyCount].size = size;
+    buffer->dirtyCount++;
+
+    if (!buffer->queued) {
+        buffer->nextDirty = _orion.dirtyBufferListHead;
+        _orion.dirtyBufferListHead = buffer;
+        buffer->queued = true;
+    }
+}
+
+/**
+ * @brief Enable or disable deferred mode for the given buffer.
+ *
+ * @details In deferred mode, the buffer keeps a CPU shadow copy of its data store. oriUpdateBufferRange() only writes to the
+ * shadow copy and records the modified range, and the recorded ranges are merged and uploaded with as few calls as possible
+ * when the buffer is flushed. This is useful when many small, scattered parts of a buffer change every frame (e.g.
+ * per-instance transforms).
+ *
+ * @note If the buffer already has data, enabling deferred mode reads it back from the GL once to initialise the shadow copy.
+ * Disabling deferred mode flushes any pending ranges first.
+ *
+ * @param buffer the buffer to update.
+ * @param deferred true to enable deferred mode, false to disable it.
+ *
+ * @ingroup buffers
+ */
+void oriSetBufferDeferred(oriBuffer *buffer, const bool deferred) {
+    _orionAssertVersion(200);
+
+    if (deferred == (buffer->shadow != NULL)) {
+        return;
+    }
+
+    if (!deferred) {
+        oriFlushBuffer(buffer);
+
+        free(buffer->shadow);
+        buffer->shadow = NULL;
+
+        return;
+    }
+
+    buffer->shadow = calloc(buffer->dataSize ? buffer->dataSize : 1, 1);
+
+    if (!buffer->dataSet || buffer->dataSize == 0) {
+        return;
+    }
+
+    // initialise the shadow copy with the buffer's current contents
+    if (_orion.glVersion >= 450) {
+        glGetNamedBufferSubData(buffer->handle, 0, buffer->dataSize, buffer->shadow);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(buffer, GL_ARRAY_BUFFER);
+
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, buffer->dataSize, buffer->shadow);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
+
+/**
+ * @brief Upload the pending ranges of a buffer in deferred mode.
+ *
+ * @details Overlapping and adjacent ranges (and ranges separated by small gaps) are merged first, so that the minimum amount
+ * of upload calls are made.
+ *
+ * @param buffer the buffer to flush.
+ *
+ * @ingroup buffers
+ */
+void oriFlushBuffer(oriBuffer *buffer) {
+    if (!buffer->shadow || buffer->dirtyCount == 0) {
+        return;
+    }
+
+    qsort(buffer->dirtyRanges, buffer->dirtyCount, sizeof(_oriBufferDirtyRange), _orionCompareDirtyRanges);
+
+    size_t start = buffer->dirtyRanges[0].offset;
+    size_t end = start + buffer->dirtyRanges[0].size;
+
+    for (unsigned int i = 1; i < buffer->dirtyCount; i++) {
+        _oriBufferDirtyRange *range = &buffer->dirtyRanges[i];
+
+        if (range->offset <= end + _ORION_DIRTY_MERGE_GAP) {
+            if (range->offset + range->size > end) {
+                end = range->offset + range->size;
+            }
+            continue;
+        }
+
+        _orionBufferSubData(buffer, start, end - start, buffer->shadow + start);
+
+        start = range->offset;
+        end = start + range->size;
+    }
+    _orionBufferSubData(buffer, start, end - start, buffer->shadow + start);
+
+    buffer->dirtyCount = 0;
+
+    // (the buffer is left in the dirty list until the next oriFlushDeferredBuffers(), which skips it if it is clean)
+}
+
+/**
+ * @brief Upload the pending ranges of every buffer in deferred mode.
+ *
+ * @details Call this once per frame, before issuing draw calls.
+ *
+ * @sa oriFlushBuffer()
+ *
+ * @ingroup buffers
+ */
+void oriFlushDeferredBuffers() {
+    while (_orion.dirtyBufferListHead) {
+        oriBuffer *buffer = _orion.dirtyBufferListHead;
+        _orion.dirtyBufferListHead = buffer->nextDirty;
+
+        buffer->nextDirty = NULL;
+        buffer->queued = false;
+
+        oriFlushBuffer(buffer);
+    }
+}
+
+/**
+ * @brief Map a range of the given buffer's data store into client memory.
+ *
+ * @details The returned pointer points to the start of the range (i.e. to @c offset), not the start of the buffer. The
+ * buffer must be unmapped with oriUnmapBuffer() before it is used by the GL, unless it is mapped with
+ * @c GL_MAP_PERSISTENT_BIT. @c GL_MAP_INVALIDATE_RANGE_BIT, @c GL_MAP_INVALIDATE_BUFFER_BIT, @c GL_MAP_UNSYNCHRONIZED_BIT
+ * and @c GL_MAP_FLUSH_EXPLICIT_BIT are passed on to the GL as they are.
+ *
+ * @param buffer the buffer to map.
+ * @param offset the offset of the range to map, in bytes.
+ * @param length the length of the range to map, in bytes.
+ * @param access the access flags to map the range with, e.g. <tt>GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT</tt>.
+ * @return a pointer to the mapped range, or NULL if the range could not be mapped.
+ *
+ * @sa <a href="https://docs.gl/gl4/glMapBufferRange">glMapBufferRange</a>
+ *
+ * @ingroup buffers
+ */
+void *oriMapBufferRange(oriBuffer *buffer, const size_t offset, const size_t length, const unsigned int access) {
+    _orionAssertVersion(300);
+
+    if (buffer->mapped) {
+        _orionThrowWarning("(in oriMapBufferRange()): Buffer is already mapped. Buffer not mapped.");
+        return NULL;
+    }
+    if (!buffer->dataSet || length > buffer->dataSize || offset > buffer->dataSize - length) {
+        _orionThrowWarning("(in oriMapBufferRange()): Range is outside of the buffer's data store. Buffer not mapped.");
+        return NULL;
+    }
+
+    // immutable data stores can only be mapped in ways that were declared when they were allocated
+    unsigned int storageAccess = access & (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    if (buffer->immutableStorage && (storageAccess & ~buffer->storageFlags)) {
+        _orionThrowWarning("(in oriMapBufferRange()): Access flags are not a subset of the buffer's immutable storage flags. Buffer not mapped.");
+        return NULL;
+    }
+
+    if (_orion.glVersion >= 450) {
+        buffer->mapped = glMapNamedBufferRange(buffer->handle, offset, length, access);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(buffer, GL_ARRAY_BUFFER);
+
+        buffer->mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, length, access);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+
+    if (buffer->mapped) {
+        buffer->mapOffset = offset;
+        buffer->mapLength = length;
+        buffer->mapAccess = access;
+    }
+
+    return buffer->mapped;
+}
+
+/**
+ * @brief Indicate that a range of a buffer that was mapped with @c GL_MAP_FLUSH_EXPLICIT_BIT has been modified.
+ *
+ * @param buffer the mapped buffer.
+ * @param offset the offset of the modified range, in bytes, @b relative @b to @b the @b start @b of @b the @b mapping.
+ * @param length the length of the modified range, in bytes.
+ *
+ * @sa <a href="https://docs.gl/gl4/glFlushMappedBufferRange">glFlushMappedBufferRange</a>
+ *
+ * @ingroup buffers
+ */
+void oriFlushMappedRange(oriBuffer *buffer, const size_t offset, const size_t length) {
+    _orionAssertVersion(300);
+
+    if (!buffer->mapped || !(buffer->mapAccess & GL_MAP_FLUSH_EXPLICIT_BIT)) {
+        _orionThrowWarning("(in oriFlushMappedRange()): Buffer is not mapped with GL_MAP_FLUSH_EXPLICIT_BIT. Range not flushed.");
+        return;
+    }
+    if (length > buffer->mapLength || offset > buffer->mapLength - length) {
+        _orionThrowWarning("(in oriFlushMappedRange()): Range is outside of the mapped range. Range not flushed.");
+        return;
+    }
+
+    if (_orion.glVersion >= 450) {
+        glFlushMappedNamedBufferRange(buffer->handle, offset, length);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(buffer, GL_ARRAY_BUFFER);
+
+        glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, length);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
+
+/**
+ * @brief Unmap the given buffer.
+ *
+ * @param buffer the buffer to unmap.
+ * @return false if the buffer's data store became corrupt while it was mapped (e.g. due to a screen mode change), in which
+ * case its contents are undefined and must be uploaded again.
+ *
+ * @ingroup buffers
+ */
+bool oriUnmapBuffer(oriBuffer *buffer) {
+    _orionAssertVersion(300);
+
+    if (!buffer->mapped) {
+        return true;
+    }
+
+    bool r;
+    if (_orion.glVersion >= 450) {
+        r = glUnmapNamedBuffer(buffer->handle);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(buffer, GL_ARRAY_BUFFER);
+
+        r = glUnmapBuffer(GL_ARRAY_BUFFER);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+
+    buffer->mapped = NULL;
+    buffer->mapOffset = 0;
+    buffer->mapLength = 0;
+    buffer->mapAccess = 0;
+
+    return r;
+}
+
+/**
+ * @brief Upload 32-bit index data to the given buffer, narrowing it to 16 bits if every index fits.
+ *
+ * @details The indices are scanned once: if the largest index is below 65535, they are stored as @c GL_UNSIGNED_SHORT,
+ * halving the memory and bandwidth they take up; otherwise they are stored as given. If @c restart is true, indices equal
+ * to @c ORION_PRIMITIVE_RESTART are primitive restart markers, and are stored as the largest value of the chosen type
+ * (see oriSetPrimitiveRestart()).
+ *
+ * @param buffer the buffer to copy the indices into. Its data store is reallocated with oriSetBufferData().
+ * @param indices the indices to upload.
+ * @param count the amount of indices.
+ * @param usage the usage of the buffer, e.g. @c GL_STATIC_DRAW.
+ * @param restart true if @c indices contains @c ORION_PRIMITIVE_RESTART markers.
+ * @return the type that the indices were stored as (@c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT), to be given to
+ * oriSetVertexArrayIndexBuffer().
+ *
+ * @ingroup buffers
+ */
+unsigned int oriUploadIndexData(oriBuffer *buffer, const unsigned int *indices, const size_t count, const unsigned int usage, const bool restart) {
+    unsigned int max = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] > max && !(restart && indices[i] == ORION_PRIMITIVE_RESTART)) {
+            max = indices[i];
+        }
+    }
+
+    // (0xFFFF is kept free so that it can't be mistaken for a restart marker)
+    if (max >= 0xFFFF) {
+        oriSetBufferData(buffer, indices, count * sizeof(unsigned int), usage);
+        return GL_UNSIGNED_INT;
+    }
+
+    unsigned short *narrowed = malloc(count * sizeof(unsigned short));
+    for (size_t i = 0; i < count; i++) {
+        // (ORION_PRIMITIVE_RESTART truncates to 0xFFFF)
+        narrowed[i] = (unsigned short) indices[i];
+    }
+
+    oriSetBufferData(buffer, narrowed, count * sizeof(unsigned short), usage);
+    free(narrowed);
+
+    return GL_UNSIGNED_SHORT;
+}
@@ -0,0 +1,522 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief The layout of the commands read by glMultiDrawElementsIndirect.
+ *
+ */
+typedef struct _oriDrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+} _oriDrawElementsIndirectCommand;
+
+/**
+ * @brief The layout of the commands read by glMultiDrawArraysIndirect.
+ *
+ */
+typedef struct _oriDrawArraysIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int first;
+    unsigned int baseInstance;
+} _oriDrawArraysIndirectCommand;
+
+/**
+ * @brief The commands of a draw list that share a vertex array and shader, and so can be submitted with one call.
+ *
+ */
+typedef struct _oriDrawBatch {
+    oriVertexArray *va;
+    oriShader *shader;
+
+    // (either _oriDrawElementsIndirectCommand or _oriDrawArraysIndirectCommand, depending on the draw list)
+    unsigned char *commands;
+    unsigned int count;
+    unsigned int capacity;
+
+    // the offset of the batch's commands in the indirect buffer, as of the last upload.
+    size_t offset;
+} _oriDrawBatch;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A list of indirect draw commands that is submitted with as few calls as possible.
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriDrawList {
+    oriDrawList *next;
+
+    unsigned int mode;
+    // the type of the indices, or 0 if the list draws non-indexed geometry.
+    unsigned int indexType;
+    size_t commandSize;
+
+    _oriDrawBatch *batches;
+    unsigned int batchCount;
+    unsigned int batchCapacity;
+
+    // true if commands have been added since the last upload.
+    bool dirty;
+
+    oriBuffer *indirect;
+    // (4.6+) the amount of commands of each batch, read by glMultiDraw*IndirectCount
+    oriBuffer *parameter;
+
+    // CPU staging area that the batches are packed into before upload
+    unsigned char *staging;
+    size_t stagingSize;
+} oriDrawList;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// return the batch of the given list that draws with the given vertex array and shader, creating it if needed.
+static _oriDrawBatch *_orionGetDrawBatch(oriDrawList *list, oriVertexArray *va, oriShader *shader) {
+    // (commands are usually added in runs with the same state, so check the most recent batch first)
+    for (unsigned int i = list->batchCount; i > 0; i--) {
+        _oriDrawBatch *batch = &list->batches[i - 1];
+        if (batch->va == va && batch->shader == shader) {
+            return batch;
+        }
+    }
+
+    if (list->batchCount == list->batchCapacity) {
+        list->batchCapacity = list->batchCapacity ? list->batchCapacity * 2 : 8;
+        list->batches = realloc(list->batches, list->batchCapacity * sizeof(_oriDrawBatch));
+    }
+
+    _oriDrawBatch *r = &list->batches[list->batchCount++];
+    r->va = va;
+    r->shader = shader;
+    r->commands = NULL;
+    r->count = 0;
+    r->capacity = 0;
+    r->offset = 0;
+
+    return r;
+}
+
+// append a command to the given batch.
+static void _orionPushDrawCommand(oriDrawList *list, _oriDrawBatch *batch, const void *command) {
+    if (batch->count == batch->capacity) {
+        batch->capacity = batch->capacity ? batch->capacity * 2 : 64;
+        batch->commands = realloc(batch->commands, batch->capacity * list->commandSize);
+    }
+
+    memcpy(batch->commands + batch->count * list->commandSize, command, list->commandSize);
+    batch->count++;
+
+    list->dirty = true;
+}
+
+// ======================================================================================
+// *****                             ORION DRAW FUNCTIONS                           *****
+// ======================================================================================
+
+/**
+ * @brief Draw @c instanceCount instances of non-indexed geometry with one call.
+ *
+ * @details Per-instance attributes are specified with oriSpecifyInstanceData(). A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param first the first vertex to draw.
+ * @param count the amount of vertices to draw per instance.
+ * @param instanceCount the amount of instances to draw.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawInstanced(oriVertexArray *va, oriShader *shader, const unsigned int mode, const unsigned int first, const unsigned int count, const unsigned int instanceCount, const unsigned int baseInstance) {
+    _orionAssertVersion(310);
+
+    oriBindVertexArray(va);
+    if (shader) {
+        oriBindShader(shader);
+    }
+
+    if (baseInstance) {
+        _orionAssertVersion(420);
+        glDrawArraysInstancedBaseInstance(mode, first, count, instanceCount, baseInstance);
+    } else {
+        glDrawArraysInstanced(mode, first, count, instanceCount);
+    }
+}
+
+/**
+ * @brief Draw @c instanceCount instances of indexed geometry with one call.
+ *
+ * @details The indices are read from the element buffer of @c va. Per-instance attributes are specified with
+ * oriSpecifyInstanceData(). A non-zero @c baseVertex requires GL 3.2, and a non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param count the amount of indices to draw per instance.
+ * @param indexType the type of the indices, e.g. @c GL_UNSIGNED_INT.
+ * @param indexOffset the offset of the first index into the element buffer, in bytes.
+ * @param instanceCount the amount of instances to draw.
+ * @param baseVertex a constant that is added to each index.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawElementsInstanced(oriVertexArray *va, oriShader *shader, const unsigned int mode, const unsigned int count, const unsigned int indexType, const size_t indexOffset, const unsigned int instanceCount, const int baseVertex, const unsigned int baseInstance) {
+    _orionAssertVersion(310);
+
+    oriBindVertexArray(va);
+    if (shader) {
+        oriBindShader(shader);
+    }
+
+    // with an element buffer bound, the pointer is an offset into it
+    const void *indices = (const void *) indexOffset;
+
+    if (baseInstance) {
+        _orionAssertVersion(420);
+        glDrawElementsInstancedBaseVertexBaseInstance(mode, count, indexType, indices, instanceCount, baseVertex, baseInstance);
+    } else if (baseVertex) {
+        _orionAssertVersion(320);
+        glDrawElementsInstancedBaseVertex(mode, count, indexType, indices, instanceCount, baseVertex);
+    } else {
+        glDrawElementsInstanced(mode, count, indexType, indices, instanceCount);
+    }
+}
+
+// ======================================================================================
+// *****                          ORION DRAW LIST FUNCTIONS                         *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriDrawList structure.
+ *
+ * @details A draw list records draw commands into a @c GL_DRAW_INDIRECT_BUFFER. Commands are grouped by the vertex array
+ * and shader they are drawn with, and each group is submitted with a single @c glMultiDrawElementsIndirect (or
+ * @c glMultiDrawArraysIndirect) call, so thousands of draws only cost a handful of driver calls. Draw lists are intended
+ * to be cleared and refilled every frame with oriClearDrawList(); the memory they allocate is kept between frames.
+ *
+ * @param mode the kind of primitives to draw, e.g. @c GL_TRIANGLES.
+ * @param indexType the type of the indices in the vertex arrays' element buffers (@c GL_UNSIGNED_BYTE,
+ * @c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT), or 0 to draw non-indexed geometry.
+ *
+ * @ingroup vertexspec
+ */
+oriDrawList *oriCreateDrawList(const unsigned int mode, const unsigned int indexType) {
+    // indirect draw commands
+    _orionAssertVersion(400);
+
+    oriDrawList *r = malloc(sizeof(oriDrawList));
+    r->mode = mode;
+    r->indexType = indexType;
+    r->commandSize = indexType ? sizeof(_oriDrawElementsIndirectCommand) : sizeof(_oriDrawArraysIndirectCommand);
+    r->batches = NULL;
+    r->batchCount = 0;
+    r->batchCapacity = 0;
+    r->dirty = false;
+    r->indirect = oriCreateBuffer();
+    r->parameter = (_orion.glVersion >= 460) ? oriCreateBuffer() : NULL;
+    r->staging = NULL;
+    r->stagingSize = 0;
+
+    // add to global linked list
+    r->next = _orion.drawListListHead;
+    _orion.drawListListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given draw list.
+ *
+ * @param list the draw list to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeDrawList(oriDrawList *list) {
+    _orionAssertVersion(400);
+
+    // unlink from global linked list
+    if (_orion.drawListListHead == list) {
+        _orion.drawListListHead = list->next;
+    } else {
+        oriDrawList *current = _orion.drawListListHead;
+        while (current->next != list)
+            current = current->next;
+        current->next = list->next;
+    }
+
+    for (unsigned int i = 0; i < list->batchCount; i++) {
+        free(list->batches[i].commands);
+    }
+    free(list->batches);
+    free(list->staging);
+
+    oriFreeBuffer(list->indirect);
+    if (list->parameter) {
+        oriFreeBuffer(list->parameter);
+    }
+
+    free(list);
+    list = NULL;
+}
+
+/**
+ * @brief Remove all commands from the given draw list.
+ *
+ * @note The list remembers the vertex array and shader pairs it has seen. If a vertex array or shader that was used
+ * with the list is freed, free the list as well.
+ *
+ * @param list the draw list to clear.
+ *
+ * @ingroup vertexspec
+ */
+void oriClearDrawList(oriDrawList *list) {
+    for (unsigned int i = 0; i < list->batchCount; i++) {
+        list->batches[i].count = 0;
+    }
+    list->dirty = true;
+}
+
+/**
+ * @brief Add an indexed draw to the given draw list.
+ *
+ * @details The draw reads its indices from the element buffer of @c va. The list must have been created with an index
+ * type. A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param list the draw list to add to.
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound when the list is submitted.
+ * @param count the amount of indices to draw.
+ * @param instanceCount the amount of instances to draw (1 if instancing isn't used).
+ * @param firstIndex the index (not byte offset) of the first index to draw in the element buffer.
+ * @param baseVertex a constant that is added to each index.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawListAddElements(oriDrawList *list, oriVertexArray *va, oriShader *shader, const unsigned int count, const unsigned int instanceCount, const unsigned int firstIndex, const int baseVertex, const unsigned int baseInstance) {
+    if (!list->indexType) {
+        _orionThrowWarning("(in oriDrawListAddElements()): Draw list was created for non-indexed draws. Command not added.");
+        return;
+    }
+
+    _oriDrawElementsIndirectCommand command = { count, instanceCount, firstIndex, baseVertex, baseInstance };
+    _orionPushDrawCommand(list, _orionGetDrawBatch(list, va, shader), &command);
+}
+
+/**
+ * @brief Add a non-indexed draw to the given draw list.
+ *
+ * @details The list must have been created with an index type of 0. A non-zero @c baseInstance requires GL 4.2.
+ *
+ * @param list the draw list to add to.
+ * @param va the vertex array to draw with.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound when the list is submitted.
+ * @param count the amount of vertices to draw.
+ * @param instanceCount the amount of instances to draw (1 if instancing isn't used).
+ * @param first the first vertex to draw.
+ * @param baseInstance the first instance to draw, for instanced vertex attributes.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawListAddArrays(oriDrawList *list, oriVertexArray *va, oriShader *shader, const unsigned int count, const unsigned int instanceCount, const unsigned int first, const unsigned int baseInstance) {
+    if (list->indexType) {
+        _orionThrowWarning("(in oriDrawListAddArrays()): Draw list was created for indexed draws. Command not added.");
+        return;
+    }
+
+    _oriDrawArraysIndirectCommand command = { count, instanceCount, first, baseInstance };
+    _orionPushDrawCommand(list, _orionGetDrawBatch(list, va, shader), &command);
+}
+
+/**
+ * @brief Upload the commands of the given draw list to its indirect buffer without drawing them.
+ *
+ * @details This is done implicitly by oriSubmitDrawList(). Call it explicitly to modify the commands on the GPU before
+ * they are drawn, e.g. to cull them with a compute shader: the indirect buffer (see oriGetDrawListIndirectBuffer()) holds
+ * each batch's commands back-to-back, and on GL 4.6 the parameter buffer (see oriGetDrawListParameterBuffer()) holds one
+ * @c uint command count per batch, which may be lowered to skip the commands at the end of a batch.
+ *
+ * @param list the draw list to upload.
+ *
+ * @ingroup vertexspec
+ */
+void oriUploadDrawList(oriDrawList *list) {
+    if (!list->dirty) {
+        return;
+    }
+    list->dirty = false;
+
+    unsigned int total = 0;
+    for (unsigned int i = 0; i < list->batchCount; i++) {
+        total += list->batches[i].count;
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // pack every batch into the staging area so that the whole list is uploaded with one call
+    size_t size = total * list->commandSize;
+    if (list->stagingSize < size) {
+        list->stagingSize = size * 2;
+        list->staging = realloc(list->staging, list->stagingSize);
+
+        oriSetBufferData(list->indirect, NULL, list->stagingSize, GL_DYNAMIC_DRAW);
+    }
+
+    size_t offset = 0;
+    for (unsigned int i = 0; i < list->batchCount; i++) {
+        _oriDrawBatch *batch = &list->batches[i];
+
+        batch->offset = offset;
+        memcpy(list->staging + offset, batch->commands, batch->count * list->commandSize);
+        offset += batch->count * list->commandSize;
+    }
+    oriUpdateBufferRange(list->indirect, 0, size, list->staging);
+
+    if (list->parameter) {
+        unsigned int *counts = malloc(list->batchCount * sizeof(unsigned int));
+        for (unsigned int i = 0; i < list->batchCount; i++) {
+            counts[i] = list->batches[i].count;
+        }
+
+        size_t countsSize = list->batchCount * sizeof(unsigned int);
+        if (list->parameter->dataSize < countsSize) {
+            oriSetBufferData(list->parameter, counts, countsSize, GL_DYNAMIC_DRAW);
+        } else {
+            oriUpdateBufferRange(list->parameter, 0, countsSize, counts);
+        }
+
+        free(counts);
+    }
+}
+
+/**
+ * @brief Draw every command in the given draw list.
+ *
+ * @details Each vertex array and shader pair is bound once and drawn with one call: @c glMultiDraw*IndirectCount on
+ * GL 4.6, @c glMultiDraw*Indirect on GL 4.3, or one @c glDraw*Indirect per command below that. The list's commands are
+ * uploaded first if they have changed (see oriUploadDrawList()).
+ *
+ * @param list the draw list to draw.
+ *
+ * @ingroup vertexspec
+ */
+void oriSubmitDrawList(oriDrawList *list) {
+    _orionAssertVersion(400);
+
+    oriUploadDrawList(list);
+
+    if (!list->indirect->dataSet) {
+        return;
+    }
+
+    unsigned int indirectCache = oriCurrentBufferAt(GL_DRAW_INDIRECT_BUFFER);
+    oriBindBuffer(list->indirect, GL_DRAW_INDIRECT_BUFFER);
+
+    unsigned int parameterCache = 0;
+    if (list->parameter) {
+        parameterCache = oriCurrentBufferAt(GL_PARAMETER_BUFFER);
+        oriBindBuffer(list->parameter, GL_PARAMETER_BUFFER);
+    }
+
+    for (unsigned int i = 0; i < list->batchCount; i++) {
+        _oriDrawBatch *batch = &list->batches[i];
+        if (batch->count == 0) {
+            continue;
+        }
+
+        oriBindVertexArray(batch->va);
+        if (batch->shader) {
+            oriBindShader(batch->shader);
+        }
+
+        // with an indirect buffer bound, the pointer is an offset into it
+        const void *offset = (const void *) batch->offset;
+
+        if (_orion.glVersion >= 460) {
+            GLintptr drawCount = i * sizeof(unsigned int);
+            if (list->indexType) {
+                glMultiDrawElementsIndirectCount(list->mode, list->indexType, offset, drawCount, batch->count, 0);
+            } else {
+                glMultiDrawArraysIndirectCount(list->mode, offset, drawCount, batch->count, 0);
+            }
+        } else if (_orion.glVersion >= 430) {
+            if (list->indexType) {
+                glMultiDrawElementsIndirect(list->mode, list->indexType, offset, batch->count, 0);
+            } else {
+                glMultiDrawArraysIndirect(list->mode, offset, batch->count, 0);
+            }
+        } else {
+            for (unsigned int j = 0; j < batch->count; j++) {
+                const void *command = (const void *) (batch->offset + j * list->commandSize);
+                if (list->indexType) {
+                    glDrawElementsIndirect(list->mode, list->indexType, command);
+                } else {
+                    glDrawArraysIndirect(list->mode, command);
+                }
+            }
+        }
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCache);
+    if (list->parameter) {
+        glBindBuffer(GL_PARAMETER_BUFFER, parameterCache);
+    }
+}
+
+/**
+ * @brief Return the indirect buffer that the commands of the given draw list are uploaded to.
+ *
+ * @warning The returned buffer is owned by the draw list; do not free it or set its data with oriSetBufferData().
+ *
+ * @param list the draw list to inspect.
+ *
+ * @ingroup vertexspec
+ */
+oriBuffer *oriGetDrawListIndirectBuffer(oriDrawList *list) {
+    return list->indirect;
+}
+
+/**
+ * @brief Return the buffer that the per-batch command counts of the given draw list are uploaded to, or NULL below GL 4.6.
+ *
+ * @warning The returned buffer is owned by the draw list; do not free it or set its data with oriSetBufferData().
+ *
+ * @param list the draw list to inspect.
+ *
+ * @ingroup vertexspec
+ */
+oriBuffer *oriGetDrawListParameterBuffer(oriDrawList *list) {
+    return list->parameter;
+}
@@ -81,6 +81,28 @@ void _orionAssertVersion(unsigned int minimum) {
     }
 }
 
+/**
+ * @brief Return true if the current OpenGL context supports the given extension (e.g. "GL_ARB_sparse_buffer").
+ *
+ */
+bool _orionHasExtension(const char *name) {
+    // (extensions can only be queried one at a time from 3.0)
+    if (_orion.glVersion < 300) {
+        return false;
+    }
+
+    int count;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (int i = 0; i < count; i++) {
+        if (!strcmp((const char *) glGetStringi(GL_EXTENSIONS, i), name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 // ======================================================================================
 // *****                    ORION PUBLIC INITIALISATION FUNCTIONS                   *****
 // ======================================================================================
@@ -180,6 +202,42 @@ void oriTerminate() {
     while (_orion.shaderListHead) {
         oriFreeShader(_orion.shaderListHead);
     }
+    // destroy all draw lists (these own their indirect buffers)
+    while (_orion.drawListListHead) {
+        oriFreeDrawList(_orion.drawListListHead);
+    }
+    // destroy all mesh LODs (these own their index buffers)
+    while (_orion.meshLODListHead) {
+        oriFreeMeshLOD(_orion.meshLODListHead);
+    }
+    // destroy all clustered meshes (these own their index buffers)
+    while (_orion.clusteredMeshListHead) {
+        oriFreeClusteredMesh(_orion.clusteredMeshListHead);
+    }
+    // destroy all stream buffers (before buffer objects, as they own one each)
+    while (_orion.streamBufferListHead) {
+        oriFreeStreamBuffer(_orion.streamBufferListHead);
+    }
+    // destroy all sparse buffers (these own one or more buffer objects each)
+    while (_orion.sparseBufferListHead) {
+        oriFreeSparseBuffer(_orion.sparseBufferListHead);
+    }
+    // destroy all vertex layouts (these own the vertex arrays cached for them)
+    while (_orion.vertexLayoutListHead) {
+        oriFreeVertexLayout(_orion.vertexLayoutListHead);
+    }
+    // destroy all buffer pools (these own their idle buffer objects)
+    while (_orion.bufferPoolListHead) {
+        oriFreeBufferPool(_orion.bufferPoolListHead);
+    }
+    // destroy all readbacks (these own a staging buffer each)
+    while (_orion.readbackListHead) {
+        oriFreeReadback(_orion.readbackListHead);
+    }
+    // destroy all buffer heaps (these also own buffer objects)
+    while (_orion.bufferHeapListHead) {
+        oriFreeBufferHeap(_orion.bufferHeapListHead);
+    }
     // destroy all buffer objects
     while (_orion.bufferListHead) {
         oriFreeBuffer(_orion.bufferListHead);
@@ -188,10 +246,40 @@ void oriTerminate() {
     while (_orion.vertexArrayListHead) {
         oriFreeVertexArray(_orion.vertexArrayListHead);
     }
+    // destroy all texture atlases (these own a texture and texture shadows)
+    while (_orion.textureAtlasListHead) {
+        oriFreeTextureAtlas(_orion.textureAtlasListHead);
+    }
+    // destroy all texture array pools (these own their array textures)
+    while (_orion.textureArrayPoolListHead) {
+        oriFreeTextureArrayPool(_orion.textureArrayPoolListHead);
+    }
+    // destroy all virtual textures (these own their page cache and page table textures, and may be loading pages)
+    while (_orion.virtualTextureListHead) {
+        oriFreeVirtualTexture(_orion.virtualTextureListHead);
+    }
+    // destroy all texture shadows (before the textures they shadow), and the buffer their changes are staged in
+    while (_orion.textureShadowListHead) {
+        oriFreeTextureShadow(_orion.textureShadowListHead);
+    }
+    if (_orion.textureShadowBuffer) {
+        glDeleteBuffers(1, &_orion.textureShadowBuffer);
+    }
+    // destroy the buffer that texture uploads are staged in
+    if (_orion.textureUploadBuffer) {
+        glDeleteBuffers(1, &_orion.textureUploadBuffer);
+    }
     // destroy all vertex array objects
     while (_orion.textureListHead) {
         oriFreeTexture(_orion.textureListHead);
     }
+    // destroy all texture residency managers (after their textures, so that evicted textures aren't restored)
+    while (_orion.textureResidencyListHead) {
+        oriFreeTextureResidency(_orion.textureResidencyListHead);
+    }
+
+    // stop the worker threads (pending texture loads were cancelled when their textures were freed)
+    _orionShutdownJobs();
 
     // destroy all window objects
     while (_orion.windowListHead) {
@@ -204,6 +292,7 @@ void oriTerminate() {
 
     // free malloc'd state members
     free(_orion.execDir);
+    free(_orion.textureCacheDir);
 
     // clear state (reset to nil)
     memset(&_orion, 0, sizeof(_orion));
@@ -222,6 +311,13 @@ void oriLoadGL(void *(* loadproc)(const char *)) {
         _orionThrowError(ORERR_GL_FAIL);
     }
 
+    // load extension functions that aren't part of the core profile
+    // (assigned through a void ** as ISO C doesn't allow casting object pointers to function pointers)
+    if (_orionHasExtension("GL_ARB_sparse_buffer")) {
+        *(void **) &_orion.extensions.bufferPageCommitment = loadproc("glBufferPageCommitmentARB");
+        *(void **) &_orion.extensions.namedBufferPageCommitment = loadproc("glNamedBufferPageCommitmentARB");
+    }
+
     _orion.glLoaded = true;
 }
 
@@ -22,6 +22,7 @@ extern "C" {
 #include "oriongl.h"
 #include "orionwin.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <signal.h>
 
 #ifdef SIGTRAP
@@ -34,6 +35,26 @@ extern "C" {
 // *****                          ORION INTERNAL DATA TYPES                         *****
 // ======================================================================================
 
+// ARB_sparse_buffer isn't part of any core version, so Glad doesn't load it.
+#define _ORION_GL_SPARSE_STORAGE_BIT_ARB        0x0400
+#define _ORION_GL_SPARSE_BUFFER_PAGE_SIZE_ARB   0x82F8
+typedef void (APIENTRYP _orionPFNGLBUFFERPAGECOMMITMENTARBPROC)(GLenum target, GLintptr offset, GLsizeiptr size, GLboolean commit);
+typedef void (APIENTRYP _orionPFNGLNAMEDBUFFERPAGECOMMITMENTARBPROC)(GLuint buffer, GLintptr offset, GLsizeiptr size, GLboolean commit);
+
+// the default amount of bytes of image data that the texture upload functions upload per call (see
+// oriSetTextureUploadBudget()).
+#define _ORION_DEFAULT_UPLOAD_BUDGET (4 * 1024 * 1024)
+
+// the alignment of each region staged in a pixel buffer.
+#define _ORION_STAGING_ALIGNMENT 16
+
+// a pending load of a texture created with oriLoadTextureAsync() (defined in textureloading.c)
+typedef struct _oriTextureLoad _oriTextureLoad;
+// a texture managed by an oriTextureResidency (defined in textureresidency.c)
+typedef struct _oriResidentTexture _oriResidentTexture;
+// the streaming state of a texture created with oriCreateStreamedTexture() (defined in texturestreaming.c)
+typedef struct _oriTextureStream _oriTextureStream;
+
 /**
  * @brief Structure to store global mutable data.
  * 
@@ -55,6 +76,43 @@ typedef struct _orionState {
     oriBuffer *bufferListHead;
     oriVertexArray *vertexArrayListHead;
     oriTexture *textureListHead;
+    // pending texture loads (see oriLoadTextureAsync()), and the amount of bytes that can be uploaded per frame
+    _oriTextureLoad *textureLoadListHead;
+    size_t textureUploadBudget;
+    // the pixel buffer that texture uploads are staged in, used as a ring (see _orionStageTextureUpload())
+    unsigned int textureUploadBuffer;
+    size_t textureUploadBufferSize;
+    size_t textureUploadBufferHead;
+    // texture shadows, and the pixel buffer their changes are staged in (see oriFlushTextureShadows())
+    oriTextureShadow *textureShadowListHead;
+    unsigned int textureShadowBuffer;
+    size_t textureShadowBufferSize;
+    oriTextureAtlas *textureAtlasListHead;
+    oriTextureArrayPool *textureArrayPoolListHead;
+    oriTextureResidency *textureResidencyListHead;
+    // textures created with oriCreateStreamedTexture()
+    _oriTextureStream *textureStreamListHead;
+    oriVirtualTexture *virtualTextureListHead;
+    // the directory compressed textures are cached in (NULL if they aren't; see oriSetTextureCacheDirectory())
+    char *textureCacheDir;
+    oriStreamBuffer *streamBufferListHead;
+    oriBufferHeap *bufferHeapListHead;
+    oriReadback *readbackListHead;
+    oriSparseBuffer *sparseBufferListHead;
+    oriBufferPool *bufferPoolListHead;
+    oriDrawList *drawListListHead;
+    oriVertexLayout *vertexLayoutListHead;
+    oriMeshLOD *meshLODListHead;
+    oriClusteredMesh *clusteredMeshListHead;
+
+    // deferred buffers with dirty ranges waiting to be uploaded
+    oriBuffer *dirtyBufferListHead;
+
+    // extension functions that are loaded manually in oriLoadGL() (NULL if the extension isn't supported)
+    struct {
+        _orionPFNGLBUFFERPAGECOMMITMENTARBPROC bufferPageCommitment;
+        _orionPFNGLNAMEDBUFFERPAGECOMMITMENTARBPROC namedBufferPageCommitment;
+    } extensions;
 
     struct {
         oriGLFWErrorCallback glfwErrorCallback;
@@ -63,6 +121,138 @@ typedef struct _orionState {
 } _orionState;
 extern _orionState _orion;
 
+// ======================================================================================
+// *****                           ORION SHARED STRUCTURES                          *****
+// ======================================================================================
+// Public (opaque) structures that are defined here rather than in their own source file
+// because more than one source file needs to access their members.
+
+/**
+ * @brief A byte range of a buffer that has been modified in its CPU shadow copy but not yet uploaded.
+ *
+ */
+typedef struct _oriBufferDirtyRange {
+    size_t offset;
+    size_t size;
+} _oriBufferDirtyRange;
+
+/**
+ * @brief An OpenGL buffer object.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriBuffer {
+    // (doubly-linked so that buffers can be unlinked without walking the list)
+    oriBuffer *next;
+    oriBuffer *prev;
+
+    unsigned int handle;
+    unsigned int currentTarget;
+    bool dataSet;
+    size_t dataSize;
+    // the usage given to oriSetBufferData() (0 for immutable storage)
+    unsigned int usage;
+
+    // true if the buffer's data store was allocated with glBufferStorage (and therefore cannot be reallocated)
+    bool immutableStorage;
+    unsigned int storageFlags;
+
+    // the currently-mapped range of the buffer (mapped is NULL if the buffer isn't mapped)
+    void *mapped;
+    size_t mapOffset;
+    size_t mapLength;
+    unsigned int mapAccess;
+
+    // deferred mode: a CPU copy of the data store (NULL if the buffer isn't deferred) and the ranges that need uploading
+    unsigned char *shadow;
+    _oriBufferDirtyRange *dirtyRanges;
+    unsigned int dirtyCount;
+    unsigned int dirtyCapacity;
+    // linked list of buffers with pending dirty ranges (see oriFlushDeferredBuffers())
+    oriBuffer *nextDirty;
+    bool queued;
+} oriBuffer;
+
+/**
+ * @brief An OpenGL vertex array object.
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriVertexArray {
+    oriVertexArray *next;
+
+    unsigned int handle;
+
+    // the element buffer attached with oriSetVertexArrayIndexBuffer() (NULL if none), and the type of its indices
+    oriBuffer *indexBuffer;
+    unsigned int indexType;
+} oriVertexArray;
+
+/**
+ * @brief An OpenGL texture object.
+ *
+ * @ingroup textures
+ */
+typedef struct oriTexture {
+    oriTexture *next;
+    unsigned int handle;
+
+    unsigned int type;
+    unsigned int width;
+    unsigned int height;
+    unsigned int depth;
+    unsigned int internalFormat;
+    unsigned int levels;
+    unsigned int samples;
+
+    bool immutableStorage;
+
+    // when oriUploadTexImage() generates mipmaps (ORION_MIPMAPS_*), and the last minifying filter set on the texture
+    unsigned int mipmapPolicy;
+    int minFilter;
+
+    // the pending load if the texture was created with oriLoadTextureAsync() and hasn't finished loading (NULL otherwise)
+    _oriTextureLoad *load;
+
+    // the texture's entry in the residency manager it was added to with oriAddResidentTexture() (NULL otherwise)
+    _oriResidentTexture *resident;
+
+    // the streaming state if the texture was created with oriCreateStreamedTexture() (NULL otherwise)
+    _oriTextureStream *stream;
+
+    // the amount of texture shadows of the texture created with oriCreateTextureShadow()
+    unsigned int shadowCount;
+} oriTexture;
+
+/**
+ * @brief A unit of work to be run on a worker thread (see _orionSubmitJob()). Structures that are submitted as jobs embed
+ * this as their first member.
+ *
+ */
+typedef struct _oriJob {
+    struct _oriJob *next;
+    void (*func)(struct _oriJob *job);
+
+    // (protected by the thread pool's lock)
+    bool queued;
+    bool running;
+} _oriJob;
+
+/**
+ * @brief A file mapped into memory with read-only access (see _orionMapFile()).
+ *
+ */
+typedef struct _oriMappedFile {
+    const unsigned char *data;
+    size_t size;
+
+#ifdef _WIN32
+    // (the file and mapping HANDLEs)
+    void *file;
+    void *mapping;
+#endif
+} _oriMappedFile;
+
 // ======================================================================================
 // *****                              HELPER FUNCTIONS                              *****
 // ======================================================================================
@@ -79,6 +269,184 @@ void _orionInitGLFW();
  */
 void _orionAssertVersion(unsigned int minimum);
 
+/**
+ * @brief Return true if the current OpenGL context supports the given extension (e.g. "GL_ARB_sparse_buffer").
+ *
+ */
+bool _orionHasExtension(const char *name);
+
+/**
+ * @brief Return which variant of glVertexAttrib*Pointer / glVertexArrayAttrib*Format should be used for attributes of the
+ * given component type so that their data isn't converted to floats.
+ *
+ * @return 1 for the float variant, 2 for the I variant or 3 for the L variant.
+ */
+unsigned int _orionVertexAttribFuncType(const unsigned int type);
+
+/**
+ * @brief Remove every cached vertex array that was created from a layout with the given buffer (see
+ * oriCreateVertexArrayFromLayout()). This is called when the buffer is freed.
+ *
+ */
+void _orionEvictVertexLayoutBuffer(oriBuffer *buffer);
+
+/**
+ * @brief Shared implementation of oriSpecifyVertexData(), oriSpecifyInstanceData() and oriSpecifyVertexDataRange(), with
+ * the buffer read from @c bufferOffset bytes onwards and the attribute advanced once every @c divisor instances (0 for
+ * once per vertex).
+ *
+ */
+void _orionSpecifyVertexData(const char *caller, oriVertexArray *va, oriBuffer *buffer, const size_t bufferOffset,
+    const unsigned int index,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int stride,
+    const unsigned int offset,
+    const unsigned int divisor
+);
+
+/**
+ * @brief Copy @c size bytes from one buffer's data store to another's.
+ *
+ */
+void _orionCopyBufferData(oriBuffer *src, size_t srcOffset, oriBuffer *dst, size_t dstOffset, size_t size);
+
+/**
+ * @brief Queue @c job to be run by @c func on a worker thread, starting the worker threads if they aren't running. The
+ * job must stay allocated until it has finished (see _orionJobPending()) or has been cancelled with _orionWaitJob().
+ *
+ */
+void _orionSubmitJob(_oriJob *job, void (*func)(_oriJob *job));
+
+/**
+ * @brief Return true if the given job is waiting to be run or is running.
+ *
+ */
+bool _orionJobPending(_oriJob *job);
+
+/**
+ * @brief Block until the given job has finished. If @c cancel is true and the job hasn't started, it is removed from the
+ * queue instead.
+ *
+ */
+void _orionWaitJob(_oriJob *job, bool cancel);
+
+/**
+ * @brief Map the file at the given path into memory with read-only access, hinting to the OS that it will be read front
+ * to back if @c sequential is true, or at random otherwise. Return false if it can't be opened or mapped.
+ *
+ */
+bool _orionMapFile(const char *path, bool sequential, _oriMappedFile *file);
+
+/**
+ * @brief Unmap a file mapped with _orionMapFile().
+ *
+ */
+void _orionUnmapFile(_oriMappedFile *file);
+
+/**
+ * @brief Cancel the pending load of a texture created with oriLoadTextureAsync() and free its resources. This is called
+ * when the texture is freed.
+ *
+ */
+void _orionCancelTextureLoad(oriTexture *texture);
+
+/**
+ * @brief Copy @c size bytes of image data into the shared texture upload buffer and return their offset in it. The
+ * buffer is left bound to @c GL_PIXEL_UNPACK_BUFFER, so the caller must restore the previous binding once it has
+ * uploaded from it.
+ *
+ */
+size_t _orionStageTextureUpload(const void *data, size_t size);
+
+/**
+ * @brief Mark the given texture as used by its residency manager, so that it is evicted last, or restored by the next
+ * update if it is evicted. This is called when the texture is bound.
+ *
+ */
+void _orionTouchResidentTexture(_oriResidentTexture *resident);
+
+/**
+ * @brief Stop managing the residency of the given texture and free its CPU copy, restoring it to full resolution first
+ * if @c restore is true. This is called (without restoring) when the texture is freed.
+ *
+ */
+void _orionUnmanageTexture(oriTexture *texture, bool restore);
+
+/**
+ * @brief Free the streaming state of a texture created with oriCreateStreamedTexture(). This is called when the texture
+ * is freed.
+ *
+ */
+void _orionFreeTextureStream(oriTexture *texture);
+
+/**
+ * @brief Detach every texture shadow of the given texture from it, so that their changes are no longer uploaded. This is
+ * called when the texture is freed.
+ *
+ */
+void _orionDetachTextureShadows(oriTexture *texture);
+
+/**
+ * @brief Stop the worker threads. Every job must have finished or been cancelled first. This is called by oriTerminate().
+ *
+ */
+void _orionShutdownJobs();
+
+/**
+ * @brief Return true if every one of the given indices is less than @c vertexCount.
+ *
+ */
+bool _orionIndicesInRange(const unsigned int *indices, size_t indexCount, size_t vertexCount);
+
+/**
+ * @brief Build the list of triangles that use each vertex of a triangle list: the triangles of vertex @c v are
+ * @c (*triangles)[(*offsets)[v]] to @c (*triangles)[(*offsets)[v + 1] - 1]. Both arrays must be freed by the caller.
+ *
+ */
+void _orionBuildTriangleAdjacency(const unsigned int *indices, size_t indexCount, size_t vertexCount, unsigned int **offsets, unsigned int **triangles);
+
+/**
+ * @brief Return the size in bytes of one texel of client image data with the given format (e.g. @c GL_RGBA) and type
+ * (e.g. @c GL_UNSIGNED_BYTE), or 0 if either isn't supported.
+ *
+ */
+size_t _orionTexelSize(unsigned int imageFormat, unsigned int dataType);
+
+/**
+ * @brief Return the size in bytes of one 4x4 block of the given block-compressed format, or 0 if Orion can't compress to
+ * it (see oriCompressImage()).
+ *
+ */
+unsigned int _orionBlockSize(unsigned int format);
+
+/**
+ * @brief Compress block rows @c firstRow to @c firstRow + @c rowCount - 1 of an image on the calling thread. Unlike
+ * oriCompressImage(), this can be called from a worker thread.
+ *
+ */
+void _orionCompressRows(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int format, unsigned char *dst, unsigned int firstRow, unsigned int rowCount);
+
+/**
+ * @brief Return a 64-bit hash of @c size bytes, for keying cache entries (not for security).
+ *
+ */
+uint64_t _orionHashBytes(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief Read the compressed levels cached under the given key in @c directory into a new array (to be freed by the
+ * caller), if there is an entry for the same format, dimensions and level count with the size of their whole chain.
+ *
+ */
+bool _orionReadTextureCache(const char *directory, uint64_t key, unsigned int format, unsigned int width, unsigned int height, unsigned int levels, unsigned char **data, size_t *size);
+
+/**
+ * @brief Cache compressed levels under the given key in @c directory, unless it is NULL.
+ *
+ */
+void _orionWriteTextureCache(const char *directory, uint64_t key, unsigned int format, unsigned int width, unsigned int height, unsigned int levels, const unsigned char *data, size_t size);
+
 // ======================================================================================
 // *****                                ORION ERRORS                                *****
 // ======================================================================================
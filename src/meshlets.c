@@ -0,0 +1,431 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// the limits of each cluster (the same as those commonly used for mesh shader meshlets).
+#define _ORION_CLUSTER_MAX_VERTICES 64
+#define _ORION_CLUSTER_MAX_TRIANGLES 124
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A cluster of triangles, with the bounds used to cull it.
+ *
+ */
+typedef struct _oriCluster {
+    // the range of the clustered mesh's index buffer
+    unsigned int firstIndex;
+    unsigned int count;
+
+    // the bounding sphere
+    float center[3];
+    float radius;
+
+    // the cone that contains the normals of all triangles (cutoff is the sine of its half-angle; 1 or more if the cone is
+    // too wide to ever be back-facing)
+    float coneAxis[3];
+    float coneCutoff;
+} _oriCluster;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A mesh split into small clusters of triangles that can be culled individually.
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriClusteredMesh {
+    oriClusteredMesh *next;
+
+    oriVertexArray *va;
+
+    // the indices of every cluster, one after the other, attached to va as its element buffer
+    oriBuffer *indexBuffer;
+    unsigned int indexType;
+
+    _oriCluster *clusters;
+    unsigned int clusterCount;
+} oriClusteredMesh;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// compute the bounding sphere and normal cone of the triangles in [first, last).
+static void _orionComputeClusterBounds(_oriCluster *cluster, const unsigned int *indices, size_t first, size_t last, const float *vertices, unsigned int stride, unsigned int positionOffset) {
+    float min[3] = { HUGE_VALF, HUGE_VALF, HUGE_VALF };
+    float max[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+    float axis[3] = { 0.0f, 0.0f, 0.0f };
+
+    // (triangle normals are kept to find the cone's angle once the axis is known)
+    float normals[_ORION_CLUSTER_MAX_TRIANGLES][3];
+
+    for (size_t t = first; t < last; t++) {
+        const float *p[3];
+        for (unsigned int k = 0; k < 3; k++) {
+            p[k] = vertices + (size_t) indices[t * 3 + k] * stride + positionOffset;
+
+            for (unsigned int c = 0; c < 3; c++) {
+                if (p[k][c] < min[c]) min[c] = p[k][c];
+                if (p[k][c] > max[c]) max[c] = p[k][c];
+            }
+        }
+
+        float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+        float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+        float *n = normals[t - first];
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+        float l = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (l > 0.0f) {
+            n[0] /= l;
+            n[1] /= l;
+            n[2] /= l;
+        }
+
+        axis[0] += n[0];
+        axis[1] += n[1];
+        axis[2] += n[2];
+    }
+
+    // bounding sphere around the centre of the bounding box
+    for (unsigned int c = 0; c < 3; c++) {
+        cluster->center[c] = (min[c] + max[c]) * 0.5f;
+    }
+
+    float radius2 = 0.0f;
+    for (size_t i = first * 3; i < last * 3; i++) {
+        const float *p = vertices + (size_t) indices[i] * stride + positionOffset;
+        float d[3] = { p[0] - cluster->center[0], p[1] - cluster->center[1], p[2] - cluster->center[2] };
+        float d2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        if (d2 > radius2) {
+            radius2 = d2;
+        }
+    }
+    cluster->radius = sqrtf(radius2);
+
+    // normal cone: the average normal, widened to contain every triangle's normal
+    float l = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (l <= 0.0f) {
+        cluster->coneAxis[0] = 0.0f;
+        cluster->coneAxis[1] = 0.0f;
+        cluster->coneAxis[2] = 1.0f;
+        cluster->coneCutoff = 1.0f;
+        return;
+    }
+
+    for (unsigned int c = 0; c < 3; c++) {
+        cluster->coneAxis[c] = axis[c] / l;
+    }
+
+    float minDot = 1.0f;
+    for (size_t t = 0; t < last - first; t++) {
+        const float *n = normals[t];
+        float d = n[0] * cluster->coneAxis[0] + n[1] * cluster->coneAxis[1] + n[2] * cluster->coneAxis[2];
+        if (d < minDot) {
+            minDot = d;
+        }
+    }
+
+    // a cone wider than a hemisphere always has some triangles facing the camera
+    cluster->coneCutoff = (minDot <= 0.0f) ? 1.0f : sqrtf(1.0f - minDot * minDot);
+}
+
+// extract the six normalised frustum planes of a column-major model-view-projection matrix.
+static void _orionExtractFrustum(const float *m, float planes[6][4]) {
+    for (unsigned int i = 0; i < 3; i++) {
+        for (unsigned int c = 0; c < 4; c++) {
+            // (row 3 +/- row i)
+            planes[i * 2 + 0][c] = m[c * 4 + 3] + m[c * 4 + i];
+            planes[i * 2 + 1][c] = m[c * 4 + 3] - m[c * 4 + i];
+        }
+    }
+
+    for (unsigned int p = 0; p < 6; p++) {
+        float l = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        if (l > 0.0f) {
+            for (unsigned int c = 0; c < 4; c++) {
+                planes[p][c] /= l;
+            }
+        }
+    }
+}
+
+static bool _orionClusterVisible(const _oriCluster *cluster, float planes[6][4], const float *cameraPosition) {
+    // frustum
+    for (unsigned int p = 0; p < 6; p++) {
+        float d = planes[p][0] * cluster->center[0] + planes[p][1] * cluster->center[1] + planes[p][2] * cluster->center[2] + planes[p][3];
+        if (d < -cluster->radius) {
+            return false;
+        }
+    }
+
+    // back-facing: the whole normal cone faces away from the camera, from anywhere in the bounding sphere
+    if (cameraPosition && cluster->coneCutoff < 1.0f) {
+        float v[3] = {
+            cluster->center[0] - cameraPosition[0],
+            cluster->center[1] - cameraPosition[1],
+            cluster->center[2] - cameraPosition[2]
+        };
+        float l = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+        if (v[0] * cluster->coneAxis[0] + v[1] * cluster->coneAxis[1] + v[2] * cluster->coneAxis[2] >= cluster->coneCutoff * l + cluster->radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ======================================================================================
+// *****                       ORION CLUSTERED MESH FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriClusteredMesh structure, splitting a mesh into clusters of at most 64 vertices
+ * and 124 triangles.
+ *
+ * @details The triangles are reordered for the vertex cache and then grouped into clusters in that order, so each
+ * cluster is a small, connected patch of the mesh. Each cluster gets a bounding sphere and a cone containing the normals
+ * of its triangles, which are used by oriCullClusters() to skip clusters that are off-screen or entirely back-facing.
+ * The clustered indices are uploaded to one index buffer (narrowed to 16-bit indices where possible), which is attached
+ * to @c va as its element buffer.
+ *
+ * @warning Back-face culling of clusters assumes that front faces are wound counter-clockwise. Free the clustered mesh
+ * before the vertex array it is attached to.
+ *
+ * @param va the vertex array that the mesh's vertex data is specified in.
+ * @param vertices the interleaved vertices of the mesh, as uploaded to the vertex array's buffer.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param indices the indices of the mesh's triangle list.
+ * @param indexCount the amount of indices.
+ *
+ * @ingroup vertexspec
+ */
+oriClusteredMesh *oriCreateClusteredMesh(oriVertexArray *va, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const unsigned int *indices, const size_t indexCount) {
+    _orionAssertVersion(300);
+
+    size_t triangleCount = indexCount / 3;
+    if (!_orionIndicesInRange(indices, triangleCount * 3, vertexCount)) {
+        _orionThrowWarning("(in oriCreateClusteredMesh()): Indices refer to vertices past vertexCount. Clustered mesh not created.");
+        return NULL;
+    }
+
+    unsigned int *ordered = malloc((triangleCount ? triangleCount * 3 : 1) * sizeof(unsigned int));
+    oriOptimiseVertexCache(ordered, indices, triangleCount * 3, vertexCount);
+
+    // at least one cluster per 124 triangles, and at most one per triangle
+    _oriCluster *clusters = malloc((triangleCount ? triangleCount : 1) * sizeof(_oriCluster));
+    unsigned int clusterCount = 0;
+
+    // the cluster that each vertex was last added to (+1, so that 0 means none)
+    unsigned int *vertexCluster = calloc(vertexCount ? vertexCount : 1, sizeof(unsigned int));
+
+    size_t first = 0;
+    unsigned int clusterVertices = 0;
+
+    for (size_t t = 0; t <= triangleCount; t++) {
+        unsigned int newVertices = 0;
+        if (t < triangleCount) {
+            for (unsigned int k = 0; k < 3; k++) {
+                if (vertexCluster[ordered[t * 3 + k]] != clusterCount + 1) {
+                    newVertices++;
+                }
+            }
+        }
+
+        // close the current cluster when the triangle doesn't fit (or at the end)
+        if (t == triangleCount || clusterVertices + newVertices > _ORION_CLUSTER_MAX_VERTICES || t - first >= _ORION_CLUSTER_MAX_TRIANGLES) {
+            if (t > first) {
+                _oriCluster *cluster = &clusters[clusterCount++];
+                cluster->firstIndex = (unsigned int) (first * 3);
+                cluster->count = (unsigned int) ((t - first) * 3);
+                _orionComputeClusterBounds(cluster, ordered, first, t, vertices, stride, positionOffset);
+            }
+
+            if (t == triangleCount) {
+                break;
+            }
+
+            first = t;
+            clusterVertices = 0;
+        }
+
+        for (unsigned int k = 0; k < 3; k++) {
+            unsigned int v = ordered[t * 3 + k];
+            if (vertexCluster[v] != clusterCount + 1) {
+                vertexCluster[v] = clusterCount + 1;
+                clusterVertices++;
+            }
+        }
+    }
+
+    free(vertexCluster);
+
+    oriClusteredMesh *r = malloc(sizeof(oriClusteredMesh));
+    r->va = va;
+    r->clusters = clusters;
+    r->clusterCount = clusterCount;
+
+    r->indexBuffer = oriCreateBuffer();
+    r->indexType = oriUploadIndexData(r->indexBuffer, ordered, triangleCount * 3, GL_STATIC_DRAW, false);
+    free(ordered);
+
+    oriSetVertexArrayIndexBuffer(va, r->indexBuffer, r->indexType);
+
+    // add to global linked list
+    r->next = _orion.clusteredMeshListHead;
+    _orion.clusteredMeshListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given clustered mesh, and its index buffer.
+ *
+ * @details If the index buffer is still attached to the mesh's vertex array, it is detached.
+ *
+ * @param mesh the clustered mesh to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeClusteredMesh(oriClusteredMesh *mesh) {
+    _orionAssertVersion(300);
+
+    // unlink from global linked list
+    if (_orion.clusteredMeshListHead == mesh) {
+        _orion.clusteredMeshListHead = mesh->next;
+    } else {
+        oriClusteredMesh *current = _orion.clusteredMeshListHead;
+        while (current->next != mesh)
+            current = current->next;
+        current->next = mesh->next;
+    }
+
+    if (mesh->va->indexBuffer == mesh->indexBuffer) {
+        oriSetVertexArrayIndexBuffer(mesh->va, NULL, 0);
+    }
+    oriFreeBuffer(mesh->indexBuffer);
+
+    free(mesh->clusters);
+
+    free(mesh);
+    mesh = NULL;
+}
+
+/**
+ * @brief Return the amount of clusters in the given clustered mesh.
+ *
+ * @param mesh the clustered mesh to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetClusterCount(oriClusteredMesh *mesh) {
+    return mesh->clusterCount;
+}
+
+/**
+ * @brief Return the type of the indices in the given clustered mesh's element buffer (@c GL_UNSIGNED_SHORT or
+ * @c GL_UNSIGNED_INT), e.g. to create a draw list for it.
+ *
+ * @param mesh the clustered mesh to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetClusteredMeshIndexType(oriClusteredMesh *mesh) {
+    return mesh->indexType;
+}
+
+/**
+ * @brief Cull the clusters of a mesh that are outside of the view frustum or entirely back-facing, and get the ranges of
+ * its element buffer that remain to be drawn.
+ *
+ * @details Visible clusters that are next to each other in the element buffer are merged into one range, so the ranges
+ * can be drawn with few calls, e.g. with @c glMultiDrawElements.
+ *
+ * @param mesh the clustered mesh to cull.
+ * @param modelViewProjection the column-major model-view-projection matrix that the mesh will be drawn with.
+ * @param cameraPosition the position of the camera in the mesh's model space, or NULL to skip back-face culling.
+ * @param firstIndices the destination array of at least oriGetClusterCount() ranges' first indices.
+ * @param counts the destination array of at least oriGetClusterCount() ranges' index counts.
+ * @return the amount of ranges.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriCullClusters(oriClusteredMesh *mesh, const float *modelViewProjection, const float *cameraPosition, unsigned int *firstIndices, unsigned int *counts) {
+    float planes[6][4];
+    _orionExtractFrustum(modelViewProjection, planes);
+
+    unsigned int r = 0;
+    for (unsigned int i = 0; i < mesh->clusterCount; i++) {
+        const _oriCluster *cluster = &mesh->clusters[i];
+        if (!_orionClusterVisible(cluster, planes, cameraPosition)) {
+            continue;
+        }
+
+        // (extend the previous range if this cluster follows straight on from it)
+        if (r && firstIndices[r - 1] + counts[r - 1] == cluster->firstIndex) {
+            counts[r - 1] += cluster->count;
+            continue;
+        }
+
+        firstIndices[r] = cluster->firstIndex;
+        counts[r] = cluster->count;
+        r++;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Cull the clusters of a mesh with oriCullClusters() and add a draw command for each remaining range to the given
+ * draw list.
+ *
+ * @details The draw list must have been created with the index type given by oriGetClusteredMeshIndexType().
+ *
+ * @param list the draw list to add commands to.
+ * @param mesh the clustered mesh to cull and draw.
+ * @param shader the shader to draw with.
+ * @param modelViewProjection the column-major model-view-projection matrix that the mesh will be drawn with.
+ * @param cameraPosition the position of the camera in the mesh's model space, or NULL to skip back-face culling.
+ * @return the amount of commands added.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriDrawListAddClusters(oriDrawList *list, oriClusteredMesh *mesh, oriShader *shader, const float *modelViewProjection, const float *cameraPosition) {
+    unsigned int *ranges = malloc((mesh->clusterCount ? mesh->clusterCount : 1) * 2 * sizeof(unsigned int));
+
+    unsigned int r = oriCullClusters(mesh, modelViewProjection, cameraPosition, ranges, ranges + mesh->clusterCount);
+    for (unsigned int i = 0; i < r; i++) {
+        oriDrawListAddElements(list, mesh->va, shader, ranges[mesh->clusterCount + i], 1, ranges[i], 0, 0);
+    }
+
+    free(ranges);
+
+    return r;
+}
@@ -0,0 +1,669 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// the maximum amount of levels in a mesh LOD chain (including the full-detail level).
+#define _ORION_MAX_LOD_LEVELS 16
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A quadric error metric: the sum of squared distances to a set of planes, weighted by triangle area.
+ *
+ */
+typedef struct _oriQuadric {
+    // the symmetric matrix, upper triangle (xx, xy, xz, yy, yz, zz), the plane offsets and the constant term
+    double a[6];
+    double b[3];
+    double c;
+
+    double weight;
+} _oriQuadric;
+
+/**
+ * @brief A possible collapse of the vertex @c from onto the vertex @c to.
+ *
+ */
+typedef struct _oriCollapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+} _oriCollapse;
+
+/**
+ * @brief One level of detail: a range of the LOD index buffer.
+ *
+ */
+typedef struct _oriMeshLODLevel {
+    unsigned int firstIndex;
+    unsigned int count;
+
+    // the geometric error of the level, in the same units as the vertex positions
+    float error;
+} _oriMeshLODLevel;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A chain of simplified index buffers that share the vertex buffer of one mesh.
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriMeshLOD {
+    oriMeshLOD *next;
+
+    oriVertexArray *va;
+
+    // every level's indices, one after the other, attached to va as its element buffer
+    oriBuffer *indexBuffer;
+    unsigned int indexType;
+
+    _oriMeshLODLevel levels[_ORION_MAX_LOD_LEVELS];
+    unsigned int levelCount;
+} oriMeshLOD;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static void _orionQuadricFromTriangle(_oriQuadric *q, const float *p0, const float *p1, const float *p2) {
+    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    double n[3] = {
+        e1[1] * e2[2] - e1[2] * e2[1],
+        e1[2] * e2[0] - e1[0] * e2[2],
+        e1[0] * e2[1] - e1[1] * e2[0]
+    };
+
+    double l = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (l > 0.0) {
+        n[0] /= l;
+        n[1] /= l;
+        n[2] /= l;
+    }
+
+    double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+    double w = l * 0.5;
+
+    q->a[0] = w * n[0] * n[0];
+    q->a[1] = w * n[0] * n[1];
+    q->a[2] = w * n[0] * n[2];
+    q->a[3] = w * n[1] * n[1];
+    q->a[4] = w * n[1] * n[2];
+    q->a[5] = w * n[2] * n[2];
+    q->b[0] = w * n[0] * d;
+    q->b[1] = w * n[1] * d;
+    q->b[2] = w * n[2] * d;
+    q->c = w * d * d;
+    q->weight = w;
+}
+
+static void _orionQuadricAdd(_oriQuadric *r, const _oriQuadric *q) {
+    for (unsigned int i = 0; i < 6; i++) {
+        r->a[i] += q->a[i];
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        r->b[i] += q->b[i];
+    }
+    r->c += q->c;
+    r->weight += q->weight;
+}
+
+// the mean squared distance from p to the planes of the quadric.
+static double _orionQuadricError(const _oriQuadric *q, const float *p) {
+    double x = p[0], y = p[1], z = p[2];
+
+    double r =
+        q->a[0] * x * x + 2.0 * q->a[1] * x * y + 2.0 * q->a[2] * x * z +
+        q->a[3] * y * y + 2.0 * q->a[4] * y * z +
+        q->a[5] * z * z +
+        2.0 * (q->b[0] * x + q->b[1] * y + q->b[2] * z) +
+        q->c;
+
+    if (r < 0.0) {
+        r = 0.0;
+    }
+    return (q->weight > 0.0) ? r / q->weight : r;
+}
+
+static bool _orionTriangleHasVertex(const unsigned int *triangle, unsigned int v) {
+    return triangle[0] == v || triangle[1] == v || triangle[2] == v;
+}
+
+// return true if moving the vertex from onto to would flip any of the triangles around from. The triangles are read
+// through remap, so that the collapses already chosen in the same pass are taken into account.
+static bool _orionCollapseFlips(const unsigned int *indices, const unsigned int *adjOffsets, const unsigned int *adjTriangles, const unsigned int *remap, const float *vertices, unsigned int stride, unsigned int positionOffset, unsigned int from, unsigned int to) {
+    const float *target = vertices + (size_t) to * stride + positionOffset;
+
+    for (unsigned int a = adjOffsets[from]; a < adjOffsets[from + 1]; a++) {
+        const unsigned int *triangle = indices + (size_t) adjTriangles[a] * 3;
+        unsigned int v[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+
+        // (triangles that an earlier collapse of the pass made degenerate, or that have both vertices, disappear)
+        if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0] || _orionTriangleHasVertex(v, to)) {
+            continue;
+        }
+
+        const float *p[3];
+        const float *q[3];
+        for (unsigned int k = 0; k < 3; k++) {
+            p[k] = vertices + (size_t) v[k] * stride + positionOffset;
+            q[k] = (v[k] == from) ? target : p[k];
+        }
+
+        float n0[3], n1[3];
+        for (unsigned int s = 0; s < 2; s++) {
+            const float **t = s ? q : p;
+            float *n = s ? n1 : n0;
+
+            float e1[3] = { t[1][0] - t[0][0], t[1][1] - t[0][1], t[1][2] - t[0][2] };
+            float e2[3] = { t[2][0] - t[0][0], t[2][1] - t[0][1], t[2][2] - t[0][2] };
+            n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        }
+
+        if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0f) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// mark the vertices that can't be moved: those on open borders, and those on attribute seams (i.e. that share their
+// position with another vertex).
+static void _orionFindLockedVertices(bool *locked, const unsigned int *indices, size_t indexCount, const float *vertices, size_t vertexCount, unsigned int stride, unsigned int positionOffset, const unsigned int *adjOffsets, const unsigned int *adjTriangles) {
+    memset(locked, 0, vertexCount * sizeof(bool));
+
+    // borders: an edge a -> b is on a border if no triangle has the edge b -> a
+    for (size_t t = 0; t < indexCount / 3; t++) {
+        for (unsigned int k = 0; k < 3; k++) {
+            unsigned int a = indices[t * 3 + k];
+            unsigned int b = indices[t * 3 + (k + 1) % 3];
+
+            bool twin = false;
+            for (unsigned int j = adjOffsets[b]; j < adjOffsets[b + 1] && !twin; j++) {
+                const unsigned int *other = indices + (size_t) adjTriangles[j] * 3;
+                for (unsigned int m = 0; m < 3; m++) {
+                    if (other[m] == b && other[(m + 1) % 3] == a) {
+                        twin = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!twin) {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+
+    // seams: hash the positions
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) {
+        tableSize <<= 1;
+    }
+
+    unsigned int *table = malloc(tableSize * sizeof(unsigned int));
+    memset(table, 0xFF, tableSize * sizeof(unsigned int));
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float *p = vertices + v * stride + positionOffset;
+
+        uint32_t h = 2166136261u;
+        const unsigned char *bytes = (const unsigned char *) p;
+        for (unsigned int i = 0; i < 3 * sizeof(float); i++) {
+            h ^= bytes[i];
+            h *= 16777619u;
+        }
+
+        size_t slot = h & (tableSize - 1);
+        while (table[slot] != ~0u) {
+            const float *other = vertices + (size_t) table[slot] * stride + positionOffset;
+            if (!memcmp(other, p, 3 * sizeof(float))) {
+                locked[v] = true;
+                locked[table[slot]] = true;
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == ~0u) {
+            table[slot] = (unsigned int) v;
+        }
+    }
+
+    free(table);
+}
+
+static int _orionCompareCollapses(const void *a, const void *b) {
+    const _oriCollapse *ca = (const _oriCollapse *) a;
+    const _oriCollapse *cb = (const _oriCollapse *) b;
+
+    if (ca->cost != cb->cost) {
+        return (ca->cost < cb->cost) ? -1 : 1;
+    }
+    return (ca->from < cb->from) ? -1 : (ca->from > cb->from);
+}
+
+// ======================================================================================
+// *****                          ORION MESH LOD FUNCTIONS                          *****
+// ======================================================================================
+
+/**
+ * @brief Simplify a triangle list to roughly @c targetIndexCount indices by collapsing edges, using quadric error metrics
+ * to choose the collapses that change the shape of the mesh the least.
+ *
+ * @details Vertices are only ever collapsed onto other existing vertices, so the simplified indices refer to the same
+ * vertex buffer as the original indices. Vertices on open borders and on attribute seams (vertices that share their
+ * position with another vertex, e.g. where texture coordinates are split) are kept in place, so the result may have more
+ * indices than requested.
+ *
+ * @param dst the destination array of at most @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertices the interleaved vertices that the indices refer to.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param targetIndexCount the amount of indices to aim for.
+ * @param error if not NULL, this is set to the largest distance (in the same units as the vertex positions) between the
+ * simplified mesh and the original that was introduced by a collapse.
+ * @return the amount of indices written to @c dst.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriSimplifyMesh(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const size_t targetIndexCount, float *error) {
+    size_t count = indexCount - indexCount % 3;
+    if (count < 3 || !vertexCount) {
+        _orionThrowWarning("(in oriSimplifyMesh()): No triangles or vertices were given. Nothing written.");
+        if (error) {
+            *error = 0.0f;
+        }
+        return 0;
+    }
+    if (!_orionIndicesInRange(indices, count, vertexCount)) {
+        _orionThrowWarning("(in oriSimplifyMesh()): Indices refer to vertices past vertexCount. Nothing written.");
+        if (error) {
+            *error = 0.0f;
+        }
+        return 0;
+    }
+
+    unsigned int *current = malloc(count * sizeof(unsigned int));
+    memcpy(current, indices, count * sizeof(unsigned int));
+
+    _oriQuadric *quadrics = calloc(vertexCount, sizeof(_oriQuadric));
+    bool *locked = malloc(vertexCount * sizeof(bool));
+    bool *touched = malloc(vertexCount * sizeof(bool));
+    unsigned int *remap = malloc(vertexCount * sizeof(unsigned int));
+    _oriCollapse *collapses = malloc(count * 2 * sizeof(_oriCollapse));
+
+    double maxError = 0.0;
+
+    // the quadric of each vertex starts as the sum of the planes of its triangles
+    for (size_t t = 0; t < count / 3; t++) {
+        const float *p[3];
+        for (unsigned int k = 0; k < 3; k++) {
+            p[k] = vertices + (size_t) current[t * 3 + k] * stride + positionOffset;
+        }
+
+        _oriQuadric q;
+        _orionQuadricFromTriangle(&q, p[0], p[1], p[2]);
+        for (unsigned int k = 0; k < 3; k++) {
+            _orionQuadricAdd(&quadrics[current[t * 3 + k]], &q);
+        }
+    }
+
+    unsigned int *adjOffsets, *adjTriangles;
+    _orionBuildTriangleAdjacency(current, count, vertexCount, &adjOffsets, &adjTriangles);
+    _orionFindLockedVertices(locked, current, count, vertices, vertexCount, stride, positionOffset, adjOffsets, adjTriangles);
+
+    // each pass collapses a set of independent edges (no vertex is part of two collapses), cheapest first
+    while (count > targetIndexCount) {
+        size_t collapseCount = 0;
+
+        for (size_t t = 0; t < count / 3; t++) {
+            for (unsigned int k = 0; k < 3; k++) {
+                unsigned int a = current[t * 3 + k];
+                unsigned int b = current[t * 3 + (k + 1) % 3];
+
+                // the merged vertex carries the planes of both, so either direction costs the error of their sum at the
+                // vertex that is kept; consider both, and keep the cheaper valid one
+                _oriQuadric q = quadrics[a];
+                _orionQuadricAdd(&q, &quadrics[b]);
+
+                double costAB = locked[a] ? HUGE_VAL : _orionQuadricError(&q, vertices + (size_t) b * stride + positionOffset);
+                double costBA = locked[b] ? HUGE_VAL : _orionQuadricError(&q, vertices + (size_t) a * stride + positionOffset);
+                if (costAB == HUGE_VAL && costBA == HUGE_VAL) {
+                    continue;
+                }
+
+                _oriCollapse *c = &collapses[collapseCount++];
+                if (costAB <= costBA) {
+                    c->from = a;
+                    c->to = b;
+                    c->cost = costAB;
+                } else {
+                    c->from = b;
+                    c->to = a;
+                    c->cost = costBA;
+                }
+            }
+        }
+
+        if (!collapseCount) {
+            break;
+        }
+
+        qsort(collapses, collapseCount, sizeof(_oriCollapse), _orionCompareCollapses);
+
+        for (size_t v = 0; v < vertexCount; v++) {
+            remap[v] = (unsigned int) v;
+        }
+        memset(touched, 0, vertexCount * sizeof(bool));
+
+        // (each collapse removes the triangles that share the edge, usually two)
+        size_t removed = 0;
+        size_t performed = 0;
+        size_t needed = (count - targetIndexCount) / 3;
+
+        for (size_t i = 0; i < collapseCount && removed < needed; i++) {
+            _oriCollapse *c = &collapses[i];
+            if (touched[c->from] || touched[c->to]) {
+                continue;
+            }
+            if (_orionCollapseFlips(current, adjOffsets, adjTriangles, remap, vertices, stride, positionOffset, c->from, c->to)) {
+                continue;
+            }
+
+            for (unsigned int a = adjOffsets[c->from]; a < adjOffsets[c->from + 1]; a++) {
+                if (_orionTriangleHasVertex(current + (size_t) adjTriangles[a] * 3, c->to)) {
+                    removed++;
+                }
+            }
+
+            remap[c->from] = c->to;
+            touched[c->from] = true;
+            touched[c->to] = true;
+            _orionQuadricAdd(&quadrics[c->to], &quadrics[c->from]);
+
+            if (c->cost > maxError) {
+                maxError = c->cost;
+            }
+            performed++;
+        }
+
+        if (!performed) {
+            break;
+        }
+
+        // apply the collapses and drop the degenerate triangles
+        size_t write = 0;
+        for (size_t t = 0; t < count / 3; t++) {
+            unsigned int a = remap[current[t * 3 + 0]];
+            unsigned int b = remap[current[t * 3 + 1]];
+            unsigned int c = remap[current[t * 3 + 2]];
+
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+
+            current[write++] = a;
+            current[write++] = b;
+            current[write++] = c;
+        }
+        count = write;
+
+        free(adjTriangles);
+        free(adjOffsets);
+        _orionBuildTriangleAdjacency(current, count, vertexCount, &adjOffsets, &adjTriangles);
+    }
+
+    memcpy(dst, current, count * sizeof(unsigned int));
+
+    if (error) {
+        *error = (float) sqrt(maxError);
+    }
+
+    free(adjTriangles);
+    free(adjOffsets);
+    free(collapses);
+    free(remap);
+    free(touched);
+    free(locked);
+    free(quadrics);
+    free(current);
+
+    return count;
+}
+
+/**
+ * @brief Allocate and initialise a new oriMeshLOD structure, generating a chain of simplified index buffers for a mesh.
+ *
+ * @details Level 0 is the given indices at full detail, and each further level is simplified from the one before it with
+ * oriSimplifyMesh() to the corresponding fraction of the original triangle count. All levels are uploaded into one index
+ * buffer (narrowed to 16-bit indices where possible), which is attached to @c va as its element buffer, so each level is
+ * drawn from the same vertex buffer with oriDrawMeshLOD() or from a draw list with the range given by
+ * oriGetMeshLODRange().
+ *
+ * @warning Free the mesh LOD before the vertex array it is attached to.
+ *
+ * @param va the vertex array that the mesh's vertex data is specified in.
+ * @param vertices the interleaved vertices of the mesh, as uploaded to the vertex array's buffer.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param indices the indices of the mesh's triangle list.
+ * @param indexCount the amount of indices.
+ * @param ratios the fraction of triangles to keep for each simplified level, e.g. { 0.5, 0.25, 0.1 }.
+ * @param ratioCount the amount of simplified levels (at most 15).
+ *
+ * @ingroup vertexspec
+ */
+oriMeshLOD *oriCreateMeshLOD(oriVertexArray *va, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const unsigned int *indices, const size_t indexCount, const float *ratios, unsigned int ratioCount) {
+    _orionAssertVersion(300);
+
+    if (ratioCount > _ORION_MAX_LOD_LEVELS - 1) {
+        _orionThrowWarning("(in oriCreateMeshLOD()): Too many levels of detail requested. Extra levels not generated.");
+        ratioCount = _ORION_MAX_LOD_LEVELS - 1;
+    }
+    if (!_orionIndicesInRange(indices, indexCount - indexCount % 3, vertexCount)) {
+        _orionThrowWarning("(in oriCreateMeshLOD()): Indices refer to vertices past vertexCount. Mesh LOD not created.");
+        return NULL;
+    }
+
+    oriMeshLOD *r = malloc(sizeof(oriMeshLOD));
+    r->va = va;
+    r->levelCount = 0;
+
+    size_t baseCount = indexCount - indexCount % 3;
+
+    // every level is at most as large as the first
+    unsigned int *chain = malloc((baseCount ? baseCount : 1) * (ratioCount + 1) * sizeof(unsigned int));
+    size_t chainCount = 0;
+
+    memcpy(chain, indices, baseCount * sizeof(unsigned int));
+    r->levels[0].firstIndex = 0;
+    r->levels[0].count = (unsigned int) baseCount;
+    r->levels[0].error = 0.0f;
+    r->levelCount = 1;
+    chainCount = baseCount;
+
+    for (unsigned int i = 0; i < ratioCount; i++) {
+        _oriMeshLODLevel *previous = &r->levels[r->levelCount - 1];
+        if (previous->count < 3) {
+            break;
+        }
+
+        size_t target = (size_t) ((double) baseCount / 3.0 * ratios[i]) * 3;
+
+        float error;
+        size_t count = oriSimplifyMesh(chain + chainCount, chain + previous->firstIndex, previous->count, vertices, vertexCount, stride, positionOffset, target, &error);
+
+        // stop once simplification can't make any more progress
+        if (count >= previous->count) {
+            break;
+        }
+
+        _oriMeshLODLevel *level = &r->levels[r->levelCount++];
+        level->firstIndex = (unsigned int) chainCount;
+        level->count = (unsigned int) count;
+        level->error = (error > previous->error) ? error : previous->error;
+
+        chainCount += count;
+    }
+
+    r->indexBuffer = oriCreateBuffer();
+    r->indexType = oriUploadIndexData(r->indexBuffer, chain, chainCount, GL_STATIC_DRAW, false);
+    free(chain);
+
+    oriSetVertexArrayIndexBuffer(va, r->indexBuffer, r->indexType);
+
+    // add to global linked list
+    r->next = _orion.meshLODListHead;
+    _orion.meshLODListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given mesh LOD, and its index buffer.
+ *
+ * @details If the index buffer is still attached to the mesh's vertex array, it is detached.
+ *
+ * @param lod the mesh LOD to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeMeshLOD(oriMeshLOD *lod) {
+    _orionAssertVersion(300);
+
+    // unlink from global linked list
+    if (_orion.meshLODListHead == lod) {
+        _orion.meshLODListHead = lod->next;
+    } else {
+        oriMeshLOD *current = _orion.meshLODListHead;
+        while (current->next != lod)
+            current = current->next;
+        current->next = lod->next;
+    }
+
+    if (lod->va->indexBuffer == lod->indexBuffer) {
+        oriSetVertexArrayIndexBuffer(lod->va, NULL, 0);
+    }
+    oriFreeBuffer(lod->indexBuffer);
+
+    free(lod);
+    lod = NULL;
+}
+
+/**
+ * @brief Return the amount of levels of detail in the given mesh LOD, including the full-detail level 0.
+ *
+ * @param lod the mesh LOD to inspect.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetMeshLODLevelCount(oriMeshLOD *lod) {
+    return lod->levelCount;
+}
+
+/**
+ * @brief Get the range of the element buffer that holds the indices of the given level, e.g. to add it to a draw list
+ * with oriDrawListAddElements().
+ *
+ * @param lod the mesh LOD to inspect.
+ * @param level the level of detail.
+ * @param firstIndex if not NULL, this is set to the position of the level's first index in the element buffer.
+ * @param count if not NULL, this is set to the amount of indices in the level.
+ * @return the type of the indices in the element buffer (@c GL_UNSIGNED_SHORT or @c GL_UNSIGNED_INT).
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriGetMeshLODRange(oriMeshLOD *lod, unsigned int level, unsigned int *firstIndex, unsigned int *count) {
+    if (level >= lod->levelCount) {
+        level = lod->levelCount - 1;
+    }
+
+    if (firstIndex) {
+        *firstIndex = lod->levels[level].firstIndex;
+    }
+    if (count) {
+        *count = lod->levels[level].count;
+    }
+
+    return lod->indexType;
+}
+
+/**
+ * @brief Choose the coarsest level of detail whose error, projected onto the screen, is at most @c maxPixelError pixels.
+ *
+ * @details @c projectionScale converts a size at a distance of 1 unit into pixels; for a perspective projection, it is
+ * the viewport height divided by @c (2 * tan(fovY / 2)).
+ *
+ * @param lod the mesh LOD to choose a level from.
+ * @param distance the distance from the camera to the mesh, in the same units as the vertex positions (after scaling).
+ * @param projectionScale the size in pixels of 1 unit at a distance of 1 unit.
+ * @param maxPixelError the largest acceptable error on screen, in pixels (e.g. 1).
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriSelectMeshLOD(oriMeshLOD *lod, const float distance, const float projectionScale, const float maxPixelError) {
+    if (distance <= 0.0f) {
+        return 0;
+    }
+
+    unsigned int r = 0;
+    for (unsigned int i = 1; i < lod->levelCount; i++) {
+        if (lod->levels[i].error * projectionScale / distance > maxPixelError) {
+            break;
+        }
+        r = i;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Draw the given level of detail of a mesh, from the vertex array that the mesh LOD was created with.
+ *
+ * @param lod the mesh LOD to draw.
+ * @param shader the shader to draw with, or NULL to draw with whichever shader is bound.
+ * @param level the level of detail to draw, e.g. as chosen by oriSelectMeshLOD().
+ * @param instanceCount the amount of instances to draw.
+ *
+ * @ingroup vertexspec
+ */
+void oriDrawMeshLOD(oriMeshLOD *lod, oriShader *shader, unsigned int level, const unsigned int instanceCount) {
+    unsigned int firstIndex, count;
+    unsigned int type = oriGetMeshLODRange(lod, level, &firstIndex, &count);
+
+    size_t indexSize = (type == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+
+    oriDrawElementsInstanced(lod->va, shader, GL_TRIANGLES, count, type, firstIndex * indexSize, instanceCount, 0, 0);
+}
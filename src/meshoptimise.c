@@ -0,0 +1,704 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#endif
+
+// the size of the simulated post-transform vertex cache (a FIFO).
+#define _ORION_VERTEX_CACHE_SIZE 16
+// the ACMR increase (over that of the cache-optimised order) that overdraw optimisation may cause.
+#define _ORION_OVERDRAW_THRESHOLD 1.05f
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A cluster of triangles to be sorted for overdraw.
+ *
+ */
+typedef struct _oriTriangleCluster {
+    // the range of triangles in the cluster
+    size_t first;
+    size_t last;
+
+    float sortKey;
+} _oriTriangleCluster;
+
+/**
+ * @brief The work shared between threads of oriOptimiseMeshes().
+ *
+ */
+typedef struct _oriMeshBatch {
+    oriMeshData *meshes;
+    size_t meshCount;
+
+    // the next mesh to be optimised
+    volatile long next;
+} _oriMeshBatch;
+
+/**
+ * @brief A worker thread's share of oriOptimiseMeshes(), which takes meshes from the batch until there are none left.
+ *
+ */
+typedef struct _oriMeshBatchJob {
+    // (must be first, as the worker is given a pointer to it)
+    _oriJob job;
+
+    _oriMeshBatch *batch;
+} _oriMeshBatchJob;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static uint32_t _orionHashVertex(const float *vertex, unsigned int stride) {
+    // FNV-1a over the bytes of the vertex
+    const unsigned char *bytes = (const unsigned char *) vertex;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < stride * sizeof(float); i++) {
+        h ^= bytes[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool _orionIndicesInRange(const unsigned int *indices, size_t indexCount, size_t vertexCount) {
+    for (size_t i = 0; i < indexCount; i++) {
+        if (indices[i] >= vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void _orionBuildTriangleAdjacency(const unsigned int *indices, size_t indexCount, size_t vertexCount, unsigned int **offsets, unsigned int **triangles) {
+    unsigned int *o = calloc(vertexCount + 1, sizeof(unsigned int));
+    unsigned int *t = malloc((indexCount ? indexCount : 1) * sizeof(unsigned int));
+
+    for (size_t i = 0; i < indexCount; i++) {
+        o[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        o[v + 1] += o[v];
+    }
+
+    // (fill using a cursor per vertex, so the offsets are left intact)
+    unsigned int *cursor = malloc((vertexCount ? vertexCount : 1) * sizeof(unsigned int));
+    memcpy(cursor, o, vertexCount * sizeof(unsigned int));
+    for (size_t i = 0; i < indexCount; i++) {
+        t[cursor[indices[i]]++] = (unsigned int) (i / 3);
+    }
+    free(cursor);
+
+    *offsets = o;
+    *triangles = t;
+}
+
+// the Tipsify algorithm (Sander, Nehab and Barczak 2007).
+static void _orionTipsify(unsigned int *dst, const unsigned int *indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize) {
+    size_t triangleCount = indexCount / 3;
+
+    unsigned int *adjOffsets, *adjTriangles;
+    _orionBuildTriangleAdjacency(indices, indexCount, vertexCount, &adjOffsets, &adjTriangles);
+
+    unsigned int *live = malloc(vertexCount * sizeof(unsigned int));
+    unsigned int *cacheTime = calloc(vertexCount, sizeof(unsigned int));
+    bool *emitted = calloc(triangleCount, sizeof(bool));
+
+    // each triangle pushes 3 vertices, so this can't overflow
+    unsigned int *deadEnd = malloc(indexCount * sizeof(unsigned int));
+    size_t deadEndSize = 0;
+    unsigned int *candidates = malloc(indexCount * sizeof(unsigned int));
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        live[v] = adjOffsets[v + 1] - adjOffsets[v];
+    }
+
+    unsigned int timestamp = cacheSize + 1;
+    size_t cursor = 0;
+    size_t outputTriangle = 0;
+
+    // start with the first used vertex
+    long fanning = -1;
+    while (cursor < vertexCount && !live[cursor]) {
+        cursor++;
+    }
+    if (cursor < vertexCount) {
+        fanning = (long) cursor;
+    }
+
+    while (fanning >= 0) {
+        size_t candidateCount = 0;
+
+        // emit all unemitted triangles around the fanning vertex
+        for (unsigned int a = adjOffsets[fanning]; a < adjOffsets[fanning + 1]; a++) {
+            unsigned int t = adjTriangles[a];
+            if (emitted[t]) {
+                continue;
+            }
+
+            for (unsigned int k = 0; k < 3; k++) {
+                unsigned int v = indices[t * 3 + k];
+
+                dst[outputTriangle * 3 + k] = v;
+
+                deadEnd[deadEndSize++] = v;
+                candidates[candidateCount++] = v;
+                live[v]--;
+
+                if (timestamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timestamp++;
+                }
+            }
+
+            emitted[t] = true;
+            outputTriangle++;
+        }
+
+        // choose the candidate that will still be in the cache after its remaining triangles are emitted, and that
+        // entered the cache the earliest
+        long best = -1;
+        int bestPriority = -1;
+        for (size_t c = 0; c < candidateCount; c++) {
+            unsigned int v = candidates[c];
+            if (!live[v]) {
+                continue;
+            }
+
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = (int) (timestamp - cacheTime[v]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = (long) v;
+            }
+        }
+
+        if (best < 0) {
+            // dead end: try recently used vertices, then the next vertex in input order
+            while (deadEndSize) {
+                unsigned int v = deadEnd[--deadEndSize];
+                if (live[v]) {
+                    best = (long) v;
+                    break;
+                }
+            }
+
+            if (best < 0) {
+                while (cursor < vertexCount && !live[cursor]) {
+                    cursor++;
+                }
+                if (cursor < vertexCount) {
+                    best = (long) cursor;
+                }
+            }
+        }
+
+        fanning = best;
+    }
+
+    free(candidates);
+    free(deadEnd);
+    free(emitted);
+    free(cacheTime);
+    free(live);
+    free(adjTriangles);
+    free(adjOffsets);
+}
+
+// simulate a FIFO cache over the triangles in [first, last), and return the amount of misses.
+static size_t _orionSimulateCache(const unsigned int *indices, size_t first, size_t last, unsigned int *cacheTime, unsigned int *timestamp) {
+    size_t misses = 0;
+
+    // (offset the clock so that no vertex is in the cache)
+    *timestamp += _ORION_VERTEX_CACHE_SIZE + 1;
+
+    for (size_t i = first * 3; i < last * 3; i++) {
+        unsigned int v = indices[i];
+        if (*timestamp - cacheTime[v] > _ORION_VERTEX_CACHE_SIZE) {
+            cacheTime[v] = (*timestamp)++;
+            misses++;
+        }
+    }
+
+    return misses;
+}
+
+static int _orionCompareClusters(const void *a, const void *b) {
+    const _oriTriangleCluster *ca = (const _oriTriangleCluster *) a;
+    const _oriTriangleCluster *cb = (const _oriTriangleCluster *) b;
+
+    // outward-facing clusters first; keep the input order otherwise
+    if (ca->sortKey != cb->sortKey) {
+        return (ca->sortKey > cb->sortKey) ? -1 : 1;
+    }
+    return (ca->first < cb->first) ? -1 : (ca->first > cb->first);
+}
+
+static void _orionOptimiseMesh(oriMeshData *mesh) {
+    if (!mesh->indices || !mesh->indexCount || !_orionIndicesInRange(mesh->indices, mesh->indexCount, mesh->vertexCount)) {
+        return;
+    }
+
+    size_t indexCount = mesh->indexCount;
+    unsigned int *scratch = malloc(indexCount * sizeof(unsigned int));
+
+    oriOptimiseVertexCache(scratch, mesh->indices, indexCount, mesh->vertexCount);
+    oriOptimiseOverdraw(mesh->indices, scratch, indexCount, mesh->vertices, mesh->vertexCount, mesh->stride, mesh->positionOffset, _ORION_OVERDRAW_THRESHOLD);
+
+    float *vertices = malloc(mesh->vertexCount * mesh->stride * sizeof(float));
+    mesh->vertexCount = oriOptimiseVertexFetch(vertices, mesh->indices, indexCount, mesh->vertices, mesh->vertexCount, mesh->stride);
+    memcpy(mesh->vertices, vertices, mesh->vertexCount * mesh->stride * sizeof(float));
+
+    free(vertices);
+    free(scratch);
+}
+
+static long _orionBatchNext(_oriMeshBatch *batch) {
+#ifdef _WIN32
+    return InterlockedIncrement(&batch->next) - 1;
+#else
+    return __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void _orionOptimiseBatch(_oriMeshBatch *batch) {
+    long i;
+    while ((i = _orionBatchNext(batch)) < (long) batch->meshCount) {
+        _orionOptimiseMesh(&batch->meshes[i]);
+    }
+}
+
+static void _orionOptimiseBatchJob(_oriJob *job) {
+    _orionOptimiseBatch(((_oriMeshBatchJob *) job)->batch);
+}
+
+// ======================================================================================
+// *****                        ORION MESH OPTIMISATION FUNCTIONS                   *****
+// ======================================================================================
+
+/**
+ * @brief Build an index buffer for non-indexed, interleaved vertices (e.g. a vertex array drawn with oriDrawArrays()) by
+ * merging identical vertices.
+ *
+ * @details The unique vertices are moved to the front of @c vertices, in the order they first appear.
+ *
+ * @param indices the destination array of @c vertexCount indices.
+ * @param vertices the vertices, which are compacted in place.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @return the amount of unique vertices.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriGenerateIndexBuffer(unsigned int *indices, float *vertices, const size_t vertexCount, const unsigned int stride) {
+    // open addressing, with at most half of the table in use
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) {
+        tableSize <<= 1;
+    }
+
+    unsigned int *table = malloc(tableSize * sizeof(unsigned int));
+    memset(table, 0xFF, tableSize * sizeof(unsigned int));
+
+    size_t unique = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float *vertex = vertices + v * stride;
+        size_t slot = _orionHashVertex(vertex, stride) & (tableSize - 1);
+
+        while (table[slot] != ~0u && memcmp(vertices + (size_t) table[slot] * stride, vertex, stride * sizeof(float))) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == ~0u) {
+            if (unique != v) {
+                memmove(vertices + unique * stride, vertex, stride * sizeof(float));
+            }
+            table[slot] = (unsigned int) unique++;
+        }
+
+        indices[v] = table[slot];
+    }
+
+    free(table);
+
+    return unique;
+}
+
+/**
+ * @brief Reorder triangles so that their vertices are reused from the GPU's post-transform cache as much as possible.
+ *
+ * @details The Tipsify algorithm is used, which runs in linear time and doesn't depend on the exact cache size.
+ *
+ * @param dst the destination array of @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertexCount the amount of vertices that the indices refer to.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseVertexCache(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const size_t vertexCount) {
+    if (!indexCount) {
+        return;
+    }
+    if (!_orionIndicesInRange(indices, indexCount, vertexCount)) {
+        _orionThrowWarning("(in oriOptimiseVertexCache()): Indices refer to vertices past vertexCount. Indices not optimised.");
+        return;
+    }
+
+    unsigned int *source = malloc(indexCount * sizeof(unsigned int));
+    memcpy(source, indices, indexCount * sizeof(unsigned int));
+
+    _orionTipsify(dst, source, indexCount - indexCount % 3, vertexCount, _ORION_VERTEX_CACHE_SIZE);
+
+    free(source);
+}
+
+/**
+ * @brief Reorder clusters of triangles so that those facing outwards from the mesh are drawn first, which reduces
+ * overdraw.
+ *
+ * @details The indices should already be optimised with oriOptimiseVertexCache(). They are split into clusters wherever
+ * the cache is cold, and further wherever the vertex cache efficiency is within @c threshold of the whole cluster's, so
+ * reordering the clusters keeps most of the cache optimisation.
+ *
+ * @param dst the destination array of @c indexCount indices. This may be the same as @c indices.
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices (a multiple of 3).
+ * @param vertices the interleaved vertices that the indices refer to.
+ * @param vertexCount the amount of vertices.
+ * @param stride the amount of floats in each vertex.
+ * @param positionOffset the offset of the 3-component position in each vertex, in floats.
+ * @param threshold the allowed decrease in cache efficiency, e.g. 1.05 for 5%.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseOverdraw(unsigned int *dst, const unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride, const unsigned int positionOffset, const float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (!triangleCount) {
+        return;
+    }
+    if (!_orionIndicesInRange(indices, triangleCount * 3, vertexCount)) {
+        _orionThrowWarning("(in oriOptimiseOverdraw()): Indices refer to vertices past vertexCount. Indices not optimised.");
+        return;
+    }
+
+    unsigned int *source = malloc(triangleCount * 3 * sizeof(unsigned int));
+    memcpy(source, indices, triangleCount * 3 * sizeof(unsigned int));
+
+    unsigned int *cacheTime = calloc(vertexCount, sizeof(unsigned int));
+    unsigned int timestamp = 0;
+
+    // hard boundaries: triangles whose vertices all miss the cache
+    size_t *hard = malloc((triangleCount + 1) * sizeof(size_t));
+    size_t hardCount = 0;
+    timestamp += _ORION_VERTEX_CACHE_SIZE + 1;
+    for (size_t t = 0; t < triangleCount; t++) {
+        unsigned int misses = 0;
+        for (unsigned int k = 0; k < 3; k++) {
+            unsigned int v = source[t * 3 + k];
+            if (timestamp - cacheTime[v] > _ORION_VERTEX_CACHE_SIZE) {
+                cacheTime[v] = timestamp++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            hard[hardCount++] = t;
+        }
+    }
+    hard[hardCount] = triangleCount;
+
+    // soft boundaries: split hard clusters where the running ACMR is already as good as the whole cluster's
+    _oriTriangleCluster *clusters = malloc(triangleCount * sizeof(_oriTriangleCluster));
+    size_t clusterCount = 0;
+
+    for (size_t h = 0; h < hardCount; h++) {
+        size_t first = hard[h];
+        size_t last = hard[h + 1];
+
+        float target = (float) _orionSimulateCache(source, first, last, cacheTime, &timestamp) / (float) (last - first) * threshold;
+
+        clusters[clusterCount++].first = first;
+
+        timestamp += _ORION_VERTEX_CACHE_SIZE + 1;
+        size_t start = first;
+        size_t misses = 0;
+        for (size_t t = first; t < last; t++) {
+            for (unsigned int k = 0; k < 3; k++) {
+                unsigned int v = source[t * 3 + k];
+                if (timestamp - cacheTime[v] > _ORION_VERTEX_CACHE_SIZE) {
+                    cacheTime[v] = timestamp++;
+                    misses++;
+                }
+            }
+
+            if (t + 1 < last && (float) misses / (float) (t + 1 - start) <= target) {
+                clusters[clusterCount++].first = t + 1;
+                start = t + 1;
+                misses = 0;
+                timestamp += _ORION_VERTEX_CACHE_SIZE + 1;
+            }
+        }
+    }
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        clusters[c].last = (c + 1 < clusterCount) ? clusters[c + 1].first : triangleCount;
+    }
+
+    // the area-weighted centroid and normal of each cluster
+    float *clusterData = malloc(clusterCount * 6 * sizeof(float));
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        size_t first = clusters[c].first;
+        size_t last = clusters[c].last;
+
+        float *centroid = clusterData + c * 6;
+        float *normal = centroid + 3;
+        float area = 0.0f;
+        memset(centroid, 0, 6 * sizeof(float));
+
+        for (size_t t = first; t < last; t++) {
+            const float *p0 = vertices + (size_t) source[t * 3 + 0] * stride + positionOffset;
+            const float *p1 = vertices + (size_t) source[t * 3 + 1] * stride + positionOffset;
+            const float *p2 = vertices + (size_t) source[t * 3 + 2] * stride + positionOffset;
+
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float n[3] = {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0]
+            };
+            float a = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (unsigned int k = 0; k < 3; k++) {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * (a / 3.0f);
+                normal[k] += n[k];
+            }
+            area += a;
+        }
+
+        if (area > 0.0f) {
+            for (unsigned int k = 0; k < 3; k++) {
+                meshCentroid[k] += centroid[k];
+                centroid[k] /= area;
+            }
+        }
+        meshArea += area;
+
+        float l = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (l > 0.0f) {
+            for (unsigned int k = 0; k < 3; k++) {
+                normal[k] /= l;
+            }
+        }
+    }
+
+    if (meshArea > 0.0f) {
+        for (unsigned int k = 0; k < 3; k++) {
+            meshCentroid[k] /= meshArea;
+        }
+    }
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float *centroid = clusterData + c * 6;
+        const float *normal = centroid + 3;
+
+        clusters[c].sortKey =
+            (centroid[0] - meshCentroid[0]) * normal[0] +
+            (centroid[1] - meshCentroid[1]) * normal[1] +
+            (centroid[2] - meshCentroid[2]) * normal[2];
+    }
+
+    qsort(clusters, clusterCount, sizeof(_oriTriangleCluster), _orionCompareClusters);
+
+    size_t output = 0;
+    for (size_t c = 0; c < clusterCount; c++) {
+        size_t count = clusters[c].last - clusters[c].first;
+        memcpy(dst + output * 3, source + clusters[c].first * 3, count * 3 * sizeof(unsigned int));
+        output += count;
+    }
+
+    // (any trailing indices that don't make a full triangle are left in place)
+    if (dst != indices) {
+        memcpy(dst + triangleCount * 3, indices + triangleCount * 3, (indexCount - triangleCount * 3) * sizeof(unsigned int));
+    }
+
+    free(clusterData);
+    free(clusters);
+    free(hard);
+    free(cacheTime);
+    free(source);
+}
+
+/**
+ * @brief Reorder interleaved vertices in the order they are first used by the given indices, so that vertex fetches are
+ * as sequential as possible, and remap the indices to match.
+ *
+ * @details Vertices that aren't used by any index are removed.
+ *
+ * @param dstVertices the destination array of at most @c vertexCount vertices. This must not overlap @c vertices.
+ * @param indices the indices, which are remapped in place.
+ * @param indexCount the amount of indices.
+ * @param vertices the source vertices.
+ * @param vertexCount the amount of source vertices.
+ * @param stride the amount of floats in each vertex.
+ * @return the amount of vertices written to @c dstVertices.
+ *
+ * @ingroup vertexspec
+ */
+size_t oriOptimiseVertexFetch(float *dstVertices, unsigned int *indices, const size_t indexCount, const float *vertices, const size_t vertexCount, const unsigned int stride) {
+    if (!_orionIndicesInRange(indices, indexCount, vertexCount)) {
+        _orionThrowWarning("(in oriOptimiseVertexFetch()): Indices refer to vertices past vertexCount. Vertices not reordered.");
+        return 0;
+    }
+
+    unsigned int *remap = malloc((vertexCount ? vertexCount : 1) * sizeof(unsigned int));
+    memset(remap, 0xFF, vertexCount * sizeof(unsigned int));
+
+    size_t r = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int v = indices[i];
+
+        if (remap[v] == ~0u) {
+            memcpy(dstVertices + r * stride, vertices + (size_t) v * stride, stride * sizeof(float));
+            remap[v] = (unsigned int) r++;
+        }
+
+        indices[i] = remap[v];
+    }
+
+    free(remap);
+
+    return r;
+}
+
+/**
+ * @brief Get the average cache miss ratio (ACMR) of the given indices, i.e. the average amount of vertex shader invocations
+ * per triangle with a typical post-transform cache.
+ *
+ * @details This can be used to measure the effect of oriOptimiseVertexCache(); it is between 0.5 (ideal for large meshes)
+ * and 3 (no reuse).
+ *
+ * @param indices the indices of a triangle list.
+ * @param indexCount the amount of indices.
+ * @param vertexCount the amount of vertices that the indices refer to.
+ *
+ * @ingroup vertexspec
+ */
+float oriGetVertexCacheMissRatio(const unsigned int *indices, const size_t indexCount, const size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+    if (!triangleCount) {
+        return 0.0f;
+    }
+    if (!_orionIndicesInRange(indices, triangleCount * 3, vertexCount)) {
+        _orionThrowWarning("(in oriGetVertexCacheMissRatio()): Indices refer to vertices past vertexCount. Nothing measured.");
+        return 0.0f;
+    }
+
+    unsigned int *cacheTime = calloc(vertexCount, sizeof(unsigned int));
+    unsigned int timestamp = 0;
+
+    size_t misses = _orionSimulateCache(indices, 0, triangleCount, cacheTime, &timestamp);
+
+    free(cacheTime);
+
+    return (float) misses / (float) triangleCount;
+}
+
+/**
+ * @brief Run the full optimisation pipeline on the given mesh: vertex cache, then overdraw, then vertex fetch.
+ *
+ * @details This should be done once, when building assets or before the mesh's data is uploaded with oriSetBufferData().
+ * The vertices and indices are modified in place, and @c vertexCount is updated to the amount of vertices that are used.
+ * For non-indexed vertices, build the indices first with oriGenerateIndexBuffer().
+ *
+ * @param mesh the mesh to optimise.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseMesh(oriMeshData *mesh) {
+    if (!mesh->indices) {
+        _orionThrowWarning("(in oriOptimiseMesh()): Mesh has no indices (see oriGenerateIndexBuffer()). Mesh not optimised.");
+        return;
+    }
+    if (!_orionIndicesInRange(mesh->indices, mesh->indexCount, mesh->vertexCount)) {
+        _orionThrowWarning("(in oriOptimiseMesh()): Indices refer to vertices past vertexCount. Mesh not optimised.");
+        return;
+    }
+
+    _orionOptimiseMesh(mesh);
+}
+
+/**
+ * @brief Optimise the given meshes with oriOptimiseMesh(), spread across the worker threads (see
+ * oriSetWorkerThreadCount()).
+ *
+ * @details Meshes are handed out to the threads one at a time, so a batch of meshes of different sizes is balanced
+ * between them. The calling thread also optimises meshes, and the function returns once all meshes have been optimised.
+ *
+ * @param meshes the meshes to optimise.
+ * @param meshCount the amount of meshes.
+ * @param threadCount the most threads to use, including the calling thread.
+ *
+ * @ingroup vertexspec
+ */
+void oriOptimiseMeshes(oriMeshData *meshes, const size_t meshCount, const unsigned int threadCount) {
+    for (size_t i = 0; i < meshCount; i++) {
+        if (!meshes[i].indices) {
+            _orionThrowWarning("(in oriOptimiseMeshes()): Mesh has no indices (see oriGenerateIndexBuffer()). Mesh not optimised.");
+        } else if (!_orionIndicesInRange(meshes[i].indices, meshes[i].indexCount, meshes[i].vertexCount)) {
+            _orionThrowWarning("(in oriOptimiseMeshes()): Indices refer to vertices past vertexCount. Mesh not optimised.");
+        }
+    }
+
+    _oriMeshBatch batch;
+    batch.meshes = meshes;
+    batch.meshCount = meshCount;
+    batch.next = 0;
+
+    unsigned int jobCount = (threadCount > 1) ? threadCount - 1 : 0;
+    if (jobCount > meshCount) {
+        jobCount = (unsigned int) meshCount;
+    }
+
+    _oriMeshBatchJob *jobs = malloc((jobCount ? jobCount : 1) * sizeof(_oriMeshBatchJob));
+    for (unsigned int i = 0; i < jobCount; i++) {
+        jobs[i].batch = &batch;
+        _orionSubmitJob(&jobs[i].job, _orionOptimiseBatchJob);
+    }
+
+    _orionOptimiseBatch(&batch);
+
+    // (jobs that the workers haven't got to by the time the calling thread runs out of meshes have nothing left to do)
+    for (unsigned int i = 0; i < jobCount; i++) {
+        _orionWaitJob(&jobs[i].job, true);
+    }
+
+    free(jobs);
+}
@@ -0,0 +1,417 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+// the row kernels are picked at compile time, as in vertexpacking.c.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define _ORION_SSE2
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   define _ORION_NEON
+#endif
+
+#if defined(_ORION_SSE2)
+#   include <emmintrin.h>
+#endif
+#if defined(_ORION_NEON)
+#   include <arm_neon.h>
+#endif
+
+// the radius of the Kaiser filter, in destination texels, and its window shape.
+#define _ORION_KAISER_RADIUS 2.0f
+#define _ORION_KAISER_ALPHA 4.0f
+
+// the size of the table used to convert linear values back to sRGB.
+#define _ORION_SRGB_TABLE_SIZE 4096
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief The source texels and weights that make up each destination texel along one axis of a downsample.
+ *
+ */
+typedef struct _oriFilterTaps {
+    unsigned int taps;
+
+    // (taps entries per destination texel)
+    unsigned int *indices;
+    float *weights;
+} _oriFilterTaps;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static float _orionSRGBToLinear(float x) {
+    return (x <= 0.04045f) ? x / 12.92f : powf((x + 0.055f) / 1.055f, 2.4f);
+}
+
+static float _orionLinearToSRGB(float x) {
+    return (x <= 0.0031308f) ? x * 12.92f : 1.055f * powf(x, 1.0f / 2.4f) - 0.055f;
+}
+
+// zeroth-order modified Bessel function of the first kind (for the Kaiser window).
+static float _orionBesselI0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (unsigned int k = 1; k < 32; k++) {
+        term *= (x * 0.5f / k) * (x * 0.5f / k);
+        sum += term;
+        if (term < sum * 1e-7f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static float _orionKaiser(float t) {
+    // Kaiser-windowed sinc, with t in destination texels
+    float x = t / _ORION_KAISER_RADIUS;
+    if (x <= -1.0f || x >= 1.0f) {
+        return 0.0f;
+    }
+
+    float sinc = (fabsf(t) < 1e-6f) ? 1.0f : sinf(3.14159265f * t) / (3.14159265f * t);
+    return sinc * _orionBesselI0(_ORION_KAISER_ALPHA * sqrtf(1.0f - x * x)) / _orionBesselI0(_ORION_KAISER_ALPHA);
+}
+
+// build the taps that downsample srcSize texels to dstSize along one axis (with clamping at the edges).
+static bool _orionBuildTaps(_oriFilterTaps *taps, unsigned int srcSize, unsigned int dstSize, unsigned int filter) {
+    float scale = (float) srcSize / (float) dstSize;
+    float support = (filter == ORION_MIP_FILTER_KAISER) ? _ORION_KAISER_RADIUS * scale : scale * 0.5f;
+
+    taps->taps = (unsigned int) ceilf(support * 2.0f) + 1;
+    taps->indices = malloc((size_t) dstSize * taps->taps * sizeof(unsigned int));
+    taps->weights = malloc((size_t) dstSize * taps->taps * sizeof(float));
+    if (!taps->indices || !taps->weights) {
+        free(taps->indices);
+        free(taps->weights);
+        return false;
+    }
+
+    for (unsigned int x = 0; x < dstSize; x++) {
+        unsigned int *indices = taps->indices + (size_t) x * taps->taps;
+        float *weights = taps->weights + (size_t) x * taps->taps;
+
+        float centre = ((float) x + 0.5f) * scale;
+        int first = (int) floorf(centre - support);
+
+        float total = 0.0f;
+        for (unsigned int k = 0; k < taps->taps; k++) {
+            int i = first + (int) k;
+
+            float w;
+            if (filter == ORION_MIP_FILTER_KAISER) {
+                w = _orionKaiser(((float) i + 0.5f - centre) / scale);
+            } else {
+                // coverage of the source texel [i, i + 1] by the destination texel
+                float lo = fmaxf((float) i, centre - support);
+                float hi = fminf((float) i + 1.0f, centre + support);
+                w = fmaxf(hi - lo, 0.0f);
+            }
+
+            indices[k] = (i < 0) ? 0 : (((unsigned int) i >= srcSize) ? srcSize - 1 : (unsigned int) i);
+            weights[k] = w;
+            total += w;
+        }
+
+        for (unsigned int k = 0; k < taps->taps; k++) {
+            weights[k] /= total;
+        }
+    }
+
+    return true;
+}
+
+// acc[i] += w * src[i] for n floats.
+static void _orionAccumulateRow(float *acc, const float *src, float w, size_t n) {
+    size_t i = 0;
+
+#if defined(_ORION_SSE2)
+    __m128 wv = _mm_set1_ps(w);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(wv, _mm_loadu_ps(src + i))));
+    }
+#elif defined(_ORION_NEON)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vmlaq_n_f32(vld1q_f32(acc + i), vld1q_f32(src + i), w));
+    }
+#endif
+
+    for (; i < n; i++) {
+        acc[i] += w * src[i];
+    }
+}
+
+// filter a row horizontally from srcRow into dstRow.
+static void _orionFilterRow(float *dstRow, const float *srcRow, unsigned int dstWidth, unsigned int channels, const _oriFilterTaps *taps) {
+    for (unsigned int x = 0; x < dstWidth; x++) {
+        const unsigned int *indices = taps->indices + (size_t) x * taps->taps;
+        const float *weights = taps->weights + (size_t) x * taps->taps;
+        float *dst = dstRow + (size_t) x * channels;
+
+#if defined(_ORION_SSE2) || defined(_ORION_NEON)
+        // (a whole RGBA texel in one register)
+        if (channels == 4) {
+#   if defined(_ORION_SSE2)
+            __m128 acc = _mm_setzero_ps();
+            for (unsigned int k = 0; k < taps->taps; k++) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(srcRow + (size_t) indices[k] * 4)));
+            }
+            _mm_storeu_ps(dst, acc);
+#   else
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (unsigned int k = 0; k < taps->taps; k++) {
+                acc = vmlaq_n_f32(acc, vld1q_f32(srcRow + (size_t) indices[k] * 4), weights[k]);
+            }
+            vst1q_f32(dst, acc);
+#   endif
+            continue;
+        }
+#endif
+
+        for (unsigned int c = 0; c < channels; c++) {
+            float acc = 0.0f;
+            for (unsigned int k = 0; k < taps->taps; k++) {
+                acc += weights[k] * srcRow[(size_t) indices[k] * channels + c];
+            }
+            dst[c] = acc;
+        }
+    }
+}
+
+// downsample a level of linear texels into the next one (vertically into a row, then horizontally).
+static bool _orionDownsample(float *dst, const float *src, unsigned int srcWidth, unsigned int srcHeight, unsigned int dstWidth, unsigned int dstHeight, unsigned int channels, unsigned int filter) {
+    _oriFilterTaps horizontal, vertical;
+    if (!_orionBuildTaps(&horizontal, srcWidth, dstWidth, filter)) {
+        return false;
+    }
+    if (!_orionBuildTaps(&vertical, srcHeight, dstHeight, filter)) {
+        free(horizontal.indices);
+        free(horizontal.weights);
+        return false;
+    }
+
+    size_t srcRowLength = (size_t) srcWidth * channels;
+    float *row = malloc(srcRowLength * sizeof(float));
+
+    if (row) {
+        for (unsigned int y = 0; y < dstHeight; y++) {
+            const unsigned int *indices = vertical.indices + (size_t) y * vertical.taps;
+            const float *weights = vertical.weights + (size_t) y * vertical.taps;
+
+            for (size_t i = 0; i < srcRowLength; i++) {
+                row[i] = 0.0f;
+            }
+            for (unsigned int k = 0; k < vertical.taps; k++) {
+                if (weights[k] != 0.0f) {
+                    _orionAccumulateRow(row, src + (size_t) indices[k] * srcRowLength, weights[k], srcRowLength);
+                }
+            }
+
+            _orionFilterRow(dst + (size_t) y * dstWidth * channels, row, dstWidth, channels, &horizontal);
+        }
+    }
+
+    free(row);
+    free(horizontal.indices);
+    free(horizontal.weights);
+    free(vertical.indices);
+    free(vertical.weights);
+
+    return row != NULL;
+}
+
+// the amount of channels that hold colour (the rest hold alpha, which is always linear).
+static unsigned int _orionColourChannels(unsigned int channels) {
+    return (channels == 2 || channels == 4) ? channels - 1 : channels;
+}
+
+static void _orionQuantiseLevel(unsigned char *dst, const float *src, size_t texels, unsigned int channels, const unsigned char *srgbTable) {
+    unsigned int colourChannels = srgbTable ? _orionColourChannels(channels) : 0;
+
+    for (size_t i = 0; i < texels; i++) {
+        for (unsigned int c = 0; c < channels; c++) {
+            float v = src[i * channels + c];
+            v = (v < 0.0f) ? 0.0f : ((v > 1.0f) ? 1.0f : v);
+
+            if (c < colourChannels) {
+                dst[i * channels + c] = srgbTable[(unsigned int) (v * (_ORION_SRGB_TABLE_SIZE - 1) + 0.5f)];
+            } else {
+                dst[i * channels + c] = (unsigned char) (v * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+// ======================================================================================
+// *****                           ORION MIPMAP FUNCTIONS                           *****
+// ======================================================================================
+
+/**
+ * @brief Return the amount of levels in a full mipmap chain for an image with the given dimensions, including the base
+ * level.
+ *
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetMipLevelCount(unsigned int width, unsigned int height) {
+    unsigned int extent = (width > height) ? width : height;
+
+    unsigned int r = 1;
+    while (extent >>= 1) {
+        r++;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Return the amount of bytes needed to hold every mipmap level below the base level of an 8-bit image, as
+ * written by oriGenerateMipChain().
+ *
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param channels the amount of channels in the image (1-4).
+ *
+ * @ingroup textures
+ */
+size_t oriGetMipChainSize(unsigned int width, unsigned int height, unsigned int channels) {
+    size_t r = 0;
+
+    unsigned int levels = oriGetMipLevelCount(width, height);
+    for (unsigned int level = 1; level < levels; level++) {
+        unsigned int w = (width >> level) ? (width >> level) : 1;
+        unsigned int h = (height >> level) ? (height >> level) : 1;
+        r += (size_t) w * h * channels;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Build the mipmap levels of an 8-bit image on the CPU.
+ *
+ * @details Each level is filtered from the one above it in linear floating point (without rounding to 8 bits between
+ * levels), with SIMD row kernels where they are available. The box filter averages the texels each destination texel
+ * covers; the Kaiser filter is a windowed sinc that keeps distant levels sharper. If @c srgb is true, colour channels
+ * are converted from sRGB to linear before filtering and back afterwards (alpha is always filtered as it is), so that
+ * the levels of an sRGB texture don't darken.
+ *
+ * Unlike glGenerateMipmap(), this doesn't need the GL context, so it can run on a worker thread (as
+ * oriLoadTextureAsync() does). The levels can then be uploaded with oriUploadTexMipmaps().
+ *
+ * @param image the base level, with tightly packed rows.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param channels the amount of channels in the image (1-4).
+ * @param filter the downsampling filter: @c ORION_MIP_FILTER_BOX or @c ORION_MIP_FILTER_KAISER.
+ * @param srgb true if the colour channels of the image are sRGB-encoded.
+ * @param dst the array to write the levels below the base level to, one after the other with tightly packed rows. It
+ * must hold at least oriGetMipChainSize() bytes.
+ * @param levels an array of at least oriGetMipLevelCount() pointers to fill with the start of each level (the first
+ * being @c image), or NULL.
+ * @return the amount of levels, including the base level, or 0 if the memory to filter them couldn't be allocated.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGenerateMipChain(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int filter, bool srgb, unsigned char *dst, const unsigned char **levels) {
+    unsigned int levelCount = oriGetMipLevelCount(width, height);
+    if (levels) {
+        levels[0] = image;
+    }
+    if (levelCount == 1) {
+        return 1;
+    }
+
+    unsigned int colourChannels = srgb ? _orionColourChannels(channels) : 0;
+
+    float toLinear[256];
+    for (unsigned int i = 0; i < 256; i++) {
+        toLinear[i] = srgb ? _orionSRGBToLinear(i / 255.0f) : i / 255.0f;
+    }
+
+    unsigned char *srgbTable = NULL;
+    if (srgb) {
+        srgbTable = malloc(_ORION_SRGB_TABLE_SIZE);
+        if (!srgbTable) {
+            return 0;
+        }
+        for (unsigned int i = 0; i < _ORION_SRGB_TABLE_SIZE; i++) {
+            srgbTable[i] = (unsigned char) (_orionLinearToSRGB((float) i / (_ORION_SRGB_TABLE_SIZE - 1)) * 255.0f + 0.5f);
+        }
+    }
+
+    // the previous and current levels in linear floating point (the second is at most a quarter of the first)
+    size_t texels = (size_t) width * height;
+    unsigned int w1 = (width >> 1) ? (width >> 1) : 1;
+    unsigned int h1 = (height >> 1) ? (height >> 1) : 1;
+    float *source = malloc(texels * channels * sizeof(float));
+    float *target = malloc((size_t) w1 * h1 * channels * sizeof(float));
+    if (!source || !target) {
+        free(source);
+        free(target);
+        free(srgbTable);
+        return 0;
+    }
+
+    for (size_t i = 0; i < texels; i++) {
+        for (unsigned int c = 0; c < channels; c++) {
+            unsigned char v = image[i * channels + c];
+            source[i * channels + c] = (c < colourChannels) ? toLinear[v] : v / 255.0f;
+        }
+    }
+
+    unsigned int r = levelCount;
+    unsigned int w = width;
+    unsigned int h = height;
+    for (unsigned int level = 1; level < levelCount; level++) {
+        unsigned int nw = (w >> 1) ? (w >> 1) : 1;
+        unsigned int nh = (h >> 1) ? (h >> 1) : 1;
+
+        if (!_orionDownsample(target, source, w, h, nw, nh, channels, filter)) {
+            r = 0;
+            break;
+        }
+
+        _orionQuantiseLevel(dst, target, (size_t) nw * nh, channels, srgbTable);
+        if (levels) {
+            levels[level] = dst;
+        }
+        dst += (size_t) nw * nh * channels;
+
+        // the level just filtered is the source of the next (which fits in the old source's memory)
+        float *swap = source;
+        source = target;
+        target = swap;
+
+        w = nw;
+        h = nh;
+    }
+
+    free(source);
+    free(target);
+    free(srgbTable);
+
+    return r;
+}
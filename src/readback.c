@@ -0,0 +1,310 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A pending GPU-to-CPU transfer into a staging buffer.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriReadback {
+    oriReadback *next;
+
+    oriBuffer *staging;
+    size_t size;
+
+    // signalled when the GPU has finished writing to the staging buffer; NULL once the readback is ready.
+    GLsync fence;
+
+    // true if the staging buffer is persistently mapped (4.4+), in which case `data` points into the mapping.
+    bool persistent;
+    // the read-back data, or NULL if the readback isn't ready yet.
+    void *data;
+} oriReadback;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// create a readback and its staging buffer, and add it to the global linked list.
+static oriReadback *_orionCreateReadback(const size_t size) {
+    oriReadback *r = malloc(sizeof(oriReadback));
+    r->size = size;
+    r->fence = NULL;
+    r->persistent = _orion.glVersion >= 440;
+    r->data = NULL;
+
+    if (r->persistent) {
+        unsigned int flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        r->staging = oriCreateBufferImmutable(size, NULL, flags);
+        oriMapBufferRange(r->staging, 0, size, flags);
+    } else {
+        r->staging = oriCreateBuffer();
+        oriSetBufferData(r->staging, NULL, size, GL_STREAM_READ);
+    }
+
+    // add to global linked list
+    r->next = _orion.readbackListHead;
+    _orion.readbackListHead = r;
+
+    return r;
+}
+
+// the amount of bytes per pixel of the given pixel transfer format and type, or 0 if unknown.
+static unsigned int _orionPixelSize(const unsigned int format, const unsigned int type) {
+    // packed types store the whole pixel in one value
+    switch (type) {
+        case GL_UNSIGNED_BYTE_3_3_2:
+        case GL_UNSIGNED_BYTE_2_3_3_REV:
+            return 1;
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_5_6_5_REV:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+        case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+            return 2;
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_10_10_10_2:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_24_8:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+    }
+
+    unsigned int components;
+    switch (format) {
+        case GL_RED: case GL_GREEN: case GL_BLUE:
+        case GL_RED_INTEGER: case GL_GREEN_INTEGER: case GL_BLUE_INTEGER:
+        case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+            components = 1;
+            break;
+        case GL_RG: case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER:
+            components = 3;
+            break;
+        case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: case GL_BGRA_INTEGER:
+            components = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    switch (type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+            return components * 4;
+        default:
+            return 0;
+    }
+}
+
+// ======================================================================================
+// *****                           ORION READBACK FUNCTIONS                         *****
+// ======================================================================================
+
+/**
+ * @brief Start reading back @c size bytes of the given buffer, starting at @c offset, without stalling the pipeline.
+ *
+ * @details The data is copied into a staging buffer on the GPU timeline and a fence is inserted after the copy. Poll
+ * oriReadbackReady() (e.g. once per frame) and read the result with oriReadbackData() once it returns true; results from
+ * compute or transform feedback passes typically arrive one to three frames later. NULL is returned if the range is out
+ * of the buffer's bounds.
+ *
+ * @param buffer the buffer to read from.
+ * @param offset the offset into the buffer's data store, in bytes.
+ * @param size the amount of bytes to read.
+ *
+ * @ingroup buffers
+ */
+oriReadback *oriReadBufferAsync(oriBuffer *buffer, const size_t offset, const size_t size) {
+    // glCopyBufferSubData and fence sync objects
+    _orionAssertVersion(320);
+
+    if (size == 0 || size > buffer->dataSize || offset > buffer->dataSize - size) {
+        _orionThrowWarning("(in oriReadBufferAsync()): Range is out of the buffer's bounds. Nothing read.");
+        return NULL;
+    }
+
+    oriReadback *r = _orionCreateReadback(size);
+
+    _orionCopyBufferData(buffer, offset, r->staging, 0, size);
+    r->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return r;
+}
+
+/**
+ * @brief Start reading back a block of pixels from the current read framebuffer without stalling the pipeline.
+ *
+ * @details This is the asynchronous equivalent of @c glReadPixels: the pixels are packed into a staging buffer bound at
+ * @c GL_PIXEL_PACK_BUFFER and are available through oriReadbackData() once oriReadbackReady() returns true. Rows are
+ * padded to the current @c GL_PACK_ALIGNMENT, as with @c glReadPixels. NULL is returned if the format/type combination is
+ * not recognised.
+ *
+ * @param x the window x coordinate of the first pixel to read.
+ * @param y the window y coordinate of the first pixel to read.
+ * @param width the width of the block of pixels.
+ * @param height the height of the block of pixels.
+ * @param format the format of the pixel data, e.g. @c GL_RGBA.
+ * @param type the data type of the pixel data, e.g. @c GL_UNSIGNED_BYTE.
+ *
+ * @ingroup buffers
+ */
+oriReadback *oriReadPixelsAsync(const int x, const int y, const unsigned int width, const unsigned int height, const unsigned int format, const unsigned int type) {
+    _orionAssertVersion(320);
+
+    unsigned int pixelSize = _orionPixelSize(format, type);
+    if (pixelSize == 0 || width == 0 || height == 0) {
+        _orionThrowWarning("(in oriReadPixelsAsync()): Unrecognised format/type combination or empty area. Nothing read.");
+        return NULL;
+    }
+
+    int alignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+
+    size_t rowSize = (size_t) width * pixelSize;
+    if (rowSize % alignment) {
+        rowSize += alignment - rowSize % alignment;
+    }
+
+    oriReadback *r = _orionCreateReadback(rowSize * height);
+
+    unsigned int boundCache = oriCurrentBufferAt(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, r->staging->handle);
+
+    // with a pack buffer bound, the pointer is an offset into it
+    glReadPixels(x, y, width, height, format, type, (void *) 0);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, boundCache);
+
+    r->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given readback, whether it is ready or not.
+ *
+ * @param readback the readback to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeReadback(oriReadback *readback) {
+    _orionAssertVersion(320);
+
+    // unlink from global linked list
+    if (_orion.readbackListHead == readback) {
+        _orion.readbackListHead = readback->next;
+    } else {
+        oriReadback *current = _orion.readbackListHead;
+        while (current->next != readback)
+            current = current->next;
+        current->next = readback->next;
+    }
+
+    if (readback->fence) {
+        glDeleteSync(readback->fence);
+    }
+
+    // (the data of a persistent readback is owned by the mapping)
+    if (!readback->persistent) {
+        free(readback->data);
+    }
+
+    // deleting the buffer object implicitly unmaps it
+    oriFreeBuffer(readback->staging);
+
+    free(readback);
+    readback = NULL;
+}
+
+/**
+ * @brief Return true if the GPU has finished the transfer of the given readback. This function never blocks.
+ *
+ * @param readback the readback to poll.
+ *
+ * @ingroup buffers
+ */
+bool oriReadbackReady(oriReadback *readback) {
+    if (!readback->fence) {
+        return true;
+    }
+
+    // a timeout of 0 only polls the fence; the flush makes sure it will eventually be signalled.
+    GLenum status = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+
+    if (readback->persistent) {
+        // GPU writes to a coherent mapping are visible once the fence has been waited on
+        readback->data = readback->staging->mapped;
+    } else {
+        // the copy has finished, so mapping the staging buffer doesn't stall
+        readback->data = malloc(readback->size);
+
+        void *mapped = oriMapBufferRange(readback->staging, 0, readback->size, GL_MAP_READ_BIT);
+        if (mapped) {
+            memcpy(readback->data, mapped, readback->size);
+        }
+        oriUnmapBuffer(readback->staging);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Return the data of the given readback, or NULL if it isn't ready yet (see oriReadbackReady()).
+ *
+ * @details The returned pointer is valid until the readback is freed.
+ *
+ * @param readback the readback to read.
+ * @param size if not NULL, this is set to the size of the data in bytes.
+ *
+ * @ingroup buffers
+ */
+const void *oriReadbackData(oriReadback *readback, size_t *size) {
+    if (!oriReadbackReady(readback)) {
+        _orionThrowWarning("(in oriReadbackData()): The readback is not ready yet. NULL returned.");
+        return NULL;
+    }
+
+    if (size) {
+        *size = readback->size;
+    }
+
+    return readback->data;
+}
@@ -0,0 +1,358 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// the size of each physical buffer when ARB_sparse_buffer isn't supported.
+#define _ORION_SPARSE_CHUNK_SIZE (16u << 20)
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A buffer with a large virtual address range, of which only some pages are backed by memory.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriSparseBuffer {
+    oriSparseBuffer *next;
+
+    size_t virtualSize;
+    // the granularity of commitment: the GL's sparse page size, or the chunk size of the fallback.
+    size_t pageSize;
+    size_t pageCount;
+
+    // true if the buffer uses ARB_sparse_buffer, false if it is emulated with one buffer object per page.
+    bool sparse;
+
+    // sparse: the buffer object with sparse storage.
+    oriBuffer *buffer;
+    // sparse: whether each page is committed.
+    // fallback: the buffer object of each page, or NULL if the page isn't committed.
+    bool *committed;
+    oriBuffer **chunks;
+
+    size_t committedSize;
+} oriSparseBuffer;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// the size of the given page (only the last page can be smaller than the page size).
+static size_t _orionSparsePageSize(oriSparseBuffer *sparse, size_t page) {
+    size_t start = page * sparse->pageSize;
+    return (sparse->virtualSize - start < sparse->pageSize) ? sparse->virtualSize - start : sparse->pageSize;
+}
+
+static bool _orionSparsePageCommitted(oriSparseBuffer *sparse, size_t page) {
+    return sparse->sparse ? sparse->committed[page] : sparse->chunks[page] != NULL;
+}
+
+// commit or decommit a run of pages of a buffer with sparse storage.
+static void _orionSparseCommitRun(oriSparseBuffer *sparse, size_t first, size_t last, bool commit) {
+    size_t offset = first * sparse->pageSize;
+    size_t size = last * sparse->pageSize - offset;
+    // (the last run may end at the end of the buffer rather than on a page boundary)
+    if (size > sparse->virtualSize - offset) {
+        size = sparse->virtualSize - offset;
+    }
+
+    if (_orion.glVersion >= 450 && _orion.extensions.namedBufferPageCommitment) {
+        _orion.extensions.namedBufferPageCommitment(sparse->buffer->handle, offset, size, commit);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(sparse->buffer, GL_ARRAY_BUFFER);
+
+        _orion.extensions.bufferPageCommitment(GL_ARRAY_BUFFER, offset, size, commit);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
+
+// ======================================================================================
+// *****                        ORION SPARSE BUFFER FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriSparseBuffer structure.
+ *
+ * @details Only address space is reserved on creation; memory is committed in pages with oriCommitBufferPages(). If
+ * @c ARB_sparse_buffer is supported (and the GL version is 4.4 or later), the buffer is a single buffer object with sparse
+ * storage. Otherwise, it is emulated with one buffer object per page (see oriGetSparseBufferPageSize()), so data that is
+ * read in one draw call must not straddle a page boundary; use oriGetSparseBufferBuffer() to find the buffer object and
+ * offset to draw from.
+ *
+ * @param virtualSize the size of the buffer's address range in bytes. This can be far larger than the available memory.
+ *
+ * @ingroup buffers
+ */
+oriSparseBuffer *oriCreateSparseBuffer(const size_t virtualSize) {
+    _orionAssertVersion(200);
+
+    if (virtualSize == 0) {
+        _orionThrowError(ORERR_NULL_RECIEVED);
+    }
+
+    oriSparseBuffer *r = malloc(sizeof(oriSparseBuffer));
+    r->virtualSize = virtualSize;
+    r->sparse = _orion.glVersion >= 440 && _orion.extensions.bufferPageCommitment;
+    r->buffer = NULL;
+    r->committed = NULL;
+    r->chunks = NULL;
+    r->committedSize = 0;
+
+    if (r->sparse) {
+        int pageSize;
+        glGetIntegerv(_ORION_GL_SPARSE_BUFFER_PAGE_SIZE_ARB, &pageSize);
+        r->pageSize = pageSize;
+
+        r->buffer = oriCreateBufferImmutable(virtualSize, NULL, _ORION_GL_SPARSE_STORAGE_BIT_ARB | GL_DYNAMIC_STORAGE_BIT);
+    } else {
+        r->pageSize = _ORION_SPARSE_CHUNK_SIZE;
+    }
+
+    r->pageCount = (virtualSize + r->pageSize - 1) / r->pageSize;
+
+    if (r->sparse) {
+        r->committed = calloc(r->pageCount, sizeof(bool));
+    } else {
+        r->chunks = calloc(r->pageCount, sizeof(oriBuffer *));
+    }
+
+    // add to global linked list
+    r->next = _orion.sparseBufferListHead;
+    _orion.sparseBufferListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given sparse buffer, including all of its committed pages.
+ *
+ * @param sparse the sparse buffer to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeSparseBuffer(oriSparseBuffer *sparse) {
+    _orionAssertVersion(200);
+
+    // unlink from global linked list
+    if (_orion.sparseBufferListHead == sparse) {
+        _orion.sparseBufferListHead = sparse->next;
+    } else {
+        oriSparseBuffer *current = _orion.sparseBufferListHead;
+        while (current->next != sparse)
+            current = current->next;
+        current->next = sparse->next;
+    }
+
+    if (sparse->sparse) {
+        // (deleting the buffer object releases its committed pages)
+        oriFreeBuffer(sparse->buffer);
+        free(sparse->committed);
+    } else {
+        for (size_t i = 0; i < sparse->pageCount; i++) {
+            if (sparse->chunks[i]) {
+                oriFreeBuffer(sparse->chunks[i]);
+            }
+        }
+        free(sparse->chunks);
+    }
+
+    free(sparse);
+    sparse = NULL;
+}
+
+/**
+ * @brief Return the granularity, in bytes, with which memory is committed to the given sparse buffer.
+ *
+ * @param sparse the sparse buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+size_t oriGetSparseBufferPageSize(oriSparseBuffer *sparse) {
+    return sparse->pageSize;
+}
+
+/**
+ * @brief Return the amount of bytes of the given sparse buffer that are currently backed by memory.
+ *
+ * @param sparse the sparse buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+size_t oriGetSparseBufferCommittedSize(oriSparseBuffer *sparse) {
+    return sparse->committedSize;
+}
+
+/**
+ * @brief Commit or decommit memory for the pages of a sparse buffer that overlap the given range.
+ *
+ * @details When committing, every page that the range touches is committed. When decommitting, only the pages that lie
+ * completely inside the range are decommitted, so that neighbouring data that shares a page with the range is kept.
+ * The contents of newly committed pages are undefined.
+ *
+ * @param sparse the sparse buffer to modify.
+ * @param offset the offset of the range into the buffer's address range, in bytes.
+ * @param size the size of the range in bytes.
+ * @param commit true to commit memory for the range, false to release it.
+ *
+ * @ingroup buffers
+ */
+void oriCommitBufferPages(oriSparseBuffer *sparse, const size_t offset, const size_t size, const bool commit) {
+    if (size > sparse->virtualSize || offset > sparse->virtualSize - size) {
+        _orionThrowWarning("(in oriCommitBufferPages()): Range is outside of the buffer's address range. Pages not committed.");
+        return;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    size_t end = offset + size;
+    size_t first, last;
+    if (commit) {
+        first = offset / sparse->pageSize;
+        last = (end + sparse->pageSize - 1) / sparse->pageSize;
+    } else {
+        first = (offset + sparse->pageSize - 1) / sparse->pageSize;
+        last = (end == sparse->virtualSize) ? sparse->pageCount : end / sparse->pageSize;
+    }
+
+    size_t runStart = 0;
+    bool inRun = false;
+
+    for (size_t i = first; i < last; i++) {
+        if (_orionSparsePageCommitted(sparse, i) == commit) {
+            // the page is already in the requested state: end the current run of pages to change
+            if (inRun) {
+                _orionSparseCommitRun(sparse, runStart, i, commit);
+                inRun = false;
+            }
+            continue;
+        }
+
+        size_t pageSize = _orionSparsePageSize(sparse, i);
+        sparse->committedSize = commit ? sparse->committedSize + pageSize : sparse->committedSize - pageSize;
+
+        if (!sparse->sparse) {
+            if (commit) {
+                if (_orion.glVersion >= 440) {
+                    sparse->chunks[i] = oriCreateBufferImmutable(pageSize, NULL, GL_DYNAMIC_STORAGE_BIT);
+                } else {
+                    sparse->chunks[i] = oriCreateBuffer();
+                    oriSetBufferData(sparse->chunks[i], NULL, pageSize, GL_STATIC_DRAW);
+                }
+            } else {
+                oriFreeBuffer(sparse->chunks[i]);
+                sparse->chunks[i] = NULL;
+            }
+            continue;
+        }
+
+        sparse->committed[i] = commit;
+        if (!inRun) {
+            runStart = i;
+            inRun = true;
+        }
+    }
+
+    if (inRun) {
+        _orionSparseCommitRun(sparse, runStart, last, commit);
+    }
+}
+
+/**
+ * @brief Return the buffer object that holds the data at the given offset of a sparse buffer, e.g. for use with
+ * oriSpecifyVertexData() or oriBindBuffer().
+ *
+ * @details With @c ARB_sparse_buffer, this is always the same buffer object and @c localOffset is set to @c offset.
+ * Otherwise, it is the buffer object of the page that contains @c offset (or NULL if that page isn't committed), and
+ * @c localOffset is set to the offset into that buffer object.
+ *
+ * @warning The returned buffer is owned by the sparse buffer; do not free it or set its data with oriSetBufferData().
+ *
+ * @param sparse the sparse buffer to inspect.
+ * @param offset the offset into the sparse buffer's address range, in bytes.
+ * @param localOffset if not NULL, this is set to the offset into the returned buffer object that corresponds to @c offset.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriGetSparseBufferBuffer(oriSparseBuffer *sparse, const size_t offset, size_t *localOffset) {
+    if (sparse->sparse) {
+        if (localOffset) {
+            *localOffset = offset;
+        }
+        return sparse->buffer;
+    }
+
+    if (offset >= sparse->virtualSize) {
+        return NULL;
+    }
+
+    if (localOffset) {
+        *localOffset = offset % sparse->pageSize;
+    }
+    return sparse->chunks[offset / sparse->pageSize];
+}
+
+/**
+ * @brief Overwrite part of a sparse buffer's data. Every page that the range touches must be committed.
+ *
+ * @param sparse the sparse buffer to update.
+ * @param offset the offset into the buffer's address range to write to, in bytes.
+ * @param size the size of the given data.
+ * @param data the data to copy into @c sparse.
+ *
+ * @ingroup buffers
+ */
+void oriSetSparseBufferData(oriSparseBuffer *sparse, const size_t offset, const size_t size, const void *data) {
+    if (size > sparse->virtualSize || offset > sparse->virtualSize - size) {
+        _orionThrowWarning("(in oriSetSparseBufferData()): Range is outside of the buffer's address range. Buffer data not updated.");
+        return;
+    }
+
+    size_t end = offset + size;
+    for (size_t i = offset / sparse->pageSize; i * sparse->pageSize < end; i++) {
+        if (!_orionSparsePageCommitted(sparse, i)) {
+            _orionThrowWarning("(in oriSetSparseBufferData()): Range touches pages that aren't committed. Buffer data not updated.");
+            return;
+        }
+    }
+
+    if (sparse->sparse) {
+        oriUpdateBufferRange(sparse->buffer, offset, size, data);
+        return;
+    }
+
+    // split the data between the pages' buffer objects
+    const unsigned char *src = data;
+    size_t current = offset;
+    while (current < end) {
+        size_t page = current / sparse->pageSize;
+        size_t local = current - page * sparse->pageSize;
+        size_t count = _orionSparsePageSize(sparse, page) - local;
+        if (count > end - current) {
+            count = end - current;
+        }
+
+        oriUpdateBufferRange(sparse->chunks[page], local, count, src + (current - offset));
+
+        current += count;
+    }
+}
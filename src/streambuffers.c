@@ -0,0 +1,290 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A persistently-mapped buffer used to stream per-frame data to the GPU.
+ *
+ * @ingroup buffers
+ */
+typedef struct oriStreamBuffer {
+    oriStreamBuffer *next;
+
+    oriBuffer *buffer;
+
+    // true if the storage is immutable and persistently mapped (4.4+), false if it is orphaned every frame instead.
+    bool persistent;
+
+    // persistent: the start of the whole buffer (mapped once at creation).
+    // orphaned: the start of the current mapping, or NULL if the buffer isn't mapped.
+    unsigned char *mapped;
+    // the offset into the buffer that `mapped` points to.
+    size_t mappedOffset;
+
+    size_t regionSize;
+    unsigned int regionCount;
+    // the region that is being written to this frame.
+    unsigned int region;
+    // the write offset within the current region.
+    size_t head;
+
+    // one fence per region; NULL if the region isn't in use by the GPU.
+    GLsync *fences;
+} oriStreamBuffer;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// wait for the GPU to finish reading from the current region, if it hasn't already.
+static void _orionStreamWaitRegion(oriStreamBuffer *stream) {
+    GLsync fence = stream->fences[stream->region];
+    if (!fence) {
+        return;
+    }
+
+    // the timeout is in nanoseconds. In the (expected) case that the region was last read a few frames ago, this returns immediately.
+    GLenum status;
+    do {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    } while (status == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fence);
+    stream->fences[stream->region] = NULL;
+}
+
+// ======================================================================================
+// *****                        ORION STREAM BUFFER FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new oriStreamBuffer structure.
+ *
+ * @details The stream buffer is split into @c regionCount regions of @c regionSize bytes each, one of which is written to
+ * per frame. Each region is guarded by a fence, so the CPU only ever writes to memory that the GPU has finished reading.
+ * On GL 4.4+ the storage is persistently and coherently mapped so that uploads are a plain @c memcpy; on older versions the
+ * buffer is orphaned each frame instead (and @c regionCount is ignored).
+ *
+ * @param regionSize the size, in bytes, of the data that will be streamed per frame.
+ * @param regionCount the amount of frames that can be in flight at once (3 is a sensible default).
+ *
+ * @ingroup buffers
+ */
+oriStreamBuffer *oriCreateStreamBuffer(const size_t regionSize, const unsigned int regionCount) {
+    // glMapBufferRange and fence sync objects are needed even for the fallback.
+    _orionAssertVersion(320);
+
+    if (regionSize == 0) {
+        _orionThrowError(ORERR_NULL_RECIEVED);
+    }
+
+    oriStreamBuffer *r = malloc(sizeof(oriStreamBuffer));
+    r->persistent = _orion.glVersion >= 440;
+    r->mapped = NULL;
+    r->mappedOffset = 0;
+    r->regionSize = regionSize;
+    r->regionCount = (r->persistent && regionCount > 0) ? regionCount : 1;
+    r->region = 0;
+    r->head = 0;
+    r->fences = calloc(r->regionCount, sizeof(GLsync));
+
+    size_t size = r->regionSize * r->regionCount;
+
+    if (r->persistent) {
+        unsigned int flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        r->buffer = oriCreateBufferImmutable(size, NULL, flags);
+        r->mapped = oriMapBufferRange(r->buffer, 0, size, flags);
+    } else {
+        // the buffer is mapped lazily in oriStreamAlloc() instead.
+        r->buffer = oriCreateBuffer();
+        oriSetBufferData(r->buffer, NULL, size, GL_STREAM_DRAW);
+    }
+
+    // add to global linked list
+    r->next = _orion.streamBufferListHead;
+    _orion.streamBufferListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given stream buffer.
+ *
+ * @param stream the stream buffer to free.
+ *
+ * @ingroup buffers
+ */
+void oriFreeStreamBuffer(oriStreamBuffer *stream) {
+    _orionAssertVersion(320);
+
+    // unlink from global linked list
+    if (_orion.streamBufferListHead == stream) {
+        _orion.streamBufferListHead = stream->next;
+    } else {
+        oriStreamBuffer *current = _orion.streamBufferListHead;
+        while (current->next != stream)
+            current = current->next;
+        current->next = stream->next;
+    }
+
+    for (unsigned int i = 0; i < stream->regionCount; i++) {
+        if (stream->fences[i]) {
+            glDeleteSync(stream->fences[i]);
+        }
+    }
+    free(stream->fences);
+
+    // deleting the buffer object implicitly unmaps it
+    oriFreeBuffer(stream->buffer);
+
+    free(stream);
+    stream = NULL;
+}
+
+/**
+ * @brief Return the oriBuffer that backs the given stream buffer, e.g. for use with oriSpecifyVertexData() or oriBindBuffer().
+ *
+ * @warning The returned buffer is owned by the stream buffer; do not free it or set its data with oriSetBufferData().
+ *
+ * @param stream the stream buffer to inspect.
+ *
+ * @ingroup buffers
+ */
+oriBuffer *oriGetStreamBufferBuffer(oriStreamBuffer *stream) {
+    return stream->buffer;
+}
+
+/**
+ * @brief Allocate @c size bytes from the current frame's region of the given stream buffer.
+ *
+ * @details The returned pointer is write-only. If the region doesn't have enough space left, a warning is sent and a NULL
+ * pointer is returned.
+ *
+ * @param stream the stream buffer to allocate from.
+ * @param size the size of the allocation in bytes.
+ * @param align the alignment of the allocation's offset in bytes. Set to 0 or 1 if not applicable.
+ *
+ * @ingroup buffers
+ */
+oriStreamAllocation oriStreamAlloc(oriStreamBuffer *stream, const size_t size, const unsigned int align) {
+    oriStreamAllocation r = { NULL, 0 };
+
+    size_t regionStart = (size_t) stream->region * stream->regionSize;
+
+    // (the offset into the whole buffer is aligned, as regions don't necessarily start at a multiple of the alignment)
+    size_t offset = regionStart + stream->head;
+    if (align > 1 && offset % align) {
+        offset += align - offset % align;
+    }
+    size_t head = offset - regionStart;
+
+    if (head > stream->regionSize || size > stream->regionSize - head) {
+        _orionThrowWarning("(in oriStreamAlloc()): Not enough space left in the stream buffer's region for this frame. Nothing allocated.");
+        return r;
+    }
+
+    // the first allocation of the frame has to make sure the GPU is done with the region.
+    if (stream->persistent && stream->head == 0) {
+        _orionStreamWaitRegion(stream);
+    }
+
+    if (!stream->persistent && !stream->mapped) {
+        // the range past the write head hasn't been used yet this frame, so there is nothing to synchronise with.
+        stream->mapped = oriMapBufferRange(stream->buffer, regionStart + head, stream->regionSize - head,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        stream->mappedOffset = regionStart + head;
+
+        if (!stream->mapped) {
+            _orionThrowWarning("(in oriStreamAlloc()): Failed to map the stream buffer. Nothing allocated.");
+            return r;
+        }
+    }
+
+    r.offset = regionStart + head;
+    r.ptr = stream->mapped + (r.offset - stream->mappedOffset);
+
+    stream->head = head + size;
+
+    return r;
+}
+
+/**
+ * @brief Make the data written to the given stream buffer this frame visible to the GPU.
+ *
+ * @details This must be called after writing and @b before issuing any draw calls that read the streamed data. It is a
+ * no-op when the stream buffer is persistently mapped.
+ *
+ * @param stream the stream buffer to flush.
+ *
+ * @ingroup buffers
+ */
+void oriFlushStreamBuffer(oriStreamBuffer *stream) {
+    // coherent mappings don't need to be flushed
+    if (stream->persistent) {
+        return;
+    }
+
+    oriUnmapBuffer(stream->buffer);
+    stream->mapped = NULL;
+}
+
+/**
+ * @brief Finish the current frame's region and move on to the next one.
+ *
+ * @details Call this once per frame, @b after the draw calls that read the streamed data have been issued.
+ *
+ * @param stream the stream buffer to advance.
+ *
+ * @ingroup buffers
+ */
+void oriAdvanceStreamBuffer(oriStreamBuffer *stream) {
+    stream->head = 0;
+
+    if (stream->persistent) {
+        // fence off the region that was just used; it will be waited on (lazily) when it comes back around. (if nothing
+        // was allocated from it this frame, the fence from its last use was never waited on, and is replaced)
+        if (stream->fences[stream->region]) {
+            glDeleteSync(stream->fences[stream->region]);
+        }
+        stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stream->region = (stream->region + 1) % stream->regionCount;
+
+        return;
+    }
+
+    // orphan the buffer so that next frame's writes don't have to wait for this frame's draws
+    oriUnmapBuffer(stream->buffer);
+    stream->mapped = NULL;
+
+    // (a NULL data pointer with an unchanged size is simply uploaded with glBufferSubData, so reallocate explicitly)
+    if (_orion.glVersion >= 450) {
+        glNamedBufferData(stream->buffer->handle, stream->buffer->dataSize, NULL, GL_STREAM_DRAW);
+    } else {
+        unsigned int boundCache = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+        oriBindBuffer(stream->buffer, GL_ARRAY_BUFFER);
+
+        glBufferData(GL_ARRAY_BUFFER, stream->buffer->dataSize, NULL, GL_STREAM_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, boundCache);
+    }
+}
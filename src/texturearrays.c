@@ -0,0 +1,324 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief One 2D array texture of a pool bucket, and the layers of it that aren't allocated.
+ *
+ */
+typedef struct _oriPoolArray {
+    struct _oriPoolArray *next;
+
+    oriTexture *texture;
+
+    // (a stack of free layer indices)
+    unsigned int *freeLayers;
+    unsigned int freeCount;
+} _oriPoolArray;
+
+/**
+ * @brief The arrays of a texture array pool that hold layers of one size, format and level count.
+ *
+ */
+typedef struct _oriPoolBucket {
+    struct _oriPoolBucket *next;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int internalFormat;
+    unsigned int levels;
+
+    _oriPoolArray *arrays;
+} _oriPoolBucket;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A set of 2D array textures that same-sized textures are allocated from as layers.
+ *
+ */
+typedef struct oriTextureArrayPool {
+    oriTextureArrayPool *next;
+
+    unsigned int layersPerArray;
+    _oriPoolBucket *buckets;
+} oriTextureArrayPool;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static _oriPoolBucket *_orionFindPoolBucket(oriTextureArrayPool *pool, unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levels) {
+    for (_oriPoolBucket *bucket = pool->buckets; bucket; bucket = bucket->next) {
+        if (bucket->width == width && bucket->height == height && bucket->internalFormat == internalFormat && bucket->levels == levels) {
+            return bucket;
+        }
+    }
+
+    return NULL;
+}
+
+// allocate a new array for the bucket with every layer free.
+static _oriPoolArray *_orionCreatePoolArray(oriTextureArrayPool *pool, _oriPoolBucket *bucket) {
+    _oriPoolArray *r = malloc(sizeof(_oriPoolArray));
+
+    r->texture = oriCreateTextureImmutable(GL_TEXTURE_2D_ARRAY, bucket->width, bucket->height, pool->layersPerArray, bucket->internalFormat, bucket->levels, 0, false);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_MIN_FILTER, (bucket->levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // (hand out the lowest layers first)
+    r->freeLayers = malloc(pool->layersPerArray * sizeof(unsigned int));
+    for (unsigned int i = 0; i < pool->layersPerArray; i++) {
+        r->freeLayers[i] = pool->layersPerArray - 1 - i;
+    }
+    r->freeCount = pool->layersPerArray;
+
+    r->next = bucket->arrays;
+    bucket->arrays = r;
+
+    return r;
+}
+
+static void _orionFreePoolArray(_oriPoolArray *array) {
+    oriFreeTexture(array->texture);
+    free(array->freeLayers);
+    free(array);
+}
+
+// ======================================================================================
+// *****                    ORION TEXTURE ARRAY POOL FUNCTIONS                      *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new texture array pool.
+ *
+ * @details Textures that share their size, internal format and level count are allocated as layers of the same 2D array
+ * texture (see oriAllocateTextureArrayLayer()), instead of as textures of their own. Draws that use any of them can then
+ * bind the array once and select the texture with the layer index, e.g. from a uniform, an instance attribute or a
+ * material buffer, so that they can be batched together (sample it with a @c sampler2DArray).
+ *
+ * Each array is created with immutable storage for @c layersPerArray layers when the first layer of its size is
+ * allocated, and another is created when it is full.
+ *
+ * @param layersPerArray the amount of layers in each array texture; at most @c GL_MAX_ARRAY_TEXTURE_LAYERS. As the
+ * storage for every layer is allocated with the array, this trades memory held in reserve for fewer arrays to bind.
+ *
+ * @ingroup textures
+ */
+oriTextureArrayPool *oriCreateTextureArrayPool(unsigned int layersPerArray) {
+    _orionAssertVersion(420);
+
+    int maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (!layersPerArray || layersPerArray > (unsigned int) maxLayers) {
+        _orionThrowWarning("(in oriCreateTextureArrayPool()): Layer count is 0 or above GL_MAX_ARRAY_TEXTURE_LAYERS. Texture array pool not created.");
+        return NULL;
+    }
+
+    oriTextureArrayPool *r = malloc(sizeof(oriTextureArrayPool));
+    r->layersPerArray = layersPerArray;
+    r->buckets = NULL;
+
+    // push to global linked list
+    r->next = _orion.textureArrayPoolListHead;
+    _orion.textureArrayPoolListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given texture array pool, including all of its array textures.
+ *
+ * @param pool the texture array pool to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureArrayPool(oriTextureArrayPool *pool) {
+    // unlink from global linked list.
+    if (_orion.textureArrayPoolListHead == pool) {
+        _orion.textureArrayPoolListHead = pool->next;
+    } else {
+        oriTextureArrayPool *current = _orion.textureArrayPoolListHead;
+        while (current->next != pool)
+            current = current->next;
+        current->next = pool->next;
+    }
+
+    while (pool->buckets) {
+        _oriPoolBucket *bucket = pool->buckets;
+        pool->buckets = bucket->next;
+
+        while (bucket->arrays) {
+            _oriPoolArray *array = bucket->arrays;
+            bucket->arrays = array->next;
+            _orionFreePoolArray(array);
+        }
+
+        free(bucket);
+    }
+
+    free(pool);
+    pool = NULL;
+}
+
+/**
+ * @brief Allocate a layer for a texture with the given size, internal format and level count from the given pool.
+ *
+ * @details The layer is taken from an array with the same size, format and level count that has a free layer, or from
+ * a new array if none do. Its contents are undefined until they are uploaded, e.g. with oriUploadTextureArrayLayer().
+ *
+ * @param pool the texture array pool to allocate from.
+ * @param width the width of the texture.
+ * @param height the height of the texture.
+ * @param internalFormat the internal format of the texture, e.g. @c GL_RGBA8.
+ * @param levels the amount of mipmap levels of the texture.
+ * @param layer the array texture and layer index that were allocated.
+ *
+ * @ingroup textures
+ */
+void oriAllocateTextureArrayLayer(oriTextureArrayPool *pool, unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levels, oriTextureLayer *layer) {
+    if (!levels) {
+        levels = 1;
+    }
+
+    _oriPoolBucket *bucket = _orionFindPoolBucket(pool, width, height, internalFormat, levels);
+    if (!bucket) {
+        bucket = malloc(sizeof(_oriPoolBucket));
+        bucket->width = width;
+        bucket->height = height;
+        bucket->internalFormat = internalFormat;
+        bucket->levels = levels;
+        bucket->arrays = NULL;
+
+        bucket->next = pool->buckets;
+        pool->buckets = bucket;
+    }
+
+    _oriPoolArray *array = bucket->arrays;
+    while (array && !array->freeCount) {
+        array = array->next;
+    }
+    if (!array) {
+        array = _orionCreatePoolArray(pool, bucket);
+    }
+
+    layer->array = array->texture;
+    layer->layer = array->freeLayers[--array->freeCount];
+}
+
+/**
+ * @brief Return a layer allocated with oriAllocateTextureArrayLayer() to its pool, so that it can be allocated again.
+ *
+ * @details The layer's contents are left as they are. Arrays that have no layers allocated are kept until
+ * oriTrimTextureArrayPool() is called.
+ *
+ * @param pool the texture array pool the layer was allocated from.
+ * @param layer the layer to release.
+ *
+ * @ingroup textures
+ */
+void oriReleaseTextureArrayLayer(oriTextureArrayPool *pool, const oriTextureLayer *layer) {
+    for (_oriPoolBucket *bucket = pool->buckets; bucket; bucket = bucket->next) {
+        for (_oriPoolArray *array = bucket->arrays; array; array = array->next) {
+            if (array->texture != layer->array) {
+                continue;
+            }
+
+            if (layer->layer >= pool->layersPerArray || array->freeCount == pool->layersPerArray) {
+                _orionThrowWarning("(in oriReleaseTextureArrayLayer()): Layer is out of range or its array has no layers allocated. Layer not released.");
+                return;
+            }
+            for (unsigned int i = 0; i < array->freeCount; i++) {
+                if (array->freeLayers[i] == layer->layer) {
+                    _orionThrowWarning("(in oriReleaseTextureArrayLayer()): Layer has already been released. Layer not released.");
+                    return;
+                }
+            }
+
+            array->freeLayers[array->freeCount++] = layer->layer;
+            return;
+        }
+    }
+
+    _orionThrowWarning("(in oriReleaseTextureArrayLayer()): Layer was not allocated from this pool. Layer not released.");
+}
+
+/**
+ * @brief Free every array of the given texture array pool that has no layers allocated.
+ *
+ * @param pool the texture array pool to trim.
+ *
+ * @ingroup textures
+ */
+void oriTrimTextureArrayPool(oriTextureArrayPool *pool) {
+    for (_oriPoolBucket *bucket = pool->buckets; bucket; bucket = bucket->next) {
+        _oriPoolArray **link = &bucket->arrays;
+        while (*link) {
+            _oriPoolArray *array = *link;
+            if (array->freeCount == pool->layersPerArray) {
+                *link = array->next;
+                _orionFreePoolArray(array);
+            } else {
+                link = &array->next;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fill the mipmap levels of a layer allocated with oriAllocateTextureArrayLayer() with the given images.
+ *
+ * @details Mipmaps can't be generated with the GL for one layer alone (glGenerateMipmap() would regenerate every layer
+ * of the array), so the levels are uploaded as they are given; oriGenerateMipChain() can build them on the CPU. Any
+ * levels that aren't given are left undefined.
+ *
+ * @param layer the layer to update.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows.
+ * @param levelCount the amount of levels to upload; at most the level count the layer was allocated with.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriUploadTextureArrayLayer(const oriTextureLayer *layer, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int imageFormat) {
+    oriTexture *texture = layer->array;
+
+    if (levelCount > texture->levels) {
+        _orionThrowWarning("(in oriUploadTextureArrayLayer()): Level count is above the layer's level count. Extra levels not uploaded.");
+        levelCount = texture->levels;
+    }
+
+    // (the small levels of 1- and 3-channel images aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (unsigned int level = 0; level < levelCount; level++) {
+        unsigned int w = (texture->width >> level) ? (texture->width >> level) : 1;
+        unsigned int h = (texture->height >> level) ? (texture->height >> level) : 1;
+        oriUploadTexSubImage(texture, level, 0, 0, layer->layer, w, h, 1, dataType, levels[level], imageFormat);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
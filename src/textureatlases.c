@@ -0,0 +1,460 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A segment of the skyline of an atlas layer: the lowest free row over a span of columns.
+ *
+ */
+typedef struct _oriSkylineNode {
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+} _oriSkylineNode;
+
+/**
+ * @brief One layer of an atlas: its skyline (sorted by x, covering the whole width) and the shadow its images are
+ * written to.
+ *
+ */
+typedef struct _oriAtlasLayer {
+    _oriSkylineNode *nodes;
+    unsigned int nodeCount;
+
+    oriTextureShadow *shadow;
+} _oriAtlasLayer;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A 2D array texture that images are packed into at runtime.
+ *
+ */
+typedef struct oriTextureAtlas {
+    oriTextureAtlas *next;
+
+    oriTexture *texture;
+    unsigned int width;
+    unsigned int height;
+    unsigned int internalFormat;
+    unsigned int imageFormat;
+    unsigned int dataType;
+    unsigned int levels;
+    unsigned int padding;
+    size_t texelSize;
+
+    _oriAtlasLayer *layers;
+    unsigned int layerCount;
+
+    // true if images have been inserted since the last call to oriUpdateTextureAtlas()
+    bool changed;
+} oriTextureAtlas;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// reset a layer's skyline to a single segment at the bottom.
+static void _orionResetSkyline(_oriAtlasLayer *layer, unsigned int width) {
+    layer->nodes[0].x = 0;
+    layer->nodes[0].y = 0;
+    layer->nodes[0].width = width;
+    layer->nodeCount = 1;
+}
+
+// return the lowest row at which a rectangle of the given width fits over the skyline from node i, or UINT_MAX if it
+// runs off the right of the layer.
+static unsigned int _orionSkylineFit(_oriAtlasLayer *layer, unsigned int i, unsigned int width, unsigned int atlasWidth) {
+    if (layer->nodes[i].x + width > atlasWidth) {
+        return (unsigned int) -1;
+    }
+
+    unsigned int y = 0;
+    unsigned int remaining = width;
+    for (; i < layer->nodeCount && remaining; i++) {
+        if (layer->nodes[i].y > y) {
+            y = layer->nodes[i].y;
+        }
+        remaining = (layer->nodes[i].width >= remaining) ? 0 : remaining - layer->nodes[i].width;
+    }
+
+    return y;
+}
+
+// find a place for a rectangle in the layer with the bottom-left skyline heuristic, and raise the skyline over it.
+static bool _orionSkylineInsert(oriTextureAtlas *atlas, _oriAtlasLayer *layer, unsigned int width, unsigned int height, unsigned int *x, unsigned int *y) {
+    unsigned int best = (unsigned int) -1;
+    unsigned int bestTop = (unsigned int) -1;
+    unsigned int bestWidth = (unsigned int) -1;
+    unsigned int bestY = 0;
+
+    for (unsigned int i = 0; i < layer->nodeCount; i++) {
+        unsigned int fit = _orionSkylineFit(layer, i, width, atlas->width);
+        if (fit == (unsigned int) -1 || fit + height > atlas->height) {
+            continue;
+        }
+
+        // (prefer the lowest top edge, then the narrowest segment so that wide gaps are kept for wide images)
+        if (fit + height < bestTop || (fit + height == bestTop && layer->nodes[i].width < bestWidth)) {
+            best = i;
+            bestTop = fit + height;
+            bestWidth = layer->nodes[i].width;
+            bestY = fit;
+        }
+    }
+
+    if (best == (unsigned int) -1) {
+        return false;
+    }
+
+    *x = layer->nodes[best].x;
+    *y = bestY;
+
+    // insert the new segment (there are at most width + 1 nodes, which the array was allocated for)
+    memmove(&layer->nodes[best + 1], &layer->nodes[best], (layer->nodeCount - best) * sizeof(_oriSkylineNode));
+    layer->nodes[best].x = *x;
+    layer->nodes[best].y = bestY + height;
+    layer->nodes[best].width = width;
+    layer->nodeCount++;
+
+    // shrink or remove the segments it covers
+    unsigned int right = *x + width;
+    unsigned int i = best + 1;
+    while (i < layer->nodeCount && layer->nodes[i].x < right) {
+        unsigned int end = layer->nodes[i].x + layer->nodes[i].width;
+        if (end <= right) {
+            memmove(&layer->nodes[i], &layer->nodes[i + 1], (layer->nodeCount - i - 1) * sizeof(_oriSkylineNode));
+            layer->nodeCount--;
+        } else {
+            layer->nodes[i].width = end - right;
+            layer->nodes[i].x = right;
+            break;
+        }
+    }
+
+    // merge neighbouring segments at the same height
+    for (i = 0; i + 1 < layer->nodeCount;) {
+        if (layer->nodes[i].y == layer->nodes[i + 1].y) {
+            layer->nodes[i].width += layer->nodes[i + 1].width;
+            memmove(&layer->nodes[i + 1], &layer->nodes[i + 2], (layer->nodeCount - i - 2) * sizeof(_oriSkylineNode));
+            layer->nodeCount--;
+        } else {
+            i++;
+        }
+    }
+
+    return true;
+}
+
+// add an empty layer to the atlas, reallocating its texture with one more layer and re-uploading the others.
+static bool _orionGrowTextureAtlas(oriTextureAtlas *atlas) {
+    int maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (atlas->layerCount >= (unsigned int) maxLayers) {
+        return false;
+    }
+
+    unsigned int count = atlas->layerCount + 1;
+    oriTexture *texture = atlas->texture;
+
+    // (immutable storage can't be resized, so the texture gets a new handle with the same sampling parameters)
+    static const unsigned int parameters[] = {
+        GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T
+    };
+    int values[sizeof(parameters) / sizeof(parameters[0])];
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        values[i] = oriGetTextureParameteri(texture, parameters[i]);
+    }
+
+    oriTexture *grown = oriCreateTextureImmutable(GL_TEXTURE_2D_ARRAY, atlas->width, atlas->height, count, atlas->internalFormat, atlas->levels, 0, false);
+
+    unsigned int handle = texture->handle;
+    texture->handle = grown->handle;
+    texture->depth = count;
+    grown->handle = handle;
+    oriFreeTexture(grown);
+
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        oriSetTextureParameteri(texture, parameters[i], values[i]);
+    }
+
+    atlas->layers = realloc(atlas->layers, count * sizeof(_oriAtlasLayer));
+
+    _oriAtlasLayer *layer = &atlas->layers[atlas->layerCount];
+    layer->nodes = malloc((atlas->width + 1) * sizeof(_oriSkylineNode));
+    layer->shadow = oriCreateTextureShadow(texture, 0, atlas->layerCount, atlas->dataType, atlas->imageFormat, NULL);
+    _orionResetSkyline(layer, atlas->width);
+
+    // the existing layers' contents were lost with the old storage, so upload them again from their shadows
+    for (unsigned int i = 0; i < atlas->layerCount; i++) {
+        oriMarkTextureShadowDirty(atlas->layers[i].shadow, 0, 0, atlas->width, atlas->height);
+    }
+
+    atlas->layerCount = count;
+    atlas->changed = true;
+
+    return true;
+}
+
+// copy an image into a shadow with its edges repeated into the padding around it.
+static void _orionWritePaddedImage(oriTextureAtlas *atlas, oriTextureShadow *shadow, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char *data) {
+    unsigned char *dst = oriGetTextureShadowData(shadow);
+    unsigned int padding = atlas->padding;
+    size_t texel = atlas->texelSize;
+    size_t pitch = (size_t) atlas->width * texel;
+
+    for (unsigned int row = 0; row < height + 2 * padding; row++) {
+        // (padding rows repeat the nearest image row)
+        unsigned int srcRow = (row < padding) ? 0 : ((row - padding >= height) ? height - 1 : row - padding);
+        const unsigned char *src = data + (size_t) srcRow * width * texel;
+        unsigned char *out = dst + (size_t) (y + row) * pitch + (size_t) x * texel;
+
+        for (unsigned int col = 0; col < padding; col++) {
+            memcpy(out + col * texel, src, texel);
+        }
+        memcpy(out + padding * texel, src, width * texel);
+        for (unsigned int col = 0; col < padding; col++) {
+            memcpy(out + (padding + width + col) * texel, src + (width - 1) * texel, texel);
+        }
+    }
+
+    oriMarkTextureShadowDirty(shadow, x, y, width + 2 * padding, height + 2 * padding);
+}
+
+// ======================================================================================
+// *****                        ORION TEXTURE ATLAS FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new texture atlas: a 2D array texture that images can be packed into at runtime.
+ *
+ * @details Many small images (e.g. UI elements, glyphs or sprites) can be packed into one atlas, so that they are drawn
+ * with the same texture binding and can be batched together. Images are inserted with oriInsertTextureAtlasImage(),
+ * which places them with a skyline packer and returns where they were placed. When a layer is full, a layer is added to
+ * the array.
+ *
+ * Inserted images are written to a CPU copy of each layer (see oriTextureShadow) and uploaded by
+ * oriUpdateTextureAtlas(), which should be called once per frame before drawing with the atlas.
+ *
+ * The texture starts with one layer, linear filtering (trilinear if it has more than one level) and clamp-to-edge
+ * wrapping; sample it with a @c sampler2DArray.
+ *
+ * @param width the width of each layer of the atlas, in texels.
+ * @param height the height of each layer of the atlas, in texels.
+ * @param internalFormat the internal format of the texture, e.g. @c GL_RGBA8.
+ * @param imageFormat the format of the images that will be inserted, e.g. @c GL_RGBA.
+ * @param dataType the GL type of the images that will be inserted, e.g. @c GL_UNSIGNED_BYTE.
+ * @param levels the amount of mipmap levels of the texture.
+ * @param padding the amount of texels around each image that its edges are repeated into, so that filtering doesn't
+ * bleed neighbouring images into it. For mipmapped atlases, this should be at least 2 to the power of (levels - 1) to
+ * keep the smallest levels clean.
+ *
+ * @ingroup textures
+ */
+oriTextureAtlas *oriCreateTextureAtlas(unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int imageFormat, unsigned int dataType, unsigned int levels, unsigned int padding) {
+    _orionAssertVersion(420);
+
+    size_t texelSize = _orionTexelSize(imageFormat, dataType);
+    if (!texelSize) {
+        _orionThrowWarning("(in oriCreateTextureAtlas()): Unsupported image format or data type specified. Texture atlas not created.");
+        return NULL;
+    }
+
+    oriTextureAtlas *r = malloc(sizeof(oriTextureAtlas));
+    r->width = width;
+    r->height = height;
+    r->internalFormat = internalFormat;
+    r->imageFormat = imageFormat;
+    r->dataType = dataType;
+    r->levels = levels ? levels : 1;
+    r->padding = padding;
+    r->texelSize = texelSize;
+    r->changed = false;
+
+    r->texture = oriCreateTextureImmutable(GL_TEXTURE_2D_ARRAY, width, height, 1, internalFormat, r->levels, 0, false);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_MIN_FILTER, (r->levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    oriSetTextureParameteri(r->texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    r->layers = malloc(sizeof(_oriAtlasLayer));
+    r->layers[0].nodes = malloc((width + 1) * sizeof(_oriSkylineNode));
+    r->layers[0].shadow = oriCreateTextureShadow(r->texture, 0, 0, dataType, imageFormat, NULL);
+    _orionResetSkyline(&r->layers[0], width);
+    r->layerCount = 1;
+
+    // the storage isn't initialised, so clear it from the (zeroed) shadow
+    oriMarkTextureShadowDirty(r->layers[0].shadow, 0, 0, width, height);
+    r->changed = true;
+
+    // push to global linked list
+    r->next = _orion.textureAtlasListHead;
+    _orion.textureAtlasListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given texture atlas, including its texture.
+ *
+ * @param atlas the texture atlas to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureAtlas(oriTextureAtlas *atlas) {
+    // unlink from global linked list.
+    if (_orion.textureAtlasListHead == atlas) {
+        _orion.textureAtlasListHead = atlas->next;
+    } else {
+        oriTextureAtlas *current = _orion.textureAtlasListHead;
+        while (current->next != atlas)
+            current = current->next;
+        current->next = atlas->next;
+    }
+
+    for (unsigned int i = 0; i < atlas->layerCount; i++) {
+        oriFreeTextureShadow(atlas->layers[i].shadow);
+        free(atlas->layers[i].nodes);
+    }
+    free(atlas->layers);
+
+    oriFreeTexture(atlas->texture);
+
+    free(atlas);
+    atlas = NULL;
+}
+
+/**
+ * @brief Pack an image into the given texture atlas.
+ *
+ * @details The image is placed in the first layer with room for it (with its padding), at the lowest position the
+ * skyline packer finds; if no layer has room, a layer is added. Adding a layer reallocates the texture's storage, so
+ * every layer is uploaded again by the next call to oriUpdateTextureAtlas(). The handle of the atlas' texture changes,
+ * but the oriTexture returned by oriGetTextureAtlasTexture() stays the same.
+ *
+ * Texture coordinates in @c region cover the image without its padding, with v = 0 at its first row.
+ *
+ * @param atlas the texture atlas to insert into.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param data the image, with tightly packed rows, in the format and type given to oriCreateTextureAtlas().
+ * @param region the location of the image in the atlas. Not written to if the image couldn't be inserted.
+ * @return true if the image was inserted, or false if it is larger than a layer or no more layers can be added.
+ *
+ * @ingroup textures
+ */
+bool oriInsertTextureAtlasImage(oriTextureAtlas *atlas, unsigned int width, unsigned int height, const void *data, oriAtlasRegion *region) {
+    unsigned int paddedWidth = width + 2 * atlas->padding;
+    unsigned int paddedHeight = height + 2 * atlas->padding;
+
+    if (!width || !height || paddedWidth > atlas->width || paddedHeight > atlas->height) {
+        _orionThrowWarning("(in oriInsertTextureAtlasImage()): Image is empty or larger than a layer of the atlas. Image not inserted.");
+        return false;
+    }
+
+    unsigned int layer = 0;
+    unsigned int x, y;
+    while (!_orionSkylineInsert(atlas, &atlas->layers[layer], paddedWidth, paddedHeight, &x, &y)) {
+        if (++layer == atlas->layerCount && !_orionGrowTextureAtlas(atlas)) {
+            _orionThrowWarning("(in oriInsertTextureAtlasImage()): Atlas is full and no more layers can be added. Image not inserted.");
+            return false;
+        }
+    }
+
+    _orionWritePaddedImage(atlas, atlas->layers[layer].shadow, x, y, width, height, data);
+    atlas->changed = true;
+
+    region->layer = layer;
+    region->x = x + atlas->padding;
+    region->y = y + atlas->padding;
+    region->width = width;
+    region->height = height;
+    region->u0 = (float) region->x / atlas->width;
+    region->v0 = (float) region->y / atlas->height;
+    region->u1 = (float) (region->x + width) / atlas->width;
+    region->v1 = (float) (region->y + height) / atlas->height;
+
+    return true;
+}
+
+/**
+ * @brief Upload the images inserted into the given texture atlas since the last call, and regenerate its mipmaps if it
+ * has any.
+ *
+ * @details The images are uploaded with oriFlushTextureShadows(), so this also flushes every other texture shadow.
+ *
+ * @param atlas the texture atlas to update.
+ *
+ * @ingroup textures
+ */
+void oriUpdateTextureAtlas(oriTextureAtlas *atlas) {
+    if (!atlas->changed) {
+        return;
+    }
+
+    oriFlushTextureShadows();
+    if (atlas->levels > 1) {
+        oriGenerateTextureMipmaps(atlas->texture);
+    }
+
+    atlas->changed = false;
+}
+
+/**
+ * @brief Forget every image packed into the given texture atlas, so that its space can be reused.
+ *
+ * @details The texels of the atlas aren't cleared; images inserted afterwards overwrite them.
+ *
+ * @param atlas the texture atlas to reset.
+ *
+ * @ingroup textures
+ */
+void oriResetTextureAtlas(oriTextureAtlas *atlas) {
+    for (unsigned int i = 0; i < atlas->layerCount; i++) {
+        _orionResetSkyline(&atlas->layers[i], atlas->width);
+    }
+}
+
+/**
+ * @brief Return the 2D array texture of the given texture atlas.
+ *
+ * @param atlas the texture atlas to inspect.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetTextureAtlasTexture(oriTextureAtlas *atlas) {
+    return atlas->texture;
+}
+
+/**
+ * @brief Return the amount of layers in the given texture atlas.
+ *
+ * @param atlas the texture atlas to inspect.
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetTextureAtlasLayerCount(oriTextureAtlas *atlas) {
+    return atlas->layerCount;
+}
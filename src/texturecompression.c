@@ -0,0 +1,738 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// the palette search is picked at compile time, as in vertexpacking.c.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define _ORION_SSE2
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   define _ORION_NEON
+#endif
+
+#if defined(_ORION_SSE2)
+#   include <emmintrin.h>
+#endif
+#if defined(_ORION_NEON)
+#   include <arm_neon.h>
+#endif
+
+// the most jobs that oriCompressImage() splits an image into.
+#define _ORION_MAX_COMPRESS_JOBS 16
+
+// identifies texture cache files, and is bumped whenever the encoders change so that stale entries are re-encoded.
+#define _ORION_CACHE_MAGIC 0x4342524F // "ORBC"
+#define _ORION_CACHE_VERSION 1
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A band of block rows of an image compressed by one worker thread (see oriCompressImage()).
+ *
+ */
+typedef struct _oriCompressJob {
+    // (must be first, as the worker is given a pointer to it)
+    _oriJob job;
+
+    const unsigned char *image;
+    unsigned int width;
+    unsigned int height;
+    unsigned int channels;
+    unsigned int format;
+    unsigned char *dst;
+
+    unsigned int firstRow;
+    unsigned int rowCount;
+} _oriCompressJob;
+
+/**
+ * @brief The header of a texture cache file, followed by the compressed levels one after the other.
+ *
+ */
+typedef struct _oriCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levels;
+    uint64_t size;
+} _oriCacheHeader;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+unsigned int _orionBlockSize(unsigned int format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+uint64_t _orionHashBytes(const void *data, size_t size, uint64_t seed) {
+    // (FNV-1a over 8-byte words, with the tail hashed byte by byte)
+    const uint64_t prime = 0x100000001B3ull;
+    const unsigned char *bytes = data;
+    uint64_t h = seed ^ 0xCBF29CE484222325ull;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++) {
+        h = (h ^ bytes[i]) * prime;
+    }
+
+    return h;
+}
+
+// fetch a 4x4 block as RGBA (repeating the edge texels of images that aren't a multiple of 4 in size).
+static void _orionFetchBlock(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int bx, unsigned int by, unsigned char block[64]) {
+    for (unsigned int y = 0; y < 4; y++) {
+        unsigned int sy = (by * 4 + y < height) ? by * 4 + y : height - 1;
+
+        for (unsigned int x = 0; x < 4; x++) {
+            unsigned int sx = (bx * 4 + x < width) ? bx * 4 + x : width - 1;
+            const unsigned char *src = image + ((size_t) sy * width + sx) * channels;
+            unsigned char *dst = block + (y * 4 + x) * 4;
+
+            for (unsigned int c = 0; c < 4; c++) {
+                dst[c] = (c < channels) ? src[c] : ((c == 3) ? 255 : 0);
+            }
+        }
+    }
+}
+
+// return the index of the palette entry (4 floats each) nearest to the pixel.
+static unsigned int _orionNearestEntry(const float pixel[4], const float *palette, unsigned int count) {
+    unsigned int best = 0;
+    float bestDistance = 3.4e38f;
+
+#if defined(_ORION_SSE2)
+    __m128 p = _mm_loadu_ps(pixel);
+    for (unsigned int i = 0; i < count; i++) {
+        __m128 d = _mm_sub_ps(p, _mm_loadu_ps(palette + i * 4));
+        d = _mm_mul_ps(d, d);
+        d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2)));
+        d = _mm_add_ss(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        float distance = _mm_cvtss_f32(d);
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+#elif defined(_ORION_NEON)
+    float32x4_t p = vld1q_f32(pixel);
+    for (unsigned int i = 0; i < count; i++) {
+        float32x4_t d = vsubq_f32(p, vld1q_f32(palette + i * 4));
+
+        float distance = vaddvq_f32(vmulq_f32(d, d));
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+#else
+    for (unsigned int i = 0; i < count; i++) {
+        float distance = 0.0f;
+        for (unsigned int c = 0; c < 4; c++) {
+            float d = pixel[c] - palette[i * 4 + c];
+            distance += d * d;
+        }
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+#endif
+
+    return best;
+}
+
+// find the line through the block's pixels (the first `channels` channels) that they vary most along, as the two
+// extremes of their projections onto it.
+static void _orionPrincipalEndpoints(const unsigned char block[64], unsigned int channels, float e0[4], float e1[4]) {
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (unsigned int i = 0; i < 16; i++) {
+        for (unsigned int c = 0; c < channels; c++) {
+            mean[c] += block[i * 4 + c] / 16.0f;
+        }
+    }
+
+    float covariance[4][4] = { { 0.0f } };
+    for (unsigned int i = 0; i < 16; i++) {
+        float d[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (unsigned int c = 0; c < channels; c++) {
+            d[c] = block[i * 4 + c] - mean[c];
+        }
+        for (unsigned int a = 0; a < channels; a++) {
+            for (unsigned int b = 0; b < channels; b++) {
+                covariance[a][b] += d[a] * d[b];
+            }
+        }
+    }
+
+    // (power iteration, starting from the diagonal of the bounding box)
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (unsigned int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float length = 0.0f;
+        for (unsigned int a = 0; a < channels; a++) {
+            for (unsigned int b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length = (next[a] * next[a] > length) ? next[a] * next[a] : length;
+        }
+        if (length < 1e-8f) {
+            break;
+        }
+
+        for (unsigned int c = 0; c < channels; c++) {
+            axis[c] = next[c];
+        }
+
+        float norm = 0.0f;
+        for (unsigned int c = 0; c < channels; c++) {
+            norm += axis[c] * axis[c];
+        }
+        norm = 1.0f / sqrtf(norm);
+        for (unsigned int c = 0; c < channels; c++) {
+            axis[c] *= norm;
+        }
+    }
+
+    float lo = 0.0f, hi = 0.0f;
+    for (unsigned int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (unsigned int c = 0; c < channels; c++) {
+            t += (block[i * 4 + c] - mean[c]) * axis[c];
+        }
+        lo = (t < lo) ? t : lo;
+        hi = (t > hi) ? t : hi;
+    }
+
+    for (unsigned int c = 0; c < 4; c++) {
+        float a = (c < channels) ? mean[c] + axis[c] * hi : 0.0f;
+        float b = (c < channels) ? mean[c] + axis[c] * lo : 0.0f;
+        e0[c] = (a < 0.0f) ? 0.0f : ((a > 255.0f) ? 255.0f : a);
+        e1[c] = (b < 0.0f) ? 0.0f : ((b > 255.0f) ? 255.0f : b);
+    }
+}
+
+// refit the endpoints to the block by least squares, given how far along from e0 to e1 each pixel was placed.
+static void _orionRefineEndpoints(const unsigned char block[64], unsigned int channels, const float t[16], float e0[4], float e1[4]) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for (unsigned int i = 0; i < 16; i++) {
+        float a = 1.0f - t[i], b = t[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (unsigned int c = 0; c < channels; c++) {
+            ax[c] += a * block[i * 4 + c];
+            bx[c] += b * block[i * 4 + c];
+        }
+    }
+
+    // (every pixel on one endpoint leaves nothing to solve for)
+    float determinant = aa * bb - ab * ab;
+    if (determinant < 1e-6f) {
+        return;
+    }
+
+    for (unsigned int c = 0; c < channels; c++) {
+        float a = (ax[c] * bb - bx[c] * ab) / determinant;
+        float b = (bx[c] * aa - ax[c] * ab) / determinant;
+        e0[c] = (a < 0.0f) ? 0.0f : ((a > 255.0f) ? 255.0f : a);
+        e1[c] = (b < 0.0f) ? 0.0f : ((b > 255.0f) ? 255.0f : b);
+    }
+}
+
+static unsigned short _orionPack565(const float c[4]) {
+    unsigned int r = (unsigned int) (c[0] * 31.0f / 255.0f + 0.5f);
+    unsigned int g = (unsigned int) (c[1] * 63.0f / 255.0f + 0.5f);
+    unsigned int b = (unsigned int) (c[2] * 31.0f / 255.0f + 0.5f);
+    return (unsigned short) ((r << 11) | (g << 5) | b);
+}
+
+static void _orionUnpack565(unsigned short v, float c[4]) {
+    unsigned int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    c[0] = (float) ((r << 3) | (r >> 2));
+    c[1] = (float) ((g << 2) | (g >> 4));
+    c[2] = (float) ((b << 3) | (b >> 2));
+    c[3] = 0.0f;
+}
+
+// choose the BC1 indices of a block for the given endpoints (c0 > c1), returning the squared error.
+static float _orionBC1Indices(const unsigned char block[64], unsigned short c0, unsigned short c1, uint32_t *indices, float t[16]) {
+    static const float positions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    float palette[16];
+    _orionUnpack565(c0, palette);
+    _orionUnpack565(c1, palette + 4);
+    for (unsigned int c = 0; c < 4; c++) {
+        palette[8 + c] = (2.0f * palette[c] + palette[4 + c]) / 3.0f;
+        palette[12 + c] = (palette[c] + 2.0f * palette[4 + c]) / 3.0f;
+    }
+
+    float error = 0.0f;
+    *indices = 0;
+    for (unsigned int i = 0; i < 16; i++) {
+        float pixel[4] = { block[i * 4], block[i * 4 + 1], block[i * 4 + 2], 0.0f };
+        unsigned int index = _orionNearestEntry(pixel, palette, 4);
+        *indices |= (uint32_t) index << (i * 2);
+        t[i] = positions[index];
+
+        for (unsigned int c = 0; c < 3; c++) {
+            float d = pixel[c] - palette[index * 4 + c];
+            error += d * d;
+        }
+    }
+
+    return error;
+}
+
+// BC1: two 5:6:5 endpoints and 2-bit indices into them and two colours between them.
+static void _orionEncodeBC1Block(const unsigned char block[64], unsigned char out[8]) {
+    float e0[4], e1[4];
+    _orionPrincipalEndpoints(block, 3, e0, e1);
+
+    unsigned short c0 = 0, c1 = 0;
+    uint32_t indices = 0;
+    float bestError = 3.4e38f;
+
+    // (refit the endpoints to the chosen indices, keeping whichever pass fits best)
+    for (unsigned int pass = 0; pass < 3; pass++) {
+        unsigned short a = _orionPack565(e0);
+        unsigned short b = _orionPack565(e1);
+        if (a < b) {
+            unsigned short swap = a;
+            a = b;
+            b = swap;
+        }
+
+        // (equal endpoints would select the 3-colour mode, so every pixel uses the first)
+        if (a == b) {
+            if (pass == 0) {
+                c0 = a;
+                c1 = b;
+                indices = 0;
+            }
+            break;
+        }
+
+        uint32_t candidate;
+        float t[16];
+        float error = _orionBC1Indices(block, a, b, &candidate, t);
+        if (error >= bestError) {
+            break;
+        }
+
+        bestError = error;
+        c0 = a;
+        c1 = b;
+        indices = candidate;
+
+        _orionUnpack565(a, e0);
+        _orionUnpack565(b, e1);
+        _orionRefineEndpoints(block, 3, t, e0, e1);
+    }
+
+    out[0] = (unsigned char) c0;
+    out[1] = (unsigned char) (c0 >> 8);
+    out[2] = (unsigned char) c1;
+    out[3] = (unsigned char) (c1 >> 8);
+    for (unsigned int i = 0; i < 4; i++) {
+        out[4 + i] = (unsigned char) (indices >> (i * 8));
+    }
+}
+
+// BC4: two 8-bit endpoints and 3-bit indices into them and six values between them (one channel of the block).
+static void _orionEncodeBC4Block(const unsigned char block[64], unsigned int channel, unsigned char out[8]) {
+    unsigned int lo = 255, hi = 0;
+    for (unsigned int i = 0; i < 16; i++) {
+        unsigned int v = block[i * 4 + channel];
+        lo = (v < lo) ? v : lo;
+        hi = (v > hi) ? v : hi;
+    }
+
+    out[0] = (unsigned char) hi;
+    out[1] = (unsigned char) lo;
+
+    uint64_t indices = 0;
+    if (hi != lo) {
+        unsigned int range = hi - lo;
+        for (unsigned int i = 0; i < 16; i++) {
+            // position from lo (0) to hi (7), then the code that selects it
+            unsigned int p = ((block[i * 4 + channel] - lo) * 14 + range) / (2 * range);
+            unsigned int code = (p == 7) ? 0 : ((p == 0) ? 1 : 8 - p);
+            indices |= (uint64_t) code << (i * 3);
+        }
+    }
+
+    for (unsigned int i = 0; i < 6; i++) {
+        out[2 + i] = (unsigned char) (indices >> (i * 8));
+    }
+}
+
+// write the low `bits` bits of value to a 128-bit block, from the given bit position onwards.
+static void _orionWriteBits(unsigned char out[16], unsigned int *position, unsigned int value, unsigned int bits) {
+    for (unsigned int i = 0; i < bits; i++, (*position)++) {
+        if (value & (1u << i)) {
+            out[*position >> 3] |= (unsigned char) (1u << (*position & 7));
+        }
+    }
+}
+
+// quantise an endpoint to 7 bits per channel and a shared low bit, choosing the low bit that fits it best.
+static void _orionQuantiseMode6Endpoint(const float e[4], unsigned int q[4], unsigned int *pbit) {
+    float bestError = 3.4e38f;
+
+    for (unsigned int p = 0; p < 2; p++) {
+        unsigned int candidate[4];
+        float error = 0.0f;
+        for (unsigned int c = 0; c < 4; c++) {
+            int v = (int) ((e[c] - p) / 2.0f + 0.5f);
+            candidate[c] = (v < 0) ? 0 : ((v > 127) ? 127 : (unsigned int) v);
+
+            float d = (float) ((candidate[c] << 1) | p) - e[c];
+            error += d * d;
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            *pbit = p;
+            memcpy(q, candidate, sizeof(candidate));
+        }
+    }
+}
+
+// BC7 mode 6: one subset with 7-bit RGBA endpoints (plus a low bit each) and 4-bit indices.
+static void _orionEncodeBC7Block(const unsigned char block[64], unsigned char out[16]) {
+    static const unsigned int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float e0[4], e1[4];
+    _orionPrincipalEndpoints(block, 4, e0, e1);
+
+    unsigned int q[2][4], p[2];
+    unsigned int indices[16];
+    float bestError = 3.4e38f;
+
+    // (refit the endpoints to the chosen indices, keeping whichever pass fits best)
+    for (unsigned int pass = 0; pass < 3; pass++) {
+        unsigned int cq[2][4], cp[2];
+        _orionQuantiseMode6Endpoint(e0, cq[0], &cp[0]);
+        _orionQuantiseMode6Endpoint(e1, cq[1], &cp[1]);
+
+        float palette[64];
+        for (unsigned int i = 0; i < 16; i++) {
+            for (unsigned int c = 0; c < 4; c++) {
+                unsigned int a = (cq[0][c] << 1) | cp[0];
+                unsigned int b = (cq[1][c] << 1) | cp[1];
+                palette[i * 4 + c] = (float) (((64 - weights[i]) * a + weights[i] * b + 32) >> 6);
+            }
+        }
+
+        unsigned int candidate[16];
+        float t[16];
+        float error = 0.0f;
+        for (unsigned int i = 0; i < 16; i++) {
+            float pixel[4] = { block[i * 4], block[i * 4 + 1], block[i * 4 + 2], block[i * 4 + 3] };
+            candidate[i] = _orionNearestEntry(pixel, palette, 16);
+            t[i] = weights[candidate[i]] / 64.0f;
+
+            for (unsigned int c = 0; c < 4; c++) {
+                float d = pixel[c] - palette[candidate[i] * 4 + c];
+                error += d * d;
+            }
+        }
+
+        if (error >= bestError) {
+            break;
+        }
+
+        bestError = error;
+        memcpy(q, cq, sizeof(q));
+        memcpy(p, cp, sizeof(p));
+        memcpy(indices, candidate, sizeof(indices));
+
+        _orionRefineEndpoints(block, 4, t, e0, e1);
+    }
+
+    // (the first index is stored without its top bit, so swap the endpoints if it is set)
+    if (indices[0] & 8) {
+        for (unsigned int c = 0; c < 4; c++) {
+            unsigned int swap = q[0][c];
+            q[0][c] = q[1][c];
+            q[1][c] = swap;
+        }
+        unsigned int swap = p[0];
+        p[0] = p[1];
+        p[1] = swap;
+
+        for (unsigned int i = 0; i < 16; i++) {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    memset(out, 0, 16);
+    unsigned int position = 0;
+    _orionWriteBits(out, &position, 1u << 6, 7);
+    for (unsigned int c = 0; c < 4; c++) {
+        _orionWriteBits(out, &position, q[0][c], 7);
+        _orionWriteBits(out, &position, q[1][c], 7);
+    }
+    _orionWriteBits(out, &position, p[0], 1);
+    _orionWriteBits(out, &position, p[1], 1);
+    _orionWriteBits(out, &position, indices[0], 3);
+    for (unsigned int i = 1; i < 16; i++) {
+        _orionWriteBits(out, &position, indices[i], 4);
+    }
+}
+
+void _orionCompressRows(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int format, unsigned char *dst, unsigned int firstRow, unsigned int rowCount) {
+    unsigned int blockSize = _orionBlockSize(format);
+    unsigned int blocksWide = (width + 3) / 4;
+
+    unsigned char block[64];
+    for (unsigned int by = firstRow; by < firstRow + rowCount; by++) {
+        unsigned char *out = dst + (size_t) by * blocksWide * blockSize;
+
+        for (unsigned int bx = 0; bx < blocksWide; bx++, out += blockSize) {
+            _orionFetchBlock(image, width, height, channels, bx, by, block);
+
+            switch (format) {
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+                    _orionEncodeBC1Block(block, out);
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                    _orionEncodeBC4Block(block, 3, out);
+                    _orionEncodeBC1Block(block, out + 8);
+                    break;
+                case GL_COMPRESSED_RED_RGTC1:
+                    _orionEncodeBC4Block(block, 0, out);
+                    break;
+                case GL_COMPRESSED_RG_RGTC2:
+                    _orionEncodeBC4Block(block, 0, out);
+                    _orionEncodeBC4Block(block, 1, out + 8);
+                    break;
+                case GL_COMPRESSED_RGBA_BPTC_UNORM:
+                case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+                    _orionEncodeBC7Block(block, out);
+                    break;
+            }
+        }
+    }
+}
+
+static void _orionCompressJob(_oriJob *job) {
+    _oriCompressJob *j = (_oriCompressJob *) job;
+    _orionCompressRows(j->image, j->width, j->height, j->channels, j->format, j->dst, j->firstRow, j->rowCount);
+}
+
+static void _orionCachePath(char *path, size_t size, const char *directory, uint64_t key) {
+    snprintf(path, size, "%s/%016llx.orbc", directory, (unsigned long long) key);
+}
+
+bool _orionReadTextureCache(const char *directory, uint64_t key, unsigned int format, unsigned int width, unsigned int height, unsigned int levels, unsigned char **data, size_t *size) {
+    if (!directory) {
+        return false;
+    }
+
+    char path[1024];
+    _orionCachePath(path, sizeof(path), directory, key);
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    // the size of the whole chain, which a valid entry holds exactly
+    size_t expected = 0;
+    for (unsigned int level = 0; level < levels; level++) {
+        unsigned int w = (width >> level) ? (width >> level) : 1;
+        unsigned int h = (height >> level) ? (height >> level) : 1;
+        expected += oriGetCompressedImageSize(format, w, h);
+    }
+
+    _oriCacheHeader header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == _ORION_CACHE_MAGIC && header.version == _ORION_CACHE_VERSION && header.format == format &&
+        header.width == width && header.height == height && header.levels == levels && header.size == expected;
+
+    *data = valid ? malloc(header.size) : NULL;
+    if (*data && fread(*data, 1, header.size, file) != header.size) {
+        free(*data);
+        *data = NULL;
+    }
+    fclose(file);
+
+    *size = *data ? header.size : 0;
+    return *data != NULL;
+}
+
+void _orionWriteTextureCache(const char *directory, uint64_t key, unsigned int format, unsigned int width, unsigned int height, unsigned int levels, const unsigned char *data, size_t size) {
+    if (!directory) {
+        return;
+    }
+
+    char path[1024];
+    _orionCachePath(path, sizeof(path), directory, key);
+
+    // (write to a temporary file first so that a reader never sees half an entry)
+    char temporary[1040];
+    snprintf(temporary, sizeof(temporary), "%s.%p", path, (const void *) data);
+
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        return;
+    }
+
+    _oriCacheHeader header = { _ORION_CACHE_MAGIC, _ORION_CACHE_VERSION, format, width, height, levels, size };
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(data, 1, size, file) == size;
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(temporary, path) != 0) {
+        remove(temporary);
+    }
+}
+
+// ======================================================================================
+// *****                      ORION TEXTURE COMPRESSION FUNCTIONS                   *****
+// ======================================================================================
+
+/**
+ * @brief Return the size in bytes of an image of the given dimensions compressed to the given block-compressed format.
+ *
+ * @param format the compressed format (see oriCompressImage()).
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @return the size of the compressed image, or 0 if the format isn't supported.
+ *
+ * @ingroup textures
+ */
+size_t oriGetCompressedImageSize(unsigned int format, unsigned int width, unsigned int height) {
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * _orionBlockSize(format);
+}
+
+/**
+ * @brief Compress an 8-bit image to a block-compressed (BCn) format, on the worker threads.
+ *
+ * @details The image is split into bands of 4x4 blocks that are compressed in parallel (see oriSetWorkerThreadCount());
+ * this function returns once every band is done. Endpoints are fitted along the principal axis of each block's colours,
+ * and indices are chosen with SIMD distance searches where they are available. The supported formats are:
+ *  - @c GL_COMPRESSED_RGB_S3TC_DXT1_EXT / @c GL_COMPRESSED_SRGB_S3TC_DXT1_EXT (BC1; opaque colour, 4 bits per texel)
+ *  - @c GL_COMPRESSED_RGBA_S3TC_DXT5_EXT / @c GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT (BC3; colour and alpha, 8 bits)
+ *  - @c GL_COMPRESSED_RED_RGTC1 (BC4; one channel, 4 bits)
+ *  - @c GL_COMPRESSED_RG_RGTC2 (BC5; two channels, e.g. normal maps, 8 bits)
+ *  - @c GL_COMPRESSED_RGBA_BPTC_UNORM / @c GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM (BC7; colour and alpha, 8 bits)
+ *
+ * BC7 is encoded with mode 6 only (one subset), which is fast and suits most images, but doesn't reach the quality of
+ * an exhaustive offline encoder.
+ *
+ * The result can be uploaded with oriUploadCompressedTexMipmaps(); oriLoadTextureAsync() compresses images itself if it
+ * is given one of these formats.
+ *
+ * @param image the image, with tightly packed rows. Images that aren't a multiple of 4 texels in size have their edge
+ * texels repeated to fill their last blocks.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param channels the amount of channels in the image (1-4). Missing colour channels are read as 0 and missing alpha as
+ * 255.
+ * @param format the compressed format.
+ * @param dst the array to write the compressed image to. It must hold at least oriGetCompressedImageSize() bytes.
+ *
+ * @ingroup textures
+ */
+void oriCompressImage(const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int format, void *dst) {
+    if (!_orionBlockSize(format)) {
+        _orionThrowWarning("(in oriCompressImage()): Unsupported compressed format specified. Image not compressed.");
+        return;
+    }
+
+    unsigned int rows = (height + 3) / 4;
+    unsigned int jobCount = (rows < _ORION_MAX_COMPRESS_JOBS) ? rows : _ORION_MAX_COMPRESS_JOBS;
+
+    _oriCompressJob jobs[_ORION_MAX_COMPRESS_JOBS];
+    for (unsigned int i = 0; i < jobCount; i++) {
+        jobs[i].image = image;
+        jobs[i].width = width;
+        jobs[i].height = height;
+        jobs[i].channels = channels;
+        jobs[i].format = format;
+        jobs[i].dst = dst;
+        jobs[i].firstRow = rows * i / jobCount;
+        jobs[i].rowCount = rows * (i + 1) / jobCount - jobs[i].firstRow;
+
+        _orionSubmitJob(&jobs[i].job, _orionCompressJob);
+    }
+
+    for (unsigned int i = 0; i < jobCount; i++) {
+        _orionWaitJob(&jobs[i].job, false);
+    }
+}
+
+/**
+ * @brief Set the directory that compressed textures are cached in, so that images are only compressed once.
+ *
+ * @details When oriLoadTextureAsync() loads an image to a compressed format, it looks for a cache entry keyed by a hash
+ * of the image file's contents and the load parameters; if there is one, the compressed levels are read from it instead
+ * of being decoded and compressed again. Otherwise, the compressed levels are written to a new entry. Entries written
+ * by another version of the encoder are ignored.
+ *
+ * Loads that have already started keep using the directory that was set when they started.
+ *
+ * @param path the directory to cache compressed textures in (which must exist), relative to the location of the
+ * executable, or NULL to stop caching (the default).
+ *
+ * @ingroup textures
+ */
+void oriSetTextureCacheDirectory(const char *path) {
+    free(_orion.textureCacheDir);
+    _orion.textureCacheDir = NULL;
+
+    if (path) {
+        size_t length = strlen(path);
+        _orion.textureCacheDir = malloc(length + 1);
+        memcpy(_orion.textureCacheDir, path, length + 1);
+    }
+}
@@ -0,0 +1,566 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+// the first bytes of every KTX2 file.
+static const unsigned char _orionKTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// DDS header flags.
+#define _ORION_DDPF_FOURCC 0x4
+#define _ORION_DDPF_RGB 0x40
+#define _ORION_DDSCAPS2_CUBEMAP 0x200
+#define _ORION_DDSCAPS2_VOLUME 0x200000
+#define _ORION_DDS_RESOURCE_MISC_TEXTURECUBE 0x4
+
+// the largest dimensions that are accepted (above any GL implementation's limits), so that image sizes and offsets
+// can't overflow when they are computed.
+#define _ORION_CONTAINER_MAX_SIZE 16384
+#define _ORION_CONTAINER_MAX_DEPTH 2048
+#define _ORION_CONTAINER_MAX_LAYERS 2048
+
+// the FourCC code of the given four characters, as read from a little-endian file.
+#define _ORION_FOURCC(a, b, c, d) ((uint32_t) (a) | ((uint32_t) (b) << 8) | ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A texture format that can be stored in a container file, and the GL formats it is uploaded with.
+ *
+ */
+typedef struct _oriContainerFormat {
+    // the VkFormat (KTX2) and DXGI_FORMAT (DDS) values of the format, or 0 if the container can't store it
+    uint32_t vkFormat;
+    uint32_t dxgiFormat;
+
+    unsigned int internalFormat;
+    unsigned int imageFormat;
+    unsigned int dataType;
+
+    // the size in bytes of one texel, or of one 4x4 block if the format is compressed
+    unsigned int size;
+    bool compressed;
+} _oriContainerFormat;
+
+/**
+ * @brief The layout of the images in a container file.
+ *
+ */
+typedef struct _oriContainerLayout {
+    const _oriContainerFormat *format;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int depth;
+    unsigned int layers;
+    unsigned int faces;
+    unsigned int levels;
+
+    // (KTX2 files can leave mipmaps to be generated when the texture is loaded)
+    bool generateMipmaps;
+
+    // KTX2: the offset of each level, which holds every layer and face of it
+    // DDS: the offset of the first image, which every layer and face's mipmap chain follows
+    uint64_t levelOffsets[32];
+    bool levelMajor;
+} _oriContainerLayout;
+
+static const _oriContainerFormat _orionContainerFormats[] = {
+    // uncompressed
+    { 9,   61, GL_R8,                                   GL_RED,  GL_UNSIGNED_BYTE, 1,  false },
+    { 16,  49, GL_RG8,                                  GL_RG,   GL_UNSIGNED_BYTE, 2,  false },
+    { 23,  0,  GL_RGB8,                                 GL_RGB,  GL_UNSIGNED_BYTE, 3,  false },
+    { 29,  0,  GL_SRGB8,                                GL_RGB,  GL_UNSIGNED_BYTE, 3,  false },
+    { 37,  28, GL_RGBA8,                                GL_RGBA, GL_UNSIGNED_BYTE, 4,  false },
+    { 43,  29, GL_SRGB8_ALPHA8,                         GL_RGBA, GL_UNSIGNED_BYTE, 4,  false },
+    { 44,  87, GL_RGBA8,                                GL_BGRA, GL_UNSIGNED_BYTE, 4,  false },
+    { 50,  91, GL_SRGB8_ALPHA8,                         GL_BGRA, GL_UNSIGNED_BYTE, 4,  false },
+    { 76,  54, GL_R16F,                                 GL_RED,  GL_HALF_FLOAT,    2,  false },
+    { 83,  34, GL_RG16F,                                GL_RG,   GL_HALF_FLOAT,    4,  false },
+    { 97,  10, GL_RGBA16F,                              GL_RGBA, GL_HALF_FLOAT,    8,  false },
+    { 100, 41, GL_R32F,                                 GL_RED,  GL_FLOAT,         4,  false },
+    { 103, 16, GL_RG32F,                                GL_RG,   GL_FLOAT,         8,  false },
+    { 109, 2,  GL_RGBA32F,                              GL_RGBA, GL_FLOAT,         16, false },
+
+    // block-compressed
+    { 131, 0,  GL_COMPRESSED_RGB_S3TC_DXT1_EXT,         0, 0, 8,  true },
+    { 132, 0,  GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,        0, 0, 8,  true },
+    { 133, 71, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,        0, 0, 8,  true },
+    { 134, 72, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,  0, 0, 8,  true },
+    { 135, 74, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,        0, 0, 16, true },
+    { 136, 75, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,  0, 0, 16, true },
+    { 137, 77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,        0, 0, 16, true },
+    { 138, 78, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,  0, 0, 16, true },
+    { 139, 80, GL_COMPRESSED_RED_RGTC1,                 0, 0, 8,  true },
+    { 140, 81, GL_COMPRESSED_SIGNED_RED_RGTC1,          0, 0, 8,  true },
+    { 141, 83, GL_COMPRESSED_RG_RGTC2,                  0, 0, 16, true },
+    { 142, 84, GL_COMPRESSED_SIGNED_RG_RGTC2,           0, 0, 16, true },
+    { 143, 95, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,   0, 0, 16, true },
+    { 144, 96, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,     0, 0, 16, true },
+    { 145, 98, GL_COMPRESSED_RGBA_BPTC_UNORM,           0, 0, 16, true },
+    { 146, 99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,     0, 0, 16, true }
+};
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+bool _orionMapFile(const char *path, bool sequential, _oriMappedFile *file) {
+#ifdef _WIN32
+    file->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (file->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    file->mapping = GetFileSizeEx(file->file, &size) ? CreateFileMappingA(file->file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    file->data = file->mapping ? MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!file->data) {
+        if (file->mapping) {
+            CloseHandle(file->mapping);
+        }
+        CloseHandle(file->file);
+        return false;
+    }
+
+    file->size = (size_t) size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    void *data = (fstat(fd, &st) == 0 && st.st_size > 0) ? mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+    // (the mapping stays valid once the descriptor is closed)
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    madvise(data, (size_t) st.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    file->data = data;
+    file->size = (size_t) st.st_size;
+#endif
+
+    return true;
+}
+
+void _orionUnmapFile(_oriMappedFile *file) {
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->file);
+#else
+    munmap((void *) file->data, file->size);
+#endif
+}
+
+static uint32_t _orionRead32(const unsigned char *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t _orionRead64(const unsigned char *p) {
+    return (uint64_t) _orionRead32(p) | ((uint64_t) _orionRead32(p + 4) << 32);
+}
+
+static const _oriContainerFormat *_orionFindContainerFormat(uint32_t vkFormat, uint32_t dxgiFormat) {
+    for (unsigned int i = 0; i < sizeof(_orionContainerFormats) / sizeof(_orionContainerFormats[0]); i++) {
+        const _oriContainerFormat *format = &_orionContainerFormats[i];
+        if ((vkFormat && format->vkFormat == vkFormat) || (dxgiFormat && format->dxgiFormat == dxgiFormat)) {
+            return format;
+        }
+    }
+
+    return NULL;
+}
+
+static bool _orionIsS3TCFormat(unsigned int internalFormat) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// return the size in bytes of one image (every depth slice of one layer and face) of the given level.
+static size_t _orionContainerImageSize(const _oriContainerLayout *layout, unsigned int level) {
+    size_t w = (layout->width >> level) ? (layout->width >> level) : 1;
+    size_t h = (layout->height >> level) ? (layout->height >> level) : 1;
+    size_t d = (layout->depth >> level) ? (layout->depth >> level) : 1;
+
+    if (layout->format->compressed) {
+        return ((w + 3) / 4) * ((h + 3) / 4) * d * layout->format->size;
+    }
+    return w * h * d * layout->format->size;
+}
+
+// return the offset in the file of the image of the given level and (layer * faces + face).
+static uint64_t _orionContainerImageOffset(const _oriContainerLayout *layout, unsigned int level, unsigned int image) {
+    if (layout->levelMajor) {
+        return layout->levelOffsets[level] + (uint64_t) image * _orionContainerImageSize(layout, level);
+    }
+
+    // (each layer and face has its whole mipmap chain before the next one)
+    uint64_t chainSize = 0;
+    uint64_t levelOffset = 0;
+    for (unsigned int i = 0; i < layout->levels; i++) {
+        if (i == level) {
+            levelOffset = chainSize;
+        }
+        chainSize += _orionContainerImageSize(layout, i);
+    }
+
+    return layout->levelOffsets[0] + (uint64_t) image * chainSize + levelOffset;
+}
+
+static const char *_orionParseKTX2(const _oriMappedFile *file, _oriContainerLayout *layout) {
+    const unsigned char *p = file->data;
+    if (file->size < 80) {
+        return "file is too small";
+    }
+
+    uint32_t vkFormat = _orionRead32(p + 12);
+    layout->width = _orionRead32(p + 20);
+    layout->height = _orionRead32(p + 24);
+    layout->depth = _orionRead32(p + 28);
+    layout->layers = _orionRead32(p + 32);
+    layout->faces = _orionRead32(p + 36);
+    layout->levels = _orionRead32(p + 40);
+    uint32_t supercompression = _orionRead32(p + 44);
+
+    if (supercompression) {
+        return "supercompressed KTX2 files are not supported";
+    }
+    if (!(layout->format = _orionFindContainerFormat(vkFormat, 0))) {
+        return "unsupported VkFormat";
+    }
+
+    // (a level count of 0 asks for the mipmaps to be generated from the one level stored)
+    layout->generateMipmaps = layout->levels == 0;
+    if (layout->generateMipmaps) {
+        layout->levels = 1;
+    }
+    if (layout->levels > 32 || file->size < 80 + (size_t) layout->levels * 24) {
+        return "level index is out of range";
+    }
+
+    for (unsigned int level = 0; level < layout->levels; level++) {
+        layout->levelOffsets[level] = _orionRead64(p + 80 + level * 24);
+    }
+    layout->levelMajor = true;
+
+    return NULL;
+}
+
+static const char *_orionParseDDS(const _oriMappedFile *file, _oriContainerLayout *layout) {
+    const unsigned char *p = file->data;
+    if (file->size < 128) {
+        return "file is too small";
+    }
+
+    layout->height = _orionRead32(p + 12);
+    layout->width = _orionRead32(p + 16);
+    layout->depth = _orionRead32(p + 24);
+    layout->levels = _orionRead32(p + 28);
+    layout->layers = 0;
+    layout->faces = 1;
+    layout->generateMipmaps = false;
+
+    uint32_t pixelFlags = _orionRead32(p + 80);
+    uint32_t fourCC = _orionRead32(p + 84);
+    uint32_t caps2 = _orionRead32(p + 112);
+    uint32_t dxgiFormat = 0;
+    uint64_t dataOffset = 128;
+
+    if ((pixelFlags & _ORION_DDPF_FOURCC) && fourCC == _ORION_FOURCC('D', 'X', '1', '0')) {
+        if (file->size < 148) {
+            return "file is too small";
+        }
+
+        dxgiFormat = _orionRead32(p + 128);
+        uint32_t miscFlags = _orionRead32(p + 136);
+        uint32_t arraySize = _orionRead32(p + 140);
+
+        if (miscFlags & _ORION_DDS_RESOURCE_MISC_TEXTURECUBE) {
+            layout->faces = 6;
+        }
+        if (arraySize > 1) {
+            layout->layers = arraySize;
+        }
+
+        dataOffset = 148;
+    } else if (pixelFlags & _ORION_DDPF_FOURCC) {
+        // (legacy compressed formats)
+        switch (fourCC) {
+            case _ORION_FOURCC('D', 'X', 'T', '1'):
+                dxgiFormat = 71;
+                break;
+            case _ORION_FOURCC('D', 'X', 'T', '3'):
+                dxgiFormat = 74;
+                break;
+            case _ORION_FOURCC('D', 'X', 'T', '5'):
+                dxgiFormat = 77;
+                break;
+            case _ORION_FOURCC('A', 'T', 'I', '1'):
+            case _ORION_FOURCC('B', 'C', '4', 'U'):
+                dxgiFormat = 80;
+                break;
+            case _ORION_FOURCC('A', 'T', 'I', '2'):
+            case _ORION_FOURCC('B', 'C', '5', 'U'):
+                dxgiFormat = 83;
+                break;
+        }
+    } else if ((pixelFlags & _ORION_DDPF_RGB) && _orionRead32(p + 88) == 32) {
+        // (legacy 32-bit RGBA or BGRA, told apart by where the red channel is)
+        dxgiFormat = (_orionRead32(p + 92) == 0xFF) ? 28 : 87;
+    }
+
+    if (!(layout->format = _orionFindContainerFormat(0, dxgiFormat))) {
+        return "unsupported pixel format";
+    }
+
+    if (caps2 & _ORION_DDSCAPS2_CUBEMAP) {
+        layout->faces = 6;
+    }
+    if (!(caps2 & _ORION_DDSCAPS2_VOLUME)) {
+        layout->depth = 0;
+    }
+    if (!layout->levels) {
+        layout->levels = 1;
+    }
+    if (layout->levels > 32) {
+        return "level count is out of range";
+    }
+
+    layout->levelOffsets[0] = dataOffset;
+    layout->levelMajor = false;
+
+    return NULL;
+}
+
+// return the texture type of the given layout, or 0 if it isn't supported.
+static unsigned int _orionContainerTextureType(const _oriContainerLayout *layout) {
+    if (layout->faces == 6) {
+        return layout->layers ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+    }
+    if (layout->faces != 1 || !layout->height) {
+        return 0;
+    }
+    if (layout->depth > 1) {
+        return layout->layers ? 0 : GL_TEXTURE_3D;
+    }
+
+    return layout->layers ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+}
+
+// upload one image (every depth slice of one layer and face) of one level straight from the mapped file.
+static void _orionUploadContainerImage(oriTexture *texture, const _oriContainerFormat *format, unsigned int level, unsigned int z, unsigned int width, unsigned int height, unsigned int depth, const void *data, size_t size) {
+    if (!format->compressed) {
+        oriUploadTexSubImage(texture, level, 0, 0, (int) z, width, height, depth, format->dataType, data, format->imageFormat);
+        return;
+    }
+
+    bool layered = texture->type != GL_TEXTURE_2D && (texture->type != GL_TEXTURE_CUBE_MAP || _orion.glVersion >= 450);
+
+    if (_orion.glVersion >= 450) {
+        if (layered) {
+            glCompressedTextureSubImage3D(texture->handle, level, 0, 0, z, width, height, depth, format->internalFormat, (int) size, data);
+        } else {
+            glCompressedTextureSubImage2D(texture->handle, level, 0, 0, width, height, format->internalFormat, (int) size, data);
+        }
+
+        return;
+    }
+
+    // bind to this again at the end of the function
+    unsigned int boundCache = oriCurrentTextureAt(texture->type);
+    glBindTexture(texture->type, texture->handle);
+
+    if (layered) {
+        glCompressedTexSubImage3D(texture->type, level, 0, 0, z, width, height, depth, format->internalFormat, (int) size, data);
+    } else if (texture->type == GL_TEXTURE_CUBE_MAP) {
+        glCompressedTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + z, level, 0, 0, width, height, format->internalFormat, (int) size, data);
+    } else {
+        glCompressedTexSubImage2D(texture->type, level, 0, 0, width, height, format->internalFormat, (int) size, data);
+    }
+
+    glBindTexture(texture->type, boundCache);
+}
+
+// ======================================================================================
+// *****                      ORION TEXTURE CONTAINER FUNCTIONS                     *****
+// ======================================================================================
+
+/**
+ * @brief Load a texture from a KTX2 or DDS container file, with the format, mipmap levels and layers stored in it.
+ *
+ * @details Unlike oriLoadTextureAsync(), nothing is decoded: the file is mapped into memory, its level index is parsed
+ * and each image is uploaded straight from the mapped pages to immutable storage created with
+ * oriCreateTextureImmutable(), without being copied into memory of its own first. This makes it the fastest way to
+ * load textures that were baked ahead of time, especially block-compressed ones, which are uploaded as they are.
+ *
+ * 2D, 2D array, cube map, cube map array and 3D textures are supported, in uncompressed 8-bit, half-float and float
+ * formats or the BC1-BC7 compressed formats (BC1-BC3 need @c GL_EXT_texture_compression_s3tc). KTX2 files must not be
+ * supercompressed (e.g. with Basis Universal or zstd). If a KTX2 file has a level count of 0, the rest of the mipmap
+ * chain is generated with the GL; the GL can't generate mipmaps of compressed textures, so only the stored level is
+ * loaded for those.
+ *
+ * If the file can't be loaded, a warning is thrown and NULL is returned.
+ *
+ * @param path the path of the container file, relative to the location of the executable.
+ * @return the texture, or NULL if it couldn't be loaded.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriLoadTextureContainer(const char *path) {
+    _orionAssertVersion(420);
+
+    _oriMappedFile file;
+    // (the images are read front to back, once)
+    if (!_orionMapFile(path, true, &file)) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriLoadTextureContainer()): Failed to open \"%s\". Texture not created.", path);
+        _orionThrowWarning(message);
+        return NULL;
+    }
+
+    _oriContainerLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    const char *failureReason;
+
+    if (file.size >= sizeof(_orionKTX2Identifier) && !memcmp(file.data, _orionKTX2Identifier, sizeof(_orionKTX2Identifier))) {
+        failureReason = _orionParseKTX2(&file, &layout);
+    } else if (file.size >= 4 && _orionRead32(file.data) == _ORION_FOURCC('D', 'D', 'S', ' ')) {
+        failureReason = _orionParseDDS(&file, &layout);
+    } else {
+        failureReason = "not a KTX2 or DDS file";
+    }
+
+    if (!failureReason && (!layout.width || layout.width > _ORION_CONTAINER_MAX_SIZE || layout.height > _ORION_CONTAINER_MAX_SIZE ||
+        layout.depth > _ORION_CONTAINER_MAX_DEPTH || layout.layers > _ORION_CONTAINER_MAX_LAYERS)) {
+        failureReason = "texture dimensions are out of range";
+    }
+
+    unsigned int type = failureReason ? 0 : _orionContainerTextureType(&layout);
+    if (!failureReason && !type) {
+        failureReason = "unsupported texture dimensions";
+    }
+
+    // (S3TC is an extension rather than part of core GL, so drivers can leave it out)
+    if (!failureReason && _orionIsS3TCFormat(layout.format->internalFormat) && !_orionHasExtension("GL_EXT_texture_compression_s3tc")) {
+        failureReason = "S3TC compressed formats are not supported by the GL driver";
+    }
+
+    // make sure that every image is inside the file before anything is read from it (with the dimensions bounded, only
+    // the offsets stored in the file can make the image offsets wrap)
+    unsigned int images = (layout.layers ? layout.layers : 1) * layout.faces;
+    for (unsigned int level = 0; !failureReason && level < layout.levels; level++) {
+        if (layout.levelOffsets[layout.levelMajor ? level : 0] > file.size) {
+            failureReason = "image data is out of range";
+            break;
+        }
+
+        for (unsigned int image = 0; image < images; image++) {
+            uint64_t offset = _orionContainerImageOffset(&layout, level, image);
+            uint64_t size = _orionContainerImageSize(&layout, level);
+            if (offset > file.size || size > file.size - offset) {
+                failureReason = "image data is out of range";
+                break;
+            }
+        }
+    }
+
+    if (failureReason) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriLoadTextureContainer()): Failed to load \"%s\" (%s). Texture not created.", path, failureReason);
+        _orionThrowWarning(message);
+
+        _orionUnmapFile(&file);
+        return NULL;
+    }
+
+    // (glGenerateMipmap() rejects compressed textures, so only their stored level is loaded)
+    if (layout.generateMipmaps && layout.format->compressed) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriLoadTextureContainer()): Mipmaps of \"%s\" can't be generated for a compressed format. Only the stored level loaded.", path);
+        _orionThrowWarning(message);
+        layout.generateMipmaps = false;
+    }
+
+    unsigned int levels = layout.generateMipmaps ? oriGetMipLevelCount(layout.width, layout.height) : layout.levels;
+    unsigned int depth = (type == GL_TEXTURE_3D) ? layout.depth : ((type == GL_TEXTURE_CUBE_MAP) ? 0 : images);
+
+    oriTexture *r = oriCreateTextureImmutable(type, layout.width, layout.height, depth, layout.format->internalFormat, levels, 0, false);
+    oriSetTextureParameteri(r, GL_TEXTURE_MIN_FILTER, (levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    oriSetTextureParameteri(r, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // (the mapped pages are read directly, so nothing may be bound as the pixel unpack buffer)
+    unsigned int bufferCache = oriCurrentBufferAt(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // (rows of 1- and 3-byte texels aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (unsigned int level = 0; level < layout.levels; level++) {
+        unsigned int w = (layout.width >> level) ? (layout.width >> level) : 1;
+        unsigned int h = (layout.height >> level) ? (layout.height >> level) : 1;
+        unsigned int d = (layout.depth >> level) ? (layout.depth >> level) : 1;
+
+        for (unsigned int image = 0; image < images; image++) {
+            const unsigned char *data = file.data + _orionContainerImageOffset(&layout, level, image);
+            _orionUploadContainerImage(r, layout.format, level, image, w, h, d, data, _orionContainerImageSize(&layout, level));
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferCache);
+
+    if (layout.generateMipmaps && levels > 1) {
+        oriGenerateTextureMipmaps(r);
+    }
+
+    _orionUnmapFile(&file);
+
+    return r;
+}
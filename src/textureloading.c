@@ -0,0 +1,649 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// stb_image is compiled into this file only (with static linkage), so that it doesn't clash with applications that also
+// use it. (unused stb_image functions are only reported at the end of the file, so the warning stays disabled)
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#if defined(__GNUC__)
+#   pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include "execdeps/stb_image/stb_image.h"
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A texture that is being decoded on a worker thread or uploaded on the GL thread.
+ *
+ */
+typedef struct _oriTextureLoad {
+    // (must be first, as the worker is given a pointer to it)
+    _oriJob job;
+
+    _oriTextureLoad *next;
+
+    oriTexture *texture;
+    char *path;
+    oriTextureLoadParams params;
+
+    // the texture cache directory when the load was started (NULL if textures weren't being cached), as the worker
+    // can't read the global one while oriSetTextureCacheDirectory() may replace it
+    char *cacheDir;
+
+    // set by the worker thread: the decoded image and its mipmap levels (one after the other), or NULL and the reason it
+    // couldn't be decoded
+    unsigned char *pixels;
+    unsigned char *mipmaps;
+    unsigned int width;
+    unsigned int height;
+    unsigned int channels;
+    unsigned int levels;
+    const char *failureReason;
+
+    // set instead of the decoded image if the texture is block-compressed: every level, compressed, one after the other
+    unsigned char *compressed;
+    size_t compressedSize;
+
+    // the texture that the image is uploaded to before it replaces the placeholder
+    unsigned int staging;
+
+    // the level being uploaded, its offset into the image data and the amount of its rows uploaded so far
+    unsigned int level;
+    size_t levelOffset;
+    unsigned int rowsUploaded;
+} _oriTextureLoad;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// read the whole of the given file into memory.
+static unsigned char *_orionReadFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    unsigned char *r = NULL;
+    long length;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        r = malloc((size_t) length);
+        if (r && fread(r, 1, (size_t) length, file) != (size_t) length) {
+            free(r);
+            r = NULL;
+        }
+        *size = (size_t) length;
+    }
+
+    fclose(file);
+    return r;
+}
+
+// compress every level of the decoded image into one buffer, one after the other.
+static void _orionCompressTextureLoad(_oriTextureLoad *load) {
+    unsigned int format = load->params.internalFormat;
+
+    load->compressedSize = 0;
+    for (unsigned int level = 0; level < load->levels; level++) {
+        unsigned int w = (load->width >> level) ? (load->width >> level) : 1;
+        unsigned int h = (load->height >> level) ? (load->height >> level) : 1;
+        load->compressedSize += oriGetCompressedImageSize(format, w, h);
+    }
+
+    load->compressed = malloc(load->compressedSize);
+    if (!load->compressed) {
+        return;
+    }
+
+    // (this already runs on a worker thread, so the levels are compressed here rather than split up into more jobs)
+    const unsigned char *image = load->pixels;
+    unsigned char *dst = load->compressed;
+    for (unsigned int level = 0; level < load->levels; level++) {
+        unsigned int w = (load->width >> level) ? (load->width >> level) : 1;
+        unsigned int h = (load->height >> level) ? (load->height >> level) : 1;
+
+        _orionCompressRows(image, w, h, load->channels, format, dst, 0, (h + 3) / 4);
+
+        image = (level == 0) ? load->mipmaps : image + (size_t) w * h * load->channels;
+        dst += oriGetCompressedImageSize(format, w, h);
+    }
+}
+
+static void _orionDecodeTexture(_oriJob *job) {
+    _oriTextureLoad *load = (_oriTextureLoad *) job;
+    unsigned int internalFormat = load->params.internalFormat;
+
+    size_t fileSize;
+    unsigned char *file = _orionReadFile(load->path, &fileSize);
+    if (!file) {
+        load->failureReason = "can't open file";
+        return;
+    }
+
+    // block-compressed textures are looked up in the texture cache first, keyed by the file's contents and everything
+    // else that changes the compressed result
+    bool compress = _orionBlockSize(internalFormat) != 0;
+    uint64_t key = 0;
+    int w, h, n;
+
+    if (compress && stbi_info_from_memory(file, (int) fileSize, &w, &h, &n)) {
+        const unsigned int params[] = {
+            internalFormat, load->params.channels, load->params.flipVertically, load->params.generateMipmaps, load->params.mipmapFilter
+        };
+        key = _orionHashBytes(file, fileSize, _orionHashBytes(params, sizeof(params), 0));
+
+        load->width = (unsigned int) w;
+        load->height = (unsigned int) h;
+        load->levels = load->params.generateMipmaps ? oriGetMipLevelCount(load->width, load->height) : 1;
+
+        if (_orionReadTextureCache(load->cacheDir, key, internalFormat, load->width, load->height, load->levels, &load->compressed, &load->compressedSize)) {
+            free(file);
+            return;
+        }
+    }
+
+    stbi_set_flip_vertically_on_load_thread(load->params.flipVertically);
+
+    load->pixels = stbi_load_from_memory(file, (int) fileSize, &w, &h, &n, (int) load->params.channels);
+    free(file);
+    if (!load->pixels) {
+        load->failureReason = stbi_failure_reason();
+        return;
+    }
+
+    load->width = (unsigned int) w;
+    load->height = (unsigned int) h;
+    load->channels = load->params.channels ? load->params.channels : (unsigned int) n;
+    load->levels = 1;
+
+    // build the mipmap levels here too, so that the GL thread only has to upload them
+    if (load->params.generateMipmaps) {
+        bool srgb = internalFormat == GL_SRGB8 || internalFormat == GL_SRGB8_ALPHA8 || internalFormat == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT ||
+            internalFormat == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT || internalFormat == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+
+        load->mipmaps = malloc(oriGetMipChainSize(load->width, load->height, load->channels));
+        unsigned int levels = load->mipmaps ? oriGenerateMipChain(load->pixels, load->width, load->height, load->channels, load->params.mipmapFilter, srgb, load->mipmaps, NULL) : 0;
+
+        // (without the memory to build them, the image is uploaded without mipmaps)
+        load->levels = levels ? levels : 1;
+    }
+
+    if (!compress) {
+        return;
+    }
+
+    _orionCompressTextureLoad(load);
+
+    // the uncompressed image isn't needed any more
+    stbi_image_free(load->pixels);
+    free(load->mipmaps);
+    load->pixels = NULL;
+    load->mipmaps = NULL;
+
+    if (!load->compressed) {
+        load->failureReason = "out of memory";
+        return;
+    }
+
+    // (only cache the full chain, which is what a cache lookup expects)
+    if (load->levels == (load->params.generateMipmaps ? oriGetMipLevelCount(load->width, load->height) : 1)) {
+        _orionWriteTextureCache(load->cacheDir, key, internalFormat, load->width, load->height, load->levels, load->compressed, load->compressedSize);
+    }
+}
+
+static unsigned int _orionChannelsFormat(unsigned int channels) {
+    switch (channels) {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+    }
+}
+
+static unsigned int _orionChannelsInternalFormat(unsigned int channels) {
+    switch (channels) {
+        case 1:
+            return GL_R8;
+        case 2:
+            return GL_RG8;
+        case 3:
+            return GL_RGB8;
+        default:
+            return GL_RGBA8;
+    }
+}
+
+// unlink the load from the global list and free it (but not its texture).
+static void _orionFreeTextureLoad(_oriTextureLoad *load) {
+    if (_orion.textureLoadListHead == load) {
+        _orion.textureLoadListHead = load->next;
+    } else {
+        _oriTextureLoad *current = _orion.textureLoadListHead;
+        while (current->next != load)
+            current = current->next;
+        current->next = load->next;
+    }
+
+    if (load->staging) {
+        glDeleteTextures(1, &load->staging);
+    }
+    if (load->pixels) {
+        stbi_image_free(load->pixels);
+    }
+    free(load->mipmaps);
+    free(load->compressed);
+
+    load->texture->load = NULL;
+
+    free(load->path);
+    free(load->cacheDir);
+    free(load);
+}
+
+// allocate the staging texture for a decoded image.
+static void _orionBeginTextureUpload(_oriTextureLoad *load) {
+    unsigned int internalFormat = load->params.internalFormat ? load->params.internalFormat : _orionChannelsInternalFormat(load->channels);
+
+    if (_orion.glVersion >= 450) {
+        glCreateTextures(GL_TEXTURE_2D, 1, &load->staging);
+        glTextureStorage2D(load->staging, load->levels, internalFormat, load->width, load->height);
+    } else {
+        glGenTextures(1, &load->staging);
+
+        unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, load->staging);
+        for (unsigned int level = 0; level < load->levels; level++) {
+            unsigned int w = (load->width >> level) ? (load->width >> level) : 1;
+            unsigned int h = (load->height >> level) ? (load->height >> level) : 1;
+            if (load->compressed) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, w, h, 0, oriGetCompressedImageSize(internalFormat, w, h), NULL);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, level, internalFormat, w, h, 0, _orionChannelsFormat(load->channels), GL_UNSIGNED_BYTE, NULL);
+            }
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int) load->levels - 1);
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+    }
+}
+
+// return the width of the level being uploaded.
+static unsigned int _orionLoadLevelWidth(_oriTextureLoad *load) {
+    return (load->width >> load->level) ? (load->width >> load->level) : 1;
+}
+
+// return the height of the level being uploaded.
+static unsigned int _orionLoadLevelHeight(_oriTextureLoad *load) {
+    return (load->height >> load->level) ? (load->height >> load->level) : 1;
+}
+
+// return the size in bytes of one row of the level being uploaded (a row of blocks if the texture is compressed).
+static size_t _orionLoadRowSize(_oriTextureLoad *load) {
+    if (load->compressed) {
+        return (size_t) ((_orionLoadLevelWidth(load) + 3) / 4) * _orionBlockSize(load->params.internalFormat);
+    }
+    return (size_t) _orionLoadLevelWidth(load) * load->channels;
+}
+
+// return the amount of rows of the level being uploaded (rows of blocks if the texture is compressed).
+static unsigned int _orionLoadRowCount(_oriTextureLoad *load) {
+    return load->compressed ? (_orionLoadLevelHeight(load) + 3) / 4 : _orionLoadLevelHeight(load);
+}
+
+// stage the given rows of the current level through the upload buffer and copy them into the staging texture.
+static void _orionUploadTextureRows(_oriTextureLoad *load, unsigned int rows) {
+    unsigned int width = _orionLoadLevelWidth(load);
+    size_t rowSize = _orionLoadRowSize(load);
+    size_t offset = load->levelOffset + (size_t) load->rowsUploaded * rowSize;
+    unsigned int format = _orionChannelsFormat(load->channels);
+
+    // (the base level is decoded on its own, and the levels below it follow each other; compressed levels are all in
+    // the same buffer)
+    size_t baseSize = (size_t) load->width * load->height * load->channels;
+    const unsigned char *data;
+    if (load->compressed) {
+        data = load->compressed + offset;
+    } else {
+        data = (offset < baseSize) ? load->pixels + offset : load->mipmaps + (offset - baseSize);
+    }
+
+    // (compressed rows are rows of 4x4 blocks; the last one can be cut off by the bottom of the level)
+    unsigned int y = load->compressed ? load->rowsUploaded * 4 : load->rowsUploaded;
+    unsigned int height = rows;
+    if (load->compressed) {
+        height = (rows * 4 < _orionLoadLevelHeight(load) - y) ? rows * 4 : _orionLoadLevelHeight(load) - y;
+    }
+
+    // (rows of 1- and 3-channel images aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    unsigned int bufferCache = oriCurrentBufferAt(GL_PIXEL_UNPACK_BUFFER);
+    size_t staged = _orionStageTextureUpload(data, rows * rowSize);
+
+    // with a pixel unpack buffer bound, the pointer is an offset into it
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+    if (load->compressed) {
+        unsigned int internalFormat = load->params.internalFormat;
+
+        if (_orion.glVersion >= 450) {
+            glCompressedTextureSubImage2D(load->staging, load->level, 0, y, width, height, internalFormat, rows * rowSize, (const void *) staged);
+        } else {
+            unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, load->staging);
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, load->level, 0, y, width, height, internalFormat, rows * rowSize, (const void *) staged);
+            glBindTexture(GL_TEXTURE_2D, boundCache);
+        }
+    } else if (_orion.glVersion >= 450) {
+        glTextureSubImage2D(load->staging, load->level, 0, y, width, height, format, GL_UNSIGNED_BYTE, (const void *) staged);
+    } else {
+        unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, load->staging);
+        glTexSubImage2D(GL_TEXTURE_2D, load->level, 0, y, width, height, format, GL_UNSIGNED_BYTE, (const void *) staged);
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+    }
+#pragma GCC diagnostic pop
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferCache);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    load->rowsUploaded += rows;
+
+    // move on to the next level
+    if (load->rowsUploaded == _orionLoadRowCount(load)) {
+        load->levelOffset += (size_t) load->rowsUploaded * rowSize;
+        load->rowsUploaded = 0;
+        load->level++;
+    }
+}
+
+// replace the placeholder with the fully uploaded staging texture, keeping the sampling parameters set on it.
+static void _orionFinishTextureLoad(_oriTextureLoad *load) {
+    oriTexture *texture = load->texture;
+
+    static const unsigned int parameters[] = {
+        GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T
+    };
+
+    if (_orion.glVersion >= 450) {
+        for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+            int value;
+            glGetTextureParameteriv(texture->handle, parameters[i], &value);
+            glTextureParameteri(load->staging, parameters[i], value);
+        }
+
+        texture->immutableStorage = true;
+    } else {
+        unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+
+        int values[sizeof(parameters) / sizeof(parameters[0])];
+        glBindTexture(GL_TEXTURE_2D, texture->handle);
+        for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+            glGetTexParameteriv(GL_TEXTURE_2D, parameters[i], &values[i]);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, load->staging);
+        for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+            glTexParameteri(GL_TEXTURE_2D, parameters[i], values[i]);
+        }
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+
+        texture->immutableStorage = false;
+    }
+
+    // swap the placeholder out
+    glDeleteTextures(1, &texture->handle);
+    texture->handle = load->staging;
+    texture->internalFormat = load->params.internalFormat ? load->params.internalFormat : _orionChannelsInternalFormat(load->channels);
+    texture->width = load->width;
+    texture->height = load->height;
+    texture->depth = 0;
+    texture->levels = load->levels;
+    load->staging = 0;
+
+    _orionFreeTextureLoad(load);
+}
+
+void _orionCancelTextureLoad(oriTexture *texture) {
+    _oriTextureLoad *load = texture->load;
+
+    _orionWaitJob(&load->job, true);
+    _orionFreeTextureLoad(load);
+}
+
+size_t _orionStageTextureUpload(const void *data, size_t size) {
+    size_t budget = _orion.textureUploadBudget ? _orion.textureUploadBudget : _ORION_DEFAULT_UPLOAD_BUDGET;
+    size_t capacity = (size > budget) ? size : budget;
+
+    if (!_orion.textureUploadBuffer) {
+        glGenBuffers(1, &_orion.textureUploadBuffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _orion.textureUploadBuffer);
+
+    // once the ring is full, start again at the front of a new data store (orphaning the old one, so this doesn't wait
+    // for the uploads still reading from it)
+    if (capacity > _orion.textureUploadBufferSize || size > _orion.textureUploadBufferSize - _orion.textureUploadBufferHead) {
+        if (capacity > _orion.textureUploadBufferSize) {
+            _orion.textureUploadBufferSize = capacity;
+        }
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, _orion.textureUploadBufferSize, NULL, GL_STREAM_DRAW);
+        _orion.textureUploadBufferHead = 0;
+    }
+
+    size_t offset = _orion.textureUploadBufferHead;
+
+    // (nothing has been staged in this range since the data store was orphaned, so it can be written without waiting)
+    unsigned char *staging = NULL;
+    if (_orion.glVersion >= 300) {
+        staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    if (staging) {
+        memcpy(staging, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, offset, size, data);
+    }
+
+    size_t head = (offset + size + _ORION_STAGING_ALIGNMENT - 1) & ~(size_t) (_ORION_STAGING_ALIGNMENT - 1);
+    _orion.textureUploadBufferHead = (head < _orion.textureUploadBufferSize) ? head : _orion.textureUploadBufferSize;
+
+    return offset;
+}
+
+// ======================================================================================
+// *****                        ORION TEXTURE LOADING FUNCTIONS                     *****
+// ======================================================================================
+
+/**
+ * @brief Start loading a 2D texture from an image file in the background, and return it straight away with a placeholder
+ * image.
+ *
+ * @details The image is decoded with stb_image on a worker thread (see oriSetWorkerThreadCount()), which also builds
+ * its mipmaps with oriGenerateMipChain() if they are asked for (sRGB-correct if the internal format is @c GL_SRGB8 or
+ * @c GL_SRGB8_ALPHA8). The levels are then uploaded over
+ * the following frames by oriProcessTextureLoads(), which must be called regularly (e.g. once per frame) on the thread
+ * with the GL context. Until then, the texture is a 1x1 opaque grey image. Once the upload is complete, the placeholder
+ * is replaced, keeping the filtering and wrapping parameters that were set on it, so the returned texture can be used
+ * straight away and will show the image once it is ready.
+ *
+ * If the internal format is block-compressed (see oriCompressImage()), the worker thread also compresses every level.
+ * The result is kept in the texture cache if one is set with oriSetTextureCacheDirectory(), keyed by the contents of the
+ * image file and the load parameters, so that later loads of the same image skip both decoding and compression.
+ *
+ * If the image can't be loaded, a warning is thrown by oriProcessTextureLoads() and the placeholder is kept.
+ *
+ * @param path the path of the image file (any format supported by stb_image, e.g. PNG or JPEG), relative to the
+ * location of the executable.
+ * @param params how to load the image, or NULL for the defaults (all zero/false, except that mipmaps are generated).
+ *
+ * @ingroup textures
+ */
+oriTexture *oriLoadTextureAsync(const char *path, const oriTextureLoadParams *params) {
+    _orionAssertVersion(210);
+
+    oriTexture *r = oriCreateTexture(GL_TEXTURE_2D, GL_RGBA8);
+
+    static const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+    oriUploadTexImage(r, GL_UNSIGNED_BYTE, placeholder, 1, 1, 0, GL_RGBA);
+
+    _oriTextureLoad *load = malloc(sizeof(_oriTextureLoad));
+    load->texture = r;
+
+    if (params) {
+        load->params = *params;
+    } else {
+        memset(&load->params, 0, sizeof(load->params));
+        load->params.generateMipmaps = true;
+    }
+
+    // (S3TC is an extension rather than part of core GL, so drivers can leave it out)
+    unsigned int format = load->params.internalFormat;
+    bool s3tc = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT ||
+        format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT || format == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    if (s3tc && !_orionHasExtension("GL_EXT_texture_compression_s3tc")) {
+        _orionThrowWarning("(in oriLoadTextureAsync()): S3TC compressed formats are not supported by the GL driver. Texture will be loaded uncompressed.");
+        load->params.internalFormat = 0;
+    }
+
+    size_t pathLength = strlen(path);
+    load->path = malloc(pathLength + 1);
+    memcpy(load->path, path, pathLength + 1);
+
+    load->cacheDir = NULL;
+    if (_orion.textureCacheDir) {
+        size_t cacheDirLength = strlen(_orion.textureCacheDir);
+        load->cacheDir = malloc(cacheDirLength + 1);
+        memcpy(load->cacheDir, _orion.textureCacheDir, cacheDirLength + 1);
+    }
+
+    load->pixels = NULL;
+    load->mipmaps = NULL;
+    load->width = 0;
+    load->height = 0;
+    load->channels = 0;
+    load->levels = 0;
+    load->failureReason = NULL;
+    load->compressed = NULL;
+    load->compressedSize = 0;
+    load->staging = 0;
+    load->level = 0;
+    load->levelOffset = 0;
+    load->rowsUploaded = 0;
+
+    r->load = load;
+
+    // add to global linked list
+    load->next = _orion.textureLoadListHead;
+    _orion.textureLoadListHead = load;
+
+    _orionSubmitJob(&load->job, _orionDecodeTexture);
+
+    return r;
+}
+
+/**
+ * @brief Upload the images of textures loaded with oriLoadTextureAsync() that have finished decoding.
+ *
+ * @details This must be called on the thread with the GL context, e.g. once per frame. Images are uploaded a few rows at a
+ * time, so that at most the budget set with oriSetTextureUploadBudget() is uploaded per call, and a large texture
+ * doesn't stall a single frame. The rows are staged in one pixel unpack buffer the size of the budget, shared by every
+ * load and reused as a ring.
+ *
+ * @ingroup textures
+ */
+void oriProcessTextureLoads() {
+    size_t budget = _orion.textureUploadBudget ? _orion.textureUploadBudget : _ORION_DEFAULT_UPLOAD_BUDGET;
+
+    _oriTextureLoad *load = _orion.textureLoadListHead;
+    while (load && budget) {
+        _oriTextureLoad *next = load->next;
+
+        if (_orionJobPending(&load->job)) {
+            load = next;
+            continue;
+        }
+
+        if (!load->pixels && !load->compressed) {
+            char message[512];
+            snprintf(message, sizeof(message), "(in oriProcessTextureLoads()): Failed to load image \"%s\" (%s). Placeholder texture kept.",
+                load->path, load->failureReason ? load->failureReason : "unknown error");
+            _orionThrowWarning(message);
+
+            _orionFreeTextureLoad(load);
+            load = next;
+            continue;
+        }
+
+        if (!load->staging) {
+            _orionBeginTextureUpload(load);
+        }
+
+        // upload level by level (always at least one row, so that the load progresses)
+        while (budget && load->level < load->levels) {
+            size_t rowSize = _orionLoadRowSize(load);
+            size_t rows = budget / rowSize;
+            if (!rows) {
+                rows = 1;
+            }
+            if (rows > _orionLoadRowCount(load) - load->rowsUploaded) {
+                rows = _orionLoadRowCount(load) - load->rowsUploaded;
+            }
+
+            _orionUploadTextureRows(load, (unsigned int) rows);
+            budget = (rows * rowSize < budget) ? budget - rows * rowSize : 0;
+        }
+
+        if (load->level == load->levels) {
+            _orionFinishTextureLoad(load);
+        }
+
+        load = next;
+    }
+}
+
+/**
+ * @brief Set the amount of bytes of image data that oriProcessTextureLoads(), oriProcessTextureStreaming() and
+ * oriUpdateVirtualTexture() each upload per call.
+ *
+ * @param bytes the upload budget in bytes, or 0 for the default (4 MiB).
+ *
+ * @ingroup textures
+ */
+void oriSetTextureUploadBudget(const size_t bytes) {
+    _orion.textureUploadBudget = bytes;
+}
+
+/**
+ * @brief Return true if the given texture was created with oriLoadTextureAsync() and is still showing its placeholder.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
+ */
+bool oriIsTextureLoading(oriTexture *texture) {
+    return texture->load != NULL;
+}
@@ -0,0 +1,587 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A texture managed by an oriTextureResidency, and the CPU copy of its levels that it is restored from.
+ *
+ */
+typedef struct _oriResidentTexture {
+    // (the residency's LRU list, most recently used first)
+    struct _oriResidentTexture *prev;
+    struct _oriResidentTexture *next;
+
+    oriTextureResidency *residency;
+    oriTexture *texture;
+
+    // every level of the texture, one after the other, and where each one starts
+    unsigned char *source;
+    size_t levelOffsets[32];
+    unsigned int levelCount;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int internalFormat;
+    unsigned int dataType;
+    unsigned int imageFormat;
+
+    // the first level on the GPU (0 if fully resident, or levelCount if the placeholder is), and its estimated size
+    unsigned int residentLevel;
+    size_t size;
+
+    // the update the texture was last bound in, and whether it was bound while evicted
+    unsigned long lastUsed;
+    bool requested;
+} _oriResidentTexture;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A GPU memory budget that managed textures are evicted to low-resolution mipmaps to stay under.
+ *
+ */
+typedef struct oriTextureResidency {
+    oriTextureResidency *next;
+
+    size_t budget;
+    unsigned int evictedSize;
+
+    _oriResidentTexture *mostRecent;
+    _oriResidentTexture *leastRecent;
+    size_t usage;
+
+    unsigned long frame;
+} oriTextureResidency;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// return the estimated size in bits of one texel of the given internal format, and whether it is block-compressed.
+static unsigned int _orionInternalFormatBits(unsigned int internalFormat, bool *compressed) {
+    *compressed = false;
+
+    switch (internalFormat) {
+        case GL_R8:
+        case GL_R8UI:
+        case GL_R8I:
+            return 8;
+        case GL_RG8:
+        case GL_R16:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 16;
+        case GL_RGB8:
+        case GL_SRGB8:
+            return 24;
+        case GL_RG16:
+        case GL_RG16F:
+        case GL_R32F:
+        case GL_R11F_G11F_B10F:
+        case GL_RGB10_A2:
+            return 32;
+        case GL_RGB16F:
+            return 48;
+        case GL_RGBA16:
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:
+            return 64;
+        case GL_RGB32F:
+            return 96;
+        case GL_RGBA32F:
+            return 128;
+
+        // block-compressed formats (8 or 16 bytes per 4x4 block)
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            *compressed = true;
+            return 4;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+        case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+            *compressed = true;
+            return 8;
+
+        // (RGBA8, depth-stencil and anything else that isn't listed)
+        default:
+            return 32;
+    }
+}
+
+// return the estimated size in bytes of the levels of a 2D texture from the given one down.
+static size_t _orionChainMemorySize(unsigned int internalFormat, unsigned int width, unsigned int height, unsigned int firstLevel, unsigned int levelCount) {
+    bool compressed;
+    size_t bits = _orionInternalFormatBits(internalFormat, &compressed);
+
+    size_t texels = 0;
+    for (unsigned int level = firstLevel; level < levelCount; level++) {
+        size_t w = (width >> level) ? (width >> level) : 1;
+        size_t h = (height >> level) ? (height >> level) : 1;
+
+        // (block-compressed levels are stored in whole 4x4 blocks)
+        if (compressed) {
+            w = (w + 3) & ~(size_t) 3;
+            h = (h + 3) & ~(size_t) 3;
+        }
+
+        texels += w * h;
+    }
+
+    return texels * bits / 8;
+}
+
+static void _orionUnlinkResident(_oriResidentTexture *resident) {
+    oriTextureResidency *residency = resident->residency;
+
+    if (resident->prev) {
+        resident->prev->next = resident->next;
+    } else {
+        residency->mostRecent = resident->next;
+    }
+    if (resident->next) {
+        resident->next->prev = resident->prev;
+    } else {
+        residency->leastRecent = resident->prev;
+    }
+}
+
+static void _orionPushResident(_oriResidentTexture *resident) {
+    oriTextureResidency *residency = resident->residency;
+
+    resident->prev = NULL;
+    resident->next = residency->mostRecent;
+    if (residency->mostRecent) {
+        residency->mostRecent->prev = resident;
+    } else {
+        residency->leastRecent = resident;
+    }
+    residency->mostRecent = resident;
+}
+
+// reallocate the texture with the levels of its source from the given one down (or as the placeholder if it is
+// levelCount), keeping its handle's sampling parameters.
+static void _orionSetResidentLevel(_oriResidentTexture *resident, unsigned int level) {
+    oriTexture *texture = resident->texture;
+
+    // (the texture gets a new handle, as immutable storage can't be shrunk and mutable storage would keep its old levels)
+    static const unsigned int parameters[] = {
+        GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T
+    };
+    int values[sizeof(parameters) / sizeof(parameters[0])];
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        values[i] = oriGetTextureParameteri(texture, parameters[i]);
+    }
+
+    // (the minifying filter may have been changed for the placeholder, so use the last one set by the application)
+    int minFilter = texture->minFilter;
+    values[0] = minFilter;
+
+    oriTexture *replacement;
+
+    if (level == resident->levelCount) {
+        static const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+
+        replacement = oriCreateTexture(GL_TEXTURE_2D, GL_RGBA8);
+        oriSetTextureMipmapPolicy(replacement, ORION_MIPMAPS_NEVER);
+        oriUploadTexImage(replacement, GL_UNSIGNED_BYTE, placeholder, 1, 1, 0, GL_RGBA);
+    } else {
+        unsigned int w = (resident->width >> level) ? (resident->width >> level) : 1;
+        unsigned int h = (resident->height >> level) ? (resident->height >> level) : 1;
+        unsigned int levelCount = resident->levelCount - level;
+
+        const void *levels[32];
+        for (unsigned int i = 0; i < levelCount; i++) {
+            levels[i] = resident->source + resident->levelOffsets[level + i];
+        }
+
+        if (_orion.glVersion >= 420) {
+            replacement = oriCreateTextureImmutable(GL_TEXTURE_2D, w, h, 0, resident->internalFormat, levelCount, 0, false);
+        } else {
+            replacement = oriCreateTexture(GL_TEXTURE_2D, resident->internalFormat);
+        }
+
+        if (_orionBlockSize(resident->internalFormat)) {
+            oriUploadCompressedTexMipmaps(replacement, resident->internalFormat, levels, levelCount, w, h);
+        } else {
+            oriUploadTexMipmaps(replacement, resident->dataType, levels, levelCount, w, h, resident->imageFormat);
+        }
+    }
+
+    unsigned int handle = texture->handle;
+    texture->handle = replacement->handle;
+    texture->internalFormat = replacement->internalFormat;
+    texture->width = replacement->width;
+    texture->height = replacement->height;
+    texture->levels = replacement->levels;
+    texture->immutableStorage = replacement->immutableStorage;
+    replacement->handle = handle;
+    oriFreeTexture(replacement);
+
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        // (the placeholder has no mipmaps to sample)
+        int value = values[i];
+        if (parameters[i] == GL_TEXTURE_MIN_FILTER && texture->levels == 1) {
+            value = (value == GL_NEAREST || value == GL_NEAREST_MIPMAP_NEAREST || value == GL_NEAREST_MIPMAP_LINEAR) ? GL_NEAREST : GL_LINEAR;
+        }
+        oriSetTextureParameteri(texture, parameters[i], value);
+    }
+
+    // (the filter set by the application is kept for when the texture is restored)
+    texture->minFilter = minFilter;
+
+    resident->residency->usage -= resident->size;
+    resident->size = oriGetTextureMemorySize(texture);
+    resident->residency->usage += resident->size;
+    resident->residentLevel = level;
+}
+
+// return the level that the given texture is evicted down to.
+static unsigned int _orionEvictedLevel(_oriResidentTexture *resident) {
+    unsigned int level = 0;
+    while (level < resident->levelCount && ((resident->width >> level) > resident->residency->evictedSize || (resident->height >> level) > resident->residency->evictedSize)) {
+        level++;
+    }
+
+    return level;
+}
+
+// evict the least recently used textures that weren't used in the last update until the given amount of bytes is free
+// under the budget, or until there are none left to evict.
+static void _orionEvictResidents(oriTextureResidency *residency, size_t needed) {
+    for (_oriResidentTexture *resident = residency->leastRecent; resident && residency->usage + needed > residency->budget; resident = resident->prev) {
+        if (resident->lastUsed >= residency->frame) {
+            // (everything before it in the list was used more recently)
+            break;
+        }
+
+        unsigned int level = _orionEvictedLevel(resident);
+        if (level > resident->residentLevel) {
+            _orionSetResidentLevel(resident, level);
+        }
+    }
+}
+
+void _orionTouchResidentTexture(_oriResidentTexture *resident) {
+    resident->lastUsed = resident->residency->frame;
+    if (resident->residentLevel) {
+        resident->requested = true;
+    }
+
+    if (resident->residency->mostRecent != resident) {
+        _orionUnlinkResident(resident);
+        _orionPushResident(resident);
+    }
+}
+
+void _orionUnmanageTexture(oriTexture *texture, bool restore) {
+    _oriResidentTexture *resident = texture->resident;
+
+    if (restore && resident->residentLevel) {
+        _orionSetResidentLevel(resident, 0);
+    }
+
+    _orionUnlinkResident(resident);
+    resident->residency->usage -= resident->size;
+
+    texture->resident = NULL;
+
+    free(resident->source);
+    free(resident);
+}
+
+// ======================================================================================
+// *****                      ORION TEXTURE RESIDENCY FUNCTIONS                     *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new texture residency manager.
+ *
+ * @details Textures added to the manager with oriAddResidentTexture() are counted against a GPU memory budget, with the
+ * estimate from oriGetTextureMemorySize(). When oriUpdateTextureResidency() finds the budget exceeded, the textures
+ * that were bound least recently (with oriBindTexture()) are evicted: their storage is reallocated with only the
+ * mipmap levels of at most @c evictedSize texels across, or with a 1x1 placeholder if they have no levels that small.
+ * A texture that is bound while evicted is restored to full resolution from its CPU copy by the next update.
+ *
+ * This lets an application keep more textures loaded than fit in GPU memory at once, as long as those that are drawn
+ * in any one frame do.
+ *
+ * @param budget the amount of GPU memory in bytes that the managed textures should fit in.
+ * @param evictedSize the largest width or height of the level that evicted textures keep, e.g. 64.
+ *
+ * @ingroup textures
+ */
+oriTextureResidency *oriCreateTextureResidency(size_t budget, unsigned int evictedSize) {
+    oriTextureResidency *r = malloc(sizeof(oriTextureResidency));
+    r->budget = budget;
+    r->evictedSize = evictedSize;
+    r->mostRecent = NULL;
+    r->leastRecent = NULL;
+    r->usage = 0;
+    r->frame = 0;
+
+    // push to global linked list
+    r->next = _orion.textureResidencyListHead;
+    _orion.textureResidencyListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Free memory for the given texture residency manager.
+ *
+ * @details Its textures are not freed; those that are evicted are restored to full resolution first.
+ *
+ * @param residency the texture residency manager to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureResidency(oriTextureResidency *residency) {
+    // unlink from global linked list.
+    if (_orion.textureResidencyListHead == residency) {
+        _orion.textureResidencyListHead = residency->next;
+    } else {
+        oriTextureResidency *current = _orion.textureResidencyListHead;
+        while (current->next != residency)
+            current = current->next;
+        current->next = residency->next;
+    }
+
+    while (residency->mostRecent) {
+        _orionUnmanageTexture(residency->mostRecent->texture, true);
+    }
+
+    free(residency);
+    residency = NULL;
+}
+
+/**
+ * @brief Set the amount of GPU memory that the textures of the given residency manager should fit in.
+ *
+ * @details If the budget is lowered, textures are evicted by the next call to oriUpdateTextureResidency().
+ *
+ * @param residency the texture residency manager to update.
+ * @param budget the budget in bytes.
+ *
+ * @ingroup textures
+ */
+void oriSetTextureResidencyBudget(oriTextureResidency *residency, size_t budget) {
+    residency->budget = budget;
+}
+
+/**
+ * @brief Start managing the residency of the given texture, keeping a CPU copy of its mipmap levels to restore it from.
+ *
+ * @details The texture must be a 2D texture that already holds the given levels (e.g. uploaded with
+ * oriUploadTexMipmaps() or oriUploadCompressedTexMipmaps()), which are copied so that the application can free its
+ * own. If the texture's internal format is block-compressed (see oriCompressImage()), the levels are compressed images
+ * in that format, and @c dataType and @c imageFormat are ignored. The more levels are given, the smaller the texture
+ * can be evicted to.
+ *
+ * The texture stops being managed when it is freed, or with oriRemoveResidentTexture().
+ *
+ * @param residency the texture residency manager to add the texture to.
+ * @param texture the texture to manage. It can only be managed by one residency manager.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows.
+ * @param levelCount the amount of levels, at most 32.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriAddResidentTexture(oriTextureResidency *residency, oriTexture *texture, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int imageFormat) {
+    if (texture->type != GL_TEXTURE_2D || texture->load || texture->stream) {
+        _orionThrowWarning("(in oriAddResidentTexture()): Only loaded GL_TEXTURE_2D textures that aren't streamed can be managed. Texture not added.");
+        return;
+    }
+    if (texture->resident) {
+        _orionThrowWarning("(in oriAddResidentTexture()): Texture is already managed by a residency manager. Texture not added.");
+        return;
+    }
+    if (!levelCount || levelCount > 32) {
+        _orionThrowWarning("(in oriAddResidentTexture()): Level count is 0 or above 32. Texture not added.");
+        return;
+    }
+
+    _oriResidentTexture *r = malloc(sizeof(_oriResidentTexture));
+    r->residency = residency;
+    r->texture = texture;
+    r->levelCount = levelCount;
+    r->width = texture->width;
+    r->height = texture->height;
+    r->internalFormat = texture->internalFormat;
+    r->dataType = dataType;
+    r->imageFormat = imageFormat;
+    r->residentLevel = 0;
+    r->lastUsed = residency->frame;
+    r->requested = false;
+
+    // copy the levels into one allocation
+    size_t size = 0;
+    for (unsigned int level = 0; level < levelCount; level++) {
+        unsigned int w = (r->width >> level) ? (r->width >> level) : 1;
+        unsigned int h = (r->height >> level) ? (r->height >> level) : 1;
+
+        r->levelOffsets[level] = size;
+        size += _orionBlockSize(r->internalFormat) ? oriGetCompressedImageSize(r->internalFormat, w, h) : (size_t) w * h * _orionTexelSize(imageFormat, dataType);
+    }
+
+    r->source = malloc(size);
+    for (unsigned int level = 0; level < levelCount; level++) {
+        size_t end = (level + 1 < levelCount) ? r->levelOffsets[level + 1] : size;
+        memcpy(r->source + r->levelOffsets[level], levels[level], end - r->levelOffsets[level]);
+    }
+
+    r->size = oriGetTextureMemorySize(texture);
+    residency->usage += r->size;
+
+    texture->resident = r;
+    _orionPushResident(r);
+}
+
+/**
+ * @brief Stop managing the residency of the given texture, restoring it to full resolution if it is evicted.
+ *
+ * @param texture the texture added to a residency manager with oriAddResidentTexture().
+ *
+ * @ingroup textures
+ */
+void oriRemoveResidentTexture(oriTexture *texture) {
+    if (!texture->resident) {
+        _orionThrowWarning("(in oriRemoveResidentTexture()): Texture is not managed by a residency manager. Texture not removed.");
+        return;
+    }
+
+    _orionUnmanageTexture(texture, true);
+}
+
+/**
+ * @brief Restore the textures of the given residency manager that have been bound since they were evicted, and evict
+ * the least recently used textures while the budget is exceeded.
+ *
+ * @details This should be called once per frame, e.g. before drawing. Textures bound since the previous update are
+ * never evicted, so the budget is exceeded if they don't fit in it on their own. A texture that is needed while
+ * evicted is shown at low resolution for the frame it is first bound in, and restored by the following update if
+ * enough textures can be evicted to make room for it.
+ *
+ * @param residency the texture residency manager to update.
+ *
+ * @ingroup textures
+ */
+void oriUpdateTextureResidency(oriTextureResidency *residency) {
+    // restore textures that were asked for, most recently used first
+    for (_oriResidentTexture *resident = residency->mostRecent; resident; resident = resident->next) {
+        if (!resident->requested) {
+            continue;
+        }
+        resident->requested = false;
+
+        size_t size = _orionChainMemorySize(resident->internalFormat, resident->width, resident->height, 0, resident->levelCount);
+        size_t needed = (size > resident->size) ? size - resident->size : 0;
+
+        _orionEvictResidents(residency, needed);
+        if (residency->usage + needed <= residency->budget) {
+            _orionSetResidentLevel(resident, 0);
+        }
+    }
+
+    // (e.g. if the budget was lowered, or textures were added)
+    _orionEvictResidents(residency, 0);
+
+    residency->frame++;
+}
+
+/**
+ * @brief Return the estimated amount of GPU memory in bytes used by the textures of the given residency manager.
+ *
+ * @param residency the texture residency manager to inspect.
+ *
+ * @ingroup textures
+ */
+size_t oriGetTextureResidencyUsage(oriTextureResidency *residency) {
+    return residency->usage;
+}
+
+/**
+ * @brief Return false if the given texture is managed by a residency manager and is evicted, or true otherwise.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
+ */
+bool oriIsTextureResident(oriTexture *texture) {
+    return !texture->resident || !texture->resident->residentLevel;
+}
+
+/**
+ * @brief Return an estimate of the amount of GPU memory in bytes used by the given texture's storage.
+ *
+ * @details This is calculated from the texture's dimensions, level count, sample count and internal format, so it
+ * doesn't include any padding or alignment added by the driver.
+ *
+ * @param texture the texture to inspect.
+ *
+ * @ingroup textures
+ */
+size_t oriGetTextureMemorySize(oriTexture *texture) {
+    unsigned int levels = texture->levels ? texture->levels : 1;
+    size_t samples = texture->samples ? texture->samples : 1;
+
+    switch (texture->type) {
+        case GL_TEXTURE_1D:
+            return _orionChainMemorySize(texture->internalFormat, texture->width, 1, 0, levels);
+        case GL_TEXTURE_1D_ARRAY:
+            // (the height is the layer count, which doesn't shrink with the level)
+            return _orionChainMemorySize(texture->internalFormat, texture->width, 1, 0, levels) * (texture->height ? texture->height : 1);
+        case GL_TEXTURE_3D: {
+            size_t size = 0;
+            for (unsigned int level = 0; level < levels; level++) {
+                size_t d = (texture->depth >> level) ? (texture->depth >> level) : 1;
+                size += _orionChainMemorySize(texture->internalFormat, texture->width, texture->height, level, level + 1) * d;
+            }
+            return size;
+        }
+        case GL_TEXTURE_CUBE_MAP:
+            return _orionChainMemorySize(texture->internalFormat, texture->width, texture->height, 0, levels) * 6;
+        case GL_TEXTURE_2D_ARRAY:
+        case GL_TEXTURE_CUBE_MAP_ARRAY:
+            return _orionChainMemorySize(texture->internalFormat, texture->width, texture->height, 0, levels) * (texture->depth ? texture->depth : 1);
+        case GL_TEXTURE_2D_MULTISAMPLE_ARRAY:
+            return _orionChainMemorySize(texture->internalFormat, texture->width, texture->height, 0, 1) * (texture->depth ? texture->depth : 1) * samples;
+        default:
+            return _orionChainMemorySize(texture->internalFormat, texture->width, texture->height, 0, levels) * samples;
+    }
+}
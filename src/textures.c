@@ -19,23 +19,21 @@
 #include "stdio.h"
 
 // ======================================================================================
-// *****                            ORION PUBLIC STRUCTURES                         *****
+// *****                              HELPER FUNCTIONS                              *****
 // ======================================================================================
 
-typedef struct oriTexture {
-    oriTexture *next;
-    unsigned int handle;
-
-    unsigned int type;
-    unsigned int width;
-    unsigned int height;
-    unsigned int depth;
-    unsigned int internalFormat;
-    unsigned int levels;
-    unsigned int samples;
-
-    bool immutableStorage;
-} oriTexture;
+// return true if the given texture's mipmap policy asks for mipmaps to be generated after an upload.
+static bool _orionWantsMipmaps(oriTexture *texture) {
+    switch (texture->mipmapPolicy) {
+        case ORION_MIPMAPS_ALWAYS:
+            return true;
+        case ORION_MIPMAPS_NEVER:
+            return false;
+        default:
+            // (only if the minifying filter samples mipmaps)
+            return texture->minFilter != GL_NEAREST && texture->minFilter != GL_LINEAR;
+    }
+}
 
 // ======================================================================================
 // *****                           ORION TEXTURE FUNCTIONS                          *****
@@ -73,6 +71,12 @@ oriTexture *oriCreateTexture(unsigned int target, unsigned int internalFormat) {
     r->levels = 0;
     r->samples = 0;
     r->immutableStorage = false;
+    r->mipmapPolicy = ORION_MIPMAPS_AUTO;
+    r->minFilter = GL_NEAREST_MIPMAP_LINEAR;
+    r->load = NULL;
+    r->resident = NULL;
+    r->stream = NULL;
+    r->shadowCount = 0;
 
     // use DSA if possible
     if (_orion.glVersion >= 450) {
@@ -230,12 +234,32 @@ oriTexture *oriCreateTextureImmutable(unsigned int target, unsigned int width, u
 void oriFreeTexture(oriTexture *texture) {
     _orionAssertVersion(200);
 
+    // cancel loading if the texture was created with oriLoadTextureAsync()
+    if (texture->load) {
+        _orionCancelTextureLoad(texture);
+    }
+    // stop managing its residency if it was added to a residency manager
+    if (texture->resident) {
+        _orionUnmanageTexture(texture, false);
+    }
+    // and stop streaming it if it was created with oriCreateStreamedTexture()
+    if (texture->stream) {
+        _orionFreeTextureStream(texture);
+    }
+    // and detach the texture shadows created of it with oriCreateTextureShadow()
+    if (texture->shadowCount) {
+        _orionDetachTextureShadows(texture);
+    }
+
     // unlink from global linked list.
-    oriTexture *current = _orion.textureListHead;
-    while (current != texture) {
-        current = current->next;
+    if (_orion.textureListHead == texture) {
+        _orion.textureListHead = texture->next;
+    } else {
+        oriTexture *current = _orion.textureListHead;
+        while (current->next != texture)
+            current = current->next;
+        current->next = texture->next;
     }
-    _orion.textureListHead = texture->next;
 
     glDeleteTextures(1, &texture->handle);
 
@@ -246,6 +270,8 @@ void oriFreeTexture(oriTexture *texture) {
 /**
  * @brief Bind a given texture to the specified target.
  *
+ * @details If the texture is managed by an oriTextureResidency, it is marked as used (see oriUpdateTextureResidency()).
+ *
  * @param texture the texture to bind.
  * @param unit the texture image unit to bind the texture to.
  *
@@ -254,6 +280,10 @@ void oriFreeTexture(oriTexture *texture) {
 void oriBindTexture(oriTexture *texture, unsigned int unit) {
     _orionAssertVersion(200);
 
+    if (texture->resident) {
+        _orionTouchResidentTexture(texture->resident);
+    }
+
     if (oriCurrentTextureAt(texture->type) == texture->handle) {
         return;
     }
@@ -302,7 +332,8 @@ void oriGetTextureProperty(oriTexture *texture, unsigned int *type, unsigned int
 /**
  * @brief Fill the given texture's storage with an image at the specified path.
  * 
- * @details The path is relative to the location of the executable.
+ * @details The path is relative to the location of the executable. Afterwards, mipmaps are generated according to the
+ * texture's mipmap policy (see oriSetTextureMipmapPolicy()).
  * 
  * @param texture the texture object to update.
  * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if @c data is an unsigned char array)
@@ -424,18 +455,312 @@ void oriUploadTexImage(oriTexture *texture, unsigned int dataType, const void *d
         }
     }
 
+    // generate mipmaps if the texture's mipmap policy asks for them
+    bool mipmaps = _orionWantsMipmaps(texture);
+
     // don't affect global state outside of this function
     if (_orion.glVersion < 450) {
-        // (generate mipmaps too)
-        glGenerateMipmap(texture->type);
+        if (mipmaps) {
+            glGenerateMipmap(texture->type);
+        }
 
         glBindTexture(texture->type, boundCache);
-    } else {
+    } else if (mipmaps) {
         // generate mipmap with DSA
         glGenerateTextureMipmap(texture->handle);
     }
 }
 
+/**
+ * @brief Update a region of one level of the given texture with an image, without reallocating its storage.
+ *
+ * @details Unlike oriUploadTexImage(), only the given region is written, and no mipmaps are generated (see
+ * oriGenerateTextureMipmaps()). The texture must already have storage for the region, i.e. it must have immutable
+ * storage or have had an image uploaded to it. For cube maps, @c z is the face index (0-5), in the order of
+ * @c GL_TEXTURE_CUBE_MAP_POSITIVE_X onwards.
+ *
+ * To batch many small updates into one upload per frame, use an oriTextureShadow instead.
+ *
+ * @param texture the texture object to update.
+ * @param level the mipmap level to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region (or the layer, for 1D array textures). Set to 0 if the texture is 1D.
+ * @param z the z offset of the region (or the layer or face, for array and cube map textures). Set to 0 if the texture
+ * is 1D or 2D.
+ * @param width the width of the region.
+ * @param height the height of the region. Set to 1 if the texture is 1D.
+ * @param depth the depth of the region. Set to 1 if the texture is 1D or 2D.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if @c data is an unsigned char array)
+ * @param data the image data to write to the region.
+ * @param imageFormat the format of the image data.
+ *
+ * @ingroup textures
+ */
+void oriUploadTexSubImage(oriTexture *texture, unsigned int level, int x, int y, int z, unsigned int width, unsigned int height, unsigned int depth, unsigned int dataType, const void *data, unsigned int imageFormat) {
+    _orionAssertVersion(200);
+
+    // 0: glTex*SubImage1D
+    // 1: glTex*SubImage2D
+    // 2: glTex*SubImage3D
+    unsigned int glTexImageFuncType;
+
+    switch (texture->type) {
+        case GL_TEXTURE_1D:
+            glTexImageFuncType = 0;
+            break;
+        case GL_TEXTURE_2D:
+        case GL_TEXTURE_RECTANGLE:
+        case GL_TEXTURE_1D_ARRAY:
+            glTexImageFuncType = 1;
+            break;
+        case GL_TEXTURE_CUBE_MAP:
+            // (without DSA, each face is updated as its own 2D target)
+            glTexImageFuncType = (_orion.glVersion >= 450) ? 2 : 1;
+            break;
+        case GL_TEXTURE_3D:
+        case GL_TEXTURE_2D_ARRAY:
+        case GL_TEXTURE_CUBE_MAP_ARRAY:
+            glTexImageFuncType = 2;
+            break;
+        case GL_TEXTURE_2D_MULTISAMPLE:
+        case GL_TEXTURE_2D_MULTISAMPLE_ARRAY:
+            _orionThrowWarning("(in oriUploadTexSubImage()): OpenGL does not support directly writing to multisample textures. Texture data not updated.");
+            return;
+        default:
+            _orionThrowWarning("(in oriUploadTexSubImage()): Unsupported texture type specified. Texture data not updated.");
+            return;
+    }
+
+    if (_orion.glVersion >= 450) {
+        switch (glTexImageFuncType) {
+            case 0:
+                glTextureSubImage1D(texture->handle, level, x, width, imageFormat, dataType, data);
+                break;
+            case 1:
+                glTextureSubImage2D(texture->handle, level, x, y, width, height, imageFormat, dataType, data);
+                break;
+            case 2:
+                glTextureSubImage3D(texture->handle, level, x, y, z, width, height, depth, imageFormat, dataType, data);
+                break;
+        }
+
+        return;
+    }
+
+    // bind to this again at the end of the function
+    unsigned int boundCache = oriCurrentTextureAt(texture->type);
+    glBindTexture(texture->type, texture->handle);
+
+    switch (glTexImageFuncType) {
+        case 0:
+            glTexSubImage1D(texture->type, level, x, width, imageFormat, dataType, data);
+            break;
+        case 1:
+            if (texture->type == GL_TEXTURE_CUBE_MAP) {
+                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + z, level, x, y, width, height, imageFormat, dataType, data);
+            } else {
+                glTexSubImage2D(texture->type, level, x, y, width, height, imageFormat, dataType, data);
+            }
+            break;
+        case 2:
+            glTexSubImage3D(texture->type, level, x, y, z, width, height, depth, imageFormat, dataType, data);
+            break;
+    }
+
+    // don't affect global state outside of this function
+    glBindTexture(texture->type, boundCache);
+}
+
+/**
+ * @brief Fill every mipmap level of the given 2D texture with the given images.
+ *
+ * @details This uploads a mipmap chain that was built ahead of time (e.g. with oriGenerateMipChain(), or loaded from a
+ * file), so no mipmaps are generated by the GL. If the texture has immutable storage, it must have at least
+ * @c levelCount levels; otherwise, storage is reallocated for each level, and @c GL_TEXTURE_MAX_LEVEL is set so that
+ * the texture is complete with only the given levels.
+ *
+ * @param texture the texture object to update. Its type must be @c GL_TEXTURE_2D.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level. Each level is half the size of the one
+ * above it (rounded down, to a minimum of 1), with tightly packed rows.
+ * @param levelCount the amount of levels to upload.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param imageFormat the format of the images.
+ *
+ * @ingroup textures
+ */
+void oriUploadTexMipmaps(oriTexture *texture, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height, unsigned int imageFormat) {
+    _orionAssertVersion(200);
+
+    if (texture->type != GL_TEXTURE_2D) {
+        _orionThrowWarning("(in oriUploadTexMipmaps()): Mipmap chains can only be uploaded to GL_TEXTURE_2D textures. Texture data not updated.");
+        return;
+    }
+    if (texture->immutableStorage && (levelCount > texture->levels || width != texture->width || height != texture->height)) {
+        _orionThrowWarning("(in oriUploadTexMipmaps()): Mipmap chain does not fit the texture's immutable storage. Texture data not updated.");
+        return;
+    }
+
+    // bind to this again at the end of the function if DSA is not used.
+    unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+    bool dsa = _orion.glVersion >= 450 && texture->immutableStorage;
+
+    if (!dsa) {
+        glBindTexture(GL_TEXTURE_2D, texture->handle);
+    }
+
+    // (the small levels of 1- and 3-channel images aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (unsigned int level = 0; level < levelCount; level++) {
+        unsigned int w = (width >> level) ? (width >> level) : 1;
+        unsigned int h = (height >> level) ? (height >> level) : 1;
+
+        if (dsa) {
+            glTextureSubImage2D(texture->handle, level, 0, 0, w, h, imageFormat, dataType, levels[level]);
+        } else if (texture->immutableStorage) {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, imageFormat, dataType, levels[level]);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, level, texture->internalFormat, w, h, 0, imageFormat, dataType, levels[level]);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    if (!texture->immutableStorage) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int) levelCount - 1);
+
+        // update texture properties as the texture storage has been reallocated.
+        texture->width = width;
+        texture->height = height;
+        texture->depth = 0;
+        texture->levels = levelCount;
+    }
+
+    // don't affect global state outside of this function
+    if (!dsa) {
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+    }
+}
+
+/**
+ * @brief Fill every mipmap level of the given 2D texture with the given block-compressed images.
+ *
+ * @details This is the compressed counterpart of oriUploadTexMipmaps(): each level is written with
+ * glCompressedTex(ture)SubImage2D if the texture has immutable storage (which must have the same compressed internal
+ * format and at least @c levelCount levels), or with glCompressedTexImage2D otherwise.
+ *
+ * @param texture the texture object to update. Its type must be @c GL_TEXTURE_2D.
+ * @param format the compressed format of the images (see oriCompressImage()).
+ * @param levels an array of @c levelCount compressed images, starting with the base level (e.g. from
+ * oriCompressImage()).
+ * @param levelCount the amount of levels to upload.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ *
+ * @ingroup textures
+ */
+void oriUploadCompressedTexMipmaps(oriTexture *texture, unsigned int format, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height) {
+    _orionAssertVersion(300);
+
+    if (texture->type != GL_TEXTURE_2D) {
+        _orionThrowWarning("(in oriUploadCompressedTexMipmaps()): Mipmap chains can only be uploaded to GL_TEXTURE_2D textures. Texture data not updated.");
+        return;
+    }
+    if (!_orionBlockSize(format)) {
+        _orionThrowWarning("(in oriUploadCompressedTexMipmaps()): Unsupported compressed format specified. Texture data not updated.");
+        return;
+    }
+    if (texture->immutableStorage && (levelCount > texture->levels || width != texture->width || height != texture->height)) {
+        _orionThrowWarning("(in oriUploadCompressedTexMipmaps()): Mipmap chain does not fit the texture's immutable storage. Texture data not updated.");
+        return;
+    }
+
+    // bind to this again at the end of the function if DSA is not used.
+    unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+    bool dsa = _orion.glVersion >= 450 && texture->immutableStorage;
+
+    if (!dsa) {
+        glBindTexture(GL_TEXTURE_2D, texture->handle);
+    }
+
+    for (unsigned int level = 0; level < levelCount; level++) {
+        unsigned int w = (width >> level) ? (width >> level) : 1;
+        unsigned int h = (height >> level) ? (height >> level) : 1;
+        int size = (int) oriGetCompressedImageSize(format, w, h);
+
+        if (dsa) {
+            glCompressedTextureSubImage2D(texture->handle, level, 0, 0, w, h, format, size, levels[level]);
+        } else if (texture->immutableStorage) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, format, size, levels[level]);
+        } else {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, format, w, h, 0, size, levels[level]);
+        }
+    }
+
+    if (!texture->immutableStorage) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int) levelCount - 1);
+
+        // update texture properties as the texture storage has been reallocated.
+        texture->internalFormat = format;
+        texture->width = width;
+        texture->height = height;
+        texture->depth = 0;
+        texture->levels = levelCount;
+    }
+
+    // don't affect global state outside of this function
+    if (!dsa) {
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+    }
+}
+
+/**
+ * @brief Generate the mipmaps of the given texture from its base level with the GL.
+ *
+ * @details This is done by oriUploadTexImage() if the texture's mipmap policy asks for it (see
+ * oriSetTextureMipmapPolicy()); call it directly when the policy is @c ORION_MIPMAPS_NEVER, e.g. after several partial
+ * updates.
+ *
+ * @param texture the texture to update.
+ *
+ * @ingroup textures
+ */
+void oriGenerateTextureMipmaps(oriTexture *texture) {
+    _orionAssertVersion(300);
+
+    if (_orion.glVersion >= 450) {
+        glGenerateTextureMipmap(texture->handle);
+    } else {
+        unsigned int boundCache = oriCurrentTextureAt(texture->type);
+        glBindTexture(texture->type, texture->handle);
+
+        glGenerateMipmap(texture->type);
+
+        glBindTexture(texture->type, boundCache);
+    }
+}
+
+/**
+ * @brief Set when oriUploadTexImage() generates mipmaps for the given texture.
+ *
+ * @details By default (@c ORION_MIPMAPS_AUTO), mipmaps are generated after an upload only if the texture's minifying
+ * filter samples them, so textures filtered with @c GL_NEAREST or @c GL_LINEAR (such as video frames) are uploaded
+ * without regenerating a mipmap chain every time. @c ORION_MIPMAPS_ALWAYS generates them after every upload, and
+ * @c ORION_MIPMAPS_NEVER leaves them to oriGenerateTextureMipmaps() or oriUploadTexMipmaps().
+ *
+ * @param texture the texture to update.
+ * @param policy the mipmap policy: @c ORION_MIPMAPS_AUTO, @c ORION_MIPMAPS_ALWAYS or @c ORION_MIPMAPS_NEVER.
+ *
+ * @ingroup textures
+ */
+void oriSetTextureMipmapPolicy(oriTexture *texture, unsigned int policy) {
+    texture->mipmapPolicy = policy;
+}
+
 /**
  * @brief Set a parameter for the given texture.
  *
@@ -448,6 +773,10 @@ void oriUploadTexImage(oriTexture *texture, unsigned int dataType, const void *d
 void oriSetTextureParameteri(oriTexture *texture, unsigned int param, int val) {
     _orionAssertVersion(200);
 
+    if (param == GL_TEXTURE_MIN_FILTER) {
+        texture->minFilter = val;
+    }
+
     if (_orion.glVersion >= 450) {
         glTextureParameteri(texture->handle, param, val);
     } else {
@@ -472,6 +801,10 @@ void oriSetTextureParameteri(oriTexture *texture, unsigned int param, int val) {
 void oriSetTextureParameterf(oriTexture *texture, unsigned int param, float val) {
     _orionAssertVersion(200);
 
+    if (param == GL_TEXTURE_MIN_FILTER) {
+        texture->minFilter = (int) val;
+    }
+
     if (_orion.glVersion >= 450) {
         glTextureParameterf(texture->handle, param, val);
     } else {
@@ -0,0 +1,460 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// the most dirty rectangles kept per shadow before they are merged regardless of the texels they waste.
+#define _ORION_MAX_DIRTY_RECTS 32
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief A rectangle of texels (from x0, y0 inclusive to x1, y1 exclusive) waiting to be uploaded.
+ *
+ */
+typedef struct _oriDirtyRect {
+    unsigned int x0;
+    unsigned int y0;
+    unsigned int x1;
+    unsigned int y1;
+} _oriDirtyRect;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A CPU copy of one level (and layer) of a texture, whose changed regions are uploaded together.
+ *
+ */
+typedef struct oriTextureShadow {
+    oriTextureShadow *next;
+
+    oriTexture *texture;
+    unsigned int level;
+    unsigned int layer;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int dataType;
+    unsigned int imageFormat;
+    size_t texelSize;
+
+    unsigned char *data;
+
+    _oriDirtyRect rects[_ORION_MAX_DIRTY_RECTS];
+    unsigned int rectCount;
+} oriTextureShadow;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+size_t _orionTexelSize(unsigned int imageFormat, unsigned int dataType) {
+    // (packed types hold every component in one value)
+    switch (dataType) {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+    }
+
+    size_t components;
+    switch (imageFormat) {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        case GL_RGBA:
+        case GL_BGRA:
+        case GL_RGBA_INTEGER:
+            components = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    switch (dataType) {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            return components * 4;
+        default:
+            return 0;
+    }
+}
+
+static size_t _orionRectArea(const _oriDirtyRect *r) {
+    return (size_t) (r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static _oriDirtyRect _orionRectUnion(const _oriDirtyRect *a, const _oriDirtyRect *b) {
+    _oriDirtyRect r;
+    r.x0 = (a->x0 < b->x0) ? a->x0 : b->x0;
+    r.y0 = (a->y0 < b->y0) ? a->y0 : b->y0;
+    r.x1 = (a->x1 > b->x1) ? a->x1 : b->x1;
+    r.y1 = (a->y1 > b->y1) ? a->y1 : b->y1;
+    return r;
+}
+
+// whether two rectangles overlap or share an edge (or a corner).
+static bool _orionRectsTouch(const _oriDirtyRect *a, const _oriDirtyRect *b) {
+    return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+// add a rectangle to the shadow's dirty list, merging it with the rectangles it overlaps or sits next to.
+static void _orionAddDirtyRect(oriTextureShadow *shadow, _oriDirtyRect rect) {
+    // (merge with touching rectangles while the union wastes little more than a quarter of the texels they cover)
+    bool merged = true;
+    while (merged) {
+        merged = false;
+
+        for (unsigned int i = 0; i < shadow->rectCount; i++) {
+            if (!_orionRectsTouch(&shadow->rects[i], &rect)) {
+                continue;
+            }
+
+            _oriDirtyRect u = _orionRectUnion(&shadow->rects[i], &rect);
+            size_t areas = _orionRectArea(&shadow->rects[i]) + _orionRectArea(&rect);
+
+            if (_orionRectArea(&u) <= areas + areas / 4) {
+                rect = u;
+                shadow->rects[i] = shadow->rects[--shadow->rectCount];
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (shadow->rectCount < _ORION_MAX_DIRTY_RECTS) {
+        shadow->rects[shadow->rectCount++] = rect;
+        return;
+    }
+
+    // with no room left, grow the rectangle that wastes the fewest texels to take this one in
+    unsigned int best = 0;
+    size_t bestWaste = (size_t) -1;
+    for (unsigned int i = 0; i < shadow->rectCount; i++) {
+        _oriDirtyRect u = _orionRectUnion(&shadow->rects[i], &rect);
+        size_t waste = _orionRectArea(&u) - _orionRectArea(&shadow->rects[i]);
+        if (waste < bestWaste) {
+            best = i;
+            bestWaste = waste;
+        }
+    }
+    shadow->rects[best] = _orionRectUnion(&shadow->rects[best], &rect);
+}
+
+void _orionDetachTextureShadows(oriTexture *texture) {
+    for (oriTextureShadow *shadow = _orion.textureShadowListHead; shadow; shadow = shadow->next) {
+        if (shadow->texture == texture) {
+            shadow->texture = NULL;
+            shadow->rectCount = 0;
+        }
+    }
+    texture->shadowCount = 0;
+}
+
+// ======================================================================================
+// *****                        ORION TEXTURE SHADOW FUNCTIONS                      *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a CPU copy of one level of the given texture, for batching small updates to it.
+ *
+ * @details Updates are written to the shadow with oriWriteTextureShadow() (or directly through
+ * oriGetTextureShadowData() and oriMarkTextureShadowDirty()), which only records the regions that changed. Regions that
+ * overlap or sit next to each other are merged when their bounding rectangle wastes few texels. oriFlushTextureShadows()
+ * then uploads the changed regions of every shadow through one pixel unpack buffer, e.g. once per frame. This suits
+ * dynamic atlases, lightmap patches and video tiles, which change a few small regions at a time.
+ *
+ * The texture's storage is not read back: the shadow starts with the given image, or zeroes.
+ *
+ * @param texture the texture to shadow. It must already have storage for the level.
+ * @param level the mipmap level to shadow. It must be less than the texture's level count, if that is known.
+ * @param layer the layer (or face, for cube maps) to shadow, for array, cube map and 3D textures. Set to 0 otherwise.
+ * @param dataType the GL type of the shadow's texels (e.g. GL_UNSIGNED_BYTE).
+ * @param imageFormat the format of the shadow's texels (e.g. GL_RGBA).
+ * @param data the initial image of the shadow, with tightly packed rows, or NULL to start with zeroes.
+ *
+ * @warning If the texture is freed before the shadow, the shadow is detached from it and its changes are no longer
+ * uploaded; it must still be freed with oriFreeTextureShadow().
+ *
+ * @ingroup textures
+ */
+oriTextureShadow *oriCreateTextureShadow(oriTexture *texture, unsigned int level, unsigned int layer, unsigned int dataType, unsigned int imageFormat, const void *data) {
+    _orionAssertVersion(300);
+
+    size_t texelSize = _orionTexelSize(imageFormat, dataType);
+    if (!texelSize) {
+        _orionThrowWarning("(in oriCreateTextureShadow()): Unsupported image format or data type specified. Texture shadow not created.");
+        return NULL;
+    }
+
+    if (!texture->width) {
+        _orionThrowWarning("(in oriCreateTextureShadow()): Texture has no storage. Texture shadow not created.");
+        return NULL;
+    }
+
+    if (level >= 32 || (texture->levels && level >= texture->levels)) {
+        _orionThrowWarning("(in oriCreateTextureShadow()): Level is out of the texture's range. Texture shadow not created.");
+        return NULL;
+    }
+
+    unsigned int width = (texture->width >> level) ? (texture->width >> level) : 1;
+    unsigned int height = (texture->height >> level) ? (texture->height >> level) : 1;
+
+    oriTextureShadow *r = malloc(sizeof(oriTextureShadow));
+    r->texture = texture;
+    r->level = level;
+    r->layer = layer;
+    r->width = width;
+    r->height = height;
+    r->dataType = dataType;
+    r->imageFormat = imageFormat;
+    r->texelSize = texelSize;
+    r->rectCount = 0;
+
+    size_t size = (size_t) width * height * texelSize;
+    r->data = malloc(size);
+    if (data) {
+        memcpy(r->data, data, size);
+    } else {
+        memset(r->data, 0, size);
+    }
+
+    texture->shadowCount++;
+
+    // push to global linked list
+    r->next = _orion.textureShadowListHead;
+    _orion.textureShadowListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given texture shadow.
+ *
+ * @details Changes that haven't been flushed with oriFlushTextureShadows() are discarded.
+ *
+ * @param shadow the texture shadow to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeTextureShadow(oriTextureShadow *shadow) {
+    // unlink from global linked list.
+    if (_orion.textureShadowListHead == shadow) {
+        _orion.textureShadowListHead = shadow->next;
+    } else {
+        oriTextureShadow *current = _orion.textureShadowListHead;
+        while (current->next != shadow)
+            current = current->next;
+        current->next = shadow->next;
+    }
+
+    if (shadow->texture) {
+        shadow->texture->shadowCount--;
+    }
+
+    free(shadow->data);
+
+    free(shadow);
+    shadow = NULL;
+}
+
+/**
+ * @brief Return the CPU copy of the texels of the given texture shadow.
+ *
+ * @details Rows are tightly packed, starting from the first row of the texture. Regions written through this pointer
+ * must be marked with oriMarkTextureShadowDirty() to be uploaded.
+ *
+ * @param shadow the texture shadow to inspect.
+ *
+ * @ingroup textures
+ */
+void *oriGetTextureShadowData(oriTextureShadow *shadow) {
+    return shadow->data;
+}
+
+/**
+ * @brief Mark a region of the given texture shadow as changed, so that it is uploaded by the next call to
+ * oriFlushTextureShadows().
+ *
+ * @details The region is clipped to the shadow.
+ *
+ * @param shadow the texture shadow to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region, in texels.
+ * @param width the width of the region.
+ * @param height the height of the region.
+ *
+ * @ingroup textures
+ */
+void oriMarkTextureShadowDirty(oriTextureShadow *shadow, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    if (!shadow->texture || x >= shadow->width || y >= shadow->height || !width || !height) {
+        return;
+    }
+
+    _oriDirtyRect rect;
+    rect.x0 = x;
+    rect.y0 = y;
+    rect.x1 = (width > shadow->width - x) ? shadow->width : x + width;
+    rect.y1 = (height > shadow->height - y) ? shadow->height : y + height;
+
+    _orionAddDirtyRect(shadow, rect);
+}
+
+/**
+ * @brief Write an image to a region of the given texture shadow and mark it as changed.
+ *
+ * @param shadow the texture shadow to update.
+ * @param x the x offset of the region, in texels.
+ * @param y the y offset of the region, in texels.
+ * @param width the width of the region (and the image).
+ * @param height the height of the region (and the image).
+ * @param data the image to write, with tightly packed rows, in the data type and format of the shadow.
+ *
+ * @ingroup textures
+ */
+void oriWriteTextureShadow(oriTextureShadow *shadow, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void *data) {
+    if (x > shadow->width || width > shadow->width - x || y > shadow->height || height > shadow->height - y) {
+        _orionThrowWarning("(in oriWriteTextureShadow()): Region is out of the shadow's bounds. Texture shadow not updated.");
+        return;
+    }
+
+    size_t rowSize = (size_t) width * shadow->texelSize;
+    for (unsigned int row = 0; row < height; row++) {
+        memcpy(shadow->data + ((size_t) (y + row) * shadow->width + x) * shadow->texelSize, (const unsigned char *) data + row * rowSize, rowSize);
+    }
+
+    oriMarkTextureShadowDirty(shadow, x, y, width, height);
+}
+
+/**
+ * @brief Upload the changed regions of every texture shadow.
+ *
+ * @details The regions are packed into one pixel unpack buffer (orphaned and mapped once per call), then copied into
+ * their textures with one glTex(ture)SubImage* call each. Call this once per frame, before drawing with the textures.
+ * No mipmaps are generated; use oriGenerateTextureMipmaps() if the shadowed level is the base of a mipmapped texture.
+ *
+ * @ingroup textures
+ */
+void oriFlushTextureShadows() {
+    _orionAssertVersion(300);
+
+    size_t total = 0;
+    for (oriTextureShadow *shadow = _orion.textureShadowListHead; shadow; shadow = shadow->next) {
+        for (unsigned int i = 0; i < shadow->rectCount; i++) {
+            size_t size = _orionRectArea(&shadow->rects[i]) * shadow->texelSize;
+            total += (size + _ORION_STAGING_ALIGNMENT - 1) & ~(size_t) (_ORION_STAGING_ALIGNMENT - 1);
+        }
+    }
+
+    if (!total) {
+        return;
+    }
+
+    unsigned int bufferCache = oriCurrentBufferAt(GL_PIXEL_UNPACK_BUFFER);
+
+    if (!_orion.textureShadowBuffer) {
+        glGenBuffers(1, &_orion.textureShadowBuffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _orion.textureShadowBuffer);
+
+    // (orphan the buffer, so this doesn't wait for the previous flush to be consumed)
+    if (total > _orion.textureShadowBufferSize) {
+        _orion.textureShadowBufferSize = total;
+    }
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, _orion.textureShadowBufferSize, NULL, GL_STREAM_DRAW);
+
+    unsigned char *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!staging) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferCache);
+        _orionThrowWarning("(in oriFlushTextureShadows()): Failed to map the staging buffer. Textures not updated.");
+        return;
+    }
+
+    // pack the regions tightly, one after the other
+    size_t offset = 0;
+    for (oriTextureShadow *shadow = _orion.textureShadowListHead; shadow; shadow = shadow->next) {
+        for (unsigned int i = 0; i < shadow->rectCount; i++) {
+            _oriDirtyRect *rect = &shadow->rects[i];
+            size_t rowSize = (size_t) (rect->x1 - rect->x0) * shadow->texelSize;
+
+            for (unsigned int y = rect->y0; y < rect->y1; y++) {
+                memcpy(staging + offset, shadow->data + ((size_t) y * shadow->width + rect->x0) * shadow->texelSize, rowSize);
+                offset += rowSize;
+            }
+            offset = (offset + _ORION_STAGING_ALIGNMENT - 1) & ~(size_t) (_ORION_STAGING_ALIGNMENT - 1);
+        }
+    }
+
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // (rows of odd-sized regions aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // copy each region into its texture; with a pixel unpack buffer bound, the pointer is an offset into it
+    offset = 0;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+    for (oriTextureShadow *shadow = _orion.textureShadowListHead; shadow; shadow = shadow->next) {
+        for (unsigned int i = 0; i < shadow->rectCount; i++) {
+            _oriDirtyRect *rect = &shadow->rects[i];
+
+            oriUploadTexSubImage(shadow->texture, shadow->level, rect->x0, rect->y0, shadow->layer, rect->x1 - rect->x0, rect->y1 - rect->y0, 1,
+                shadow->dataType, (const void *) offset, shadow->imageFormat);
+
+            offset += _orionRectArea(rect) * shadow->texelSize;
+            offset = (offset + _ORION_STAGING_ALIGNMENT - 1) & ~(size_t) (_ORION_STAGING_ALIGNMENT - 1);
+        }
+
+        shadow->rectCount = 0;
+    }
+#pragma GCC diagnostic pop
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferCache);
+}
@@ -0,0 +1,505 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// the largest width or height of the levels that are always resident.
+#define _ORION_STREAM_TAIL_SIZE 64
+// the amount of calls to oriProcessTextureStreaming() that levels must go unrequested for before they are dropped.
+#define _ORION_STREAM_DROP_DELAY 60
+// how much GL_TEXTURE_MIN_LOD is lowered per call to oriProcessTextureStreaming() as a new level fades in.
+#define _ORION_STREAM_FADE_STEP 0.25f
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief The streaming state of a texture created with oriCreateStreamedTexture().
+ *
+ */
+typedef struct _oriTextureStream {
+    _oriTextureStream *next;
+
+    oriTexture *texture;
+
+    // every level of the texture, one after the other, and where each one starts
+    unsigned char *source;
+    size_t levelOffsets[32];
+    unsigned int levelCount;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int internalFormat;
+    unsigned int dataType;
+    unsigned int imageFormat;
+
+    // the finest level in the texture's storage (its storage level 0), and the finest that is always kept
+    unsigned int first;
+    unsigned int tail;
+
+    // the finest level requested since the last call to oriProcessTextureStreaming() (levelCount if none was), and
+    // the amount of calls that the finest level in storage has gone unrequested for
+    unsigned int requested;
+    unsigned int unrequestedCalls;
+
+    // while the first level is being uploaded, the amount of its rows uploaded
+    bool uploading;
+    unsigned int rowsUploaded;
+
+    // GL_TEXTURE_MIN_LOD, raised when a level has just been uploaded so that it fades in
+    float minLod;
+} _oriTextureStream;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static unsigned int _orionStreamLevelWidth(_oriTextureStream *stream, unsigned int level) {
+    return (stream->width >> level) ? (stream->width >> level) : 1;
+}
+
+static unsigned int _orionStreamLevelHeight(_oriTextureStream *stream, unsigned int level) {
+    return (stream->height >> level) ? (stream->height >> level) : 1;
+}
+
+// return the size in bytes of one row of the given level (a row of blocks if the texture is compressed).
+static size_t _orionStreamRowSize(_oriTextureStream *stream, unsigned int level) {
+    unsigned int blockSize = _orionBlockSize(stream->internalFormat);
+    if (blockSize) {
+        return (size_t) ((_orionStreamLevelWidth(stream, level) + 3) / 4) * blockSize;
+    }
+    return (size_t) _orionStreamLevelWidth(stream, level) * _orionTexelSize(stream->imageFormat, stream->dataType);
+}
+
+// return the amount of rows of the given level (rows of blocks if the texture is compressed).
+static unsigned int _orionStreamRowCount(_oriTextureStream *stream, unsigned int level) {
+    unsigned int h = _orionStreamLevelHeight(stream, level);
+    return _orionBlockSize(stream->internalFormat) ? (h + 3) / 4 : h;
+}
+
+// upload the levels of the source from the given one down to the texture as they are.
+static void _orionUploadStreamLevels(_oriTextureStream *stream, oriTexture *texture, unsigned int firstLevel) {
+    const void *levels[32];
+    for (unsigned int level = firstLevel; level < stream->levelCount; level++) {
+        levels[level - firstLevel] = stream->source + stream->levelOffsets[level];
+    }
+
+    unsigned int w = _orionStreamLevelWidth(stream, firstLevel);
+    unsigned int h = _orionStreamLevelHeight(stream, firstLevel);
+
+    if (_orionBlockSize(stream->internalFormat)) {
+        oriUploadCompressedTexMipmaps(texture, stream->internalFormat, levels, stream->levelCount - firstLevel, w, h);
+    } else {
+        oriUploadTexMipmaps(texture, stream->dataType, levels, stream->levelCount - firstLevel, w, h, stream->imageFormat);
+    }
+}
+
+// reallocate the texture's storage with the levels of the source from the given one down, keeping the contents of the
+// levels it already has. Levels that it didn't have are left undefined.
+static void _orionReallocateStream(_oriTextureStream *stream, unsigned int first) {
+    oriTexture *texture = stream->texture;
+
+    static const unsigned int parameters[] = {
+        GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T
+    };
+    int values[sizeof(parameters) / sizeof(parameters[0])];
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        values[i] = oriGetTextureParameteri(texture, parameters[i]);
+    }
+
+    unsigned int levelCount = stream->levelCount - first;
+    oriTexture *replacement = oriCreateTextureImmutable(GL_TEXTURE_2D, _orionStreamLevelWidth(stream, first), _orionStreamLevelHeight(stream, first), 0,
+        stream->internalFormat, levelCount, 0, false);
+
+    unsigned int kept = (first > stream->first) ? first : stream->first;
+
+    if (_orion.glVersion >= 430) {
+        // copy the levels that both have on the GPU
+        for (unsigned int level = kept; level < stream->levelCount; level++) {
+            glCopyImageSubData(texture->handle, GL_TEXTURE_2D, level - stream->first, 0, 0, 0, replacement->handle, GL_TEXTURE_2D, level - first, 0, 0, 0,
+                _orionStreamLevelWidth(stream, level), _orionStreamLevelHeight(stream, level), 1);
+        }
+    } else {
+        // (without glCopyImageSubData, they are uploaded again from the source; the coarser levels are a third of the
+        // size of the finest one together, so this costs little)
+        int alignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        for (unsigned int level = kept; level < stream->levelCount; level++) {
+            unsigned int w = _orionStreamLevelWidth(stream, level);
+            unsigned int h = _orionStreamLevelHeight(stream, level);
+            const unsigned char *data = stream->source + stream->levelOffsets[level];
+
+            if (_orionBlockSize(stream->internalFormat)) {
+                size_t size = (size_t) _orionStreamRowCount(stream, level) * _orionStreamRowSize(stream, level);
+
+                unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, replacement->handle);
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, level - first, 0, 0, w, h, stream->internalFormat, (int) size, data);
+                glBindTexture(GL_TEXTURE_2D, boundCache);
+            } else {
+                oriUploadTexSubImage(replacement, level - first, 0, 0, 0, w, h, 1, stream->dataType, data, stream->imageFormat);
+            }
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    }
+
+    unsigned int handle = texture->handle;
+    texture->handle = replacement->handle;
+    texture->width = replacement->width;
+    texture->height = replacement->height;
+    texture->levels = replacement->levels;
+    replacement->handle = handle;
+    oriFreeTexture(replacement);
+
+    int minFilter = texture->minFilter;
+    for (unsigned int i = 0; i < sizeof(parameters) / sizeof(parameters[0]); i++) {
+        oriSetTextureParameteri(texture, parameters[i], (parameters[i] == GL_TEXTURE_MIN_FILTER) ? minFilter : values[i]);
+    }
+
+    // (a new finest level is undefined until it has been uploaded, so sampling starts from the one below it)
+    oriSetTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, (first < stream->first) ? (int) (stream->first - first) : 0);
+
+    // (a level that is still fading in carries on doing so, as GL_TEXTURE_MIN_LOD is relative to the base level, but
+    // dropping levels ends the fade)
+    if (first > stream->first) {
+        stream->minLod = 0.0f;
+    }
+    oriSetTextureParameterf(texture, GL_TEXTURE_MIN_LOD, stream->minLod);
+
+    stream->first = first;
+}
+
+// start streaming the level above the finest one in storage.
+static void _orionBeginStreamLevel(_oriTextureStream *stream) {
+    _orionReallocateStream(stream, stream->first - 1);
+
+    stream->uploading = true;
+    stream->rowsUploaded = 0;
+}
+
+// stage the given rows of the level being streamed through the upload buffer and copy them into the texture.
+static void _orionUploadStreamRows(_oriTextureStream *stream, unsigned int rows) {
+    oriTexture *texture = stream->texture;
+    unsigned int level = stream->first;
+    bool compressed = _orionBlockSize(stream->internalFormat) != 0;
+
+    size_t rowSize = _orionStreamRowSize(stream, level);
+    size_t offset = (size_t) stream->rowsUploaded * rowSize;
+    const unsigned char *data = stream->source + stream->levelOffsets[level] + offset;
+
+    unsigned int width = _orionStreamLevelWidth(stream, level);
+    unsigned int y = compressed ? stream->rowsUploaded * 4 : stream->rowsUploaded;
+    unsigned int height = rows;
+    if (compressed) {
+        height = (rows * 4 < _orionStreamLevelHeight(stream, level) - y) ? rows * 4 : _orionStreamLevelHeight(stream, level) - y;
+    }
+
+    // (rows of 1- and 3-channel images aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    unsigned int bufferCache = oriCurrentBufferAt(GL_PIXEL_UNPACK_BUFFER);
+    size_t staged = _orionStageTextureUpload(data, rows * rowSize);
+
+    // with a pixel unpack buffer bound, the pointer is an offset into it (and the level is storage level 0)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+    if (_orion.glVersion >= 450) {
+        if (compressed) {
+            glCompressedTextureSubImage2D(texture->handle, 0, 0, y, width, height, stream->internalFormat, rows * rowSize, (const void *) staged);
+        } else {
+            glTextureSubImage2D(texture->handle, 0, 0, y, width, height, stream->imageFormat, stream->dataType, (const void *) staged);
+        }
+    } else {
+        unsigned int boundCache = oriCurrentTextureAt(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, texture->handle);
+        if (compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, height, stream->internalFormat, rows * rowSize, (const void *) staged);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, height, stream->imageFormat, stream->dataType, (const void *) staged);
+        }
+        glBindTexture(GL_TEXTURE_2D, boundCache);
+    }
+#pragma GCC diagnostic pop
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferCache);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    stream->rowsUploaded += rows;
+}
+
+// start sampling the level that has finished streaming, fading it in over the next few calls.
+static void _orionFinishStreamLevel(_oriTextureStream *stream) {
+    stream->uploading = false;
+
+    oriSetTextureParameteri(stream->texture, GL_TEXTURE_BASE_LEVEL, 0);
+
+    stream->minLod = 1.0f;
+    oriSetTextureParameterf(stream->texture, GL_TEXTURE_MIN_LOD, stream->minLod);
+}
+
+void _orionFreeTextureStream(oriTexture *texture) {
+    _oriTextureStream *stream = texture->stream;
+
+    // unlink from global linked list.
+    if (_orion.textureStreamListHead == stream) {
+        _orion.textureStreamListHead = stream->next;
+    } else {
+        _oriTextureStream *current = _orion.textureStreamListHead;
+        while (current->next != stream)
+            current = current->next;
+        current->next = stream->next;
+    }
+
+    texture->stream = NULL;
+
+    free(stream->source);
+    free(stream);
+}
+
+// ======================================================================================
+// *****                       ORION TEXTURE STREAMING FUNCTIONS                    *****
+// ======================================================================================
+
+/**
+ * @brief Create a 2D texture whose finer mipmap levels are only uploaded while they are needed.
+ *
+ * @details The texture is created with immutable storage holding only the levels of at most 64 texels across, which
+ * are always kept. Each frame, the finest level that is needed is reported with oriRequestTextureLevel() or
+ * oriRequestTextureCoverage() (e.g. from the size of the objects that use the texture on screen, or from a feedback
+ * pass), and oriProcessTextureStreaming() streams finer levels in one at a time as demand rises, and drops them again
+ * once they have gone unrequested for a while. A texture that only ever covers 40 pixels on screen is then never
+ * uploaded at full resolution.
+ *
+ * Levels are added and dropped by reallocating the texture's storage with one more or fewer level, keeping the
+ * contents of the others, so the texture's handle changes (see oriGetTextureHandle()). While a new level is being
+ * uploaded, @c GL_TEXTURE_BASE_LEVEL keeps it from being sampled; once it is complete, @c GL_TEXTURE_MIN_LOD is
+ * lowered to it over a few frames so that it fades in rather than popping.
+ *
+ * The levels are copied so that the application can free its own. If the internal format is block-compressed (see
+ * oriCompressImage()), the levels are compressed images in that format, and @c dataType and @c imageFormat are
+ * ignored. The texture can't be added to an oriTextureResidency.
+ *
+ * @param internalFormat the internal format of the texture.
+ * @param dataType the GL type of the given data (e.g. GL_UNSIGNED_BYTE if the images are unsigned char arrays)
+ * @param levels an array of @c levelCount images, starting with the base level, with tightly packed rows (e.g. from
+ * oriGenerateMipChain()).
+ * @param levelCount the amount of levels, at most oriGetMipLevelCount() of the width and height.
+ * @param width the width of the base level.
+ * @param height the height of the base level.
+ * @param imageFormat the format of the images.
+ * @return the texture, or NULL if the size or level count is out of range.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriCreateStreamedTexture(unsigned int internalFormat, unsigned int dataType, const void *const *levels, unsigned int levelCount, unsigned int width, unsigned int height, unsigned int imageFormat) {
+    _orionAssertVersion(420);
+
+    if (!width || !height) {
+        _orionThrowWarning("(in oriCreateStreamedTexture()): Width or height is 0. Texture not created.");
+        return NULL;
+    }
+    if (!levelCount || levelCount > oriGetMipLevelCount(width, height)) {
+        _orionThrowWarning("(in oriCreateStreamedTexture()): Level count is 0 or above the amount of mipmap levels of the given size. Texture not created.");
+        return NULL;
+    }
+
+    _oriTextureStream *stream = malloc(sizeof(_oriTextureStream));
+    stream->levelCount = levelCount;
+    stream->width = width;
+    stream->height = height;
+    stream->internalFormat = internalFormat;
+    stream->dataType = dataType;
+    stream->imageFormat = imageFormat;
+    stream->requested = levelCount;
+    stream->unrequestedCalls = 0;
+    stream->uploading = false;
+    stream->rowsUploaded = 0;
+    stream->minLod = 0.0f;
+
+    // copy the levels into one allocation
+    size_t size = 0;
+    for (unsigned int level = 0; level < levelCount; level++) {
+        stream->levelOffsets[level] = size;
+        size += (size_t) _orionStreamRowCount(stream, level) * _orionStreamRowSize(stream, level);
+    }
+
+    stream->source = malloc(size);
+    for (unsigned int level = 0; level < levelCount; level++) {
+        size_t end = (level + 1 < levelCount) ? stream->levelOffsets[level + 1] : size;
+        memcpy(stream->source + stream->levelOffsets[level], levels[level], end - stream->levelOffsets[level]);
+    }
+
+    // the levels that are always resident
+    stream->tail = 0;
+    while (stream->tail + 1 < levelCount && (_orionStreamLevelWidth(stream, stream->tail) > _ORION_STREAM_TAIL_SIZE || _orionStreamLevelHeight(stream, stream->tail) > _ORION_STREAM_TAIL_SIZE)) {
+        stream->tail++;
+    }
+    stream->first = stream->tail;
+
+    oriTexture *r = oriCreateTextureImmutable(GL_TEXTURE_2D, _orionStreamLevelWidth(stream, stream->first), _orionStreamLevelHeight(stream, stream->first), 0,
+        internalFormat, levelCount - stream->first, 0, false);
+    oriSetTextureParameteri(r, GL_TEXTURE_MIN_FILTER, (levelCount > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    oriSetTextureParameteri(r, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    _orionUploadStreamLevels(stream, r, stream->first);
+
+    stream->texture = r;
+    r->stream = stream;
+
+    // add to global linked list
+    stream->next = _orion.textureStreamListHead;
+    _orion.textureStreamListHead = stream;
+
+    return r;
+}
+
+/**
+ * @brief Report the finest mipmap level of the given streamed texture that is needed this frame.
+ *
+ * @details This can be called any amount of times per frame (e.g. once per object that uses the texture); the finest
+ * level reported since the last call to oriProcessTextureStreaming() is used. Textures that aren't reported in a frame
+ * are treated as needing only their coarsest levels.
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ * @param level the finest level needed (0 for the full-resolution level).
+ *
+ * @ingroup textures
+ */
+void oriRequestTextureLevel(oriTexture *texture, unsigned int level) {
+    if (!texture->stream) {
+        _orionThrowWarning("(in oriRequestTextureLevel()): Texture was not created with oriCreateStreamedTexture(). Level not requested.");
+        return;
+    }
+
+    if (level < texture->stream->requested) {
+        texture->stream->requested = level;
+    }
+}
+
+/**
+ * @brief Report the finest mipmap level of the given streamed texture that is needed this frame from the amount of
+ * pixels that it covers on screen.
+ *
+ * @details This is a shortcut for oriRequestTextureLevel() with the level that has about as many texels across as the
+ * texture covers pixels (the texture is assumed not to be tiled).
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ * @param pixels the size in pixels that the texture's width or height (whichever is larger) covers on screen.
+ *
+ * @ingroup textures
+ */
+void oriRequestTextureCoverage(oriTexture *texture, float pixels) {
+    if (!texture->stream) {
+        _orionThrowWarning("(in oriRequestTextureCoverage()): Texture was not created with oriCreateStreamedTexture(). Level not requested.");
+        return;
+    }
+
+    _oriTextureStream *stream = texture->stream;
+    float size = (float) ((stream->width > stream->height) ? stream->width : stream->height);
+
+    float level = (pixels > 0.0f) ? floorf(log2f(size / pixels)) : (float) stream->levelCount;
+    oriRequestTextureLevel(texture, (level > 0.0f) ? (unsigned int) level : 0);
+}
+
+/**
+ * @brief Stream the mipmap levels of textures created with oriCreateStreamedTexture() in or out to meet the demand
+ * reported since the last call.
+ *
+ * @details This must be called on the thread with the GL context, e.g. once per frame after the levels have been
+ * reported. Levels are uploaded from the texture's CPU copy a few rows at a time, staged in the same pixel unpack
+ * buffer as oriProcessTextureLoads(), so that at most the budget set with oriSetTextureUploadBudget() is uploaded per
+ * call, and a texture only becomes sharper once a whole level has been uploaded. Levels are dropped once they have gone
+ * unrequested for 60 calls, so that textures don't flicker between levels at the edge of their demand; a level that is
+ * no longer requested while it is being uploaded stops being uploaded straight away, and is dropped in the same way.
+ *
+ * @ingroup textures
+ */
+void oriProcessTextureStreaming() {
+    size_t budget = _orion.textureUploadBudget ? _orion.textureUploadBudget : _ORION_DEFAULT_UPLOAD_BUDGET;
+
+    for (_oriTextureStream *stream = _orion.textureStreamListHead; stream; stream = stream->next) {
+        unsigned int requested = stream->requested;
+        stream->requested = stream->levelCount;
+
+        // fade in the level that was uploaded last
+        if (stream->minLod > 0.0f) {
+            stream->minLod = (stream->minLod > _ORION_STREAM_FADE_STEP) ? stream->minLod - _ORION_STREAM_FADE_STEP : 0.0f;
+            oriSetTextureParameterf(stream->texture, GL_TEXTURE_MIN_LOD, stream->minLod);
+        }
+
+        // drop levels that have gone unrequested for long enough (but never the tail); a level that is being uploaded
+        // isn't uploaded any further meanwhile, and is abandoned along with them
+        if (requested > stream->first && stream->first < stream->tail) {
+            if (++stream->unrequestedCalls >= _ORION_STREAM_DROP_DELAY) {
+                _orionReallocateStream(stream, (requested < stream->tail) ? requested : stream->tail);
+                stream->uploading = false;
+                stream->rowsUploaded = 0;
+                stream->unrequestedCalls = 0;
+            }
+            continue;
+        }
+        stream->unrequestedCalls = 0;
+
+        if (!budget || (requested >= stream->first && !stream->uploading)) {
+            continue;
+        }
+
+        if (!stream->uploading) {
+            _orionBeginStreamLevel(stream);
+        }
+
+        // (always at least one row, so that the level progresses)
+        unsigned int rowCount = _orionStreamRowCount(stream, stream->first);
+        size_t rowSize = _orionStreamRowSize(stream, stream->first);
+        size_t rows = budget / rowSize;
+        if (!rows) {
+            rows = 1;
+        }
+        if (rows > rowCount - stream->rowsUploaded) {
+            rows = rowCount - stream->rowsUploaded;
+        }
+
+        _orionUploadStreamRows(stream, (unsigned int) rows);
+        budget = (rows * rowSize < budget) ? budget - rows * rowSize : 0;
+
+        if (stream->rowsUploaded == rowCount) {
+            _orionFinishStreamLevel(stream);
+        }
+    }
+}
+
+/**
+ * @brief Return the finest mipmap level of the given streamed texture that is fully uploaded and can be sampled.
+ *
+ * @param texture the texture created with oriCreateStreamedTexture().
+ *
+ * @ingroup textures
+ */
+unsigned int oriGetTextureStreamLevel(oriTexture *texture) {
+    if (!texture->stream) {
+        return 0;
+    }
+
+    return texture->stream->uploading ? texture->stream->first + 1 : texture->stream->first;
+}
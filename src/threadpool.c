@@ -0,0 +1,337 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+// the most worker threads that are started by default.
+#define _ORION_MAX_DEFAULT_WORKERS 8
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief The worker threads that run jobs submitted with _orionSubmitJob(), and their queue.
+ *
+ * @details The pool is started the first time a job is submitted, and stopped by oriTerminate().
+ *
+ */
+typedef struct _oriThreadPool {
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE queueChanged;
+    CONDITION_VARIABLE jobFinished;
+    HANDLE *threads;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t queueChanged;
+    pthread_cond_t jobFinished;
+    pthread_t *threads;
+#endif
+    unsigned int threadCount;
+
+    bool started;
+    bool shutdown;
+
+    _oriJob *queueHead;
+    _oriJob *queueTail;
+} _oriThreadPool;
+
+static _oriThreadPool _orionPool;
+
+// the amount of worker threads to start (0 to choose from the amount of CPUs).
+static unsigned int _orionRequestedWorkers = 0;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static void _orionPoolLock() {
+#ifdef _WIN32
+    EnterCriticalSection(&_orionPool.lock);
+#else
+    pthread_mutex_lock(&_orionPool.lock);
+#endif
+}
+
+static void _orionPoolUnlock() {
+#ifdef _WIN32
+    LeaveCriticalSection(&_orionPool.lock);
+#else
+    pthread_mutex_unlock(&_orionPool.lock);
+#endif
+}
+
+static unsigned int _orionCPUCount() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long r = (long) info.dwNumberOfProcessors;
+#else
+    long r = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (r > 0) ? (unsigned int) r : 1;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI _orionWorker(LPVOID arg) {
+#else
+static void *_orionWorker(void *arg) {
+#endif
+    (void) arg;
+
+    _orionPoolLock();
+
+    while (true) {
+        while (!_orionPool.queueHead && !_orionPool.shutdown) {
+#ifdef _WIN32
+            SleepConditionVariableCS(&_orionPool.queueChanged, &_orionPool.lock, INFINITE);
+#else
+            pthread_cond_wait(&_orionPool.queueChanged, &_orionPool.lock);
+#endif
+        }
+
+        if (_orionPool.shutdown) {
+            break;
+        }
+
+        _oriJob *job = _orionPool.queueHead;
+        _orionPool.queueHead = job->next;
+        if (!_orionPool.queueHead) {
+            _orionPool.queueTail = NULL;
+        }
+        job->queued = false;
+        job->running = true;
+
+        _orionPoolUnlock();
+        job->func(job);
+        _orionPoolLock();
+
+        job->running = false;
+#ifdef _WIN32
+        WakeAllConditionVariable(&_orionPool.jobFinished);
+#else
+        pthread_cond_broadcast(&_orionPool.jobFinished);
+#endif
+    }
+
+    _orionPoolUnlock();
+
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static void _orionStartPool() {
+    unsigned int count = _orionRequestedWorkers;
+    if (!count) {
+        // (leave a core for the GL thread)
+        unsigned int cpus = _orionCPUCount();
+        count = (cpus > 1) ? cpus - 1 : 1;
+        if (count > _ORION_MAX_DEFAULT_WORKERS) {
+            count = _ORION_MAX_DEFAULT_WORKERS;
+        }
+    }
+
+#ifdef _WIN32
+    InitializeCriticalSection(&_orionPool.lock);
+    InitializeConditionVariable(&_orionPool.queueChanged);
+    InitializeConditionVariable(&_orionPool.jobFinished);
+    _orionPool.threads = malloc(count * sizeof(HANDLE));
+#else
+    pthread_mutex_init(&_orionPool.lock, NULL);
+    pthread_cond_init(&_orionPool.queueChanged, NULL);
+    pthread_cond_init(&_orionPool.jobFinished, NULL);
+    _orionPool.threads = malloc(count * sizeof(pthread_t));
+#endif
+
+    _orionPool.threadCount = 0;
+    _orionPool.shutdown = false;
+    _orionPool.queueHead = NULL;
+    _orionPool.queueTail = NULL;
+    _orionPool.started = true;
+
+    for (unsigned int i = 0; i < count; i++) {
+#ifdef _WIN32
+        _orionPool.threads[i] = CreateThread(NULL, 0, _orionWorker, NULL, 0, NULL);
+        if (!_orionPool.threads[i]) {
+            break;
+        }
+#else
+        if (pthread_create(&_orionPool.threads[i], NULL, _orionWorker, NULL)) {
+            break;
+        }
+#endif
+        _orionPool.threadCount++;
+    }
+
+    if (!_orionPool.threadCount) {
+        _orionThrowWarning("(in _orionStartPool()): Failed to start any worker threads. Jobs will run on the calling thread.");
+    }
+}
+
+void _orionSubmitJob(_oriJob *job, void (*func)(_oriJob *job)) {
+    if (!_orionPool.started) {
+        _orionStartPool();
+    }
+
+    job->func = func;
+    job->next = NULL;
+    job->running = false;
+
+    // (without any workers, run the job straight away)
+    if (!_orionPool.threadCount) {
+        job->queued = false;
+        func(job);
+        return;
+    }
+
+    _orionPoolLock();
+
+    job->queued = true;
+    if (_orionPool.queueTail) {
+        _orionPool.queueTail->next = job;
+    } else {
+        _orionPool.queueHead = job;
+    }
+    _orionPool.queueTail = job;
+
+#ifdef _WIN32
+    WakeConditionVariable(&_orionPool.queueChanged);
+#else
+    pthread_cond_signal(&_orionPool.queueChanged);
+#endif
+
+    _orionPoolUnlock();
+}
+
+bool _orionJobPending(_oriJob *job) {
+    if (!_orionPool.started) {
+        return false;
+    }
+
+    _orionPoolLock();
+    bool r = job->queued || job->running;
+    _orionPoolUnlock();
+
+    return r;
+}
+
+void _orionWaitJob(_oriJob *job, bool cancel) {
+    if (!_orionPool.started) {
+        return;
+    }
+
+    _orionPoolLock();
+
+    if (cancel && job->queued) {
+        // unlink from the queue
+        _oriJob **current = &_orionPool.queueHead;
+        _oriJob *previous = NULL;
+        while (*current != job) {
+            previous = *current;
+            current = &(*current)->next;
+        }
+        *current = job->next;
+        if (_orionPool.queueTail == job) {
+            _orionPool.queueTail = previous;
+        }
+        job->queued = false;
+    }
+
+    while (job->queued || job->running) {
+#ifdef _WIN32
+        SleepConditionVariableCS(&_orionPool.jobFinished, &_orionPool.lock, INFINITE);
+#else
+        pthread_cond_wait(&_orionPool.jobFinished, &_orionPool.lock);
+#endif
+    }
+
+    _orionPoolUnlock();
+}
+
+void _orionShutdownJobs() {
+    if (!_orionPool.started) {
+        return;
+    }
+
+    // (jobs still in the queue are dropped; their owners cancel them before this is called)
+    _orionPoolLock();
+    _orionPool.shutdown = true;
+#ifdef _WIN32
+    WakeAllConditionVariable(&_orionPool.queueChanged);
+#else
+    pthread_cond_broadcast(&_orionPool.queueChanged);
+#endif
+    _orionPoolUnlock();
+
+    for (unsigned int i = 0; i < _orionPool.threadCount; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(_orionPool.threads[i], INFINITE);
+        CloseHandle(_orionPool.threads[i]);
+#else
+        pthread_join(_orionPool.threads[i], NULL);
+#endif
+    }
+
+#ifdef _WIN32
+    DeleteCriticalSection(&_orionPool.lock);
+#else
+    pthread_cond_destroy(&_orionPool.jobFinished);
+    pthread_cond_destroy(&_orionPool.queueChanged);
+    pthread_mutex_destroy(&_orionPool.lock);
+#endif
+
+    free(_orionPool.threads);
+    _orionPool.threads = NULL;
+    _orionPool.threadCount = 0;
+    _orionPool.started = false;
+}
+
+// ======================================================================================
+// *****                         ORION THREAD POOL FUNCTIONS                        *****
+// ======================================================================================
+
+/**
+ * @brief Set the amount of worker threads that Orion uses for background work, such as decoding images loaded with
+ * oriLoadTextureAsync().
+ *
+ * @details The worker threads are started the first time they are needed; this has no effect after that (until
+ * oriTerminate() is called). By default, one thread is started for each CPU except one, up to 8.
+ *
+ * @param count the amount of worker threads, or 0 to choose from the amount of CPUs.
+ *
+ * @ingroup meta
+ */
+void oriSetWorkerThreadCount(const unsigned int count) {
+    if (_orionPool.started) {
+        _orionThrowWarning("(in oriSetWorkerThreadCount()): Worker threads have already been started. Thread count not updated.");
+        return;
+    }
+
+    _orionRequestedWorkers = count;
+}
@@ -0,0 +1,416 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// the minimum amount of vertex attributes and vertex buffer bindings that every GL implementation supports.
+#define _ORION_MAX_VERTEX_ATTRIBS 16
+#define _ORION_MAX_VERTEX_BINDINGS 16
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief An attribute declared in a vertex layout.
+ *
+ */
+typedef struct _oriVertexLayoutAttribute {
+    unsigned int index;
+    unsigned int binding;
+    unsigned int size;
+    unsigned int type;
+    bool normalised;
+    unsigned int offset;
+} _oriVertexLayoutAttribute;
+
+/**
+ * @brief A vertex buffer binding slot declared in a vertex layout.
+ *
+ */
+typedef struct _oriVertexLayoutBinding {
+    unsigned int stride;
+    unsigned int divisor;
+} _oriVertexLayoutBinding;
+
+/**
+ * @brief A vertex array that was created from a layout, and the buffers it was created with.
+ *
+ */
+typedef struct _oriVertexLayoutCacheEntry {
+    struct _oriVertexLayoutCacheEntry *next;
+
+    oriVertexArray *va;
+    oriBuffer *buffers[_ORION_MAX_VERTEX_BINDINGS];
+} _oriVertexLayoutCacheEntry;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A description of a vertex format, with attributes that share vertex buffer binding slots.
+ *
+ * @ingroup vertexspec
+ */
+typedef struct oriVertexLayout {
+    oriVertexLayout *next;
+
+    _oriVertexLayoutAttribute attributes[_ORION_MAX_VERTEX_ATTRIBS];
+    unsigned int attributeCount;
+
+    _oriVertexLayoutBinding bindings[_ORION_MAX_VERTEX_BINDINGS];
+    // one more than the highest binding slot used by an attribute
+    unsigned int bindingCount;
+
+    // vertex arrays that have been created from this layout
+    _oriVertexLayoutCacheEntry *cacheListHead;
+} oriVertexLayout;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+// free every vertex array cached for the given layout (it has been modified, so they no longer match it).
+static void _orionClearVertexLayoutCache(oriVertexLayout *layout) {
+    while (layout->cacheListHead) {
+        _oriVertexLayoutCacheEntry *entry = layout->cacheListHead;
+        layout->cacheListHead = entry->next;
+
+        oriFreeVertexArray(entry->va);
+        free(entry);
+    }
+}
+
+void _orionEvictVertexLayoutBuffer(oriBuffer *buffer) {
+    for (oriVertexLayout *layout = _orion.vertexLayoutListHead; layout; layout = layout->next) {
+        _oriVertexLayoutCacheEntry **current = &layout->cacheListHead;
+
+        while (*current) {
+            _oriVertexLayoutCacheEntry *entry = *current;
+
+            bool uses = false;
+            for (unsigned int i = 0; i < layout->bindingCount; i++) {
+                if (entry->buffers[i] == buffer) {
+                    uses = true;
+                    break;
+                }
+            }
+
+            if (!uses) {
+                current = &entry->next;
+                continue;
+            }
+
+            *current = entry->next;
+            oriFreeVertexArray(entry->va);
+            free(entry);
+        }
+    }
+}
+
+// specify the layout's format and bindings in a new vertex array object.
+static void _orionApplyVertexLayout(oriVertexLayout *layout, oriVertexArray *va, oriBuffer **buffers) {
+    // DSA
+    if (_orion.glVersion >= 450) {
+        for (unsigned int i = 0; i < layout->bindingCount; i++) {
+            if (!buffers[i]) {
+                continue;
+            }
+            glVertexArrayVertexBuffer(va->handle, i, buffers[i]->handle, 0, layout->bindings[i].stride);
+            glVertexArrayBindingDivisor(va->handle, i, layout->bindings[i].divisor);
+        }
+
+        for (unsigned int i = 0; i < layout->attributeCount; i++) {
+            _oriVertexLayoutAttribute *a = &layout->attributes[i];
+
+            glEnableVertexArrayAttrib(va->handle, a->index);
+            switch (_orionVertexAttribFuncType(a->type)) {
+                case 1:
+                default:
+                    glVertexArrayAttribFormat(va->handle, a->index, a->size, a->type, a->normalised, a->offset);
+                    break;
+                case 2:
+                    glVertexArrayAttribIFormat(va->handle, a->index, a->size, a->type, a->offset);
+                    break;
+                case 3:
+                    glVertexArrayAttribLFormat(va->handle, a->index, a->size, a->type, a->offset);
+                    break;
+            }
+            glVertexArrayAttribBinding(va->handle, a->index, a->binding);
+        }
+
+        return;
+    }
+
+    unsigned int previousVA = oriCurrentVertexArray();
+    oriBindVertexArray(va);
+
+    // separate attribute formats (4.3), without DSA
+    if (_orion.glVersion >= 430) {
+        for (unsigned int i = 0; i < layout->bindingCount; i++) {
+            if (!buffers[i]) {
+                continue;
+            }
+            glBindVertexBuffer(i, buffers[i]->handle, 0, layout->bindings[i].stride);
+            glVertexBindingDivisor(i, layout->bindings[i].divisor);
+        }
+
+        for (unsigned int i = 0; i < layout->attributeCount; i++) {
+            _oriVertexLayoutAttribute *a = &layout->attributes[i];
+
+            glEnableVertexAttribArray(a->index);
+            switch (_orionVertexAttribFuncType(a->type)) {
+                case 1:
+                default:
+                    glVertexAttribFormat(a->index, a->size, a->type, a->normalised, a->offset);
+                    break;
+                case 2:
+                    glVertexAttribIFormat(a->index, a->size, a->type, a->offset);
+                    break;
+                case 3:
+                    glVertexAttribLFormat(a->index, a->size, a->type, a->offset);
+                    break;
+            }
+            glVertexAttribBinding(a->index, a->binding);
+        }
+
+        glBindVertexArray(previousVA);
+        return;
+    }
+
+    // otherwise, each attribute has to be given its binding's buffer and stride individually
+    unsigned int previousBuffer = oriCurrentBufferAt(GL_ARRAY_BUFFER);
+
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+
+    for (unsigned int i = 0; i < layout->attributeCount; i++) {
+        _oriVertexLayoutAttribute *a = &layout->attributes[i];
+        _oriVertexLayoutBinding *binding = &layout->bindings[a->binding];
+
+        if (!buffers[a->binding]) {
+            continue;
+        }
+        oriBindBuffer(buffers[a->binding], GL_ARRAY_BUFFER);
+
+        glEnableVertexAttribArray(a->index);
+        switch (_orionVertexAttribFuncType(a->type)) {
+            case 1:
+            default:
+                glVertexAttribPointer(a->index, a->size, a->type, a->normalised, binding->stride, (const void *) (size_t) a->offset);
+                break;
+            case 2:
+                glVertexAttribIPointer(a->index, a->size, a->type, binding->stride, (const void *) (size_t) a->offset);
+                break;
+            case 3:
+                glVertexAttribLPointer(a->index, a->size, a->type, binding->stride, (const void *) (size_t) a->offset);
+                break;
+        }
+
+        if (_orion.glVersion >= 330) {
+            glVertexAttribDivisor(a->index, binding->divisor);
+        }
+    }
+
+#   pragma GCC diagnostic pop
+
+    glBindVertexArray(previousVA);
+    glBindBuffer(GL_ARRAY_BUFFER, previousBuffer);
+}
+
+// ======================================================================================
+// *****                        ORION VERTEX LAYOUT FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Allocate and initialise a new, empty oriVertexLayout structure.
+ *
+ * @details A vertex layout declares a vertex format once: attributes are added with oriVertexLayoutAttribute() and
+ * refer to binding slots declared with oriVertexLayoutBinding(), so e.g. the attributes of an interleaved vertex all share
+ * one binding. Vertex arrays are then created from the layout with oriCreateVertexArrayFromLayout().
+ *
+ * @ingroup vertexspec
+ */
+oriVertexLayout *oriCreateVertexLayout() {
+    _orionAssertVersion(300);
+
+    oriVertexLayout *r = malloc(sizeof(oriVertexLayout));
+    r->attributeCount = 0;
+    r->bindingCount = 0;
+    r->cacheListHead = NULL;
+
+    for (unsigned int i = 0; i < _ORION_MAX_VERTEX_BINDINGS; i++) {
+        r->bindings[i].stride = 0;
+        r->bindings[i].divisor = 0;
+    }
+
+    // add to global linked list
+    r->next = _orion.vertexLayoutListHead;
+    _orion.vertexLayoutListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given vertex layout, including every vertex array created from it.
+ *
+ * @param layout the vertex layout to free.
+ *
+ * @ingroup vertexspec
+ */
+void oriFreeVertexLayout(oriVertexLayout *layout) {
+    _orionAssertVersion(300);
+
+    // unlink from global linked list
+    if (_orion.vertexLayoutListHead == layout) {
+        _orion.vertexLayoutListHead = layout->next;
+    } else {
+        oriVertexLayout *current = _orion.vertexLayoutListHead;
+        while (current->next != layout)
+            current = current->next;
+        current->next = layout->next;
+    }
+
+    _orionClearVertexLayoutCache(layout);
+
+    free(layout);
+    layout = NULL;
+}
+
+/**
+ * @brief Declare the stride and instance divisor of a binding slot of the given vertex layout.
+ *
+ * @details Slots that are never declared have a stride of 0 (tightly packed is @b not inferred) and a divisor of 0.
+ *
+ * @note Modifying a layout frees every vertex array that has been created from it.
+ *
+ * @param layout the layout to modify.
+ * @param binding the index of the binding slot, up to 15.
+ * @param stride the byte offset between consecutive elements in the slot's buffer.
+ * @param divisor 0 if the slot's buffer holds per-vertex data, otherwise the amount of instances that share each element.
+ *
+ * @ingroup vertexspec
+ */
+void oriVertexLayoutBinding(oriVertexLayout *layout, const unsigned int binding, const unsigned int stride, const unsigned int divisor) {
+    if (binding >= _ORION_MAX_VERTEX_BINDINGS) {
+        _orionThrowWarning("(in oriVertexLayoutBinding()): Binding slot is out of range. Layout not updated.");
+        return;
+    }
+    if (divisor) {
+        _orionAssertVersion(330);
+    }
+
+    _orionClearVertexLayoutCache(layout);
+
+    layout->bindings[binding].stride = stride;
+    layout->bindings[binding].divisor = divisor;
+}
+
+/**
+ * @brief Declare a vertex attribute of the given vertex layout.
+ *
+ * @note Modifying a layout frees every vertex array that has been created from it.
+ *
+ * @param layout the layout to modify.
+ * @param index the index of the vertex attribute to be defined.
+ * @param binding the binding slot that the attribute reads from, up to 15.
+ * @param size the number of components per vertex attribute.
+ * @param type the type of each component, e.g. \c GL_FLOAT or \c GL_INT.
+ * @param normalised should the data be normalised
+ * @param offset the offset of the attribute from the start of each element of the binding slot's buffer.
+ *
+ * @ingroup vertexspec
+ */
+void oriVertexLayoutAttribute(oriVertexLayout *layout,
+    const unsigned int index,
+    const unsigned int binding,
+    const unsigned int size,
+    const unsigned int type,
+    const bool normalised,
+    const unsigned int offset
+) {
+    if (binding >= _ORION_MAX_VERTEX_BINDINGS) {
+        _orionThrowWarning("(in oriVertexLayoutAttribute()): Binding slot is out of range. Layout not updated.");
+        return;
+    }
+
+    // redeclaring an attribute replaces it
+    unsigned int i = 0;
+    while (i < layout->attributeCount && layout->attributes[i].index != index) {
+        i++;
+    }
+    if (i == _ORION_MAX_VERTEX_ATTRIBS) {
+        _orionThrowWarning("(in oriVertexLayoutAttribute()): Too many attributes in layout. Layout not updated.");
+        return;
+    }
+    if (i == layout->attributeCount) {
+        layout->attributeCount++;
+    }
+
+    _orionClearVertexLayoutCache(layout);
+
+    _oriVertexLayoutAttribute *a = &layout->attributes[i];
+    a->index = index;
+    a->binding = binding;
+    a->size = size;
+    a->type = type;
+    a->normalised = normalised;
+    a->offset = offset;
+
+    if (binding >= layout->bindingCount) {
+        layout->bindingCount = binding + 1;
+    }
+}
+
+/**
+ * @brief Return a vertex array that reads the given buffers with the given layout.
+ *
+ * @details Vertex arrays are cached by layout and buffers: if this has been called before with the same layout and the
+ * same buffers, the same vertex array is returned without any GL calls. Otherwise, a new vertex array is created and its
+ * format is specified once, with one vertex buffer binding per binding slot rather than one per attribute.
+ *
+ * @warning The returned vertex array is owned by the layout; do not free it or modify it with oriSpecifyVertexData(). It
+ * is freed when the layout is freed or modified, or when one of its buffers is freed.
+ *
+ * @param layout the layout of the vertex data.
+ * @param buffers an array with one buffer per binding slot of the layout (slots that no attribute uses may be NULL).
+ *
+ * @ingroup vertexspec
+ */
+oriVertexArray *oriCreateVertexArrayFromLayout(oriVertexLayout *layout, oriBuffer **buffers) {
+    _orionAssertVersion(300);
+
+    for (_oriVertexLayoutCacheEntry *entry = layout->cacheListHead; entry; entry = entry->next) {
+        if (!memcmp(entry->buffers, buffers, layout->bindingCount * sizeof(oriBuffer *))) {
+            return entry->va;
+        }
+    }
+
+    _oriVertexLayoutCacheEntry *entry = malloc(sizeof(_oriVertexLayoutCacheEntry));
+    memset(entry->buffers, 0, sizeof(entry->buffers));
+    memcpy(entry->buffers, buffers, layout->bindingCount * sizeof(oriBuffer *));
+
+    entry->va = oriCreateVertexArray();
+    _orionApplyVertexLayout(layout, entry->va, entry->buffers);
+
+    entry->next = layout->cacheListHead;
+    layout->cacheListHead = entry;
+
+    return entry->va;
+}
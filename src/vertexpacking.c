@@ -0,0 +1,494 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// the kernels are picked at compile time: SSE2 is always available on x86-64, and AVX2/F16C are used when the library
+// is built with ORION_AVX2 (see src/CMakeLists.txt). NEON is always available on AArch64.
+#if defined(__AVX2__)
+#   define _ORION_AVX2
+#endif
+#if defined(__F16C__)
+#   define _ORION_F16C
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define _ORION_SSE2
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   define _ORION_NEON
+#endif
+
+#if defined(_ORION_AVX2) || defined(_ORION_F16C)
+#   include <immintrin.h>
+#endif
+#if defined(_ORION_SSE2)
+#   include <emmintrin.h>
+#endif
+#if defined(_ORION_NEON)
+#   include <arm_neon.h>
+#endif
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static float _orionClampSnorm(float x) {
+    return x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x);
+}
+
+// convert a float to a half float, rounding to nearest even (subnormals, infinities and NaNs are preserved).
+static unsigned short _orionFloatToHalf(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+
+    uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+
+    uint32_t r;
+    if (u >= (127u + 16) << 23) {
+        // too large for a half: infinity, or a quiet NaN
+        r = (u > 255u << 23) ? 0x7E00 : 0x7C00;
+    } else if (u < 113u << 23) {
+        // subnormal (or zero) as a half: let the FPU do the rounding by adding a magic number
+        uint32_t magicBits = ((127u - 15) + (23 - 10) + 1) << 23;
+        float magic, x;
+        memcpy(&magic, &magicBits, sizeof(magic));
+        memcpy(&x, &u, sizeof(x));
+        x += magic;
+        memcpy(&r, &x, sizeof(r));
+        r -= magicBits;
+    } else {
+        // rebias the exponent and round the mantissa to nearest even
+        uint32_t mantOdd = (u >> 13) & 1;
+        u += ((uint32_t) (15 - 127) << 23) + 0xFFF;
+        u += mantOdd;
+        r = u >> 13;
+    }
+
+    return (unsigned short) (r | (sign >> 16));
+}
+
+#if defined(_ORION_SSE2) && !defined(_ORION_F16C)
+// the same conversion as _orionFloatToHalf(), four lanes at a time. The results are sign-extended 32-bit integers, so that
+// they can be narrowed with _mm_packs_epi32.
+static __m128i _orionFloatToHalfSSE2(__m128 f) {
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+    __m128 justSign = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32((int) 0x80000000u)), f);
+    __m128 absF = _mm_xor_ps(f, justSign);
+    __m128i absI = _mm_castps_si128(absF);
+
+    __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absF, absF));
+    __m128i isRegular = _mm_cmpgt_epi32(f16Max, absI);
+    __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absI);
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(subnormMagic))), subnormMagic);
+
+    __m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absI, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absI, normalBias), mantOdd), 13);
+
+    __m128i nonSpecial = _mm_or_si128(_mm_and_si128(subnormal, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+    __m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, infOrNan));
+
+    __m128i r = _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+    return _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+}
+#endif
+
+// encode a unit vector with octahedral mapping, into two components in [-1, 1].
+static void _orionOctahedralEncode(const float *n, float *r) {
+    float l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+    if (l1 == 0.0f) {
+        r[0] = 0.0f;
+        r[1] = 0.0f;
+        return;
+    }
+
+    float x = n[0] / l1;
+    float y = n[1] / l1;
+
+    // fold the lower hemisphere over the diagonals
+    if (n[2] < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+
+    r[0] = x;
+    r[1] = y;
+}
+
+// the size in bytes of one packed attribute, padded to 4 bytes as recommended by the GL.
+static unsigned int _orionPackedSize(const oriPackedAttribute *attribute) {
+    unsigned int r;
+    switch (attribute->format) {
+        case ORION_PACK_HALF:
+            r = attribute->components * 2;
+            break;
+        case ORION_PACK_SNORM8:
+            r = attribute->components;
+            break;
+        case ORION_PACK_SNORM16:
+            r = attribute->components * 2;
+            break;
+        case ORION_PACK_OCTAHEDRAL:
+            r = 4;
+            break;
+        case ORION_PACK_2_10_10_10:
+            r = 4;
+            break;
+        case ORION_PACK_FLOAT:
+        default:
+            r = attribute->components * 4;
+            break;
+    }
+    return (r + 3) & ~3u;
+}
+
+// ======================================================================================
+// *****                        ORION VERTEX PACKING FUNCTIONS                      *****
+// ======================================================================================
+
+/**
+ * @brief Convert @c count floats to half floats, for use with @c GL_HALF_FLOAT attributes.
+ *
+ * @details Values are rounded to the nearest representable half float; values too large for a half float become
+ * infinities.
+ *
+ * @param dst the destination array of @c count half floats.
+ * @param src the source array of @c count floats.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackHalf(unsigned short *dst, const float *src, const size_t count) {
+    size_t i = 0;
+
+#if defined(_ORION_F16C)
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *) (dst + i), h);
+    }
+#elif defined(_ORION_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _orionFloatToHalfSSE2(_mm_loadu_ps(src + i));
+        __m128i hi = _orionFloatToHalfSSE2(_mm_loadu_ps(src + i + 4));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(_ORION_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+        vst1_u16(dst + i, vreinterpret_u16_f16(h));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = _orionFloatToHalf(src[i]);
+    }
+}
+
+/**
+ * @brief Convert @c count floats in [-1, 1] to normalised signed bytes, for use with normalised @c GL_BYTE attributes.
+ *
+ * @param dst the destination array of @c count bytes.
+ * @param src the source array of @c count floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackSnorm8(signed char *dst, const float *src, const size_t count) {
+    size_t i = 0;
+
+#if defined(_ORION_AVX2)
+    const __m256 lo8 = _mm256_set1_ps(-1.0f), hi8 = _mm256_set1_ps(1.0f), scale8 = _mm256_set1_ps(127.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo8), hi8), scale8));
+        __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lo8), hi8), scale8));
+        // (the AVX2 packs work within 128-bit lanes, so the result is put back in order with a permute)
+        __m256i s = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        __m128i r = _mm_packs_epi16(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        _mm_storeu_si128((__m128i *) (dst + i), r);
+    }
+#endif
+#if defined(_ORION_SSE2)
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(127.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale));
+        __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 8), lo), hi), scale));
+        __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 12), lo), hi), scale));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+#elif defined(_ORION_NEON)
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi), 127.0f));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), lo), hi), 127.0f));
+        vst1_s8(dst + i, vqmovn_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = (signed char) lrintf(_orionClampSnorm(src[i]) * 127.0f);
+    }
+}
+
+/**
+ * @brief Convert @c count floats in [-1, 1] to normalised signed shorts, for use with normalised @c GL_SHORT attributes.
+ *
+ * @param dst the destination array of @c count shorts.
+ * @param src the source array of @c count floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of values to convert.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackSnorm16(short *dst, const float *src, const size_t count) {
+    size_t i = 0;
+
+#if defined(_ORION_AVX2)
+    const __m256 lo8 = _mm256_set1_ps(-1.0f), hi8 = _mm256_set1_ps(1.0f), scale8 = _mm256_set1_ps(32767.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo8), hi8), scale8));
+        __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lo8), hi8), scale8));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8));
+    }
+#endif
+#if defined(_ORION_SSE2)
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(a, b));
+    }
+#elif defined(_ORION_NEON)
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi), 32767.0f));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), lo), hi), 32767.0f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = (short) lrintf(_orionClampSnorm(src[i]) * 32767.0f);
+    }
+}
+
+/**
+ * @brief Encode @c count unit vectors (e.g. normals) with octahedral mapping into pairs of normalised signed shorts.
+ *
+ * @details The encoded attribute is read by the shader as a @c vec2 @c e and decoded with:
+ * @code
+ * vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+ * float t = max(-n.z, 0.0);
+ * n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+ * n = normalize(n);
+ * @endcode
+ *
+ * @param dst the destination array of @c count * 2 shorts.
+ * @param src the source array of @c count * 3 floats.
+ * @param count the amount of vectors to encode.
+ *
+ * @ingroup vertexspec
+ */
+void oriPackOctahedral(short *dst, const float *src, const size_t count) {
+    float encoded[2];
+    for (size_t i = 0; i < count; i++) {
+        _orionOctahedralEncode(src + i * 3, encoded);
+        oriPackSnorm16(dst + i * 2, encoded, 2);
+    }
+}
+
+/**
+ * @brief Pack @c count 4-component vectors in [-1, 1] into the @c GL_INT_2_10_10_10_REV format, for use with normalised
+ * attributes of that type.
+ *
+ * @details x, y and z get 10 bits each and w gets 2 bits, so w can only be -1, 0 or 1 (e.g. the handedness of a tangent).
+ *
+ * @param dst the destination array of @c count packed values.
+ * @param src the source array of @c count * 4 floats. Values outside of [-1, 1] are clamped.
+ * @param count the amount of vectors to pack.
+ *
+ * @ingroup vertexspec
+ */
+void oriPack2_10_10_10(unsigned int *dst, const float *src, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int v[4];
+
+#if defined(_ORION_SSE2)
+        __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+        _mm_storeu_si128((__m128i *) v, _mm_cvtps_epi32(_mm_mul_ps(x, _mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f))));
+#elif defined(_ORION_NEON)
+        float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(src + i * 4), vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+        const float scale[4] = { 511.0f, 511.0f, 511.0f, 1.0f };
+        vst1q_s32(v, vcvtnq_s32_f32(vmulq_f32(x, vld1q_f32(scale))));
+#else
+        v[0] = (int) lrintf(_orionClampSnorm(src[i * 4 + 0]) * 511.0f);
+        v[1] = (int) lrintf(_orionClampSnorm(src[i * 4 + 1]) * 511.0f);
+        v[2] = (int) lrintf(_orionClampSnorm(src[i * 4 + 2]) * 511.0f);
+        v[3] = (int) lrintf(_orionClampSnorm(src[i * 4 + 3]));
+#endif
+
+        dst[i] = ((unsigned int) v[0] & 0x3FF) |
+            (((unsigned int) v[1] & 0x3FF) << 10) |
+            (((unsigned int) v[2] & 0x3FF) << 20) |
+            (((unsigned int) v[3] & 0x3) << 30);
+    }
+}
+
+/**
+ * @brief Pack interleaved float vertices into a compact vertex format and upload them to the given buffer.
+ *
+ * @details Each attribute of the source vertices is converted to the format given by its oriPackedAttribute, and the
+ * packed attributes are interleaved in the order given (each padded to 4 bytes). If @c layout is not NULL, the packed
+ * attributes are declared in it, reading from binding slot @c binding, with the GL type and normalisation that match
+ * their format; the layout can then be used with oriCreateVertexArrayFromLayout().
+ *
+ * @param buffer the buffer to upload the packed vertices to. Its data store is reallocated with oriSetBufferData().
+ * @param usage the usage of the buffer, e.g. @c GL_STATIC_DRAW.
+ * @param src the source vertices.
+ * @param srcStride the amount of floats between the starts of consecutive source vertices.
+ * @param vertexCount the amount of vertices.
+ * @param attributes the attributes to pack.
+ * @param attributeCount the amount of attributes.
+ * @param layout the layout to declare the packed attributes in, or NULL.
+ * @param binding the binding slot of @c layout that @c buffer will be bound to.
+ * @return the stride, in bytes, of the packed vertices.
+ *
+ * @ingroup vertexspec
+ */
+unsigned int oriPackVertices(oriBuffer *buffer, const unsigned int usage, const float *src, const unsigned int srcStride, const size_t vertexCount, const oriPackedAttribute *attributes, const unsigned int attributeCount, oriVertexLayout *layout, const unsigned int binding) {
+    if (!vertexCount || !attributeCount) {
+        _orionThrowWarning("(in oriPackVertices()): No vertices or attributes were given. Buffer not updated.");
+        return 0;
+    }
+
+    unsigned int stride = 0;
+    unsigned int maxSize = 0;
+    for (unsigned int i = 0; i < attributeCount; i++) {
+        if (attributes[i].components < 1 || attributes[i].components > 4) {
+            _orionThrowWarning("(in oriPackVertices()): Attribute component count is not between 1 and 4. Buffer not updated.");
+            return 0;
+        }
+
+        unsigned int size = _orionPackedSize(&attributes[i]);
+        stride += size;
+        if (size > maxSize) {
+            maxSize = size;
+        }
+    }
+
+    unsigned char *packed = calloc(vertexCount * stride, 1);
+
+    // each attribute is gathered into a contiguous stream so that it can be converted with the SIMD kernels
+    float *stream = malloc(vertexCount * 4 * sizeof(float));
+    unsigned char *converted = malloc(vertexCount * maxSize);
+
+    unsigned int offset = 0;
+    for (unsigned int a = 0; a < attributeCount; a++) {
+        const oriPackedAttribute *attribute = &attributes[a];
+
+        // 2_10_10_10 always reads 4 components (w is 0 if it isn't given), octahedral always reads 3
+        unsigned int components = attribute->components;
+        unsigned int streamComponents = components;
+        if (attribute->format == ORION_PACK_OCTAHEDRAL) {
+            streamComponents = 3;
+        } else if (attribute->format == ORION_PACK_2_10_10_10) {
+            streamComponents = 4;
+        }
+
+        for (size_t v = 0; v < vertexCount; v++) {
+            for (unsigned int c = 0; c < streamComponents; c++) {
+                stream[v * streamComponents + c] = (c < components) ? src[v * srcStride + attribute->srcOffset + c] : 0.0f;
+            }
+        }
+
+        unsigned int elementSize;
+        unsigned int type;
+        unsigned int glSize = components;
+        bool normalised = true;
+
+        switch (attribute->format) {
+            case ORION_PACK_HALF:
+                oriPackHalf((unsigned short *) converted, stream, vertexCount * components);
+                elementSize = components * 2;
+                type = GL_HALF_FLOAT;
+                normalised = false;
+                break;
+            case ORION_PACK_SNORM8:
+                oriPackSnorm8((signed char *) converted, stream, vertexCount * components);
+                elementSize = components;
+                type = GL_BYTE;
+                break;
+            case ORION_PACK_SNORM16:
+                oriPackSnorm16((short *) converted, stream, vertexCount * components);
+                elementSize = components * 2;
+                type = GL_SHORT;
+                break;
+            case ORION_PACK_OCTAHEDRAL:
+                oriPackOctahedral((short *) converted, stream, vertexCount);
+                elementSize = 4;
+                type = GL_SHORT;
+                glSize = 2;
+                break;
+            case ORION_PACK_2_10_10_10:
+                oriPack2_10_10_10((unsigned int *) converted, stream, vertexCount);
+                elementSize = 4;
+                type = GL_INT_2_10_10_10_REV;
+                glSize = 4;
+                break;
+            case ORION_PACK_FLOAT:
+            default:
+                memcpy(converted, stream, vertexCount * components * sizeof(float));
+                elementSize = components * 4;
+                type = GL_FLOAT;
+                normalised = false;
+                break;
+        }
+
+        // interleave
+        for (size_t v = 0; v < vertexCount; v++) {
+            memcpy(packed + v * stride + offset, converted + v * elementSize, elementSize);
+        }
+
+        if (layout) {
+            oriVertexLayoutAttribute(layout, attribute->index, binding, glSize, type, normalised, offset);
+        }
+
+        offset += _orionPackedSize(attribute);
+    }
+
+    if (layout) {
+        oriVertexLayoutBinding(layout, binding, stride, 0);
+    }
+
+    oriSetBufferData(buffer, packed, vertexCount * stride, usage);
+
+    free(converted);
+    free(stream);
+    free(packed);
+
+    return stride;
+}
@@ -0,0 +1,850 @@
+/* *************************************************************************************** */
+/*                        ORION GRAPHICS LIBRARY AND RENDERING ENGINE                      */
+/* *************************************************************************************** */
+/* Copyright (c) 2022 Jack Bennett                                                         */
+/* --------------------------------------------------------------------------------------- */
+/* THE  SOFTWARE IS  PROVIDED "AS IS",  WITHOUT WARRANTY OF ANY KIND, EXPRESS  OR IMPLIED, */
+/* INCLUDING  BUT  NOT  LIMITED  TO  THE  WARRANTIES  OF  MERCHANTABILITY,  FITNESS FOR  A */
+/* PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN  NO EVENT SHALL  THE  AUTHORS  OR COPYRIGHT */
+/* HOLDERS  BE  LIABLE  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF */
+/* CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR */
+/* THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                              */
+/* *************************************************************************************** */
+
+#include "internal.h"
+#include "oriongl.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#define _ORION_VT_MAGIC 0x5456524F // "ORVT"
+#define _ORION_VT_VERSION 1
+
+// the most pages that can be loaded at once.
+#define _ORION_VT_MAX_LOADS 16
+
+// the most pages along each side of the base level (page coordinates are 12 bits in the feedback buffer).
+#define _ORION_VT_MAX_PAGES 4096
+
+// the largest page size (pages and their borders are bounded so that the tile size can't overflow).
+#define _ORION_VT_MAX_PAGE_SIZE 4096
+
+// the most cache slots along each side of the page cache (slot coordinates are 8 bits in the page table).
+#define _ORION_VT_MAX_SLOTS 256
+
+// ======================================================================================
+// *****                          ORION INTERNAL DATA TYPES                         *****
+// ======================================================================================
+
+/**
+ * @brief The header of a virtual texture file, followed by the pages of each level (starting with the base level) in
+ * row-major order. Every page is stored uncompressed with its border, so that each is at a fixed offset.
+ *
+ */
+typedef struct _oriVirtualTextureHeader {
+    uint32_t magic;
+    uint32_t version;
+
+    // the size of the image (the levels are padded to a whole, power-of-two amount of pages)
+    uint32_t width;
+    uint32_t height;
+
+    uint32_t pageSize;
+    uint32_t border;
+    uint32_t channels;
+    uint32_t srgb;
+
+    // the amount of pages along each side of the base level, and the amount of levels (down to a single page)
+    uint32_t pagesPerSide;
+    uint32_t levels;
+} _oriVirtualTextureHeader;
+
+/**
+ * @brief A page being read from the file on a worker thread.
+ *
+ */
+typedef struct _oriPageLoad {
+    _oriJob job;
+
+    const unsigned char *source;
+    unsigned char *pixels;
+    size_t size;
+
+    bool active;
+    unsigned int slot;
+} _oriPageLoad;
+
+/**
+ * @brief A slot of the page cache, and the page that it holds.
+ *
+ */
+typedef struct _oriCacheSlot {
+    unsigned int level;
+    unsigned int x;
+    unsigned int y;
+
+    // true if the slot holds a page or a page is being loaded into it
+    bool used;
+    bool loading;
+
+    // (the single page of the last level is never evicted, so that every page has one to fall back to)
+    bool pinned;
+
+    // the frame the page was last requested (or sampled in place of a requested page) in
+    unsigned long lastUsed;
+} _oriCacheSlot;
+
+// ======================================================================================
+// *****                            ORION PUBLIC STRUCTURES                         *****
+// ======================================================================================
+
+/**
+ * @brief A texture that is too large to be resident, which is sampled through a cache of its pages.
+ *
+ */
+typedef struct oriVirtualTexture {
+    oriVirtualTexture *next;
+
+    _oriMappedFile file;
+    _oriVirtualTextureHeader header;
+
+    unsigned int tileSize;
+    size_t tileBytes;
+    unsigned int imageFormat;
+
+    // the index of the first page of each level in the file
+    size_t levelPages[32];
+
+    oriTexture *cache;
+    _oriCacheSlot *slots;
+    unsigned int slotsPerSide;
+
+    // the page table, and a copy of each level of it (an RGBA8 texel per page: the slot x, slot y and level of the page
+    // it is sampled from)
+    oriTexture *pageTable;
+    unsigned char *entries[32];
+
+    // pages requested since the last update, as keys that sort the last level first
+    uint64_t *requests;
+    size_t requestCount;
+    size_t requestCapacity;
+
+    _oriPageLoad loads[_ORION_VT_MAX_LOADS];
+
+    unsigned long frame;
+} oriVirtualTexture;
+
+// ======================================================================================
+// *****                              HELPER FUNCTIONS                              *****
+// ======================================================================================
+
+static uint64_t _orionPageKey(const oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    return ((uint64_t) (vt->header.levels - 1 - level) << 48) | ((uint64_t) y << 24) | x;
+}
+
+static int _orionComparePageKeys(const void *a, const void *b) {
+    uint64_t ka = *(const uint64_t *) a;
+    uint64_t kb = *(const uint64_t *) b;
+    return (ka > kb) - (ka < kb);
+}
+
+static unsigned char *_orionPageEntry(oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    unsigned int side = vt->header.pagesPerSide >> level;
+    return vt->entries[level] + ((size_t) y * side + x) * 4;
+}
+
+static const unsigned char *_orionPageData(const oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    unsigned int side = vt->header.pagesPerSide >> level;
+    return vt->file.data + sizeof(_oriVirtualTextureHeader) + (vt->levelPages[level] + (size_t) y * side + x) * vt->tileBytes;
+}
+
+static void _orionPushPageRequest(oriVirtualTexture *vt, uint64_t key) {
+    if (vt->requestCount == vt->requestCapacity) {
+        size_t capacity = vt->requestCapacity ? vt->requestCapacity * 2 : 256;
+        uint64_t *requests = realloc(vt->requests, capacity * sizeof(uint64_t));
+        if (!requests) {
+            return;
+        }
+
+        vt->requests = requests;
+        vt->requestCapacity = capacity;
+    }
+
+    vt->requests[vt->requestCount++] = key;
+}
+
+// (run on a worker thread; reading the page here is what faults it in from disk)
+static void _orionLoadPage(_oriJob *job) {
+    _oriPageLoad *load = (_oriPageLoad *) job;
+    memcpy(load->pixels, load->source, load->size);
+}
+
+static void _orionUploadPage(oriVirtualTexture *vt, unsigned int slot, const void *pixels) {
+    unsigned int sx = slot % vt->slotsPerSide;
+    unsigned int sy = slot / vt->slotsPerSide;
+
+    // (the rows of 1- and 3-channel pages aren't necessarily 4-byte aligned)
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    oriUploadTexSubImage(vt->cache, 0, sx * vt->tileSize, sy * vt->tileSize, 0, vt->tileSize, vt->tileSize, 1, GL_UNSIGNED_BYTE, pixels, vt->imageFormat);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+// after the entry of the given page has changed, point every page under it that isn't resident at the entry of its
+// parent, then upload the changed region of each level of the page table.
+static void _orionUpdatePageTable(oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    for (unsigned int k = level; k-- > 0;) {
+        unsigned int span = 1u << (level - k);
+        for (unsigned int py = y * span; py < (y + 1) * span; py++) {
+            for (unsigned int px = x * span; px < (x + 1) * span; px++) {
+                unsigned char *entry = _orionPageEntry(vt, k, px, py);
+                if (entry[2] != k) {
+                    memcpy(entry, _orionPageEntry(vt, k + 1, px >> 1, py >> 1), 4);
+                }
+            }
+        }
+    }
+
+    int alignment, rowLength;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &rowLength);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (unsigned int k = 0; k <= level; k++) {
+        unsigned int span = 1u << (level - k);
+
+        // (the region is read out of the whole level)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, (int) (vt->header.pagesPerSide >> k));
+        oriUploadTexSubImage(vt->pageTable, k, x * span, y * span, 0, span, span, 1, GL_UNSIGNED_BYTE, _orionPageEntry(vt, k, x * span, y * span), GL_RGBA);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+static void _orionMapPage(oriVirtualTexture *vt, unsigned int slot) {
+    _oriCacheSlot *s = &vt->slots[slot];
+
+    unsigned char *entry = _orionPageEntry(vt, s->level, s->x, s->y);
+    entry[0] = (unsigned char) (slot % vt->slotsPerSide);
+    entry[1] = (unsigned char) (slot / vt->slotsPerSide);
+    entry[2] = (unsigned char) s->level;
+    entry[3] = 255;
+
+    _orionUpdatePageTable(vt, s->level, s->x, s->y);
+}
+
+static void _orionUnmapPage(oriVirtualTexture *vt, unsigned int slot) {
+    _oriCacheSlot *s = &vt->slots[slot];
+
+    // (only the pinned page is on the last level, so every other page has a parent)
+    memcpy(_orionPageEntry(vt, s->level, s->x, s->y), _orionPageEntry(vt, s->level + 1, s->x >> 1, s->y >> 1), 4);
+
+    _orionUpdatePageTable(vt, s->level, s->x, s->y);
+}
+
+// return a free slot, or the least recently used slot that wasn't used this frame, or UINT_MAX if there is neither.
+static unsigned int _orionFindCacheSlot(oriVirtualTexture *vt) {
+    unsigned int r = UINT_MAX;
+    unsigned long oldest = vt->frame;
+
+    unsigned int slotCount = vt->slotsPerSide * vt->slotsPerSide;
+    for (unsigned int i = 0; i < slotCount; i++) {
+        _oriCacheSlot *slot = &vt->slots[i];
+        if (!slot->used) {
+            return i;
+        }
+        if (slot->loading || slot->pinned) {
+            continue;
+        }
+
+        if (slot->lastUsed < oldest) {
+            oldest = slot->lastUsed;
+            r = i;
+        }
+    }
+
+    return r;
+}
+
+static bool _orionPageLoading(oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    for (unsigned int i = 0; i < _ORION_VT_MAX_LOADS; i++) {
+        if (vt->loads[i].active) {
+            _oriCacheSlot *slot = &vt->slots[vt->loads[i].slot];
+            if (slot->level == level && slot->x == x && slot->y == y) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static const char *_orionParseVirtualTexture(oriVirtualTexture *vt) {
+    _oriVirtualTextureHeader *header = &vt->header;
+
+    if (vt->file.size < sizeof(_oriVirtualTextureHeader)) {
+        return "File is too small to be a virtual texture";
+    }
+    memcpy(header, vt->file.data, sizeof(_oriVirtualTextureHeader));
+
+    if (header->magic != _ORION_VT_MAGIC) {
+        return "File is not a virtual texture";
+    }
+    if (header->version != _ORION_VT_VERSION) {
+        return "Unsupported virtual texture version";
+    }
+    if (header->channels < 1 || header->channels > 4 || !header->pageSize || header->pageSize > _ORION_VT_MAX_PAGE_SIZE || header->border > header->pageSize) {
+        return "Invalid channel count, page size or border";
+    }
+
+    // the page table is a square, power-of-two texture with a level for each level of pages
+    unsigned int pagesPerSide = header->pagesPerSide;
+    if (!pagesPerSide || pagesPerSide > _ORION_VT_MAX_PAGES || (pagesPerSide & (pagesPerSide - 1)) || header->levels != oriGetMipLevelCount(pagesPerSide, pagesPerSide)) {
+        return "Invalid page count";
+    }
+
+    vt->tileSize = header->pageSize + header->border * 2;
+    vt->tileBytes = (size_t) vt->tileSize * vt->tileSize * header->channels;
+
+    size_t pages = 0;
+    for (unsigned int level = 0; level < header->levels; level++) {
+        vt->levelPages[level] = pages;
+        pages += (size_t) (pagesPerSide >> level) * (pagesPerSide >> level);
+    }
+    if ((vt->file.size - sizeof(_oriVirtualTextureHeader)) / vt->tileBytes < pages) {
+        return "File is truncated";
+    }
+
+    return NULL;
+}
+
+// ======================================================================================
+// *****                      ORION VIRTUAL TEXTURE FUNCTIONS                       *****
+// ======================================================================================
+
+/**
+ * @brief Write an 8-bit image to a virtual texture file, split into pages, to be opened with oriCreateVirtualTexture().
+ *
+ * @details The image is padded to a square of a power-of-two amount of pages (repeating its edge texels), and its
+ * mipmap levels are built down to a single page with oriGenerateMipChain(). Each page is stored with @c border texels
+ * of its neighbours around it, so that it can be filtered on its own in the page cache.
+ *
+ * @param path the path of the file to write.
+ * @param image the image, with tightly packed rows.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param channels the amount of channels in the image (1-4).
+ * @param pageSize the width and height of each page, without its border (e.g. 128); at most 4096.
+ * @param border the width of the border around each page: 1 for bilinear filtering, or more for anisotropic filtering;
+ * at most @c pageSize.
+ * @param srgb true if the colour channels of the image are sRGB-encoded (the cache is then created as an sRGB texture).
+ * @return true if the file was written.
+ *
+ * @ingroup textures
+ */
+bool oriWriteVirtualTextureFile(const char *path, const unsigned char *image, unsigned int width, unsigned int height, unsigned int channels, unsigned int pageSize, unsigned int border, bool srgb) {
+    if (!width || !height || channels < 1 || channels > 4 || !pageSize || pageSize > _ORION_VT_MAX_PAGE_SIZE || border > pageSize) {
+        _orionThrowWarning("(in oriWriteVirtualTextureFile()): Invalid image size, channel count, page size or border. Virtual texture file not written.");
+        return false;
+    }
+
+    unsigned int extent = (width > height) ? width : height;
+    unsigned int pagesPerSide = 1;
+    while (pagesPerSide <= _ORION_VT_MAX_PAGES && (size_t) pagesPerSide * pageSize < extent) {
+        pagesPerSide *= 2;
+    }
+    if (pagesPerSide > _ORION_VT_MAX_PAGES) {
+        _orionThrowWarning("(in oriWriteVirtualTextureFile()): Image is more than 4096 pages across. Virtual texture file not written.");
+        return false;
+    }
+
+    _oriVirtualTextureHeader header = {
+        _ORION_VT_MAGIC, _ORION_VT_VERSION, width, height, pageSize, border, channels, srgb, pagesPerSide, oriGetMipLevelCount(pagesPerSide, pagesPerSide)
+    };
+
+    unsigned int side = pagesPerSide * pageSize;
+    unsigned int tileSize = pageSize + border * 2;
+
+    // pad the image to the size of the base level, and build the levels below it
+    unsigned char *square = malloc((size_t) side * side * channels);
+    size_t chainSize = oriGetMipChainSize(side, side, channels);
+    unsigned char *chain = malloc(chainSize ? chainSize : 1);
+    const unsigned char **levels = malloc(oriGetMipLevelCount(side, side) * sizeof(unsigned char *));
+    unsigned char *tile = malloc((size_t) tileSize * tileSize * channels);
+    bool written = false;
+
+    if (square && chain && levels && tile) {
+        for (unsigned int y = 0; y < side; y++) {
+            const unsigned char *row = image + (size_t) ((y < height) ? y : height - 1) * width * channels;
+            for (unsigned int x = 0; x < side; x++) {
+                memcpy(square + ((size_t) y * side + x) * channels, row + (size_t) ((x < width) ? x : width - 1) * channels, channels);
+            }
+        }
+
+        FILE *file = oriGenerateMipChain(square, side, side, channels, ORION_MIP_FILTER_BOX, srgb, chain, levels) ? fopen(path, "wb") : NULL;
+        if (file) {
+            written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+            for (unsigned int level = 0; written && level < header.levels; level++) {
+                unsigned int levelSide = side >> level;
+                unsigned int levelPages = pagesPerSide >> level;
+
+                for (unsigned int page = 0; written && page < levelPages * levelPages; page++) {
+                    int x0 = (int) ((page % levelPages) * pageSize) - (int) border;
+                    int y0 = (int) ((page / levelPages) * pageSize) - (int) border;
+
+                    // (the border is clamped to the edges of the level)
+                    for (unsigned int ty = 0; ty < tileSize; ty++) {
+                        int sy = y0 + (int) ty;
+                        sy = (sy < 0) ? 0 : (sy >= (int) levelSide) ? (int) levelSide - 1 : sy;
+
+                        for (unsigned int tx = 0; tx < tileSize; tx++) {
+                            int sx = x0 + (int) tx;
+                            sx = (sx < 0) ? 0 : (sx >= (int) levelSide) ? (int) levelSide - 1 : sx;
+
+                            memcpy(tile + ((size_t) ty * tileSize + tx) * channels, levels[level] + ((size_t) sy * levelSide + (size_t) sx) * channels, channels);
+                        }
+                    }
+
+                    written = fwrite(tile, 1, (size_t) tileSize * tileSize * channels, file) == (size_t) tileSize * tileSize * channels;
+                }
+            }
+
+            written = (fclose(file) == 0) && written;
+        }
+    }
+
+    free(square);
+    free(chain);
+    free(levels);
+    free(tile);
+
+    if (!written) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriWriteVirtualTextureFile()): Failed to write \"%s\". Virtual texture file not written.", path);
+        _orionThrowWarning(message);
+    }
+
+    return written;
+}
+
+/**
+ * @brief Open a virtual texture file written with oriWriteVirtualTextureFile(), and allocate and initialise a virtual
+ * texture that samples it through a page cache.
+ *
+ * @details Only the pages that are needed are kept in GPU memory, in a fixed-size cache texture of
+ * @c slotsPerSide * @c slotsPerSide pages (see oriGetVirtualTextureCache()). A page table texture (see
+ * oriGetVirtualTexturePageTable()) has a texel for each page of each level, which holds the cache slot and level of the
+ * page that is sampled in its place: the page itself if it is resident, or else its closest resident ancestor. The
+ * single page of the last level is loaded now and never evicted, so that every page has one to fall back to.
+ *
+ * Pages are requested by the application, typically from a feedback pass (see oriProcessVirtualTextureFeedback()), read
+ * from the file (which is mapped into memory) on worker threads, and uploaded into the cache by
+ * oriUpdateVirtualTexture(). Only regular texture uploads are used, so this works on any GL 2.0+ implementation without
+ * @c ARB_sparse_texture.
+ *
+ * With @c vt being (pagesPerSide, pageSize, border, slotsPerSide) from oriGetVirtualTextureProperty(), it is sampled
+ * with:
+ * @code
+ * float virtualLod(vec2 uv) {
+ *     vec2 texels = uv * vt.x * vt.y;
+ *     vec2 dx = dFdx(texels), dy = dFdy(texels);
+ *     return clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), 0.0, log2(vt.x));
+ * }
+ *
+ * vec4 sampleVirtual(vec2 uv) {
+ *     vec3 entry = floor(textureLod(pageTable, uv, floor(virtualLod(uv))).rgb * 255.0 + 0.5);
+ *     float pages = vt.x / exp2(entry.z);
+ *     float tile = vt.y + 2.0 * vt.z;
+ *     vec2 texel = entry.xy * tile + vt.z + fract(uv * pages) * vt.y;
+ *     return textureLod(pageCache, texel / (vt.w * tile), 0.0);
+ * }
+ * @endcode
+ *
+ * @param path the path of the virtual texture file.
+ * @param slotsPerSide the amount of pages along each side of the cache texture (at most 256).
+ * @return the virtual texture, or NULL if the file couldn't be opened or the cache texture would be too large.
+ *
+ * @ingroup textures
+ */
+oriVirtualTexture *oriCreateVirtualTexture(const char *path, unsigned int slotsPerSide) {
+    _orionAssertVersion(200);
+
+    if (!slotsPerSide || slotsPerSide > _ORION_VT_MAX_SLOTS) {
+        _orionThrowWarning("(in oriCreateVirtualTexture()): Slot count is 0 or above 256. Virtual texture not created.");
+        return NULL;
+    }
+
+    oriVirtualTexture *r = malloc(sizeof(oriVirtualTexture));
+
+    if (!_orionMapFile(path, false, &r->file)) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriCreateVirtualTexture()): Failed to open \"%s\". Virtual texture not created.", path);
+        _orionThrowWarning(message);
+
+        free(r);
+        return NULL;
+    }
+
+    const char *error = _orionParseVirtualTexture(r);
+
+    int maxSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (!error && (long long) r->tileSize * slotsPerSide > maxSize) {
+        error = "Cache texture would be above GL_MAX_TEXTURE_SIZE";
+    }
+
+    if (error) {
+        char message[512];
+        snprintf(message, sizeof(message), "(in oriCreateVirtualTexture()): %s (\"%s\"). Virtual texture not created.", error, path);
+        _orionThrowWarning(message);
+
+        _orionUnmapFile(&r->file);
+        free(r);
+        return NULL;
+    }
+
+    const _oriVirtualTextureHeader *header = &r->header;
+
+    static const unsigned int imageFormats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    static const unsigned int internalFormats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    static const unsigned int srgbFormats[4] = { GL_R8, GL_RG8, GL_SRGB8, GL_SRGB8_ALPHA8 };
+    r->imageFormat = imageFormats[header->channels - 1];
+
+    // the page cache (filtered within each page; its border keeps the filter from reading the neighbouring slots)
+    r->slotsPerSide = slotsPerSide;
+    r->cache = oriCreateTexture(GL_TEXTURE_2D, header->srgb ? srgbFormats[header->channels - 1] : internalFormats[header->channels - 1]);
+    oriSetTextureMipmapPolicy(r->cache, ORION_MIPMAPS_NEVER);
+    oriSetTextureParameteri(r->cache, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    oriSetTextureParameteri(r->cache, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    oriSetTextureParameteri(r->cache, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    oriSetTextureParameteri(r->cache, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    oriUploadTexImage(r->cache, GL_UNSIGNED_BYTE, NULL, r->tileSize * slotsPerSide, r->tileSize * slotsPerSide, 0, r->imageFormat);
+
+    r->slots = calloc((size_t) slotsPerSide * slotsPerSide, sizeof(_oriCacheSlot));
+
+    // load the page of the last level into the first slot, and point every page at it
+    unsigned int last = header->levels - 1;
+    r->slots[0].level = last;
+    r->slots[0].used = true;
+    r->slots[0].pinned = true;
+    _orionUploadPage(r, 0, _orionPageData(r, last, 0, 0));
+
+    for (unsigned int level = 0; level < header->levels; level++) {
+        size_t pages = (size_t) (header->pagesPerSide >> level) * (header->pagesPerSide >> level);
+        r->entries[level] = malloc(pages * 4);
+        for (size_t i = 0; i < pages; i++) {
+            unsigned char *entry = r->entries[level] + i * 4;
+            entry[0] = 0;
+            entry[1] = 0;
+            entry[2] = (unsigned char) last;
+            entry[3] = 255;
+        }
+    }
+
+    r->pageTable = oriCreateTexture(GL_TEXTURE_2D, GL_RGBA8);
+    oriSetTextureParameteri(r->pageTable, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    oriSetTextureParameteri(r->pageTable, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    oriSetTextureParameteri(r->pageTable, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    oriSetTextureParameteri(r->pageTable, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    oriUploadTexMipmaps(r->pageTable, GL_UNSIGNED_BYTE, (const void *const *) r->entries, header->levels, header->pagesPerSide, header->pagesPerSide, GL_RGBA);
+
+    r->requests = NULL;
+    r->requestCount = 0;
+    r->requestCapacity = 0;
+
+    for (unsigned int i = 0; i < _ORION_VT_MAX_LOADS; i++) {
+        r->loads[i].pixels = NULL;
+        r->loads[i].active = false;
+    }
+
+    r->frame = 1;
+
+    // push to global linked list
+    r->next = _orion.virtualTextureListHead;
+    _orion.virtualTextureListHead = r;
+
+    return r;
+}
+
+/**
+ * @brief Destroy and free memory for the given virtual texture, including its cache and page table textures. Pages that
+ * are being loaded are waited for (or cancelled if they haven't started).
+ *
+ * @param vt the virtual texture to free.
+ *
+ * @ingroup textures
+ */
+void oriFreeVirtualTexture(oriVirtualTexture *vt) {
+    // unlink from global linked list.
+    if (_orion.virtualTextureListHead == vt) {
+        _orion.virtualTextureListHead = vt->next;
+    } else {
+        oriVirtualTexture *current = _orion.virtualTextureListHead;
+        while (current->next != vt)
+            current = current->next;
+        current->next = vt->next;
+    }
+
+    for (unsigned int i = 0; i < _ORION_VT_MAX_LOADS; i++) {
+        if (vt->loads[i].active) {
+            _orionWaitJob(&vt->loads[i].job, true);
+        }
+        free(vt->loads[i].pixels);
+    }
+
+    oriFreeTexture(vt->cache);
+    oriFreeTexture(vt->pageTable);
+
+    for (unsigned int level = 0; level < vt->header.levels; level++) {
+        free(vt->entries[level]);
+    }
+
+    _orionUnmapFile(&vt->file);
+
+    free(vt->slots);
+    free(vt->requests);
+
+    free(vt);
+    vt = NULL;
+}
+
+/**
+ * @brief Request a page of the given virtual texture, to be loaded by the next call to oriUpdateVirtualTexture() if it
+ * isn't resident, or kept in the cache if it is.
+ *
+ * @param vt the virtual texture.
+ * @param level the level of the page.
+ * @param x the column of the page in its level.
+ * @param y the row of the page in its level.
+ *
+ * @ingroup textures
+ */
+void oriRequestVirtualTexturePage(oriVirtualTexture *vt, unsigned int level, unsigned int x, unsigned int y) {
+    if (level >= vt->header.levels || x >= (vt->header.pagesPerSide >> level) || y >= (vt->header.pagesPerSide >> level)) {
+        _orionThrowWarning("(in oriRequestVirtualTexturePage()): Page is outside of the virtual texture. Page not requested.");
+        return;
+    }
+
+    _orionPushPageRequest(vt, _orionPageKey(vt, level, x, y));
+}
+
+/**
+ * @brief Request the pages that were written to a feedback buffer, to be loaded by the next call to
+ * oriUpdateVirtualTexture() if they aren't resident, or kept in the cache if they are.
+ *
+ * @details The feedback buffer is an RGBA8 target that the scene is drawn to with the virtual texture's shader at a low
+ * resolution (e.g. a quarter or an eighth of the screen's). Each texel names the page it sampled: R and G are the low 8
+ * bits of its column and row, B is the high 4 bits of its column plus 16 times the high 4 bits of its row, and A is its
+ * level. Texels that didn't sample the virtual texture are cleared to an A of 255. Using virtualLod() from
+ * oriCreateVirtualTexture() (where @c bias is the log2 of how many times smaller the feedback buffer is than the
+ * screen, so that the same level is requested as is sampled at full resolution):
+ * @code
+ * float lod = floor(max(virtualLod(uv) - bias, 0.0));
+ * vec2 page = min(floor(uv * vt.x / exp2(lod)), vt.x / exp2(lod) - 1.0);
+ * feedback = vec4(mod(page, 256.0), floor(page.x / 256.0) + floor(page.y / 256.0) * 16.0, lod) / 255.0;
+ * @endcode
+ *
+ * The buffer can be read back without stalling with oriReadPixelsAsync(). Each virtual texture needs its own buffer
+ * (or attachment).
+ *
+ * @param vt the virtual texture.
+ * @param feedback the texels of the feedback buffer.
+ * @param texelCount the amount of texels in @c feedback.
+ *
+ * @ingroup textures
+ */
+void oriProcessVirtualTextureFeedback(oriVirtualTexture *vt, const unsigned char *feedback, size_t texelCount) {
+    const unsigned char *previous = NULL;
+
+    for (size_t i = 0; i < texelCount; i++) {
+        const unsigned char *texel = feedback + i * 4;
+
+        // (neighbouring texels usually sampled the same page)
+        if (previous && !memcmp(texel, previous, 4)) {
+            continue;
+        }
+        previous = texel;
+
+        unsigned int level = texel[3];
+        unsigned int x = texel[0] | ((unsigned int) (texel[2] & 0x0F) << 8);
+        unsigned int y = texel[1] | ((unsigned int) (texel[2] >> 4) << 8);
+        if (level >= vt->header.levels || x >= (vt->header.pagesPerSide >> level) || y >= (vt->header.pagesPerSide >> level)) {
+            continue;
+        }
+
+        _orionPushPageRequest(vt, _orionPageKey(vt, level, x, y));
+    }
+}
+
+/**
+ * @brief Upload the pages of the given virtual texture that have been loaded, and start loading the pages that have been
+ * requested since the last update. This should be called once per frame.
+ *
+ * @details Loaded pages are uploaded into the cache up to the texture upload budget (see oriSetTextureUploadBudget()),
+ * and the page table entries that fall back to them are updated. Requested pages are loaded on worker threads, coarser
+ * levels first, into free slots or the slots of the least recently used pages; pages that were requested (or sampled in
+ * place of a requested page) this frame are never evicted for them, so if the cache is too small for a frame's pages,
+ * the rest keep falling back to coarser ones.
+ *
+ * @param vt the virtual texture to update.
+ *
+ * @ingroup textures
+ */
+void oriUpdateVirtualTexture(oriVirtualTexture *vt) {
+    size_t budget = _orion.textureUploadBudget ? _orion.textureUploadBudget : _ORION_DEFAULT_UPLOAD_BUDGET;
+    size_t uploaded = 0;
+
+    for (unsigned int i = 0; i < _ORION_VT_MAX_LOADS; i++) {
+        _oriPageLoad *load = &vt->loads[i];
+        if (!load->active || _orionJobPending(&load->job)) {
+            continue;
+        }
+        if (uploaded && uploaded + vt->tileBytes > budget) {
+            break;
+        }
+
+        _orionUploadPage(vt, load->slot, load->pixels);
+        uploaded += vt->tileBytes;
+
+        vt->slots[load->slot].loading = false;
+        _orionMapPage(vt, load->slot);
+
+        load->active = false;
+    }
+
+    qsort(vt->requests, vt->requestCount, sizeof(uint64_t), _orionComparePageKeys);
+
+    // keep every page that was requested or will be sampled in its place (before any are evicted)
+    for (size_t i = 0; i < vt->requestCount; i++) {
+        uint64_t key = vt->requests[i];
+        unsigned int level = vt->header.levels - 1 - (unsigned int) (key >> 48);
+        unsigned char *entry = _orionPageEntry(vt, level, (unsigned int) (key & 0xFFFFFF), (unsigned int) ((key >> 24) & 0xFFFFFF));
+
+        vt->slots[entry[1] * vt->slotsPerSide + entry[0]].lastUsed = vt->frame;
+    }
+
+    unsigned int nextLoad = 0;
+    for (size_t i = 0; i < vt->requestCount; i++) {
+        uint64_t key = vt->requests[i];
+        if (i && key == vt->requests[i - 1]) {
+            continue;
+        }
+
+        unsigned int level = vt->header.levels - 1 - (unsigned int) (key >> 48);
+        unsigned int x = (unsigned int) (key & 0xFFFFFF);
+        unsigned int y = (unsigned int) ((key >> 24) & 0xFFFFFF);
+        if (_orionPageEntry(vt, level, x, y)[2] == level || _orionPageLoading(vt, level, x, y)) {
+            continue;
+        }
+
+        while (nextLoad < _ORION_VT_MAX_LOADS && vt->loads[nextLoad].active) {
+            nextLoad++;
+        }
+        unsigned int slot = (nextLoad < _ORION_VT_MAX_LOADS) ? _orionFindCacheSlot(vt) : UINT_MAX;
+        if (slot == UINT_MAX) {
+            break;
+        }
+
+        _oriCacheSlot *s = &vt->slots[slot];
+        if (s->used) {
+            _orionUnmapPage(vt, slot);
+        }
+
+        s->level = level;
+        s->x = x;
+        s->y = y;
+        s->used = true;
+        s->loading = true;
+        s->lastUsed = vt->frame;
+
+        _oriPageLoad *load = &vt->loads[nextLoad];
+        if (!load->pixels) {
+            load->pixels = malloc(vt->tileBytes);
+        }
+        load->source = _orionPageData(vt, level, x, y);
+        load->size = vt->tileBytes;
+        load->slot = slot;
+        load->active = true;
+
+        _orionSubmitJob(&load->job, _orionLoadPage);
+    }
+
+    vt->requestCount = 0;
+    vt->frame++;
+}
+
+/**
+ * @brief Return the page cache texture of the given virtual texture, to bind as its @c pageCache sampler. It is owned by
+ * the virtual texture, and freed with it.
+ *
+ * @param vt the virtual texture.
+ * @return the page cache texture.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetVirtualTextureCache(oriVirtualTexture *vt) {
+    return vt->cache;
+}
+
+/**
+ * @brief Return the page table texture of the given virtual texture, to bind as its @c pageTable sampler. It is owned by
+ * the virtual texture, and freed with it.
+ *
+ * @param vt the virtual texture.
+ * @return the page table texture.
+ *
+ * @ingroup textures
+ */
+oriTexture *oriGetVirtualTexturePageTable(oriVirtualTexture *vt) {
+    return vt->pageTable;
+}
+
+/**
+ * @brief Retrieve properties of the given virtual texture. Pass NULL for any property that isn't needed.
+ *
+ * @details The image covers the top-left @c width by @c height texels of the base level, which is
+ * @c pagesPerSide * @c pageSize texels across, so texture coordinates of the image are scaled by
+ * @c width / (@c pagesPerSide * @c pageSize) and @c height / (@c pagesPerSide * @c pageSize) before they are sampled.
+ *
+ * @param vt the virtual texture.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param pagesPerSide the amount of pages along each side of the base level.
+ * @param pageSize the width and height of each page, without its border.
+ * @param border the width of the border around each page in the cache.
+ * @param slotsPerSide the amount of pages along each side of the cache.
+ * @param levels the amount of levels, down to a single page.
+ *
+ * @ingroup textures
+ */
+void oriGetVirtualTextureProperty(oriVirtualTexture *vt, unsigned int *width, unsigned int *height, unsigned int *pagesPerSide, unsigned int *pageSize, unsigned int *border, unsigned int *slotsPerSide, unsigned int *levels) {
+    if (width) {
+        *width = vt->header.width;
+    }
+    if (height) {
+        *height = vt->header.height;
+    }
+    if (pagesPerSide) {
+        *pagesPerSide = vt->header.pagesPerSide;
+    }
+    if (pageSize) {
+        *pageSize = vt->header.pageSize;
+    }
+    if (border) {
+        *border = vt->header.border;
+    }
+    if (slotsPerSide) {
+        *slotsPerSide = vt->slotsPerSide;
+    }
+    if (levels) {
+        *levels = vt->header.levels;
+    }
+}
@@ -27,7 +27,7 @@ void preload() {
 
 void initialise() {
     ibo = oriCreateBuffer();
-    oriSetBufferData(ibo, squareIndices, sizeof(squareIndices), GL_STATIC_DRAW);
+    unsigned int indexType = oriUploadIndexData(ibo, squareIndices, sizeof(squareIndices) / sizeof(unsigned int), GL_STATIC_DRAW, false);
 
     vbo = oriCreateBuffer();
     oriSetBufferData(vbo, squareVertices, sizeof(squareVertices), GL_STATIC_DRAW);
@@ -36,6 +36,7 @@ void initialise() {
     oriSpecifyVertexData(vao, vbo, 0, 3, GL_FLOAT, false, 9 * sizeof(float), 0 * sizeof(float)); // vertex positions
     oriSpecifyVertexData(vao, vbo, 2, 4, GL_FLOAT, false, 9 * sizeof(float), 3 * sizeof(float)); // vertex colours
     oriSpecifyVertexData(vao, vbo, 1, 2, GL_FLOAT, false, 9 * sizeof(float), 7 * sizeof(float)); // tex coords
+    oriSetVertexArrayIndexBuffer(vao, ibo, indexType);
 
     shader = oriCreateShader();
     oriAddShaderSource(shader, GL_VERTEX_SHADER, ORION_VERTEX_SHADER_BASIC);
@@ -88,10 +89,9 @@ void render() {
 
     oriBindTexture(onions, 0);
     oriBindVertexArray(vao);
-    oriBindBuffer(ibo, GL_ELEMENT_ARRAY_BUFFER);
     oriBindShader(shader);
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
+    glDrawElements(GL_TRIANGLES, 6, oriGetVertexArrayIndexType(vao), NULL);
 
     oriSwapBuffers(oritk.window);
     oriPollEvents();
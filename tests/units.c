@@ -0,0 +1,751 @@
+#include "oriongl.h"
+#include "orionwin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Unit tests for the parts of Orion that can be checked on the CPU. A hidden window is still created, as some of the
+// code under test creates GL objects. The exit code is the amount of failed checks.
+
+static unsigned int failures = 0;
+
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            printf("FAILED (%s:%d): %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+// a small deterministic generator, so that results don't depend on the C library's rand().
+static uint32_t random32(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// ======================================================================================
+// *****                                 BUFFER HEAPS                               *****
+// ======================================================================================
+
+static void testBufferHeap() {
+    // (2^30 blocks of 1 byte is beyond the most blocks per page)
+    CHECK(oriCreateBufferHeap(1u << 30, 1) == NULL);
+
+    oriBufferHeap *heap = oriCreateBufferHeap(4096, 256);
+    CHECK(heap != NULL);
+    if (!heap) {
+        return;
+    }
+
+    // 16 blocks of 256 bytes fill the first page, without overlapping
+    oriBufferRange *ranges[16];
+    for (unsigned int i = 0; i < 16; i++) {
+        ranges[i] = oriBufferHeapAlloc(heap, 200);
+        CHECK(ranges[i] != NULL);
+        CHECK(ranges[i]->offset % 256 == 0 && ranges[i]->offset + 256 <= 4096);
+        CHECK(ranges[i]->buffer == ranges[0]->buffer);
+        for (unsigned int j = 0; j < i; j++) {
+            CHECK(ranges[j]->offset != ranges[i]->offset);
+        }
+    }
+    oriBuffer *firstPage = ranges[0]->buffer;
+
+    // the next range needs a new page, and ranges larger than a page can't be allocated
+    oriBufferRange *second = oriBufferHeapAlloc(heap, 1000);
+    CHECK(second != NULL && second->buffer != firstPage && second->offset == 0);
+    CHECK(oriBufferHeapAlloc(heap, 4097) == NULL);
+
+    // freeing every block merges the buddies back into one block the size of the page
+    for (unsigned int i = 0; i < 16; i++) {
+        oriBufferHeapFree(ranges[i]);
+    }
+    oriBufferRange *whole = oriBufferHeapAlloc(heap, 4096);
+    CHECK(whole != NULL && whole->buffer == firstPage && whole->offset == 0);
+    oriBufferHeapFree(whole);
+
+    // once half of the first page is freed, the range left in the second page is moved into it
+    oriBufferRange *left = oriBufferHeapAlloc(heap, 2048);
+    oriBufferRange *right = oriBufferHeapAlloc(heap, 2048);
+    CHECK(left->buffer == firstPage && left->offset == 0);
+    CHECK(right->buffer == firstPage && right->offset == 2048);
+
+    oriBufferRange *moving = oriBufferHeapAlloc(heap, 256);
+    CHECK(moving->buffer == second->buffer);
+    oriBufferHeapFree(right);
+    oriBufferHeapFree(second);
+
+    CHECK(oriDefragmentBufferHeap(heap, 0) == 256);
+    CHECK(moving->buffer == firstPage && moving->offset == 2048 && moving->generation == 1);
+    CHECK(left->offset == 0 && left->generation == 0);
+
+    oriFreeBufferHeap(heap);
+}
+
+// ======================================================================================
+// *****                               BLOCK COMPRESSION                            *****
+// ======================================================================================
+
+static unsigned int readBits(const unsigned char *block, unsigned int *position, unsigned int count) {
+    unsigned int r = 0;
+    for (unsigned int i = 0; i < count; i++, (*position)++) {
+        if (block[*position >> 3] & (1u << (*position & 7))) {
+            r |= 1u << i;
+        }
+    }
+    return r;
+}
+
+// decode a BC1 block into the RGB channels of 16 RGBA texels.
+static void decodeBC1(const unsigned char *block, unsigned char *texels) {
+    unsigned int c[2] = { block[0] | (block[1] << 8), block[2] | (block[3] << 8) };
+
+    int palette[4][3];
+    for (unsigned int i = 0; i < 2; i++) {
+        palette[i][0] = (int) (((c[i] >> 11) & 31) * 255 + 15) / 31;
+        palette[i][1] = (int) (((c[i] >> 5) & 63) * 255 + 31) / 63;
+        palette[i][2] = (int) ((c[i] & 31) * 255 + 15) / 31;
+    }
+    for (unsigned int k = 0; k < 3; k++) {
+        if (c[0] > c[1]) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k] + 1) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k] + 1) / 3;
+        } else {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+            palette[3][k] = 0;
+        }
+    }
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t) block[7] << 24);
+    for (unsigned int i = 0; i < 16; i++) {
+        for (unsigned int k = 0; k < 3; k++) {
+            texels[i * 4 + k] = (unsigned char) palette[(indices >> (2 * i)) & 3][k];
+        }
+    }
+}
+
+// decode a BC4 block into the first channel of 16 RGBA texels.
+static void decodeBC4(const unsigned char *block, unsigned char *texels) {
+    unsigned int a0 = block[0];
+    unsigned int a1 = block[1];
+
+    unsigned int palette[8] = { a0, a1 };
+    for (unsigned int i = 2; i < 8; i++) {
+        if (a0 > a1) {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        } else {
+            palette[i] = (i < 6) ? ((6 - i) * a0 + (i - 1) * a1) / 5 : ((i == 6) ? 0 : 255);
+        }
+    }
+
+    uint64_t indices = 0;
+    for (unsigned int i = 0; i < 6; i++) {
+        indices |= (uint64_t) block[2 + i] << (8 * i);
+    }
+    for (unsigned int i = 0; i < 16; i++) {
+        texels[i * 4] = (unsigned char) palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+// decode a mode 6 BC7 block (the only mode the encoder writes) into 16 RGBA texels. Returns false for other modes.
+static bool decodeBC7(const unsigned char *block, unsigned char *texels) {
+    static const unsigned int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    unsigned int position = 0;
+    if (readBits(block, &position, 7) != 64) {
+        return false;
+    }
+
+    unsigned int endpoints[2][4];
+    for (unsigned int k = 0; k < 4; k++) {
+        endpoints[0][k] = readBits(block, &position, 7);
+        endpoints[1][k] = readBits(block, &position, 7);
+    }
+    unsigned int p0 = readBits(block, &position, 1);
+    unsigned int p1 = readBits(block, &position, 1);
+
+    for (unsigned int i = 0; i < 16; i++) {
+        // (the first index's top bit is implied to be 0)
+        unsigned int w = weights[readBits(block, &position, i ? 4 : 3)];
+        for (unsigned int k = 0; k < 4; k++) {
+            unsigned int e0 = (endpoints[0][k] << 1) | p0;
+            unsigned int e1 = (endpoints[1][k] << 1) | p1;
+            texels[i * 4 + k] = (unsigned char) (((64 - w) * e0 + w * e1 + 32) >> 6);
+        }
+    }
+
+    return true;
+}
+
+// compress the image, decode it again and return the mean squared error of its first `channels` channels.
+static double roundTripError(const unsigned char *image, unsigned int width, unsigned int height, unsigned int format, unsigned int channels) {
+    size_t size = oriGetCompressedImageSize(format, width, height);
+    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_BPTC_UNORM) ? 16 : 8;
+    unsigned int blocksWide = (width + 3) / 4;
+
+    unsigned char *compressed = calloc(size, 1);
+    oriCompressImage(image, width, height, 4, format, compressed);
+
+    double error = 0.0;
+    size_t samples = 0;
+    for (unsigned int by = 0; by < (height + 3) / 4; by++) {
+        for (unsigned int bx = 0; bx < blocksWide; bx++) {
+            const unsigned char *block = compressed + ((size_t) by * blocksWide + bx) * blockSize;
+            unsigned char texels[64] = { 0 };
+
+            if (format == GL_COMPRESSED_RED_RGTC1) {
+                decodeBC4(block, texels);
+            } else if (format == GL_COMPRESSED_RGBA_BPTC_UNORM) {
+                CHECK(decodeBC7(block, texels));
+            } else {
+                decodeBC1(block, texels);
+            }
+
+            // (texels past the edge of the image are only padding)
+            for (unsigned int i = 0; i < 16; i++) {
+                unsigned int x = bx * 4 + i % 4;
+                unsigned int y = by * 4 + i / 4;
+                if (x >= width || y >= height) {
+                    continue;
+                }
+
+                for (unsigned int k = 0; k < channels; k++) {
+                    double d = (double) texels[i * 4 + k] - image[((size_t) y * width + x) * 4 + k];
+                    error += d * d;
+                    samples++;
+                }
+            }
+        }
+    }
+
+    free(compressed);
+    return error / (double) samples;
+}
+
+static void testBlockCompression() {
+    // a smooth image that isn't a multiple of 4 texels in size
+    unsigned int width = 67;
+    unsigned int height = 45;
+    unsigned char *image = malloc((size_t) width * height * 4);
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+            unsigned char *texel = image + ((size_t) y * width + x) * 4;
+            texel[0] = (unsigned char) (x * 255 / width);
+            texel[1] = (unsigned char) (y * 255 / height);
+            texel[2] = (unsigned char) ((x + y) * 255 / (width + height));
+            texel[3] = (unsigned char) (255 - x * 2);
+        }
+    }
+
+    // (the limits are about twice the errors that the encoder reaches, so that a worse endpoint fit is caught)
+    double bc1 = roundTripError(image, width, height, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 3);
+    double bc4 = roundTripError(image, width, height, GL_COMPRESSED_RED_RGTC1, 1);
+    double bc7 = roundTripError(image, width, height, GL_COMPRESSED_RGBA_BPTC_UNORM, 4);
+    printf("block compression: mean squared error BC1 %.2f, BC4 %.2f, BC7 %.2f\n", bc1, bc4, bc7);
+    CHECK(bc1 < 20.0);
+    CHECK(bc4 < 0.5);
+    CHECK(bc7 < 12.0);
+
+    // a solid block is reproduced exactly (up to the precision of the endpoints)
+    unsigned char solid[16 * 4];
+    for (unsigned int i = 0; i < 16; i++) {
+        solid[i * 4 + 0] = 200;
+        solid[i * 4 + 1] = 100;
+        solid[i * 4 + 2] = 50;
+        solid[i * 4 + 3] = 255;
+    }
+    CHECK(roundTripError(solid, 4, 4, GL_COMPRESSED_RED_RGTC1, 1) == 0.0);
+    CHECK(roundTripError(solid, 4, 4, GL_COMPRESSED_RGBA_BPTC_UNORM, 4) <= 1.0);
+
+    free(image);
+}
+
+// ======================================================================================
+// *****                               TEXTURE CONTAINERS                           *****
+// ======================================================================================
+
+static void write32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+    p[2] = (unsigned char) (v >> 16);
+    p[3] = (unsigned char) (v >> 24);
+}
+
+static void write64(unsigned char *p, uint64_t v) {
+    write32(p, (uint32_t) v);
+    write32(p + 4, (uint32_t) (v >> 32));
+}
+
+// write the given bytes to a file and try to load it as a container.
+static oriTexture *loadContainer(const unsigned char *data, size_t size) {
+    const char *path = "units_container.bin";
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        CHECK(file != NULL);
+        return NULL;
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+
+    oriTexture *r = oriLoadTextureContainer(path);
+    remove(path);
+
+    return r;
+}
+
+// fill in the header of a DDS file of a 4x4 RGBA8 image, followed by the image.
+static void makeDDS(unsigned char *file, unsigned int width, unsigned int height) {
+    memset(file, 0, 192);
+    memcpy(file, "DDS ", 4);
+    write32(file + 4, 124);
+    write32(file + 12, height);
+    write32(file + 16, width);
+    write32(file + 28, 1);
+
+    // (legacy 32-bit pixel format, with red in the lowest byte)
+    write32(file + 76, 32);
+    write32(file + 80, 0x40 | 0x1);
+    write32(file + 88, 32);
+    write32(file + 92, 0xFF);
+    write32(file + 96, 0xFF00);
+    write32(file + 100, 0xFF0000);
+    write32(file + 104, 0xFF000000);
+}
+
+// fill in the header and level index of a KTX2 file of a 4x4 RGBA8 image, followed by the image.
+static void makeKTX2(unsigned char *file, uint64_t levelOffset) {
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    memset(file, 0, 168);
+    memcpy(file, identifier, sizeof(identifier));
+    write32(file + 12, 37);
+    write32(file + 20, 4);
+    write32(file + 24, 4);
+    write32(file + 36, 1);
+    write32(file + 40, 1);
+
+    write64(file + 80, levelOffset);
+    write64(file + 88, 64);
+    write64(file + 96, 64);
+}
+
+static void testTextureContainers() {
+    unsigned char file[192];
+
+    makeDDS(file, 4, 4);
+    oriTexture *texture = loadContainer(file, sizeof(file));
+    CHECK(texture != NULL);
+    if (texture) {
+        oriFreeTexture(texture);
+    }
+
+    // the image is cut off
+    CHECK(loadContainer(file, 128 + 32) == NULL);
+    // the header is cut off
+    CHECK(loadContainer(file, 100) == NULL);
+
+    // dimensions far above any GL implementation's limits
+    makeDDS(file, 1u << 20, 4);
+    CHECK(loadContainer(file, sizeof(file)) == NULL);
+    makeDDS(file, 4, 0xFFFFFFFFu);
+    CHECK(loadContainer(file, sizeof(file)) == NULL);
+
+    unsigned char ktx2[168];
+    makeKTX2(ktx2, 104);
+    texture = loadContainer(ktx2, sizeof(ktx2));
+    CHECK(texture != NULL);
+    if (texture) {
+        oriFreeTexture(texture);
+    }
+
+    // level offsets past the end of the file, including one that wraps when the image size is added to it
+    makeKTX2(ktx2, 200);
+    CHECK(loadContainer(ktx2, sizeof(ktx2)) == NULL);
+    makeKTX2(ktx2, UINT64_MAX - 32);
+    CHECK(loadContainer(ktx2, sizeof(ktx2)) == NULL);
+}
+
+// ======================================================================================
+// *****                                TEXTURE ATLASES                             *****
+// ======================================================================================
+
+static void testAtlasOccupancy() {
+    const unsigned int size = 512;
+    oriTextureAtlas *atlas = oriCreateTextureAtlas(size, size, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 1, 0);
+
+    static unsigned char image[64 * 64 * 4];
+
+    // UI-sized images between 8 and 64 texels across, enough to fill a few layers; the first layer has been offered
+    // every image, so its occupancy is what the packer reaches
+    uint32_t state = 1;
+    size_t area = 0;
+    for (unsigned int i = 0; i < 600; i++) {
+        unsigned int w = 8 + random32(&state) % 57;
+        unsigned int h = 8 + random32(&state) % 57;
+
+        oriAtlasRegion region;
+        bool inserted = oriInsertTextureAtlasImage(atlas, w, h, image, &region);
+        CHECK(inserted);
+        if (inserted && region.layer == 0) {
+            area += (size_t) w * h;
+        }
+    }
+
+    double occupancy = (double) area / ((double) size * size);
+    printf("texture atlas: first layer %.1f%% occupied\n", occupancy * 100.0);
+    CHECK(occupancy >= 0.85);
+
+    oriFreeTextureAtlas(atlas);
+}
+
+// ======================================================================================
+// *****                                VERTEX PACKING                              *****
+// ======================================================================================
+
+static float halfToFloat(unsigned short h) {
+    unsigned int exponent = (h >> 10) & 0x1F;
+    unsigned int mantissa = h & 0x3FF;
+
+    float r;
+    if (exponent == 31) {
+        r = INFINITY;
+    } else if (exponent) {
+        r = ldexpf((float) (mantissa | 0x400), (int) exponent - 25);
+    } else {
+        r = ldexpf((float) mantissa, -24);
+    }
+    return (h & 0x8000) ? -r : r;
+}
+
+// decode an octahedral-mapped vector, as the shader in oriPackOctahedral()'s documentation does.
+static void decodeOctahedral(const short *e, float *n) {
+    float x = e[0] / 32767.0f;
+    float y = e[1] / 32767.0f;
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    float t = (-z > 0.0f) ? -z : 0.0f;
+    x += (x >= 0.0f) ? -t : t;
+    y += (y >= 0.0f) ? -t : t;
+
+    float l = sqrtf(x * x + y * y + z * z);
+    n[0] = x / l;
+    n[1] = y / l;
+    n[2] = z / l;
+}
+
+static void testVertexPacking() {
+    // (the count isn't a multiple of any vector width, so every kernel leaves a scalar tail too)
+    enum { count = 67 };
+
+    uint32_t state = 7;
+    float snorms[count];
+    float halves[count];
+    for (unsigned int i = 0; i < count; i++) {
+        // slightly past [-1, 1], so that clamping is covered
+        snorms[i] = ((float) (random32(&state) % 20001) - 10000.0f) / 8000.0f;
+        // from half subnormals to past the largest half
+        halves[i] = snorms[i] * ldexpf(1.0f, (int) (random32(&state) % 42) - 25);
+    }
+
+    // every kernel must match the scalar path, which converting one value at a time goes through
+    unsigned short packedHalves[count];
+    oriPackHalf(packedHalves, halves, count);
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned short scalar;
+        oriPackHalf(&scalar, &halves[i], 1);
+        CHECK(packedHalves[i] == scalar);
+
+        float decoded = halfToFloat(packedHalves[i]);
+        if (fabsf(halves[i]) >= 65520.0f) {
+            CHECK(isinf(decoded));
+        } else {
+            CHECK(fabsf(decoded - halves[i]) <= fabsf(halves[i]) / 2048.0f + ldexpf(1.0f, -25));
+        }
+    }
+
+    signed char packedSnorm8[count];
+    short packedSnorm16[count];
+    oriPackSnorm8(packedSnorm8, snorms, count);
+    oriPackSnorm16(packedSnorm16, snorms, count);
+    for (unsigned int i = 0; i < count; i++) {
+        signed char scalar8;
+        short scalar16;
+        oriPackSnorm8(&scalar8, &snorms[i], 1);
+        oriPackSnorm16(&scalar16, &snorms[i], 1);
+        CHECK(packedSnorm8[i] == scalar8);
+        CHECK(packedSnorm16[i] == scalar16);
+
+        float clamped = snorms[i] < -1.0f ? -1.0f : (snorms[i] > 1.0f ? 1.0f : snorms[i]);
+        CHECK(fabsf(packedSnorm8[i] / 127.0f - clamped) <= 0.5f / 127.0f + 1e-6f);
+        CHECK(fabsf(packedSnorm16[i] / 32767.0f - clamped) <= 0.5f / 32767.0f + 1e-6f);
+    }
+
+    // unit vectors in every octant, and the axes (where the lower hemisphere folds onto the corners)
+    float normals[count * 3] = {
+        0.0f, 0.0f, 1.0f,   0.0f, 0.0f, -1.0f,   1.0f, 0.0f, 0.0f,   0.0f, -1.0f, 0.0f,
+    };
+    for (unsigned int i = 4; i < count; i++) {
+        float *n = &normals[i * 3];
+        n[0] = (float) (random32(&state) % 2001) - 1000.0f;
+        n[1] = (float) (random32(&state) % 2001) - 1000.0f;
+        n[2] = (float) (random32(&state) % 2001) - 1000.0f + 0.5f;
+        float l = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        n[0] /= l;
+        n[1] /= l;
+        n[2] /= l;
+    }
+
+    short packedNormals[count * 2];
+    oriPackOctahedral(packedNormals, normals, count);
+    float worst = 0.0f;
+    for (unsigned int i = 0; i < count; i++) {
+        float n[3];
+        decodeOctahedral(&packedNormals[i * 2], n);
+        float dx = n[0] - normals[i * 3], dy = n[1] - normals[i * 3 + 1], dz = n[2] - normals[i * 3 + 2];
+        float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+        if (distance > worst) {
+            worst = distance;
+        }
+    }
+    printf("vertex packing: largest octahedral error %.2e\n", worst);
+    CHECK(worst < 1e-4f);
+}
+
+// ======================================================================================
+// *****                              MESH OPTIMISATION                             *****
+// ======================================================================================
+
+// build a flat grid of size x size quads, with the triangles in a random order. Each vertex is its position followed by
+// its own index, so that it can be followed through reordering.
+static void makeShuffledGrid(unsigned int size, float *vertices, unsigned int *indices, uint32_t *state) {
+    for (unsigned int y = 0; y <= size; y++) {
+        for (unsigned int x = 0; x <= size; x++) {
+            float *v = &vertices[(y * (size + 1) + x) * 4];
+            v[0] = (float) x;
+            v[1] = (float) y;
+            v[2] = 0.0f;
+            v[3] = (float) (y * (size + 1) + x);
+        }
+    }
+
+    unsigned int triangleCount = size * size * 2;
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            unsigned int a = y * (size + 1) + x;
+            unsigned int *quad = &indices[(y * size + x) * 6];
+            quad[0] = a;
+            quad[1] = a + 1;
+            quad[2] = a + size + 1;
+            quad[3] = a + 1;
+            quad[4] = a + size + 2;
+            quad[5] = a + size + 1;
+        }
+    }
+
+    for (unsigned int i = triangleCount - 1; i > 0; i--) {
+        unsigned int j = random32(state) % (i + 1);
+        for (unsigned int k = 0; k < 3; k++) {
+            unsigned int t = indices[i * 3 + k];
+            indices[i * 3 + k] = indices[j * 3 + k];
+            indices[j * 3 + k] = t;
+        }
+    }
+}
+
+static void testMeshOptimisation() {
+    enum { size = 48, vertexCount = (size + 1) * (size + 1), indexCount = size * size * 6 };
+
+    static float vertices[vertexCount * 4];
+    static unsigned int indices[indexCount];
+    static unsigned int optimised[indexCount];
+    uint32_t state = 3;
+    makeShuffledGrid(size, vertices, indices, &state);
+
+    float before = oriGetVertexCacheMissRatio(indices, indexCount, vertexCount);
+    oriOptimiseVertexCache(optimised, indices, indexCount, vertexCount);
+    float after = oriGetVertexCacheMissRatio(optimised, indexCount, vertexCount);
+    printf("mesh optimisation: ACMR %.3f before, %.3f after\n", before, after);
+    CHECK(before > 2.0f);
+    CHECK(after < 0.8f);
+
+    // every vertex is still used as many times as before
+    static unsigned int uses[vertexCount];
+    memset(uses, 0, sizeof(uses));
+    for (unsigned int i = 0; i < indexCount; i++) {
+        uses[indices[i]]++;
+        uses[optimised[i]]--;
+    }
+    bool sameUses = true;
+    for (unsigned int v = 0; v < vertexCount; v++) {
+        sameUses = sameUses && !uses[v];
+    }
+    CHECK(sameUses);
+
+    // the fetch remap must be a permutation of the vertices, with the indices following their vertices
+    static float fetched[vertexCount * 4];
+    static unsigned int remapped[indexCount];
+    memcpy(remapped, optimised, sizeof(remapped));
+    size_t fetchedCount = oriOptimiseVertexFetch(fetched, remapped, indexCount, vertices, vertexCount, 4);
+    CHECK(fetchedCount == vertexCount);
+
+    static bool seen[vertexCount];
+    memset(seen, 0, sizeof(seen));
+    bool permutation = true;
+    for (size_t v = 0; v < fetchedCount; v++) {
+        unsigned int original = (unsigned int) fetched[v * 4 + 3];
+        permutation = permutation && original < vertexCount && !seen[original];
+        if (original < vertexCount) {
+            seen[original] = true;
+        }
+    }
+    CHECK(permutation);
+
+    bool followed = true;
+    for (unsigned int i = 0; i < indexCount; i++) {
+        followed = followed && remapped[i] < fetchedCount && fetched[remapped[i] * 4 + 3] == (float) optimised[i];
+    }
+    CHECK(followed);
+
+    // and indices past the vertex count are rejected without anything being written
+    unsigned int bad[3] = { 0, 1, vertexCount };
+    unsigned int untouched[3] = { 7, 7, 7 };
+    oriOptimiseVertexCache(untouched, bad, 3, vertexCount);
+    CHECK(untouched[0] == 7 && untouched[1] == 7 && untouched[2] == 7);
+}
+
+// ======================================================================================
+// *****                             MESH SIMPLIFICATION                            *****
+// ======================================================================================
+
+static void testMeshSimplification() {
+    // a closed torus, so that no vertices are held in place on borders or seams
+    enum { rings = 64, sides = 32, vertexCount = rings * sides, indexCount = rings * sides * 6 };
+
+    static float vertices[vertexCount * 3];
+    static unsigned int indices[indexCount];
+    for (unsigned int i = 0; i < rings; i++) {
+        for (unsigned int j = 0; j < sides; j++) {
+            float a = (float) i / rings * 6.2831853f;
+            float b = (float) j / sides * 6.2831853f;
+            float *v = &vertices[(i * sides + j) * 3];
+            v[0] = (2.0f + cosf(b)) * cosf(a);
+            v[1] = (2.0f + cosf(b)) * sinf(a);
+            v[2] = sinf(b);
+
+            unsigned int p = i * sides + j;
+            unsigned int q = ((i + 1) % rings) * sides + j;
+            unsigned int r = i * sides + (j + 1) % sides;
+            unsigned int s = ((i + 1) % rings) * sides + (j + 1) % sides;
+            unsigned int *quad = &indices[p * 6];
+            quad[0] = p;
+            quad[1] = q;
+            quad[2] = r;
+            quad[3] = q;
+            quad[4] = s;
+            quad[5] = r;
+        }
+    }
+
+    static unsigned int simplified[indexCount];
+    size_t target = (indexCount / 3 / 4) * 3;
+    float error;
+    size_t count = oriSimplifyMesh(simplified, indices, indexCount, vertices, vertexCount, 3, 0, target, &error);
+    printf("mesh simplification: %zu of %u triangles (target %zu), error %.4f\n", count / 3, indexCount / 3, target / 3, error);
+
+    // (a closed mesh has nothing held in place, so the target should be reached)
+    CHECK(count > 0 && count <= target);
+    CHECK(count % 3 == 0);
+    CHECK(error > 0.0f && error < 0.5f);
+
+    bool valid = true;
+    for (size_t t = 0; t < count / 3; t++) {
+        unsigned int a = simplified[t * 3], b = simplified[t * 3 + 1], c = simplified[t * 3 + 2];
+        valid = valid && a < vertexCount && b < vertexCount && c < vertexCount && a != b && b != c && a != c;
+    }
+    CHECK(valid);
+}
+
+// ======================================================================================
+// *****                                   MIPMAPS                                  *****
+// ======================================================================================
+
+static double srgbToLinear(unsigned char c) {
+    double x = c / 255.0;
+    return (x <= 0.04045) ? x / 12.92 : pow((x + 0.055) / 1.055, 2.4);
+}
+
+static void testMipChain() {
+    uint32_t state = 11;
+
+    // box filtering an even-sized image averages each 2x2 block of the level above
+    enum { width = 8, height = 6 };
+    unsigned char image[width * height];
+    for (unsigned int i = 0; i < width * height; i++) {
+        image[i] = (unsigned char) random32(&state);
+    }
+
+    unsigned char chain[64];
+    const unsigned char *levels[4];
+    CHECK(oriGetMipChainSize(width, height, 1) <= sizeof(chain));
+    CHECK(oriGenerateMipChain(image, width, height, 1, ORION_MIP_FILTER_BOX, false, chain, levels) == 4);
+    CHECK(levels[0] == image && levels[1] == chain);
+
+    bool averaged = true;
+    for (unsigned int y = 0; y < height / 2; y++) {
+        for (unsigned int x = 0; x < width / 2; x++) {
+            const unsigned char *p = &image[y * 2 * width + x * 2];
+            double average = (p[0] + p[1] + p[width] + p[width + 1]) / 4.0;
+            averaged = averaged && fabs(levels[1][y * (width / 2) + x] - average) <= 0.5 + 1e-9;
+        }
+    }
+    CHECK(averaged);
+
+    // filtering sRGB texels in linear space keeps the mean brightness of the image down to the last level
+    enum { size = 64 };
+    static unsigned char colours[size * size * 3];
+    static unsigned char colourChain[size * size * 3];
+    const unsigned char *colourLevels[7];
+    for (unsigned int i = 0; i < size * size * 3; i++) {
+        colours[i] = (unsigned char) random32(&state);
+    }
+
+    CHECK(oriGenerateMipChain(colours, size, size, 3, ORION_MIP_FILTER_BOX, true, colourChain, colourLevels) == 7);
+
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for (unsigned int i = 0; i < size * size; i++) {
+        for (unsigned int c = 0; c < 3; c++) {
+            mean[c] += srgbToLinear(colours[i * 3 + c]) / (size * size);
+        }
+    }
+    for (unsigned int c = 0; c < 3; c++) {
+        double last = srgbToLinear(colourLevels[6][c]);
+        printf("mipmaps: channel %u mean %.4f, last level %.4f\n", c, mean[c], last);
+        CHECK(fabs(last - mean[c]) < mean[c] * 0.02);
+    }
+}
+
+// ======================================================================================
+// *****                                    MAIN()                                  *****
+// ======================================================================================
+
+int main() {
+    oriInitialise(430);
+
+    oriWindowHint(GLFW_VISIBLE, false);
+    oriCreateWindow(64, 64, "Orion unit tests", 430, GLFW_OPENGL_CORE_PROFILE);
+
+    testBufferHeap();
+    testBlockCompression();
+    testTextureContainers();
+    testAtlasOccupancy();
+    testVertexPacking();
+    testMeshOptimisation();
+    testMeshSimplification();
+    testMipChain();
+
+    oriTerminate();
+
+    printf("%u check(s) failed\n", failures);
+    return (int) failures;
+}